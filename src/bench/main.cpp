@@ -0,0 +1,81 @@
+#include "core.cmdline/cmdline.hpp"
+#include "fmt/format.h"
+#include "suites.hpp"
+
+auto main(int argc, char** argv) -> int
+{
+	lib::string filter;
+	std::filesystem::path json;
+	std::filesystem::path baseline;
+	float32 minTime = 0.05f;
+	uint32 repetitions = 5;
+	float32 threshold = 10.f;
+	bool list = false;
+
+	core::cmdline::ProgramOptions po{ "usage: lib_bench [options]" };
+	core::cmdline::Option filterOpt{ po, "-f", "--filter", "Only run benchmarks whose name contains this string, e.g. \"map/find\".", filter };
+	core::cmdline::Option jsonOpt{ po, "-o", "--json", "Write the results to this JSON file.", json };
+	core::cmdline::Option baselineOpt{ po, "-b", "--baseline", "Compare the results against a JSON file written by an earlier run.", baseline };
+	core::cmdline::Option thresholdOpt{ po, "-t", "--threshold", "Percentage a benchmark may get slower than the baseline by before it counts as a regression. Defaults to 10.", threshold };
+	core::cmdline::Option minTimeOpt{ po, "-m", "--min-time", "Seconds every repetition runs for at least. Defaults to 0.05.", minTime };
+	core::cmdline::Option repetitionsOpt{ po, "-r", "--repetitions", "Number of repetitions the median is taken over. Defaults to 5.", repetitions };
+	core::cmdline::Option listOpt{ po, "-l", "--list", "List the benchmarks without running them.", list };
+
+	// ProgramOptions prints the help when there are no arguments, running everything is the default here.
+	if (argc > 1 && !po.parse(core::cmdline::CommandLine{ argc, argv }))
+	{
+		return 1;
+	}
+
+	bench::registry benchmarks;
+
+	bench::register_container_benchmarks(benchmarks);
+	bench::register_memory_benchmarks(benchmarks);
+	bench::register_concurrency_benchmarks(benchmarks);
+	bench::register_math_benchmarks(benchmarks);
+	bench::register_text_benchmarks(benchmarks);
+
+	if (list)
+	{
+		for (bench::benchmark const& b : benchmarks.benchmarks())
+		{
+			fmt::print("{}\n", b.name.c_str());
+		}
+
+		return 0;
+	}
+
+#if defined(DEBUG)
+	fmt::print("Warning: this is a debug build, the numbers are not representative.\n\n");
+#endif
+
+	bench::run_options const options{
+		.filter = std::string_view{ filter.c_str(), filter.size() },
+		.minTime = static_cast<float64>(minTime),
+		.repetitions = repetitions
+	};
+
+	// Read the baseline first so that a bad path does not cost a whole run.
+	lib::map<lib::string, float64> previous;
+
+	if (!baseline.empty() && !bench::load_baseline(baseline, previous))
+	{
+		fmt::print("Could not read {}.\n", baseline.string());
+		return 1;
+	}
+
+	lib::array<bench::result> const results = bench::run(benchmarks, options);
+
+	if (!json.empty() && !bench::write_json(json, bench::as_span(results), options))
+	{
+		fmt::print("Could not write {}.\n", json.string());
+		return 1;
+	}
+
+	if (!baseline.empty() && bench::compare(bench::as_span(results), previous, static_cast<float64>(threshold)) != 0)
+	{
+		return 2;
+	}
+
+	return 0;
+}
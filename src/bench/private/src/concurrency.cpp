@@ -0,0 +1,570 @@
+#include <atomic>
+#include <barrier>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "lib/concurrent_map.hpp"
+#include "lib/concurrent_queue.hpp"
+#include "lib/jobs.hpp"
+#include "lib/work_stealing_deque.hpp"
+#include "suites.hpp"
+
+namespace bench
+{
+static constexpr size_t QUEUE_ITEMS			= 1 << 16;
+static constexpr size_t QUEUE_CAPACITY		= 1024;
+static constexpr size_t QUEUE_BATCH			= 32;
+static constexpr size_t ROUND_TRIPS			= 4096;
+static constexpr size_t MAP_KEYS			= 1 << 14;
+static constexpr size_t MAP_OPERATIONS		= 1 << 15;
+static constexpr size_t DEQUE_ITEMS			= 1 << 15;
+static constexpr size_t JOB_COUNT			= 4096;
+
+/**
+* Runs fn(threadIndex) on every thread once per iteration.
+* The threads are started before the timed loop and meet at a barrier around every iteration, so starting threads is not measured.
+*/
+template <typename Fn>
+static auto run_threads(state& s, uint32 count, Fn&& fn) -> void
+{
+	std::barrier start{ static_cast<std::ptrdiff_t>(count + 1) };
+	std::barrier done{ static_cast<std::ptrdiff_t>(count + 1) };
+	std::atomic<bool> stop{ false };
+
+	std::vector<std::thread> threads;
+	threads.reserve(count);
+
+	for (uint32 i = 0; i < count; ++i)
+	{
+		threads.emplace_back([&, i]()
+		{
+			while (true)
+			{
+				start.arrive_and_wait();
+
+				if (stop.load(std::memory_order_relaxed))
+				{
+					break;
+				}
+
+				fn(i);
+				done.arrive_and_wait();
+			}
+		});
+	}
+
+	while (s.keep_running())
+	{
+		start.arrive_and_wait();
+		done.arrive_and_wait();
+	}
+
+	stop.store(true, std::memory_order_relaxed);
+	start.arrive_and_wait();
+
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+}
+
+/**
+* What a queue shared between threads looks like without lib's queues.
+*/
+template <typename T>
+class mutex_queue : lib::non_copyable_non_movable
+{
+public:
+	using value_type = T;
+
+	mutex_queue(size_t capacity) :
+		m_mutex{},
+		m_queue{},
+		m_capacity{ capacity }
+	{}
+
+	auto try_push(T value) -> bool
+	{
+		std::lock_guard lock{ m_mutex };
+
+		if (m_queue.size() == m_capacity)
+		{
+			return false;
+		}
+
+		m_queue.push_back(std::move(value));
+
+		return true;
+	}
+
+	auto try_pop() -> std::optional<T>
+	{
+		std::lock_guard lock{ m_mutex };
+
+		if (m_queue.empty())
+		{
+			return std::nullopt;
+		}
+
+		std::optional<T> value{ std::move(m_queue.front()) };
+		m_queue.pop_front();
+
+		return value;
+	}
+
+private:
+	std::mutex m_mutex;
+	std::deque<T> m_queue;
+	size_t m_capacity;
+};
+
+template <typename queue_type>
+static auto push_spinning(queue_type& queue, uint64 value) -> void
+{
+	while (!queue.try_push(value))
+	{
+		std::this_thread::yield();
+	}
+}
+
+template <typename queue_type>
+static auto pop_spinning(queue_type& queue) -> uint64
+{
+	while (true)
+	{
+		if (std::optional<uint64> value = queue.try_pop(); value.has_value())
+		{
+			return *value;
+		}
+
+		std::this_thread::yield();
+	}
+}
+
+/**
+* Producers push QUEUE_ITEMS between them and consumers pop the same number, each thread its equal share.
+*/
+template <typename queue_type>
+static auto queue_throughput(state& s, uint32 producers, uint32 consumers) -> void
+{
+	queue_type queue{ QUEUE_CAPACITY };
+
+	run_threads(s, producers + consumers, [&](uint32 thread)
+	{
+		if (thread < producers)
+		{
+			for (size_t i = 0; i < QUEUE_ITEMS / producers; ++i)
+			{
+				push_spinning(queue, i);
+			}
+		}
+		else
+		{
+			uint64 sum = 0;
+
+			for (size_t i = 0; i < QUEUE_ITEMS / consumers; ++i)
+			{
+				sum += pop_spinning(queue);
+			}
+
+			do_not_optimize(sum);
+		}
+	});
+
+	s.set_items_processed(s.iterations() * QUEUE_ITEMS);
+}
+
+template <typename queue_type>
+static auto queue_batch_throughput(state& s) -> void
+{
+	queue_type queue{ QUEUE_CAPACITY };
+
+	run_threads(s, 2, [&](uint32 thread)
+	{
+		std::array<uint64, QUEUE_BATCH> batch = {};
+
+		for (size_t done = 0; done < QUEUE_ITEMS;)
+		{
+			size_t const count = std::min(QUEUE_BATCH, QUEUE_ITEMS - done);
+			std::span<uint64> values{ batch.data(), count };
+
+			size_t const moved = (thread == 0) ? queue.try_push_batch(values) : queue.try_pop_batch(values);
+
+			if (moved == 0)
+			{
+				std::this_thread::yield();
+			}
+
+			done += moved;
+		}
+
+		do_not_optimize(batch);
+	});
+
+	s.set_items_processed(s.iterations() * QUEUE_ITEMS);
+}
+
+template <typename queue_type>
+static auto blocking_throughput(state& s, uint32 producers, uint32 consumers) -> void
+{
+	lib::blocking_queue<queue_type> queue{ QUEUE_CAPACITY };
+
+	run_threads(s, producers + consumers, [&](uint32 thread)
+	{
+		if (thread < producers)
+		{
+			for (size_t i = 0; i < QUEUE_ITEMS / producers; ++i)
+			{
+				queue.push(i);
+			}
+		}
+		else
+		{
+			uint64 sum = 0;
+
+			for (size_t i = 0; i < QUEUE_ITEMS / consumers; ++i)
+			{
+				sum += queue.pop();
+			}
+
+			do_not_optimize(sum);
+		}
+	});
+
+	s.set_items_processed(s.iterations() * QUEUE_ITEMS);
+}
+
+/**
+* A value goes from one thread to the other and back through two queues, one round trip at a time.
+*/
+template <typename queue_type>
+static auto queue_latency(state& s) -> void
+{
+	queue_type ping{ QUEUE_CAPACITY };
+	queue_type pong{ QUEUE_CAPACITY };
+
+	run_threads(s, 2, [&](uint32 thread)
+	{
+		for (size_t i = 0; i < ROUND_TRIPS; ++i)
+		{
+			if (thread == 0)
+			{
+				push_spinning(ping, i);
+				do_not_optimize(pop_spinning(pong));
+			}
+			else
+			{
+				push_spinning(pong, pop_spinning(ping));
+			}
+		}
+	});
+
+	s.set_items_processed(s.iterations() * ROUND_TRIPS);
+	s.set_counter("round_trip_ns", std::chrono::duration<float64, std::nano>{ s.elapsed() }.count() / static_cast<float64>(s.iterations() * ROUND_TRIPS));
+}
+
+template <typename queue_type>
+static auto blocking_latency(state& s) -> void
+{
+	lib::blocking_queue<queue_type> ping{ QUEUE_CAPACITY };
+	lib::blocking_queue<queue_type> pong{ QUEUE_CAPACITY };
+
+	run_threads(s, 2, [&](uint32 thread)
+	{
+		for (size_t i = 0; i < ROUND_TRIPS; ++i)
+		{
+			if (thread == 0)
+			{
+				ping.push(i);
+				do_not_optimize(pong.pop());
+			}
+			else
+			{
+				pong.push(ping.pop());
+			}
+		}
+	});
+
+	s.set_items_processed(s.iterations() * ROUND_TRIPS);
+	s.set_counter("round_trip_ns", std::chrono::duration<float64, std::nano>{ s.elapsed() }.count() / static_cast<float64>(s.iterations() * ROUND_TRIPS));
+}
+
+static auto register_queues(registry& benchmarks) -> void
+{
+	benchmarks.add("queue/throughput/lib_spsc/1x1", [](state& s) { queue_throughput<lib::spsc_queue<uint64>>(s, 1, 1); });
+	benchmarks.add("queue/throughput/lib_spsc_batch/1x1", [](state& s) { queue_batch_throughput<lib::spsc_queue<uint64>>(s); });
+	benchmarks.add("queue/throughput/lib_mpmc_batch/1x1", [](state& s) { queue_batch_throughput<lib::mpmc_queue<uint64>>(s); });
+	benchmarks.add("queue/throughput/lib_blocking_spsc/1x1", [](state& s) { blocking_throughput<lib::spsc_queue<uint64>>(s, 1, 1); });
+
+	for (uint32 threads : thread_counts())
+	{
+		if (threads < 2)
+		{
+			continue;
+		}
+
+		uint32 const half = threads / 2;
+
+		benchmarks.add(lib::format("queue/throughput/lib_mpmc/{}x{}", half, half), [half](state& s) { queue_throughput<lib::mpmc_queue<uint64>>(s, half, half); });
+		benchmarks.add(lib::format("queue/throughput/lib_blocking_mpmc/{}x{}", half, half), [half](state& s) { blocking_throughput<lib::mpmc_queue<uint64>>(s, half, half); });
+		benchmarks.add(lib::format("queue/throughput/std_mutex/{}x{}", half, half), [half](state& s) { queue_throughput<mutex_queue<uint64>>(s, half, half); });
+	}
+
+	benchmarks.add("queue/latency/lib_spsc", [](state& s) { queue_latency<lib::spsc_queue<uint64>>(s); });
+	benchmarks.add("queue/latency/lib_mpmc", [](state& s) { queue_latency<lib::mpmc_queue<uint64>>(s); });
+	benchmarks.add("queue/latency/lib_blocking_spsc", [](state& s) { blocking_latency<lib::spsc_queue<uint64>>(s); });
+	benchmarks.add("queue/latency/std_mutex", [](state& s) { queue_latency<mutex_queue<uint64>>(s); });
+}
+
+/**
+* What a shared map looks like without concurrent_map: one reader-writer lock around the whole map.
+*/
+struct locked_map
+{
+	std::shared_mutex mutex;
+	std::unordered_map<uint64, uint64> map;
+
+	auto find(uint64 key) -> std::optional<uint64>
+	{
+		std::shared_lock lock{ mutex };
+
+		if (auto it = map.find(key); it != map.end())
+		{
+			return it->second;
+		}
+
+		return std::nullopt;
+	}
+
+	auto insert_or_assign(uint64 key, uint64 value) -> void
+	{
+		std::lock_guard lock{ mutex };
+		map.insert_or_assign(key, value);
+	}
+};
+
+/**
+* Every thread does MAP_OPERATIONS lookups and updates on shared keys, one in eight is an update.
+*/
+template <typename map_type>
+static auto map_contention(state& s, uint32 threads) -> void
+{
+	map_type m;
+
+	for (uint64 key = 0; key < MAP_KEYS; ++key)
+	{
+		m.insert_or_assign(key, key);
+	}
+
+	run_threads(s, threads, [&](uint32 thread)
+	{
+		rng random{ thread + 1ull };
+		uint64 found = 0;
+
+		for (size_t i = 0; i < MAP_OPERATIONS; ++i)
+		{
+			uint64 const r = random.next();
+			uint64 const key = r % MAP_KEYS;
+
+			if ((r >> 32) % 8 == 0)
+			{
+				m.insert_or_assign(key, r);
+			}
+			else
+			{
+				found += m.find(key).has_value() ? 1 : 0;
+			}
+		}
+
+		do_not_optimize(found);
+	});
+
+	s.set_items_processed(s.iterations() * threads * MAP_OPERATIONS);
+}
+
+static auto register_maps(registry& benchmarks) -> void
+{
+	for (uint32 threads : thread_counts())
+	{
+		benchmarks.add(lib::format("concurrent_map/mixed/lib/{}", threads), [threads](state& s) { map_contention<lib::concurrent_map<uint64, uint64>>(s, threads); });
+		benchmarks.add(lib::format("concurrent_map/mixed/std_shared_mutex/{}", threads), [threads](state& s) { map_contention<locked_map>(s, threads); });
+	}
+}
+
+static auto register_deques(registry& benchmarks) -> void
+{
+	benchmarks.add("deque/push_pop/lib_work_stealing", [](state& s)
+	{
+		lib::work_stealing_deque<uint32> deque{ 1024 };
+
+		while (s.keep_running())
+		{
+			for (uint32 i = 0; i < 1024; ++i)
+			{
+				deque.push(i);
+			}
+
+			uint32 sum = 0;
+
+			while (std::optional<uint32> value = deque.pop())
+			{
+				sum += *value;
+			}
+
+			do_not_optimize(sum);
+		}
+
+		s.set_items_processed(s.iterations() * 1024);
+	});
+	benchmarks.add("deque/push_pop/std_mutex", [](state& s)
+	{
+		std::mutex mutex;
+		std::deque<uint32> deque;
+
+		while (s.keep_running())
+		{
+			for (uint32 i = 0; i < 1024; ++i)
+			{
+				std::lock_guard lock{ mutex };
+				deque.push_back(i);
+			}
+
+			uint32 sum = 0;
+
+			while (true)
+			{
+				std::lock_guard lock{ mutex };
+
+				if (deque.empty())
+				{
+					break;
+				}
+
+				sum += deque.back();
+				deque.pop_back();
+			}
+
+			do_not_optimize(sum);
+		}
+
+		s.set_items_processed(s.iterations() * 1024);
+	});
+
+	// The owner pushes everything and pops what is left while the other threads steal.
+	for (uint32 threads : thread_counts())
+	{
+		if (threads < 2)
+		{
+			continue;
+		}
+
+		benchmarks.add(lib::format("deque/steal/lib_work_stealing/{}", threads), [threads](state& s)
+		{
+			lib::work_stealing_deque<uint32> deque{ 1024 };
+			std::atomic<uint64> taken{ 0 };
+			std::vector<uint64> rounds(threads, 0);
+
+			run_threads(s, threads, [&](uint32 thread)
+			{
+				// Nobody resets "taken", every thread works out the total it has to reach from the rounds it has seen.
+				uint64 const target = ++rounds[thread] * DEQUE_ITEMS;
+
+				if (thread == 0)
+				{
+					for (uint32 i = 0; i < DEQUE_ITEMS; ++i)
+					{
+						deque.push(i);
+					}
+
+					while (deque.pop().has_value())
+					{
+						taken.fetch_add(1, std::memory_order_relaxed);
+					}
+				}
+				else
+				{
+					while (taken.load(std::memory_order_relaxed) < target)
+					{
+						if (deque.steal().has_value())
+						{
+							taken.fetch_add(1, std::memory_order_relaxed);
+						}
+					}
+				}
+
+				while (taken.load(std::memory_order_relaxed) < target)
+				{
+					std::this_thread::yield();
+				}
+			});
+
+			s.set_items_processed(s.iterations() * DEQUE_ITEMS);
+		});
+	}
+}
+
+static auto register_jobs(registry& benchmarks) -> void
+{
+	for (uint32 threads : thread_counts())
+	{
+		benchmarks.add(lib::format("jobs/spawn_empty/lib/{}", threads), [threads](state& s)
+		{
+			lib::jobs::scheduler scheduler{ { .workerCount = threads, .ioThreadCount = 0 } };
+
+			while (s.keep_running())
+			{
+				lib::jobs::counter completion;
+
+				for (size_t i = 0; i < JOB_COUNT; ++i)
+				{
+					scheduler.spawn([]() {}, &completion);
+				}
+
+				scheduler.wait(completion);
+			}
+
+			s.set_items_processed(s.iterations() * JOB_COUNT);
+		});
+		benchmarks.add(lib::format("jobs/spawn_work/lib/{}", threads), [threads](state& s)
+		{
+			lib::jobs::scheduler scheduler{ { .workerCount = threads, .ioThreadCount = 0 } };
+			std::array<uint32, 256> data = {};
+
+			while (s.keep_running())
+			{
+				lib::jobs::counter completion;
+
+				for (size_t i = 0; i < JOB_COUNT; ++i)
+				{
+					scheduler.spawn([&data, i]()
+					{
+						uint32 sum = static_cast<uint32>(i);
+
+						for (uint32 value : data)
+						{
+							sum = sum * 31 + value;
+						}
+
+						do_not_optimize(sum);
+					}, &completion);
+				}
+
+				scheduler.wait(completion);
+			}
+
+			s.set_items_processed(s.iterations() * JOB_COUNT);
+		});
+	}
+}
+
+auto register_concurrency_benchmarks(registry& benchmarks) -> void
+{
+	register_queues(benchmarks);
+	register_maps(benchmarks);
+	register_deques(benchmarks);
+	register_jobs(benchmarks);
+}
+}
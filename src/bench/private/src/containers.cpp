@@ -0,0 +1,808 @@
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "ankerl/unordered_dense.h"
+#include "plf_colony.h"
+#include "lib/dag.hpp"
+#include "lib/paged_array.hpp"
+#include "lib/set.hpp"
+#include "lib/small_array.hpp"
+#include "suites.hpp"
+
+namespace bench
+{
+static constexpr size_t HASH_SIZES[]		= { 1 << 10, 1 << 14, 1 << 18 };
+static constexpr size_t ARRAY_SIZES[]		= { 16, 1 << 10, 1 << 16 };
+static constexpr size_t STRING_SIZES[]		= { 1 << 10, 1 << 16 };
+static constexpr size_t SLOT_MAP_SIZES[]	= { 1 << 10, 1 << 16 };
+static constexpr size_t GRAPH_SIZES[]		= { 1 << 10, 1 << 14, 1 << 17 };
+static constexpr size_t GRAPH_FAN_OUT		= 4;
+
+template <typename key, typename value>
+using group_map = lib::map<key, value, lib::allocator<typename lib::map_traits<key, value>::type>, lib::hash<key>, lib::shift_growth_policy<4>, lib::group_probing_layout>;
+
+template <typename key>
+using group_set = lib::set<key, lib::allocator<typename lib::set_traits<key>::type>, lib::hash<key>, lib::shift_growth_policy<4>, lib::group_probing_layout>;
+
+/**
+* The std and ankerl containers are keyed by std::string, lib's by lib::string.
+*/
+template <typename string_type>
+static auto to_strings(lib::array<lib::string> const& keys) -> lib::array<string_type>
+{
+	lib::array<string_type> out;
+	out.reserve(keys.size());
+
+	for (lib::string const& key : keys)
+	{
+		out.emplace_back(key.c_str(), key.size());
+	}
+
+	return out;
+}
+
+template <typename map_type, typename key_type>
+static auto fill_map(map_type& m, lib::array<key_type> const& keys) -> void
+{
+	uint64 value = 0;
+
+	for (key_type const& key : keys)
+	{
+		m.emplace(key, value++);
+	}
+}
+
+template <typename map_type, typename key_type>
+static auto map_insert(state& s, lib::array<key_type> const& keys) -> void
+{
+	while (s.keep_running())
+	{
+		map_type m;
+		fill_map(m, keys);
+
+		size_t const size = m.size();
+		do_not_optimize(size);
+	}
+
+	s.set_items_processed(s.iterations() * keys.size());
+}
+
+template <typename map_type, typename key_type>
+static auto map_find(state& s, lib::array<key_type> const& keys, lib::array<key_type> const& lookups) -> void
+{
+	map_type m;
+	fill_map(m, keys);
+
+	while (s.keep_running())
+	{
+		size_t found = 0;
+
+		for (key_type const& key : lookups)
+		{
+			found += m.contains(key) ? 1 : 0;
+		}
+
+		do_not_optimize(found);
+	}
+
+	s.set_items_processed(s.iterations() * lookups.size());
+}
+
+template <typename map_type, typename key_type>
+static auto map_erase(state& s, lib::array<key_type> const& keys) -> void
+{
+	while (s.keep_running())
+	{
+		s.pause_timing();
+
+		map_type m;
+		fill_map(m, keys);
+
+		s.resume_timing();
+
+		for (key_type const& key : keys)
+		{
+			m.erase(key);
+		}
+
+		size_t const size = m.size();
+		do_not_optimize(size);
+	}
+
+	s.set_items_processed(s.iterations() * keys.size());
+}
+
+template <typename map_type, typename key_type>
+static auto map_iterate(state& s, lib::array<key_type> const& keys) -> void
+{
+	map_type m;
+	fill_map(m, keys);
+
+	while (s.keep_running())
+	{
+		uint64 sum = 0;
+
+		for (auto const& [key, value] : m)
+		{
+			sum += value;
+		}
+
+		do_not_optimize(sum);
+	}
+
+	s.set_items_processed(s.iterations() * keys.size());
+}
+
+template <typename map_type>
+static auto register_integer_map(registry& benchmarks, std::string_view impl) -> void
+{
+	for (distribution d : distributions_v)
+	{
+		std::string_view const dist = distribution_name(d);
+
+		for (size_t size : HASH_SIZES)
+		{
+			benchmarks.add(lib::format("map/insert/{}/{}/{}", impl, dist, size), [d, size](state& s) { map_insert<map_type, uint64>(s, make_keys(size, d)); });
+			benchmarks.add(lib::format("map/find_hit/{}/{}/{}", impl, dist, size), [d, size](state& s)
+			{
+				lib::array<uint64> const keys = make_keys(size, d);
+				lib::array<uint64> lookups = keys;
+
+				// Looked up in a different order than inserted.
+				rng random{ 3 };
+
+				for (size_t i = lookups.size(); i > 1; --i)
+				{
+					std::swap(lookups[i - 1], lookups[random.next_below(i)]);
+				}
+
+				map_find<map_type, uint64>(s, keys, lookups);
+			});
+			benchmarks.add(lib::format("map/find_miss/{}/{}/{}", impl, dist, size), [d, size](state& s) { map_find<map_type, uint64>(s, make_keys(size, d), make_missing_keys(size, d)); });
+			benchmarks.add(lib::format("map/erase/{}/{}/{}", impl, dist, size), [d, size](state& s) { map_erase<map_type, uint64>(s, make_keys(size, d)); });
+			benchmarks.add(lib::format("map/iterate/{}/{}/{}", impl, dist, size), [d, size](state& s) { map_iterate<map_type, uint64>(s, make_keys(size, d)); });
+		}
+	}
+}
+
+template <typename map_type, typename string_type>
+static auto register_string_map(registry& benchmarks, std::string_view impl) -> void
+{
+	for (size_t size : HASH_SIZES)
+	{
+		benchmarks.add(lib::format("map/insert/{}/string/{}", impl, size), [size](state& s)
+		{
+			map_insert<map_type, string_type>(s, to_strings<string_type>(make_string_keys(size)));
+		});
+		benchmarks.add(lib::format("map/find_hit/{}/string/{}", impl, size), [size](state& s)
+		{
+			lib::array<string_type> const keys = to_strings<string_type>(make_string_keys(size));
+			map_find<map_type, string_type>(s, keys, keys);
+		});
+		benchmarks.add(lib::format("map/find_miss/{}/string/{}", impl, size), [size](state& s)
+		{
+			lib::array<string_type> const keys = to_strings<string_type>(make_string_keys(size, 1));
+			lib::array<string_type> missing = to_strings<string_type>(make_string_keys(size, 2));
+
+			// Same shape as the stored keys, but never equal to one of them.
+			for (string_type& key : missing)
+			{
+				key.push_back('~');
+			}
+
+			map_find<map_type, string_type>(s, keys, missing);
+		});
+	}
+}
+
+template <typename set_type>
+static auto register_set(registry& benchmarks, std::string_view impl) -> void
+{
+	for (size_t size : HASH_SIZES)
+	{
+		benchmarks.add(lib::format("set/insert/{}/uniform/{}", impl, size), [size](state& s)
+		{
+			lib::array<uint64> const keys = make_keys(size, distribution::uniform);
+
+			while (s.keep_running())
+			{
+				set_type set;
+
+				for (uint64 key : keys)
+				{
+					set.emplace(key);
+				}
+
+				size_t const count = set.size();
+				do_not_optimize(count);
+			}
+
+			s.set_items_processed(s.iterations() * size);
+		});
+		benchmarks.add(lib::format("set/find_hit/{}/uniform/{}", impl, size), [size](state& s)
+		{
+			lib::array<uint64> const keys = make_keys(size, distribution::uniform);
+
+			set_type set;
+
+			for (uint64 key : keys)
+			{
+				set.emplace(key);
+			}
+
+			while (s.keep_running())
+			{
+				size_t found = 0;
+
+				for (uint64 key : keys)
+				{
+					found += set.contains(key) ? 1 : 0;
+				}
+
+				do_not_optimize(found);
+			}
+
+			s.set_items_processed(s.iterations() * size);
+		});
+	}
+}
+
+template <typename array_type>
+static auto register_array(registry& benchmarks, std::string_view impl) -> void
+{
+	using value_type = typename array_type::value_type;
+
+	for (size_t size : ARRAY_SIZES)
+	{
+		benchmarks.add(lib::format("array/push_back/{}/{}", impl, size), [size](state& s)
+		{
+			while (s.keep_running())
+			{
+				array_type a;
+
+				for (size_t i = 0; i < size; ++i)
+				{
+					a.push_back(static_cast<value_type>(i));
+				}
+
+				do_not_optimize(a.data());
+			}
+
+			s.set_items_processed(s.iterations() * size);
+		});
+		benchmarks.add(lib::format("array/iterate/{}/{}", impl, size), [size](state& s)
+		{
+			array_type a;
+
+			for (size_t i = 0; i < size; ++i)
+			{
+				a.push_back(static_cast<value_type>(i));
+			}
+
+			while (s.keep_running())
+			{
+				value_type sum = 0;
+
+				for (value_type const& value : a)
+				{
+					sum += value;
+				}
+
+				do_not_optimize(sum);
+			}
+
+			s.set_items_processed(s.iterations() * size);
+		});
+		benchmarks.add(lib::format("array/insert_front/{}/{}", impl, size), [size](state& s)
+		{
+			// Quadratic, so the large size is cut down.
+			size_t const count = std::min(size, size_t{ 4096 });
+
+			while (s.keep_running())
+			{
+				array_type a;
+
+				for (size_t i = 0; i < count; ++i)
+				{
+					a.insert(a.begin(), static_cast<value_type>(i));
+				}
+
+				do_not_optimize(a.data());
+			}
+
+			s.set_items_processed(s.iterations() * count);
+		});
+	}
+}
+
+/**
+* Growing an array of strings, where lib::array relocates with memcpy and std::vector moves one element at a time.
+*/
+template <typename array_type>
+static auto register_string_array(registry& benchmarks, std::string_view impl) -> void
+{
+	for (size_t size : ARRAY_SIZES)
+	{
+		benchmarks.add(lib::format("array/push_back_string/{}/{}", impl, size), [size](state& s)
+		{
+			while (s.keep_running())
+			{
+				array_type a;
+
+				for (size_t i = 0; i < size; ++i)
+				{
+					a.emplace_back("a string too long to fit in place");
+				}
+
+				do_not_optimize(a.data());
+			}
+
+			s.set_items_processed(s.iterations() * size);
+		});
+	}
+}
+
+template <typename array_type>
+static auto register_small_array(registry& benchmarks, std::string_view impl) -> void
+{
+	// Short lived arrays that stay within the inline capacity of small_array.
+	benchmarks.add(lib::format("array/build_small/{}/8", impl), [](state& s)
+	{
+		while (s.keep_running())
+		{
+			array_type a;
+
+			for (uint32 i = 0; i < 8; ++i)
+			{
+				a.push_back(i);
+			}
+
+			do_not_optimize(a.data());
+		}
+
+		s.set_items_processed(s.iterations() * 8);
+	});
+}
+
+template <typename string_type>
+static auto register_string(registry& benchmarks, std::string_view impl) -> void
+{
+	benchmarks.add(lib::format("string/construct_short/{}", impl), [](state& s)
+	{
+		while (s.keep_running())
+		{
+			string_type str{ "short_name" };
+			do_not_optimize(str);
+		}
+
+		s.set_items_processed(s.iterations());
+	});
+	benchmarks.add(lib::format("string/construct_long/{}", impl), [](state& s)
+	{
+		while (s.keep_running())
+		{
+			string_type str{ "assets/textures/albedo/sponza_curtain_blue_diffuse.ktx2" };
+			do_not_optimize(str);
+		}
+
+		s.set_items_processed(s.iterations());
+	});
+
+	for (size_t size : STRING_SIZES)
+	{
+		benchmarks.add(lib::format("string/push_back/{}/{}", impl, size), [size](state& s)
+		{
+			while (s.keep_running())
+			{
+				string_type str;
+
+				for (size_t i = 0; i < size; ++i)
+				{
+					str.push_back(static_cast<char>('a' + (i % 26)));
+				}
+
+				do_not_optimize(str);
+			}
+
+			s.set_items_processed(s.iterations() * size);
+		});
+		benchmarks.add(lib::format("string/append/{}/{}", impl, size), [size](state& s)
+		{
+			std::string_view const piece = "0123456789abcdef";
+
+			while (s.keep_running())
+			{
+				string_type str;
+
+				for (size_t i = 0; i < size; i += piece.size())
+				{
+					str.append(piece);
+				}
+
+				do_not_optimize(str);
+			}
+
+			s.set_items_processed(s.iterations() * size);
+		});
+		benchmarks.add(lib::format("string/compare_equal/{}/{}", impl, size), [size](state& s)
+		{
+			string_type a;
+			string_type b;
+
+			for (size_t i = 0; i < size; ++i)
+			{
+				a.push_back(static_cast<char>('a' + (i % 26)));
+				b.push_back(static_cast<char>('a' + (i % 26)));
+			}
+
+			while (s.keep_running())
+			{
+				do_not_optimize(a);
+				bool const equal = (a == b);
+				do_not_optimize(equal);
+			}
+
+			s.set_items_processed(s.iterations() * size);
+		});
+	}
+}
+
+template <template <typename> typename function_type>
+static auto register_function(registry& benchmarks, std::string_view impl) -> void
+{
+	benchmarks.add(lib::format("function/invoke/{}", impl), [](state& s)
+	{
+		uint64 const scale = 3;
+		function_type<uint64(uint64)> fn = [scale](uint64 x) -> uint64 { return x * scale + 1; };
+
+		uint64 value = 0;
+
+		while (s.keep_running())
+		{
+			do_not_optimize(fn);
+			value = fn(value);
+		}
+
+		do_not_optimize(value);
+		s.set_items_processed(s.iterations());
+	});
+	benchmarks.add(lib::format("function/construct_small/{}", impl), [](state& s)
+	{
+		uint64 a = 1;
+		uint64 b = 2;
+
+		while (s.keep_running())
+		{
+			do_not_optimize(a);
+			function_type<uint64(uint64)> fn = [a, b](uint64 x) -> uint64 { return x * a + b; };
+			do_not_optimize(fn);
+		}
+
+		s.set_items_processed(s.iterations());
+	});
+	benchmarks.add(lib::format("function/construct_large/{}", impl), [](state& s)
+	{
+		std::array<uint64, 8> captured = {};
+
+		while (s.keep_running())
+		{
+			do_not_optimize(captured);
+			function_type<uint64(uint64)> fn = [captured](uint64 x) -> uint64 { return x + captured[x & 7]; };
+			do_not_optimize(fn);
+		}
+
+		s.set_items_processed(s.iterations());
+	});
+}
+
+template <typename signature>
+using std_function = std::function<signature>;
+
+template <typename signature>
+using lib_function = lib::function<signature>;
+
+/**
+* Every vertex depends on up to GRAPH_FAN_OUT of the vertices that follow it, so the graph is acyclic.
+*/
+static auto make_edges(size_t vertexCount) -> lib::array<std::pair<uint32, uint32>>
+{
+	lib::array<std::pair<uint32, uint32>> edges;
+	edges.reserve(vertexCount * GRAPH_FAN_OUT);
+
+	rng random{ 7 };
+
+	for (size_t from = 0; from + 1 < vertexCount; ++from)
+	{
+		for (size_t i = 0; i < GRAPH_FAN_OUT; ++i)
+		{
+			size_t const window = std::min<size_t>(64, vertexCount - from - 1);
+			size_t const to = from + 1 + random.next_below(window);
+
+			edges.emplace_back(static_cast<uint32>(from), static_cast<uint32>(to));
+		}
+	}
+
+	return edges;
+}
+
+static auto build_digraph(lib::digraph<uint32>& graph, size_t vertexCount, lib::array<std::pair<uint32, uint32>> const& edges) -> void
+{
+	graph.reserve(vertexCount, edges.size());
+
+	for (size_t i = 0; i < vertexCount; ++i)
+	{
+		graph.add_vertex(static_cast<uint32>(i));
+	}
+
+	for (auto const& [from, to] : edges)
+	{
+		graph.add_edge_between(from, to);
+	}
+}
+
+/**
+* What the graph looked like before it moved to a CSR adjacency: a hash map of adjacency lists, a hash set against duplicate edges and Kahn's algorithm over them.
+*/
+struct std_digraph
+{
+	std::unordered_map<uint32, std::vector<uint32>> adjacency;
+	std::unordered_set<uint64> edgeKeys;
+
+	auto build(size_t vertexCount, lib::array<std::pair<uint32, uint32>> const& edges) -> void
+	{
+		for (size_t i = 0; i < vertexCount; ++i)
+		{
+			adjacency.emplace(static_cast<uint32>(i), std::vector<uint32>{});
+		}
+
+		for (auto const& [from, to] : edges)
+		{
+			if (edgeKeys.insert((uint64{ from } << 32) | to).second)
+			{
+				adjacency[from].push_back(to);
+			}
+		}
+	}
+
+	auto topological_order() const -> std::vector<uint32>
+	{
+		std::unordered_map<uint32, uint32> inDegree;
+
+		for (auto const& [vertex, successors] : adjacency)
+		{
+			inDegree.try_emplace(vertex, 0);
+
+			for (uint32 successor : successors)
+			{
+				++inDegree[successor];
+			}
+		}
+
+		std::vector<uint32> order;
+		order.reserve(adjacency.size());
+
+		for (auto const& [vertex, degree] : inDegree)
+		{
+			if (degree == 0)
+			{
+				order.push_back(vertex);
+			}
+		}
+
+		for (size_t i = 0; i < order.size(); ++i)
+		{
+			for (uint32 successor : adjacency.at(order[i]))
+			{
+				if (--inDegree[successor] == 0)
+				{
+					order.push_back(successor);
+				}
+			}
+		}
+
+		return order;
+	}
+};
+
+static auto register_digraph(registry& benchmarks) -> void
+{
+	for (size_t size : GRAPH_SIZES)
+	{
+		benchmarks.add(lib::format("digraph/build/lib/{}", size), [size](state& s)
+		{
+			lib::array<std::pair<uint32, uint32>> const edges = make_edges(size);
+
+			while (s.keep_running())
+			{
+				lib::digraph<uint32> graph;
+				build_digraph(graph, size, edges);
+
+				size_t const count = graph.num_edges();
+				do_not_optimize(count);
+			}
+
+			s.set_items_processed(s.iterations() * edges.size());
+		});
+		benchmarks.add(lib::format("digraph/build/std/{}", size), [size](state& s)
+		{
+			lib::array<std::pair<uint32, uint32>> const edges = make_edges(size);
+
+			while (s.keep_running())
+			{
+				std_digraph graph;
+				graph.build(size, edges);
+
+				size_t const count = graph.edgeKeys.size();
+				do_not_optimize(count);
+			}
+
+			s.set_items_processed(s.iterations() * edges.size());
+		});
+		benchmarks.add(lib::format("digraph/topological_order/lib/{}", size), [size](state& s)
+		{
+			lib::array<std::pair<uint32, uint32>> const edges = make_edges(size);
+
+			lib::digraph<uint32> graph;
+			build_digraph(graph, size, edges);
+
+			while (s.keep_running())
+			{
+				auto const result = graph.topological_order();
+				do_not_optimize(result.order.data());
+			}
+
+			s.set_items_processed(s.iterations() * size);
+		});
+		benchmarks.add(lib::format("digraph/topological_order/std/{}", size), [size](state& s)
+		{
+			lib::array<std::pair<uint32, uint32>> const edges = make_edges(size);
+
+			std_digraph graph;
+			graph.build(size, edges);
+
+			while (s.keep_running())
+			{
+				std::vector<uint32> const order = graph.topological_order();
+				do_not_optimize(order.data());
+			}
+
+			s.set_items_processed(s.iterations() * size);
+		});
+		benchmarks.add(lib::format("digraph/levelize/lib/{}", size), [size](state& s)
+		{
+			lib::array<std::pair<uint32, uint32>> const edges = make_edges(size);
+
+			lib::digraph<uint32> graph;
+			build_digraph(graph, size, edges);
+
+			while (s.keep_running())
+			{
+				auto const levels = graph.levelize();
+				do_not_optimize(levels.vertices.data());
+			}
+
+			s.set_items_processed(s.iterations() * size);
+		});
+	}
+}
+
+struct slot_element
+{
+	uint64 id;
+	float32 position[3];
+	uint32 flags;
+};
+
+/**
+* Fills the container, erases every other element and walks what is left, the churn a slot map sees from short lived objects.
+*/
+static auto register_slot_maps(registry& benchmarks) -> void
+{
+	using paged_array_type = lib::paged_array<slot_element, 1024>;
+
+	for (size_t size : SLOT_MAP_SIZES)
+	{
+		benchmarks.add(lib::format("slot_map/churn/lib_paged_array/{}", size), [size](state& s)
+		{
+			lib::array<paged_array_type::index> indices;
+			indices.reserve(size);
+
+			while (s.keep_running())
+			{
+				paged_array_type slots;
+				indices.clear();
+
+				for (size_t i = 0; i < size; ++i)
+				{
+					indices.push_back(slots.emplace(slot_element{ .id = i, .position = {}, .flags = 0 }).first);
+				}
+
+				for (size_t i = 0; i < size; i += 2)
+				{
+					slots.erase(indices[i]);
+				}
+
+				uint64 sum = 0;
+
+				for (slot_element const& element : slots)
+				{
+					sum += element.id;
+				}
+
+				do_not_optimize(sum);
+			}
+
+			s.set_items_processed(s.iterations() * size);
+		});
+		benchmarks.add(lib::format("slot_map/churn/plf_colony/{}", size), [size](state& s)
+		{
+			std::vector<plf::colony<slot_element>::iterator> iterators;
+			iterators.reserve(size);
+
+			while (s.keep_running())
+			{
+				plf::colony<slot_element> slots;
+				iterators.clear();
+
+				for (size_t i = 0; i < size; ++i)
+				{
+					iterators.push_back(slots.insert(slot_element{ .id = i, .position = {}, .flags = 0 }));
+				}
+
+				for (size_t i = 0; i < size; i += 2)
+				{
+					slots.erase(iterators[i]);
+				}
+
+				uint64 sum = 0;
+
+				for (slot_element const& element : slots)
+				{
+					sum += element.id;
+				}
+
+				do_not_optimize(sum);
+			}
+
+			s.set_items_processed(s.iterations() * size);
+		});
+	}
+}
+
+auto register_container_benchmarks(registry& benchmarks) -> void
+{
+	register_array<lib::array<uint64>>(benchmarks, "lib");
+	register_array<std::vector<uint64>>(benchmarks, "std");
+	register_string_array<lib::array<lib::string>>(benchmarks, "lib");
+	register_string_array<std::vector<std::string>>(benchmarks, "std");
+	register_small_array<lib::small_array<uint32, 8>>(benchmarks, "lib_small");
+	register_small_array<lib::array<uint32>>(benchmarks, "lib");
+	register_small_array<std::vector<uint32>>(benchmarks, "std");
+
+	register_integer_map<lib::map<uint64, uint64>>(benchmarks, "lib");
+	register_integer_map<group_map<uint64, uint64>>(benchmarks, "lib_group");
+	register_integer_map<std::unordered_map<uint64, uint64>>(benchmarks, "std");
+	register_integer_map<ankerl::unordered_dense::map<uint64, uint64>>(benchmarks, "ankerl");
+
+	register_string_map<lib::map<lib::string, uint64>, lib::string>(benchmarks, "lib");
+	register_string_map<group_map<lib::string, uint64>, lib::string>(benchmarks, "lib_group");
+	register_string_map<std::unordered_map<std::string, uint64>, std::string>(benchmarks, "std");
+	register_string_map<ankerl::unordered_dense::map<std::string, uint64>, std::string>(benchmarks, "ankerl");
+
+	register_set<lib::set<uint64>>(benchmarks, "lib");
+	register_set<group_set<uint64>>(benchmarks, "lib_group");
+	register_set<std::unordered_set<uint64>>(benchmarks, "std");
+	register_set<ankerl::unordered_dense::set<uint64>>(benchmarks, "ankerl");
+
+	register_string<lib::string>(benchmarks, "lib");
+	register_string<std::string>(benchmarks, "std");
+
+	register_function<lib_function>(benchmarks, "lib");
+	register_function<std_function>(benchmarks, "std");
+
+	register_digraph(benchmarks);
+	register_slot_maps(benchmarks);
+}
+}
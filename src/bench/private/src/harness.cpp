@@ -0,0 +1,429 @@
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <thread>
+#include "fmt/format.h"
+#include "harness.hpp"
+
+namespace bench
+{
+static constexpr uint64 MAX_ITERATIONS = 1'000'000'000ull;
+static constexpr std::string_view NAME_KEY = "\"name\": \"";
+static constexpr std::string_view TIME_KEY = "\"ns_per_iteration\": ";
+
+auto distribution_name(distribution d) -> std::string_view
+{
+	switch (d)
+	{
+	case distribution::sequential:
+		return "sequential";
+	case distribution::uniform:
+		return "uniform";
+	case distribution::high_bits:
+		return "high_bits";
+	}
+
+	return "unknown";
+}
+
+static auto shuffle(std::span<uint64> keys, uint64 seed) -> void
+{
+	rng random{ seed };
+
+	for (size_t i = keys.size(); i > 1; --i)
+	{
+		std::swap(keys[i - 1], keys[random.next_below(i)]);
+	}
+}
+
+/**
+* Even keys for make_keys() and odd keys for make_missing_keys(), so that the two never overlap.
+*/
+static auto generate_keys(size_t count, distribution d, uint64 seed, uint64 parity) -> lib::array<uint64>
+{
+	lib::array<uint64> keys;
+	keys.reserve(count);
+
+	rng random{ seed };
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		switch (d)
+		{
+		case distribution::sequential:
+			keys.push_back(i * 2 + parity);
+			break;
+		case distribution::uniform:
+			keys.push_back((random.next() & ~1ull) | parity);
+			break;
+		case distribution::high_bits:
+			keys.push_back((i * 2 + parity) << 32);
+			break;
+		}
+	}
+
+	if (d != distribution::sequential)
+	{
+		shuffle(as_span(keys), seed);
+	}
+
+	return keys;
+}
+
+auto make_keys(size_t count, distribution d, uint64 seed) -> lib::array<uint64>
+{
+	return generate_keys(count, d, seed, 0);
+}
+
+auto make_missing_keys(size_t count, distribution d, uint64 seed) -> lib::array<uint64>
+{
+	return generate_keys(count, d, seed, 1);
+}
+
+auto make_string_keys(size_t count, uint64 seed) -> lib::array<lib::string>
+{
+	static constexpr std::string_view FOLDERS[] = { "meshes", "textures/albedo", "textures/normal", "materials", "pipelines/forward", "levels/sponza" };
+	static constexpr std::string_view EXTENSIONS[] = { ".sbf", ".ktx2", ".gltf", ".json" };
+
+	lib::array<lib::string> keys;
+	keys.reserve(count);
+
+	rng random{ seed };
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		std::string_view const folder = FOLDERS[random.next_below(std::size(FOLDERS))];
+		std::string_view const extension = EXTENSIONS[random.next_below(std::size(EXTENSIONS))];
+
+		// The index keeps every key distinct.
+		keys.push_back(lib::format("assets/{}/{:x}_{}{}", folder, random.next() & 0xFFFFFF, i, extension));
+	}
+
+	return keys;
+}
+
+auto registry::add(lib::string&& name, benchmark_fn&& fn) -> void
+{
+	ASSERTION(name.find('"') == lib::string::npos && name.find('\\') == lib::string::npos, "Benchmark names are written to JSON unescaped.");
+
+	m_benchmarks.emplace_back(std::move(name), std::move(fn));
+}
+
+static auto seconds(state::clock_type::duration duration) -> float64
+{
+	return std::chrono::duration<float64>{ duration }.count();
+}
+
+static auto format_time(float64 ns) -> std::string
+{
+	if (ns < 1'000.0)
+	{
+		return fmt::format("{:.2f} ns", ns);
+	}
+
+	if (ns < 1'000'000.0)
+	{
+		return fmt::format("{:.2f} us", ns * 1e-3);
+	}
+
+	if (ns < 1'000'000'000.0)
+	{
+		return fmt::format("{:.2f} ms", ns * 1e-6);
+	}
+
+	return fmt::format("{:.2f} s", ns * 1e-9);
+}
+
+static auto format_rate(float64 perSecond) -> std::string
+{
+	if (perSecond <= 0.0)
+	{
+		return {};
+	}
+
+	if (perSecond < 1e3)
+	{
+		return fmt::format("{:.2f} /s", perSecond);
+	}
+
+	if (perSecond < 1e6)
+	{
+		return fmt::format("{:.2f} k/s", perSecond * 1e-3);
+	}
+
+	if (perSecond < 1e9)
+	{
+		return fmt::format("{:.2f} M/s", perSecond * 1e-6);
+	}
+
+	return fmt::format("{:.2f} G/s", perSecond * 1e-9);
+}
+
+static auto print_result(result const& r) -> void
+{
+	fmt::print("{:<72} {:>12} {:>12} {:>14}", r.name.c_str(), format_time(r.nsPerIteration), r.iterations, format_rate(r.itemsPerSecond));
+
+	for (uint32 i = 0; i < r.counterCount; ++i)
+	{
+		fmt::print(" {}={:.4g}", r.counters[i].name, r.counters[i].value);
+	}
+
+	fmt::print("\n");
+}
+
+/**
+* Grows the iteration count until a run takes at least minTime. The last run is only used to settle caches and the allocator.
+*/
+static auto calibrate(benchmark& b, float64 minTime) -> uint64
+{
+	uint64 iterations = 1;
+
+	while (true)
+	{
+		state s{ iterations };
+		b.fn(s);
+
+		float64 const elapsed = seconds(s.elapsed());
+
+		if (elapsed >= minTime || iterations >= MAX_ITERATIONS)
+		{
+			return iterations;
+		}
+
+		float64 const multiplier = (elapsed > 0.0) ? std::clamp(minTime * 1.4 / elapsed, 2.0, 10.0) : 10.0;
+
+		iterations = std::min(MAX_ITERATIONS, static_cast<uint64>(static_cast<float64>(iterations) * multiplier));
+	}
+}
+
+auto run(registry& benchmarks, run_options const& options) -> lib::array<result>
+{
+	lib::array<result> results;
+
+	fmt::print("{:<72} {:>12} {:>12} {:>14}\n", "benchmark", "time", "iterations", "items");
+
+	for (benchmark& b : benchmarks.benchmarks())
+	{
+		if (!options.filter.empty() && std::string_view{ b.name.c_str(), b.name.size() }.find(options.filter) == std::string_view::npos)
+		{
+			continue;
+		}
+
+		uint64 const iterations = calibrate(b, options.minTime);
+		uint32 const repetitions = std::max(options.repetitions, 1u);
+
+		lib::array<float64> times;
+		times.reserve(repetitions);
+
+		result r{
+			.name = b.name,
+			.iterations = iterations,
+			.nsPerIteration = 0.0,
+			.nsMinPerIteration = 0.0,
+			.itemsPerSecond = 0.0,
+			.counters = {},
+			.counterCount = 0
+		};
+
+		for (uint32 i = 0; i < repetitions; ++i)
+		{
+			state s{ iterations };
+			b.fn(s);
+
+			float64 const ns = seconds(s.elapsed()) * 1e9 / static_cast<float64>(iterations);
+			times.push_back(ns);
+
+			if (i + 1 == repetitions)
+			{
+				float64 const itemsPerIteration = static_cast<float64>(s.items_processed()) / static_cast<float64>(iterations);
+
+				std::ranges::sort(as_span(times));
+
+				r.nsPerIteration = times[times.size() / 2];
+				r.nsMinPerIteration = times[0];
+				r.itemsPerSecond = (r.nsPerIteration > 0.0) ? itemsPerIteration * 1e9 / r.nsPerIteration : 0.0;
+
+				for (counter const& c : s.counters())
+				{
+					r.counters[r.counterCount++] = c;
+				}
+			}
+		}
+
+		print_result(r);
+		results.push_back(std::move(r));
+	}
+
+	return results;
+}
+
+static auto build_name() -> std::string_view
+{
+#if defined(DEBUG)
+	return "debug";
+#elif defined(RELEASE_WDEBUG)
+	return "release_with_debug_info";
+#else
+	return "release";
+#endif
+}
+
+/**
+* JSON has no representation for infinities and NaNs.
+*/
+static auto append_number(fmt::memory_buffer& out, float64 value) -> void
+{
+	if (std::isfinite(value))
+	{
+		fmt::format_to(std::back_inserter(out), "{}", value);
+	}
+	else
+	{
+		fmt::format_to(std::back_inserter(out), "null");
+	}
+}
+
+auto write_json(std::filesystem::path const& path, std::span<result const> results, run_options const& options) -> bool
+{
+	fmt::memory_buffer out;
+
+	fmt::format_to(
+		std::back_inserter(out),
+		"{{\n\t\"context\": {{ \"build\": \"{}\", \"hardware_threads\": {}, \"min_time\": {:.6g}, \"repetitions\": {} }},\n\t\"benchmarks\": [\n",
+		build_name(),
+		std::thread::hardware_concurrency(),
+		options.minTime,
+		options.repetitions
+	);
+
+	for (size_t i = 0; i < results.size(); ++i)
+	{
+		result const& r = results[i];
+
+		fmt::format_to(std::back_inserter(out), "\t\t{{ {}{}\", \"iterations\": {}, {}", NAME_KEY, r.name.c_str(), r.iterations, TIME_KEY);
+		append_number(out, r.nsPerIteration);
+		fmt::format_to(std::back_inserter(out), ", \"ns_min_per_iteration\": ");
+		append_number(out, r.nsMinPerIteration);
+		fmt::format_to(std::back_inserter(out), ", \"items_per_second\": ");
+		append_number(out, r.itemsPerSecond);
+		fmt::format_to(std::back_inserter(out), ", \"counters\": {{");
+
+		for (uint32 j = 0; j < r.counterCount; ++j)
+		{
+			fmt::format_to(std::back_inserter(out), "{} \"{}\": ", (j == 0) ? "" : ",", r.counters[j].name);
+			append_number(out, r.counters[j].value);
+		}
+
+		fmt::format_to(std::back_inserter(out), " }} }}{}\n", (i + 1 == results.size()) ? "" : ",");
+	}
+
+	fmt::format_to(std::back_inserter(out), "\t]\n}}\n");
+
+	std::ofstream stream{ path, std::ios::out | std::ios::binary | std::ios::trunc };
+
+	if (!stream.good())
+	{
+		return false;
+	}
+
+	stream.write(out.data(), static_cast<std::streamsize>(out.size()));
+
+	return stream.good();
+}
+
+auto load_baseline(std::filesystem::path const& path, lib::map<lib::string, float64>& baseline) -> bool
+{
+	std::ifstream stream{ path, std::ios::in | std::ios::binary };
+
+	if (!stream.good())
+	{
+		return false;
+	}
+
+	std::string line;
+
+	while (std::getline(stream, line))
+	{
+		std::string_view const view = line;
+
+		size_t const nameBegin = view.find(NAME_KEY);
+		size_t const timeBegin = view.find(TIME_KEY);
+
+		if (nameBegin == std::string_view::npos || timeBegin == std::string_view::npos)
+		{
+			continue;
+		}
+
+		std::string_view const name = view.substr(nameBegin + NAME_KEY.size());
+		std::string_view const time = view.substr(timeBegin + TIME_KEY.size());
+
+		float64 ns = 0.0;
+
+		if (std::from_chars(time.data(), time.data() + time.size(), ns).ec != std::errc{})
+		{
+			continue;
+		}
+
+		baseline.emplace(lib::string{ name.substr(0, name.find('"')) }, ns);
+	}
+
+	return true;
+}
+
+auto compare(std::span<result const> results, lib::map<lib::string, float64> const& baseline, float64 thresholdPercent) -> uint32
+{
+	uint32 regressions = 0;
+	uint32 improvements = 0;
+	uint32 compared = 0;
+
+	fmt::print("\n{:<72} {:>12} {:>12} {:>9}\n", "benchmark", "baseline", "current", "change");
+
+	for (result const& r : results)
+	{
+		auto const entry = baseline.at(r.name);
+
+		if (!entry.has_value() || entry.value()->second <= 0.0)
+		{
+			continue;
+		}
+
+		float64 const before = entry.value()->second;
+		float64 const change = (r.nsPerIteration - before) / before * 100.0;
+
+		std::string_view verdict = {};
+
+		if (change > thresholdPercent)
+		{
+			verdict = "  slower";
+			++regressions;
+		}
+		else if (change < -thresholdPercent)
+		{
+			verdict = "  faster";
+			++improvements;
+		}
+
+		++compared;
+
+		fmt::print("{:<72} {:>12} {:>12} {:>+8.1f}%{}\n", r.name.c_str(), format_time(before), format_time(r.nsPerIteration), change, verdict);
+	}
+
+	fmt::print("\n{} compared, {} slower and {} faster by more than {}%.\n", compared, regressions, improvements, thresholdPercent);
+
+	return regressions;
+}
+
+auto thread_counts() -> lib::array<uint32>
+{
+	uint32 const hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+
+	lib::array<uint32> counts;
+
+	for (uint32 count = 1; count <= hardwareThreads; count *= 2)
+	{
+		counts.push_back(count);
+	}
+
+	return counts;
+}
+}
@@ -0,0 +1,888 @@
+#include "math/pack.h"
+// math/common.h and lib/common.hpp both define ASSERTION, lib's takes over from here.
+#undef ASSERTION
+#include "suites.hpp"
+
+namespace bench
+{
+static constexpr size_t MATRIX_COUNT		= 1024;
+static constexpr size_t POINT_COUNT			= 1 << 16;
+static constexpr size_t NODE_COUNT			= 4096;
+static constexpr size_t CULL_COUNT			= 100'000;
+static constexpr size_t QUATERNION_COUNT	= 1 << 14;
+static constexpr size_t APPROX_COUNT		= 4096;
+static constexpr size_t PACK_COUNT			= 1 << 14;
+
+/**
+* The float32 columns of a structure of arrays, kept together so that views and spans over them are easy to make.
+*/
+struct vector3_array
+{
+	lib::array<float32> x;
+	lib::array<float32> y;
+	lib::array<float32> z;
+
+	vector3_array(size_t count, rng& random, float32 lo, float32 hi)
+	{
+		x.reserve(count);
+		y.reserve(count);
+		z.reserve(count);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			x.push_back(random.next_float(lo, hi));
+			y.push_back(random.next_float(lo, hi));
+			z.push_back(random.next_float(lo, hi));
+		}
+	}
+
+	auto view() const -> math::batch::vector3_view { return { as_span(x), as_span(y), as_span(z) }; }
+	auto span() -> math::batch::vector3_span { return { as_span(x), as_span(y), as_span(z) }; }
+};
+
+static auto random_floats(size_t count, rng& random, float32 lo, float32 hi) -> lib::array<float32>
+{
+	lib::array<float32> values;
+	values.reserve(count);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		values.push_back(random.next_float(lo, hi));
+	}
+
+	return values;
+}
+
+static auto random_matrix(rng& random) -> math::mat4
+{
+	math::mat4 m;
+	float32* elements = &m.m00;
+
+	for (size_t i = 0; i < 16; ++i)
+	{
+		elements[i] = random.next_float(-2.f, 2.f);
+	}
+
+	return m;
+}
+
+static auto random_quaternions(size_t count, rng& random) -> lib::array<math::quat>
+{
+	lib::array<math::quat> values;
+	values.reserve(count);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		values.push_back(math::normalized(math::quat{ random.next_float(-1.f, 1.f), random.next_float(-1.f, 1.f), random.next_float(-1.f, 1.f), random.next_float(-1.f, 1.f) }));
+	}
+
+	return values;
+}
+
+/**
+* The scalar form operator* falls back to in constant evaluation, spelled out so that it can be timed.
+*/
+static auto multiply_scalar(math::mat4 const& l, math::mat4 const& r) -> math::mat4
+{
+	math::mat4 res;
+	res.m00 = r.m00 * l.m00 + r.m01 * l.m10 + r.m02 * l.m20 + r.m03 * l.m30;
+	res.m01 = r.m00 * l.m01 + r.m01 * l.m11 + r.m02 * l.m21 + r.m03 * l.m31;
+	res.m02 = r.m00 * l.m02 + r.m01 * l.m12 + r.m02 * l.m22 + r.m03 * l.m32;
+	res.m03 = r.m00 * l.m03 + r.m01 * l.m13 + r.m02 * l.m23 + r.m03 * l.m33;
+	res.m10 = r.m10 * l.m00 + r.m11 * l.m10 + r.m12 * l.m20 + r.m13 * l.m30;
+	res.m11 = r.m10 * l.m01 + r.m11 * l.m11 + r.m12 * l.m21 + r.m13 * l.m31;
+	res.m12 = r.m10 * l.m02 + r.m11 * l.m12 + r.m12 * l.m22 + r.m13 * l.m32;
+	res.m13 = r.m10 * l.m03 + r.m11 * l.m13 + r.m12 * l.m23 + r.m13 * l.m33;
+	res.m20 = r.m20 * l.m00 + r.m21 * l.m10 + r.m22 * l.m20 + r.m23 * l.m30;
+	res.m21 = r.m20 * l.m01 + r.m21 * l.m11 + r.m22 * l.m21 + r.m23 * l.m31;
+	res.m22 = r.m20 * l.m02 + r.m21 * l.m12 + r.m22 * l.m22 + r.m23 * l.m32;
+	res.m23 = r.m20 * l.m03 + r.m21 * l.m13 + r.m22 * l.m23 + r.m23 * l.m33;
+	res.m30 = r.m30 * l.m00 + r.m31 * l.m10 + r.m32 * l.m20 + r.m33 * l.m30;
+	res.m31 = r.m30 * l.m01 + r.m31 * l.m11 + r.m32 * l.m21 + r.m33 * l.m31;
+	res.m32 = r.m30 * l.m02 + r.m31 * l.m12 + r.m32 * l.m22 + r.m33 * l.m32;
+	res.m33 = r.m30 * l.m03 + r.m31 * l.m13 + r.m32 * l.m23 + r.m33 * l.m33;
+	return res;
+}
+
+static auto register_matrices(registry& benchmarks) -> void
+{
+	benchmarks.add("math/mat4_multiply/simd", [](state& s)
+	{
+		rng random{ 1 };
+		lib::array<math::mat4> matrices;
+		matrices.reserve(MATRIX_COUNT);
+
+		for (size_t i = 0; i < MATRIX_COUNT; ++i)
+		{
+			matrices.push_back(random_matrix(random));
+		}
+
+		while (s.keep_running())
+		{
+			math::mat4 product{ 1.f };
+
+			for (math::mat4 const& m : matrices)
+			{
+				product = product * m;
+			}
+
+			do_not_optimize(product);
+		}
+
+		s.set_items_processed(s.iterations() * MATRIX_COUNT);
+	});
+	benchmarks.add("math/mat4_multiply/scalar", [](state& s)
+	{
+		rng random{ 1 };
+		lib::array<math::mat4> matrices;
+		matrices.reserve(MATRIX_COUNT);
+
+		for (size_t i = 0; i < MATRIX_COUNT; ++i)
+		{
+			matrices.push_back(random_matrix(random));
+		}
+
+		while (s.keep_running())
+		{
+			math::mat4 product{ 1.f };
+
+			for (math::mat4 const& m : matrices)
+			{
+				product = multiply_scalar(product, m);
+			}
+
+			do_not_optimize(product);
+		}
+
+		s.set_items_processed(s.iterations() * MATRIX_COUNT);
+	});
+
+	benchmarks.add("math/transform_points/batch", [](state& s)
+	{
+		rng random{ 2 };
+		math::mat4 const m = random_matrix(random);
+		vector3_array const in{ POINT_COUNT, random, -100.f, 100.f };
+		vector3_array out{ POINT_COUNT, random, 0.f, 1.f };
+
+		while (s.keep_running())
+		{
+			math::batch::transform_points(m, in.view(), out.span());
+			do_not_optimize(out.x.data());
+		}
+
+		s.set_items_processed(s.iterations() * POINT_COUNT);
+	});
+	benchmarks.add("math/transform_points/scalar", [](state& s)
+	{
+		rng random{ 2 };
+		math::mat4 const m = random_matrix(random);
+		vector3_array const in{ POINT_COUNT, random, -100.f, 100.f };
+		vector3_array out{ POINT_COUNT, random, 0.f, 1.f };
+
+		while (s.keep_running())
+		{
+			math::batch::detail::transform_scalar(m, in.view(), out.span(), 1.f, 0);
+			do_not_optimize(out.x.data());
+		}
+
+		s.set_items_processed(s.iterations() * POINT_COUNT);
+	});
+	benchmarks.add("math/transform_points/mat4_vec4", [](state& s)
+	{
+		rng random{ 2 };
+		math::mat4 const m = random_matrix(random);
+		vector3_array const in{ POINT_COUNT, random, -100.f, 100.f };
+		vector3_array out{ POINT_COUNT, random, 0.f, 1.f };
+
+		while (s.keep_running())
+		{
+			for (size_t i = 0; i < POINT_COUNT; ++i)
+			{
+				math::vec4 const p = m * math::vec4{ in.x[i], in.y[i], in.z[i], 1.f };
+
+				out.x[i] = p.x;
+				out.y[i] = p.y;
+				out.z[i] = p.z;
+			}
+
+			do_not_optimize(out.x.data());
+		}
+
+		s.set_items_processed(s.iterations() * POINT_COUNT);
+	});
+
+	// A scene hierarchy where every node's parent comes before it.
+	benchmarks.add("math/compose_world_matrices/batch", [](state& s)
+	{
+		rng random{ 3 };
+		lib::array<math::mat4> local;
+		lib::array<uint32> parents;
+		lib::array<math::mat4> world;
+
+		for (size_t i = 0; i < NODE_COUNT; ++i)
+		{
+			local.push_back(random_matrix(random));
+			parents.push_back((i < 8) ? math::batch::no_parent_v : static_cast<uint32>(random.next_below(i)));
+			world.push_back(math::mat4{});
+		}
+
+		while (s.keep_running())
+		{
+			math::batch::compose_world_matrices(as_span(local), as_span(parents), as_span(world));
+			do_not_optimize(world.data());
+		}
+
+		s.set_items_processed(s.iterations() * NODE_COUNT);
+	});
+	benchmarks.add("math/compose_world_matrices/scalar", [](state& s)
+	{
+		rng random{ 3 };
+		lib::array<math::mat4> local;
+		lib::array<uint32> parents;
+		lib::array<math::mat4> world;
+
+		for (size_t i = 0; i < NODE_COUNT; ++i)
+		{
+			local.push_back(random_matrix(random));
+			parents.push_back((i < 8) ? math::batch::no_parent_v : static_cast<uint32>(random.next_below(i)));
+			world.push_back(math::mat4{});
+		}
+
+		while (s.keep_running())
+		{
+			for (size_t i = 0; i < NODE_COUNT; ++i)
+			{
+				world[i] = (parents[i] == math::batch::no_parent_v) ? local[i] : multiply_scalar(world[parents[i]], local[i]);
+			}
+
+			do_not_optimize(world.data());
+		}
+
+		s.set_items_processed(s.iterations() * NODE_COUNT);
+	});
+}
+
+/**
+* A camera at the origin looking down -z with a 90 degree field of view, near at 0.1 and far at 500.
+*/
+static auto camera_frustum() -> math::batch::frustum
+{
+	float32 const d = 1.f / std::sqrt(2.f);
+
+	return math::batch::frustum{
+		.planes = {
+			math::vec4{ d, 0.f, -d, 0.f },
+			math::vec4{ -d, 0.f, -d, 0.f },
+			math::vec4{ 0.f, d, -d, 0.f },
+			math::vec4{ 0.f, -d, -d, 0.f },
+			math::vec4{ 0.f, 0.f, -1.f, -0.1f },
+			math::vec4{ 0.f, 0.f, 1.f, 500.f }
+		}
+	};
+}
+
+/**
+* Objects scattered in a cube around the camera, about a sixth of them are in view.
+*/
+struct cull_scene
+{
+	math::batch::frustum frustum;
+	vector3_array centers;
+	vector3_array extents;
+	lib::array<float32> radii;
+	lib::array<uint64> visibility;
+
+	cull_scene(rng& random) :
+		frustum{ camera_frustum() },
+		centers{ CULL_COUNT, random, -400.f, 400.f },
+		extents{ CULL_COUNT, random, 0.5f, 8.f },
+		radii{ random_floats(CULL_COUNT, random, 0.5f, 8.f) },
+		visibility{}
+	{
+		visibility.resize(math::batch::visibility_words(CULL_COUNT));
+	}
+
+	auto visible_fraction() const -> float64
+	{
+		size_t visible = 0;
+
+		for (uint64 word : visibility)
+		{
+			visible += static_cast<size_t>(std::popcount(word));
+		}
+
+		return static_cast<float64>(visible) / static_cast<float64>(CULL_COUNT);
+	}
+};
+
+static auto register_culling(registry& benchmarks) -> void
+{
+	benchmarks.add("math/cull_spheres/batch/100000", [](state& s)
+	{
+		rng random{ 4 };
+		cull_scene scene{ random };
+
+		while (s.keep_running())
+		{
+			math::batch::cull_spheres(scene.frustum, scene.centers.view(), as_span(scene.radii), as_span(scene.visibility));
+			do_not_optimize(scene.visibility.data());
+		}
+
+		s.set_items_processed(s.iterations() * CULL_COUNT);
+		s.set_counter("visible", scene.visible_fraction());
+	});
+	benchmarks.add("math/cull_spheres/scalar/100000", [](state& s)
+	{
+		rng random{ 4 };
+		cull_scene scene{ random };
+
+		while (s.keep_running())
+		{
+			std::fill_n(scene.visibility.data(), scene.visibility.size(), uint64{ 0 });
+
+			for (size_t i = 0; i < CULL_COUNT; ++i)
+			{
+				if (math::batch::detail::sphere_visible(scene.frustum, scene.centers.x[i], scene.centers.y[i], scene.centers.z[i], scene.radii[i]))
+				{
+					math::batch::detail::set_visible(as_span(scene.visibility), i);
+				}
+			}
+
+			do_not_optimize(scene.visibility.data());
+		}
+
+		s.set_items_processed(s.iterations() * CULL_COUNT);
+		s.set_counter("visible", scene.visible_fraction());
+	});
+	benchmarks.add("math/cull_aabbs/batch/100000", [](state& s)
+	{
+		rng random{ 5 };
+		cull_scene scene{ random };
+
+		while (s.keep_running())
+		{
+			math::batch::cull_aabbs(scene.frustum, scene.centers.view(), scene.extents.view(), as_span(scene.visibility));
+			do_not_optimize(scene.visibility.data());
+		}
+
+		s.set_items_processed(s.iterations() * CULL_COUNT);
+		s.set_counter("visible", scene.visible_fraction());
+	});
+	benchmarks.add("math/cull_aabbs/scalar/100000", [](state& s)
+	{
+		rng random{ 5 };
+		cull_scene scene{ random };
+
+		while (s.keep_running())
+		{
+			std::fill_n(scene.visibility.data(), scene.visibility.size(), uint64{ 0 });
+
+			for (size_t i = 0; i < CULL_COUNT; ++i)
+			{
+				if (math::batch::detail::aabb_visible(scene.frustum, scene.centers.x[i], scene.centers.y[i], scene.centers.z[i], scene.extents.x[i], scene.extents.y[i], scene.extents.z[i]))
+				{
+					math::batch::detail::set_visible(as_span(scene.visibility), i);
+				}
+			}
+
+			do_not_optimize(scene.visibility.data());
+		}
+
+		s.set_items_processed(s.iterations() * CULL_COUNT);
+		s.set_counter("visible", scene.visible_fraction());
+	});
+}
+
+struct quaternion_data
+{
+	lib::array<math::quat> from;
+	lib::array<math::quat> to;
+	lib::array<float32> weights;
+	lib::array<math::quat> out;
+	vector3_array translations;
+	vector3_array scales;
+	lib::array<math::mat4> matrices;
+
+	quaternion_data(rng& random) :
+		from{ random_quaternions(QUATERNION_COUNT, random) },
+		to{ random_quaternions(QUATERNION_COUNT, random) },
+		weights{ random_floats(QUATERNION_COUNT, random, 0.f, 1.f) },
+		out{ random_quaternions(QUATERNION_COUNT, random) },
+		translations{ QUATERNION_COUNT, random, -10.f, 10.f },
+		scales{ QUATERNION_COUNT, random, 0.5f, 2.f },
+		matrices{}
+	{
+		matrices.resize(QUATERNION_COUNT);
+	}
+};
+
+/**
+* Registers the batch kernel and its per element scalar form under the same name.
+*/
+template <typename Batch, typename Scalar>
+static auto add_quaternion_pair(registry& benchmarks, std::string_view name, Batch&& batchFn, Scalar&& scalarFn) -> void
+{
+	benchmarks.add(lib::format("math/quaternion/{}/batch", name), [fn = std::forward<Batch>(batchFn)](state& s)
+	{
+		rng random{ 6 };
+		quaternion_data data{ random };
+
+		while (s.keep_running())
+		{
+			fn(data);
+			do_not_optimize(data.out.data());
+			do_not_optimize(data.matrices.data());
+		}
+
+		s.set_items_processed(s.iterations() * QUATERNION_COUNT);
+	});
+	benchmarks.add(lib::format("math/quaternion/{}/scalar", name), [fn = std::forward<Scalar>(scalarFn)](state& s)
+	{
+		rng random{ 6 };
+		quaternion_data data{ random };
+
+		while (s.keep_running())
+		{
+			for (size_t i = 0; i < QUATERNION_COUNT; ++i)
+			{
+				fn(data, i);
+			}
+
+			do_not_optimize(data.out.data());
+			do_not_optimize(data.matrices.data());
+		}
+
+		s.set_items_processed(s.iterations() * QUATERNION_COUNT);
+	});
+}
+
+static auto register_quaternions(registry& benchmarks) -> void
+{
+	add_quaternion_pair(
+		benchmarks,
+		"normalize",
+		[](quaternion_data& d) { math::batch::normalize_quaternions(as_span(d.from), as_span(d.out)); },
+		[](quaternion_data& d, size_t i) { d.out[i] = math::normalized(d.from[i]); }
+	);
+	add_quaternion_pair(
+		benchmarks,
+		"multiply",
+		[](quaternion_data& d) { math::batch::multiply_quaternions(as_span(d.from), as_span(d.to), as_span(d.out)); },
+		[](quaternion_data& d, size_t i) { d.out[i] = d.from[i] * d.to[i]; }
+	);
+	add_quaternion_pair(
+		benchmarks,
+		"nlerp",
+		[](quaternion_data& d) { math::batch::nlerp_quaternions(as_span(d.from), as_span(d.to), as_span(d.weights), as_span(d.out)); },
+		[](quaternion_data& d, size_t i) { d.out[i] = math::batch::detail::nlerp_scalar(d.from[i], d.to[i], d.weights[i]); }
+	);
+	add_quaternion_pair(
+		benchmarks,
+		"slerp",
+		[](quaternion_data& d) { math::batch::slerp_quaternions(as_span(d.from), as_span(d.to), as_span(d.weights), as_span(d.out)); },
+		[](quaternion_data& d, size_t i) { d.out[i] = math::batch::detail::slerp_scalar(d.from[i], d.to[i], d.weights[i]); }
+	);
+	add_quaternion_pair(
+		benchmarks,
+		"compose_transforms",
+		[](quaternion_data& d) { math::batch::compose_transforms(as_span(d.from), d.translations.view(), d.scales.view(), as_span(d.matrices)); },
+		[](quaternion_data& d, size_t i)
+		{
+			math::batch::detail::compose_scalar(d.from[i], d.translations.x[i], d.translations.y[i], d.translations.z[i], d.scales.x[i], d.scales.y[i], d.scales.z[i], d.matrices[i]);
+		}
+	);
+}
+
+/**
+* Distance from the float32 nearest to "reference" in units of that float's spacing.
+*/
+static auto ulp_error(float32 value, float64 reference) -> float64
+{
+	float32 const expected = static_cast<float32>(reference);
+	float64 const spacing = static_cast<float64>(std::nextafter(std::fabs(expected), std::numeric_limits<float32>::infinity()) - std::fabs(expected));
+
+	return std::fabs(static_cast<float64>(value) - reference) / spacing;
+}
+
+struct approx_case
+{
+	std::string_view name;
+	float32 lo;
+	float32 hi;
+	auto (*standard)(float32) -> float32;
+	auto (*approx)(float32) -> float32;
+#if MATH_SIMD_SSE2
+	auto (*sse)(__m128) -> __m128;
+#endif
+	auto (*reference)(float64) -> float64;
+};
+
+/**
+* Times "fn" over APPROX_COUNT inputs in [lo, hi) and reports how far its results are from the double precision reference.
+*/
+template <typename Fn>
+static auto approx_benchmark(state& s, approx_case const& c, Fn&& fn) -> void
+{
+	rng random{ 7 };
+	lib::array<float32> const in = random_floats(APPROX_COUNT, random, c.lo, c.hi);
+	lib::array<float32> out;
+	out.resize(APPROX_COUNT);
+
+	while (s.keep_running())
+	{
+		fn(as_span(in), as_span(out));
+		do_not_optimize(out.data());
+	}
+
+	float64 maxUlp = 0.0;
+	float64 maxError = 0.0;
+
+	for (size_t i = 0; i < APPROX_COUNT; ++i)
+	{
+		float64 const reference = c.reference(static_cast<float64>(in[i]));
+
+		maxUlp = std::max(maxUlp, ulp_error(out[i], reference));
+		maxError = std::max(maxError, std::fabs(static_cast<float64>(out[i]) - reference));
+	}
+
+	s.set_items_processed(s.iterations() * APPROX_COUNT);
+	s.set_counter("max_ulp", maxUlp);
+	s.set_counter("max_abs_error", maxError);
+}
+
+static auto register_approx(registry& benchmarks) -> void
+{
+	static constexpr approx_case CASES[] = {
+		{
+			"sin", -100.f, 100.f,
+			[](float32 x) { return std::sin(x); },
+			[](float32 x) { return math::approx::sin(x); },
+#if MATH_SIMD_SSE2
+			[](__m128 x) { return math::simd::approx::sin(x); },
+#endif
+			[](float64 x) { return std::sin(x); }
+		},
+		{
+			"cos", -100.f, 100.f,
+			[](float32 x) { return std::cos(x); },
+			[](float32 x) { return math::approx::cos(x); },
+#if MATH_SIMD_SSE2
+			[](__m128 x) { return math::simd::approx::cos(x); },
+#endif
+			[](float64 x) { return std::cos(x); }
+		},
+		{
+			"exp2", -20.f, 20.f,
+			[](float32 x) { return std::exp2(x); },
+			[](float32 x) { return math::approx::exp2(x); },
+#if MATH_SIMD_SSE2
+			[](__m128 x) { return math::simd::approx::exp2(x); },
+#endif
+			[](float64 x) { return std::exp2(x); }
+		},
+		{
+			"log2", 1e-3f, 1e3f,
+			[](float32 x) { return std::log2(x); },
+			[](float32 x) { return math::approx::log2(x); },
+#if MATH_SIMD_SSE2
+			[](__m128 x) { return math::simd::approx::log2(x); },
+#endif
+			[](float64 x) { return std::log2(x); }
+		},
+		{
+			"rsqrt", 1e-3f, 1e4f,
+			[](float32 x) { return 1.f / std::sqrt(x); },
+			[](float32 x) { return math::approx::rsqrt(x); },
+#if MATH_SIMD_SSE2
+			[](__m128 x) { return math::simd::approx::rsqrt(x); },
+#endif
+			[](float64 x) { return 1.0 / std::sqrt(x); }
+		}
+	};
+
+	for (approx_case const& c : CASES)
+	{
+		benchmarks.add(lib::format("math/approx/{}/std", c.name), [&c](state& s)
+		{
+			approx_benchmark(s, c, [&c](std::span<float32 const> in, std::span<float32> out)
+			{
+				for (size_t i = 0; i < in.size(); ++i)
+				{
+					out[i] = c.standard(in[i]);
+				}
+			});
+		});
+		benchmarks.add(lib::format("math/approx/{}/scalar", c.name), [&c](state& s)
+		{
+			approx_benchmark(s, c, [&c](std::span<float32 const> in, std::span<float32> out)
+			{
+				for (size_t i = 0; i < in.size(); ++i)
+				{
+					out[i] = c.approx(in[i]);
+				}
+			});
+		});
+#if MATH_SIMD_SSE2
+		benchmarks.add(lib::format("math/approx/{}/sse", c.name), [&c](state& s)
+		{
+			approx_benchmark(s, c, [&c](std::span<float32 const> in, std::span<float32> out)
+			{
+				for (size_t i = 0; i < in.size(); i += 4)
+				{
+					_mm_storeu_ps(&out[i], c.sse(_mm_loadu_ps(&in[i])));
+				}
+			});
+		});
+#endif
+	}
+
+	// atan2 takes two inputs, so it does not fit the table above.
+	benchmarks.add("math/approx/atan2/std", [](state& s)
+	{
+		rng random{ 8 };
+		lib::array<float32> const y = random_floats(APPROX_COUNT, random, -10.f, 10.f);
+		lib::array<float32> const x = random_floats(APPROX_COUNT, random, -10.f, 10.f);
+		lib::array<float32> out;
+		out.resize(APPROX_COUNT);
+
+		while (s.keep_running())
+		{
+			for (size_t i = 0; i < APPROX_COUNT; ++i)
+			{
+				out[i] = std::atan2(y[i], x[i]);
+			}
+
+			do_not_optimize(out.data());
+		}
+
+		s.set_items_processed(s.iterations() * APPROX_COUNT);
+	});
+	benchmarks.add("math/approx/atan2/scalar", [](state& s)
+	{
+		rng random{ 8 };
+		lib::array<float32> const y = random_floats(APPROX_COUNT, random, -10.f, 10.f);
+		lib::array<float32> const x = random_floats(APPROX_COUNT, random, -10.f, 10.f);
+		lib::array<float32> out;
+		out.resize(APPROX_COUNT);
+
+		while (s.keep_running())
+		{
+			for (size_t i = 0; i < APPROX_COUNT; ++i)
+			{
+				out[i] = math::approx::atan2(y[i], x[i]);
+			}
+
+			do_not_optimize(out.data());
+		}
+
+		float64 maxUlp = 0.0;
+
+		for (size_t i = 0; i < APPROX_COUNT; ++i)
+		{
+			maxUlp = std::max(maxUlp, ulp_error(out[i], std::atan2(static_cast<float64>(y[i]), static_cast<float64>(x[i]))));
+		}
+
+		s.set_items_processed(s.iterations() * APPROX_COUNT);
+		s.set_counter("max_ulp", maxUlp);
+	});
+#if MATH_SIMD_SSE2
+	benchmarks.add("math/approx/atan2/sse", [](state& s)
+	{
+		rng random{ 8 };
+		lib::array<float32> const y = random_floats(APPROX_COUNT, random, -10.f, 10.f);
+		lib::array<float32> const x = random_floats(APPROX_COUNT, random, -10.f, 10.f);
+		lib::array<float32> out;
+		out.resize(APPROX_COUNT);
+
+		while (s.keep_running())
+		{
+			for (size_t i = 0; i < APPROX_COUNT; i += 4)
+			{
+				_mm_storeu_ps(&out[i], math::simd::approx::atan2(_mm_loadu_ps(&y[i]), _mm_loadu_ps(&x[i])));
+			}
+
+			do_not_optimize(out.data());
+		}
+
+		float64 maxUlp = 0.0;
+
+		for (size_t i = 0; i < APPROX_COUNT; ++i)
+		{
+			maxUlp = std::max(maxUlp, ulp_error(out[i], std::atan2(static_cast<float64>(y[i]), static_cast<float64>(x[i]))));
+		}
+
+		s.set_items_processed(s.iterations() * APPROX_COUNT);
+		s.set_counter("max_ulp", maxUlp);
+	});
+#endif
+}
+
+/**
+* Largest difference between two arrays, the round trip error of a pack and unpack.
+*/
+static auto max_difference(std::span<float32 const> a, std::span<float32 const> b) -> float64
+{
+	float64 result = 0.0;
+
+	for (size_t i = 0; i < a.size(); ++i)
+	{
+		result = std::max(result, std::fabs(static_cast<float64>(a[i]) - static_cast<float64>(b[i])));
+	}
+
+	return result;
+}
+
+static auto register_pack(registry& benchmarks) -> void
+{
+	benchmarks.add("math/pack/half/round_trip", [](state& s)
+	{
+		rng random{ 9 };
+		lib::array<float32> const in = random_floats(PACK_COUNT, random, -1000.f, 1000.f);
+		lib::array<uint16> packed;
+		lib::array<float32> out;
+		packed.resize(PACK_COUNT);
+		out.resize(PACK_COUNT);
+
+		while (s.keep_running())
+		{
+			math::pack::float_to_half(as_span(in), as_span(packed));
+			math::pack::half_to_float(as_span(packed), as_span(out));
+			do_not_optimize(out.data());
+		}
+
+		s.set_items_processed(s.iterations() * PACK_COUNT);
+		s.set_counter("max_error", max_difference(as_span(in), as_span(out)));
+	});
+	benchmarks.add("math/pack/half/scalar_round_trip", [](state& s)
+	{
+		rng random{ 9 };
+		lib::array<float32> const in = random_floats(PACK_COUNT, random, -1000.f, 1000.f);
+		lib::array<float32> out;
+		out.resize(PACK_COUNT);
+
+		while (s.keep_running())
+		{
+			for (size_t i = 0; i < PACK_COUNT; ++i)
+			{
+				out[i] = math::pack::half_to_float(math::pack::float_to_half(in[i]));
+			}
+
+			do_not_optimize(out.data());
+		}
+
+		s.set_items_processed(s.iterations() * PACK_COUNT);
+		s.set_counter("max_error", max_difference(as_span(in), as_span(out)));
+	});
+	benchmarks.add("math/pack/snorm16/round_trip", [](state& s)
+	{
+		rng random{ 10 };
+		lib::array<float32> const in = random_floats(PACK_COUNT, random, -1.f, 1.f);
+		lib::array<int16> packed;
+		lib::array<float32> out;
+		packed.resize(PACK_COUNT);
+		out.resize(PACK_COUNT);
+
+		while (s.keep_running())
+		{
+			math::pack::float_to_snorm16(as_span(in), as_span(packed));
+			math::pack::snorm16_to_float(as_span(packed), as_span(out));
+			do_not_optimize(out.data());
+		}
+
+		s.set_items_processed(s.iterations() * PACK_COUNT);
+		s.set_counter("max_error", max_difference(as_span(in), as_span(out)));
+	});
+	benchmarks.add("math/pack/unorm8/round_trip", [](state& s)
+	{
+		rng random{ 11 };
+		lib::array<float32> const in = random_floats(PACK_COUNT, random, 0.f, 1.f);
+		lib::array<uint8> packed;
+		lib::array<float32> out;
+		packed.resize(PACK_COUNT);
+		out.resize(PACK_COUNT);
+
+		while (s.keep_running())
+		{
+			math::pack::float_to_unorm8(as_span(in), as_span(packed));
+			math::pack::unorm8_to_float(as_span(packed), as_span(out));
+			do_not_optimize(out.data());
+		}
+
+		s.set_items_processed(s.iterations() * PACK_COUNT);
+		s.set_counter("max_error", max_difference(as_span(in), as_span(out)));
+	});
+	benchmarks.add("math/pack/octahedral/round_trip", [](state& s)
+	{
+		rng random{ 12 };
+		vector3_array normals{ PACK_COUNT, random, -1.f, 1.f };
+
+		for (size_t i = 0; i < PACK_COUNT; ++i)
+		{
+			math::vec3 const n = math::normalized(math::vec3{ normals.x[i], normals.y[i], normals.z[i] });
+
+			normals.x[i] = n.x;
+			normals.y[i] = n.y;
+			normals.z[i] = n.z;
+		}
+
+		lib::array<uint32> packed;
+		vector3_array out{ PACK_COUNT, random, 0.f, 1.f };
+		packed.resize(PACK_COUNT);
+
+		while (s.keep_running())
+		{
+			math::pack::octahedral_encode(normals.view(), as_span(packed));
+			math::pack::octahedral_decode(as_span(packed), out.span());
+			do_not_optimize(out.x.data());
+		}
+
+		s.set_items_processed(s.iterations() * PACK_COUNT);
+		s.set_counter("max_error", std::max({ max_difference(as_span(normals.x), as_span(out.x)), max_difference(as_span(normals.y), as_span(out.y)), max_difference(as_span(normals.z), as_span(out.z)) }));
+	});
+	benchmarks.add("math/pack/rgb9e5/round_trip", [](state& s)
+	{
+		rng random{ 13 };
+		vector3_array const in{ PACK_COUNT, random, 0.f, 64.f };
+		lib::array<uint32> packed;
+		vector3_array out{ PACK_COUNT, random, 0.f, 1.f };
+		packed.resize(PACK_COUNT);
+
+		while (s.keep_running())
+		{
+			math::pack::float_to_rgb9e5(in.view(), as_span(packed));
+			math::pack::rgb9e5_to_float(as_span(packed), out.span());
+			do_not_optimize(out.x.data());
+		}
+
+		s.set_items_processed(s.iterations() * PACK_COUNT);
+		s.set_counter("max_error", std::max({ max_difference(as_span(in.x), as_span(out.x)), max_difference(as_span(in.y), as_span(out.y)), max_difference(as_span(in.z), as_span(out.z)) }));
+	});
+	benchmarks.add("math/pack/r11g11b10f/round_trip", [](state& s)
+	{
+		rng random{ 14 };
+		vector3_array const in{ PACK_COUNT, random, 0.f, 64.f };
+		lib::array<uint32> packed;
+		vector3_array out{ PACK_COUNT, random, 0.f, 1.f };
+		packed.resize(PACK_COUNT);
+
+		while (s.keep_running())
+		{
+			math::pack::float_to_r11g11b10f(in.view(), as_span(packed));
+			math::pack::r11g11b10f_to_float(as_span(packed), out.span());
+			do_not_optimize(out.x.data());
+		}
+
+		s.set_items_processed(s.iterations() * PACK_COUNT);
+		s.set_counter("max_error", std::max({ max_difference(as_span(in.x), as_span(out.x)), max_difference(as_span(in.y), as_span(out.y)), max_difference(as_span(in.z), as_span(out.z)) }));
+	});
+}
+
+auto register_math_benchmarks(registry& benchmarks) -> void
+{
+	register_matrices(benchmarks);
+	register_culling(benchmarks);
+	register_quaternions(benchmarks);
+	register_approx(benchmarks);
+	register_pack(benchmarks);
+}
+}
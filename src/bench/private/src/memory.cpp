@@ -0,0 +1,298 @@
+#include <thread>
+#include <vector>
+#include "core.serialization/buffer.hpp"
+#include "lib/monotonic_memory_resource.hpp"
+#include "lib/slab_memory_resource.hpp"
+#include "lib/tracking_memory_resource.hpp"
+#include "suites.hpp"
+
+namespace bench
+{
+static constexpr size_t BLOCK_SIZES[]	= { 16, 64, 256 };
+static constexpr size_t BLOCK_BATCH		= 1024;
+static constexpr size_t BUFFER_SIZES[]	= { 4_KiB, 1_MiB };
+
+/**
+* A field shaped like what the SBF writers emit.
+*/
+struct buffer_record
+{
+	uint32 tag;
+	uint32 sizeBytes;
+	uint64 offset;
+};
+
+struct memory_resource_batch
+{
+	lib::memory_resource* resource;
+	size_t blockSize;
+	std::array<void*, BLOCK_BATCH> blocks;
+	std::array<uint16, BLOCK_BATCH> order;
+
+	memory_resource_batch(lib::memory_resource* memoryResource, size_t size) :
+		resource{ memoryResource },
+		blockSize{ size },
+		blocks{},
+		order{}
+	{
+		rng random{ size };
+
+		for (size_t i = 0; i < BLOCK_BATCH; ++i)
+		{
+			order[i] = static_cast<uint16>(i);
+		}
+
+		for (size_t i = BLOCK_BATCH; i > 1; --i)
+		{
+			std::swap(order[i - 1], order[random.next_below(i)]);
+		}
+	}
+};
+
+/**
+* Allocates a batch of blocks and frees them again in a shuffled order.
+*/
+static auto churn(memory_resource_batch& batch) -> void
+{
+	for (void*& block : batch.blocks)
+	{
+		block = batch.resource->allocate(batch.blockSize, alignof(std::max_align_t));
+	}
+
+	do_not_optimize(batch.blocks);
+
+	for (uint16 i : batch.order)
+	{
+		batch.resource->deallocate(batch.blocks[i], batch.blockSize, alignof(std::max_align_t));
+	}
+}
+
+/**
+* memory_resource is non-copyable and non-movable, so every benchmark owns the resource it measures.
+*/
+template <typename Fn>
+static auto with_resource(std::string_view impl, Fn&& fn) -> void
+{
+	if (impl == "slab")
+	{
+		lib::slab_memory_resource slab{};
+		fn(static_cast<lib::memory_resource*>(&slab));
+	}
+	else if (impl == "tracking")
+	{
+		lib::tracking_memory_resource tracking{ "bench" };
+		fn(static_cast<lib::memory_resource*>(&tracking));
+	}
+	else
+	{
+		fn(lib::get_default_resource());
+	}
+}
+
+static auto register_resources(registry& benchmarks) -> void
+{
+	static constexpr std::string_view RESOURCES[] = { "default", "slab", "tracking" };
+
+	for (std::string_view impl : RESOURCES)
+	{
+		for (size_t size : BLOCK_SIZES)
+		{
+			benchmarks.add(lib::format("memory/alloc_free/{}/{}", impl, size), [impl, size](state& s)
+			{
+				with_resource(impl, [&s, size](lib::memory_resource* resource)
+				{
+					memory_resource_batch batch{ resource, size };
+
+					while (s.keep_running())
+					{
+						churn(batch);
+					}
+
+					s.set_items_processed(s.iterations() * BLOCK_BATCH);
+				});
+			});
+		}
+
+		for (uint32 threads : thread_counts())
+		{
+			if (threads == 1)
+			{
+				continue;
+			}
+
+			benchmarks.add(lib::format("memory/alloc_free_threads/{}/64/{}", impl, threads), [impl, threads](state& s)
+			{
+				with_resource(impl, [&s, threads](lib::memory_resource* resource)
+				{
+					constexpr size_t rounds = 16;
+
+					while (s.keep_running())
+					{
+						std::vector<std::thread> workers;
+						workers.reserve(threads);
+
+						for (uint32 i = 0; i < threads; ++i)
+						{
+							workers.emplace_back([resource]()
+							{
+								memory_resource_batch batch{ resource, 64 };
+
+								for (size_t round = 0; round < rounds; ++round)
+								{
+									churn(batch);
+								}
+							});
+						}
+
+						for (std::thread& worker : workers)
+						{
+							worker.join();
+						}
+					}
+
+					s.set_items_processed(s.iterations() * threads * rounds * BLOCK_BATCH);
+				});
+			});
+		}
+	}
+
+	// The monotonic arena never frees, it is rewound once per batch instead.
+	for (size_t size : BLOCK_SIZES)
+	{
+		benchmarks.add(lib::format("memory/alloc_free/monotonic/{}", size), [size](state& s)
+		{
+			lib::monotonic_memory_resource arena{};
+			std::array<void*, BLOCK_BATCH> blocks = {};
+
+			while (s.keep_running())
+			{
+				lib::monotonic_memory_resource::scope scope{ arena };
+
+				for (void*& block : blocks)
+				{
+					block = arena.allocate(size, alignof(std::max_align_t));
+				}
+
+				do_not_optimize(blocks);
+			}
+
+			s.set_items_processed(s.iterations() * BLOCK_BATCH);
+		});
+	}
+
+	// Short lived scratch arrays, the use the per-thread frame arena was added for.
+	benchmarks.add("memory/scratch_array/default/256", [](state& s)
+	{
+		while (s.keep_running())
+		{
+			lib::array<uint32> scratch;
+			scratch.reserve(256);
+
+			for (uint32 i = 0; i < 256; ++i)
+			{
+				scratch.push_back(i);
+			}
+
+			do_not_optimize(scratch.data());
+		}
+
+		s.set_items_processed(s.iterations() * 256);
+	});
+	benchmarks.add("memory/scratch_array/monotonic/256", [](state& s)
+	{
+		lib::monotonic_memory_resource arena{};
+
+		while (s.keep_running())
+		{
+			lib::monotonic_memory_resource::scope scope{ arena };
+
+			lib::array<uint32> scratch{ lib::allocator<uint32>{ &arena } };
+			scratch.reserve(256);
+
+			for (uint32 i = 0; i < 256; ++i)
+			{
+				scratch.push_back(i);
+			}
+
+			do_not_optimize(scratch.data());
+		}
+
+		s.set_items_processed(s.iterations() * 256);
+	});
+}
+
+static auto register_buffers(registry& benchmarks) -> void
+{
+	for (size_t size : BUFFER_SIZES)
+	{
+		size_t const records = size / sizeof(buffer_record);
+
+		benchmarks.add(lib::format("buffer/write/sbf_buffer/{}", size), [size, records](state& s)
+		{
+			core::sbf::Buffer buffer{ core::sbf::BufferInfo{ .blockCapacity = size }, *lib::get_default_resource() };
+
+			while (s.keep_running())
+			{
+				buffer.clear();
+
+				for (size_t i = 0; i < records; ++i)
+				{
+					buffer.write(buffer_record{ .tag = static_cast<uint32>(i), .sizeBytes = 16, .offset = i * 16 });
+				}
+
+				do_not_optimize(buffer.data());
+			}
+
+			s.set_items_processed(s.iterations() * records);
+		});
+		benchmarks.add(lib::format("buffer/write/std_vector/{}", size), [size, records](state& s)
+		{
+			std::vector<std::byte> buffer;
+			buffer.reserve(size);
+
+			while (s.keep_running())
+			{
+				buffer.clear();
+
+				for (size_t i = 0; i < records; ++i)
+				{
+					buffer_record const record{ .tag = static_cast<uint32>(i), .sizeBytes = 16, .offset = i * 16 };
+					std::byte const* bytes = reinterpret_cast<std::byte const*>(&record);
+
+					buffer.insert(buffer.end(), bytes, bytes + sizeof(record));
+				}
+
+				do_not_optimize(buffer.data());
+			}
+
+			s.set_items_processed(s.iterations() * records);
+		});
+		benchmarks.add(lib::format("buffer/reserve_for/sbf_buffer/{}", size), [size, records](state& s)
+		{
+			core::sbf::Buffer buffer{ core::sbf::BufferInfo{ .blockCapacity = size }, *lib::get_default_resource() };
+
+			while (s.keep_running())
+			{
+				buffer.clear();
+
+				std::span<buffer_record> out = buffer.reserve_for<buffer_record>(records);
+
+				for (size_t i = 0; i < out.size(); ++i)
+				{
+					out[i] = buffer_record{ .tag = static_cast<uint32>(i), .sizeBytes = 16, .offset = i * 16 };
+				}
+
+				do_not_optimize(buffer.data());
+			}
+
+			s.set_items_processed(s.iterations() * records);
+		});
+	}
+}
+
+auto register_memory_benchmarks(registry& benchmarks) -> void
+{
+	register_resources(benchmarks);
+	register_buffers(benchmarks);
+}
+}
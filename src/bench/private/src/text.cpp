@@ -0,0 +1,319 @@
+#include <string>
+#include <unordered_map>
+#include "lib/atom.hpp"
+#include "lib/string_search.hpp"
+#include "suites.hpp"
+
+namespace bench
+{
+static constexpr size_t TEXT_LENGTHS[]	= { 16, 256, 4096 };
+static constexpr size_t ATOM_COUNT		= 1 << 14;
+static constexpr std::string_view SET	= " \t\n=";
+
+static auto view(lib::string const& str) -> std::string_view
+{
+	return std::string_view{ str.c_str(), str.size() };
+}
+
+/**
+* Lower case letters other than 'z' with "tail" at the end, so every search has to go over the whole string before it finds what it is looking for.
+*/
+static auto make_text(size_t length, std::string_view tail, uint64 seed) -> lib::string
+{
+	lib::string text;
+	rng random{ seed };
+
+	for (size_t i = 0; i + tail.size() < length; ++i)
+	{
+		text.push_back(static_cast<char>('a' + random.next_below(25)));
+	}
+
+	text.append(tail);
+
+	return text;
+}
+
+static auto to_upper(std::string_view str) -> lib::string
+{
+	lib::string result;
+
+	for (char ch : str)
+	{
+		result.push_back((ch >= 'a' && ch <= 'z') ? static_cast<char>(ch - ('a' - 'A')) : ch);
+	}
+
+	return result;
+}
+
+/**
+* Registers a search or comparison over a string of every length in TEXT_LENGTHS. "fn" gets the text and returns something for do_not_optimize().
+*/
+template <typename Fn>
+static auto add_text_benchmark(registry& benchmarks, std::string_view name, std::string_view impl, std::string_view tail, Fn fn) -> void
+{
+	for (size_t length : TEXT_LENGTHS)
+	{
+		benchmarks.add(lib::format("text/{}/{}/{}", name, impl, length), [length, tail, fn](state& s)
+		{
+			lib::string const text = make_text(length, tail, length);
+
+			while (s.keep_running())
+			{
+				do_not_optimize(fn(view(text)));
+			}
+
+			s.set_items_processed(s.iterations() * length);
+		});
+	}
+}
+
+static auto register_search(registry& benchmarks) -> void
+{
+	add_text_benchmark(benchmarks, "find_char", "lib", "z", [](std::string_view text) { return lib::str::find(text, 'z'); });
+	add_text_benchmark(benchmarks, "find_char", "std", "z", [](std::string_view text) { return text.find('z'); });
+	add_text_benchmark(benchmarks, "find_char", "scalar", "z", [](std::string_view text)
+	{
+		for (size_t i = 0; i < text.size(); ++i)
+		{
+			if (text[i] == 'z')
+			{
+				return i;
+			}
+		}
+
+		return lib::str::npos;
+	});
+
+	add_text_benchmark(benchmarks, "find", "lib", "zzbz", [](std::string_view text) { return lib::str::find(text, "zzbz"); });
+	add_text_benchmark(benchmarks, "find", "std", "zzbz", [](std::string_view text) { return text.find("zzbz"); });
+
+	add_text_benchmark(benchmarks, "rfind_char", "lib", "z", [](std::string_view text) { return lib::str::rfind(text.substr(0, text.size() - 1), 'z'); });
+	add_text_benchmark(benchmarks, "rfind_char", "std", "z", [](std::string_view text) { return text.substr(0, text.size() - 1).rfind('z'); });
+
+	add_text_benchmark(benchmarks, "find_first_of", "lib", "=", [](std::string_view text) { return lib::str::find_first_of(text, SET); });
+	add_text_benchmark(benchmarks, "find_first_of", "std", "=", [](std::string_view text) { return text.find_first_of(SET); });
+
+	// Both sides differ only in case, so the whole string is compared.
+	for (size_t length : TEXT_LENGTHS)
+	{
+		benchmarks.add(lib::format("text/compare_ignore_case/lib/{}", length), [length](state& s)
+		{
+			lib::string const lower = make_text(length, {}, length);
+			lib::string const upper = to_upper(view(lower));
+
+			while (s.keep_running())
+			{
+				do_not_optimize(lib::str::compare_ignore_case(view(lower), view(upper)));
+			}
+
+			s.set_items_processed(s.iterations() * length);
+		});
+		benchmarks.add(lib::format("text/compare_ignore_case/scalar/{}", length), [length](state& s)
+		{
+			lib::string const lower = make_text(length, {}, length);
+			lib::string const upper = to_upper(view(lower));
+
+			while (s.keep_running())
+			{
+				bool const equal = std::ranges::equal(view(lower), view(upper), [](char l, char r) { return lib::str::detail::fold_case(l) == lib::str::detail::fold_case(r); });
+				do_not_optimize(equal);
+			}
+
+			s.set_items_processed(s.iterations() * length);
+		});
+	}
+
+	add_text_benchmark(benchmarks, "hash", "lib", {}, [](std::string_view text) { return lib::str::hash(text); });
+	add_text_benchmark(benchmarks, "hash", "std", {}, [](std::string_view text) { return std::hash<std::string_view>{}(text); });
+}
+
+/**
+* Lets std::unordered_map<std::string, ...> be searched with a std::string_view without making a std::string, the way atom_table is.
+*/
+struct transparent_string_hash
+{
+	using is_transparent = void;
+
+	auto operator()(std::string_view str) const -> size_t { return std::hash<std::string_view>{}(str); }
+};
+
+using std_string_table = std::unordered_map<std::string, uint32, transparent_string_hash, std::equal_to<>>;
+
+static auto make_std_table(lib::array<lib::string> const& names) -> std_string_table
+{
+	std_string_table table;
+	table.reserve(names.size());
+
+	for (lib::string const& name : names)
+	{
+		table.emplace(std::string{ view(name) }, static_cast<uint32>(table.size()));
+	}
+
+	return table;
+}
+
+static auto register_atoms(registry& benchmarks) -> void
+{
+	benchmarks.add("atom/intern_new/lib", [](state& s)
+	{
+		lib::array<lib::string> const names = make_string_keys(ATOM_COUNT);
+
+		while (s.keep_running())
+		{
+			lib::atom_table table;
+
+			for (lib::string const& name : names)
+			{
+				do_not_optimize(table.intern(view(name)));
+			}
+		}
+
+		s.set_items_processed(s.iterations() * ATOM_COUNT);
+	});
+	benchmarks.add("atom/intern_new/std_unordered_map", [](state& s)
+	{
+		lib::array<lib::string> const names = make_string_keys(ATOM_COUNT);
+
+		while (s.keep_running())
+		{
+			std_string_table table = make_std_table(names);
+			do_not_optimize(table.size());
+		}
+
+		s.set_items_processed(s.iterations() * ATOM_COUNT);
+	});
+	benchmarks.add("atom/intern_existing/lib", [](state& s)
+	{
+		lib::array<lib::string> const names = make_string_keys(ATOM_COUNT);
+		lib::atom_table table;
+
+		for (lib::string const& name : names)
+		{
+			table.intern(view(name));
+		}
+
+		while (s.keep_running())
+		{
+			for (lib::string const& name : names)
+			{
+				do_not_optimize(table.intern(view(name)));
+			}
+		}
+
+		s.set_items_processed(s.iterations() * ATOM_COUNT);
+	});
+	benchmarks.add("atom/find/lib", [](state& s)
+	{
+		lib::array<lib::string> const names = make_string_keys(ATOM_COUNT);
+		lib::atom_table table;
+
+		for (lib::string const& name : names)
+		{
+			table.intern(view(name));
+		}
+
+		while (s.keep_running())
+		{
+			for (lib::string const& name : names)
+			{
+				do_not_optimize(table.find(view(name)));
+			}
+		}
+
+		s.set_items_processed(s.iterations() * ATOM_COUNT);
+	});
+	benchmarks.add("atom/find/std_unordered_map", [](state& s)
+	{
+		lib::array<lib::string> const names = make_string_keys(ATOM_COUNT);
+		std_string_table const table = make_std_table(names);
+
+		while (s.keep_running())
+		{
+			for (lib::string const& name : names)
+			{
+				do_not_optimize(table.find(view(name))->second);
+			}
+		}
+
+		s.set_items_processed(s.iterations() * ATOM_COUNT);
+	});
+	benchmarks.add("atom/str/lib", [](state& s)
+	{
+		lib::array<lib::string> const names = make_string_keys(ATOM_COUNT);
+		lib::atom_table table;
+		lib::array<lib::atom> atoms;
+		atoms.reserve(ATOM_COUNT);
+
+		for (lib::string const& name : names)
+		{
+			atoms.push_back(table.intern(view(name)));
+		}
+
+		while (s.keep_running())
+		{
+			for (lib::atom value : atoms)
+			{
+				do_not_optimize(table.str(value).size());
+			}
+		}
+
+		s.set_items_processed(s.iterations() * ATOM_COUNT);
+	});
+
+	// What keying a lookup table by atom instead of by name saves once the names have been interned.
+	benchmarks.add("atom/map_find/lib_atom_key", [](state& s)
+	{
+		lib::array<lib::string> const names = make_string_keys(ATOM_COUNT);
+		lib::atom_table table;
+		lib::array<lib::atom> atoms;
+		lib::map<lib::atom, uint32> map;
+		atoms.reserve(ATOM_COUNT);
+		map.reserve(ATOM_COUNT);
+
+		for (lib::string const& name : names)
+		{
+			lib::atom const value = table.intern(view(name));
+
+			atoms.push_back(value);
+			map.emplace(value, static_cast<uint32>(map.size()));
+		}
+
+		while (s.keep_running())
+		{
+			for (lib::atom value : atoms)
+			{
+				do_not_optimize(map.at(value).value()->second);
+			}
+		}
+
+		s.set_items_processed(s.iterations() * ATOM_COUNT);
+	});
+	benchmarks.add("atom/map_find/lib_string_key", [](state& s)
+	{
+		lib::array<lib::string> const names = make_string_keys(ATOM_COUNT);
+		lib::map<lib::string, uint32> map;
+		map.reserve(ATOM_COUNT);
+
+		for (lib::string const& name : names)
+		{
+			map.emplace(name, static_cast<uint32>(map.size()));
+		}
+
+		while (s.keep_running())
+		{
+			for (lib::string const& name : names)
+			{
+				do_not_optimize(map.at(name).value()->second);
+			}
+		}
+
+		s.set_items_processed(s.iterations() * ATOM_COUNT);
+	});
+}
+
+auto register_text_benchmarks(registry& benchmarks) -> void
+{
+	register_search(benchmarks);
+	register_atoms(benchmarks);
+}
+}
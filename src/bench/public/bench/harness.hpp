@@ -0,0 +1,279 @@
+#pragma once
+#ifndef BENCH_HARNESS_HPP
+#define BENCH_HARNESS_HPP
+
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include "lib/array.hpp"
+#include "lib/function.hpp"
+#include "lib/map.hpp"
+#include "lib/string.hpp"
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace bench
+{
+/**
+* @brief Keeps the compiler from discarding a value, or the work that produced it, without adding any instructions.
+*/
+template <typename T>
+inline auto do_not_optimize(T const& value) -> void
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	static_cast<void>(*reinterpret_cast<char const volatile*>(&value));
+	_ReadWriteBarrier();
+#else
+	asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+/**
+* @brief Forces pending writes to memory to be treated as observable.
+*/
+inline auto clobber_memory() -> void
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	_ReadWriteBarrier();
+#else
+	asm volatile("" : : : "memory");
+#endif
+}
+
+/**
+* @brief splitmix64. Every benchmark seeds its own so that runs are repeatable.
+*/
+struct rng
+{
+	uint64 state;
+
+	auto next() -> uint64
+	{
+		uint64 z = (state += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+	auto next_below(uint64 bound) -> uint64 { return next() % bound; }
+
+	/**
+	* @brief Uniform in [lo, hi).
+	*/
+	auto next_float(float32 lo, float32 hi) -> float32
+	{
+		return lo + (hi - lo) * (static_cast<float32>(next() >> 40) * 0x1.0p-24f);
+	}
+};
+
+/**
+* How integer keys are spread. High bits keys only differ above bit 32, which hurts hashers that lean on the low bits.
+*/
+enum class distribution
+{
+	sequential,
+	uniform,
+	high_bits
+};
+
+inline constexpr std::array distributions_v = { distribution::sequential, distribution::uniform, distribution::high_bits };
+
+auto distribution_name(distribution d) -> std::string_view;
+
+/**
+* @brief count distinct keys, shuffled unless the distribution is sequential.
+*/
+auto make_keys(size_t count, distribution d, uint64 seed = 1) -> lib::array<uint64>;
+
+/**
+* @brief count distinct keys that are not produced by make_keys() with the same distribution, for lookups that miss.
+*/
+auto make_missing_keys(size_t count, distribution d, uint64 seed = 2) -> lib::array<uint64>;
+
+/**
+* @brief count distinct strings shaped like asset paths, around 24 to 40 characters long.
+*/
+auto make_string_keys(size_t count, uint64 seed = 1) -> lib::array<lib::string>;
+
+/**
+* @brief lib::array does not satisfy std::ranges::contiguous_range yet, so kernels that take spans are handed one made from data() and size().
+*/
+template <typename container_type>
+auto as_span(container_type& container)
+{
+	return std::span{ container.data(), container.size() };
+}
+
+struct counter
+{
+	literal_t name;
+	float64 value;
+};
+
+/**
+* Handed to every benchmark. The benchmark does its setup, then runs its timed loop until keep_running() returns false.
+*
+*	while (s.keep_running())
+*	{
+*		...
+*	}
+*
+* Work that should not be measured inside the loop goes between pause_timing() and resume_timing().
+*/
+class state : lib::non_copyable_non_movable
+{
+public:
+	static constexpr size_t max_counters_v = 4;
+
+	using clock_type = std::chrono::steady_clock;
+
+	state(uint64 iterations) :
+		m_iterations{ iterations },
+		m_remaining{ iterations },
+		m_start{},
+		m_elapsed{},
+		m_items{},
+		m_counters{},
+		m_counterCount{}
+	{}
+
+	/**
+	* @brief Timing starts on the first call and stops when the loop is done.
+	*/
+	auto keep_running() -> bool
+	{
+		if (m_remaining == 0) [[unlikely]]
+		{
+			m_elapsed += clock_type::now() - m_start;
+			return false;
+		}
+
+		if (m_remaining-- == m_iterations) [[unlikely]]
+		{
+			m_start = clock_type::now();
+		}
+
+		return true;
+	}
+
+	auto pause_timing() -> void { m_elapsed += clock_type::now() - m_start; }
+	auto resume_timing() -> void { m_start = clock_type::now(); }
+
+	auto iterations() const -> uint64 { return m_iterations; }
+	auto elapsed() const -> clock_type::duration { return m_elapsed; }
+
+	/**
+	* @brief Total number of items processed over all iterations, reported as items per second.
+	*/
+	auto set_items_processed(uint64 items) -> void { m_items = items; }
+	auto items_processed() const -> uint64 { return m_items; }
+
+	/**
+	* @brief Reports a value next to the timings, e.g. an error bound. The name must be a string literal.
+	*/
+	auto set_counter(literal_t name, float64 value) -> void
+	{
+		for (uint32 i = 0; i < m_counterCount; ++i)
+		{
+			if (std::string_view{ m_counters[i].name } == name)
+			{
+				m_counters[i].value = value;
+				return;
+			}
+		}
+
+		ASSERTION(m_counterCount < max_counters_v, "Too many counters for one benchmark.");
+
+		if (m_counterCount < max_counters_v)
+		{
+			m_counters[m_counterCount++] = counter{ .name = name, .value = value };
+		}
+	}
+
+	auto counters() const -> std::span<counter const> { return std::span{ m_counters.data(), m_counterCount }; }
+
+private:
+	uint64 m_iterations;
+	uint64 m_remaining;
+	clock_type::time_point m_start;
+	clock_type::duration m_elapsed;
+	uint64 m_items;
+	std::array<counter, max_counters_v> m_counters;
+	uint32 m_counterCount;
+};
+
+using benchmark_fn = lib::function<void(state&)>;
+
+struct benchmark
+{
+	lib::string name;
+	benchmark_fn fn;
+};
+
+/**
+* Benchmarks are named "group/operation/implementation/..." so that a filter can pick out a group, an operation or one implementation.
+*/
+class registry : lib::non_copyable_non_movable
+{
+public:
+	registry() = default;
+	~registry() = default;
+
+	auto add(lib::string&& name, benchmark_fn&& fn) -> void;
+	auto benchmarks() -> std::span<benchmark> { return std::span{ m_benchmarks.data(), m_benchmarks.size() }; }
+
+private:
+	lib::array<benchmark> m_benchmarks;
+};
+
+struct result
+{
+	lib::string name;
+	uint64 iterations;
+	float64 nsPerIteration;		// Median over the repetitions.
+	float64 nsMinPerIteration;
+	float64 itemsPerSecond;		// 0 when the benchmark does not count items.
+	std::array<counter, state::max_counters_v> counters;
+	uint32 counterCount;
+};
+
+struct run_options
+{
+	std::string_view filter;		// Only benchmarks whose name contains it are run.
+	float64 minTime = 0.05;			// Seconds every repetition runs for at least.
+	uint32 repetitions = 5;
+};
+
+/**
+* @brief Runs every benchmark that passes the filter and prints its result as it completes.
+* The iteration count is grown until one run takes at least minTime, that run is discarded and the count is reused for every repetition.
+*/
+auto run(registry& benchmarks, run_options const& options) -> lib::array<result>;
+
+/**
+* @brief One benchmark per line so that the file diffs well and load_baseline() does not need a full JSON parser.
+*/
+auto write_json(std::filesystem::path const& path, std::span<result const> results, run_options const& options) -> bool;
+
+/**
+* @brief Reads the ns_per_iteration of every benchmark in a file written by write_json().
+*/
+auto load_baseline(std::filesystem::path const& path, lib::map<lib::string, float64>& baseline) -> bool;
+
+/**
+* @brief Prints the change against the baseline for every benchmark it has.
+* @return Number of benchmarks that got slower by more than thresholdPercent.
+*/
+auto compare(std::span<result const> results, lib::map<lib::string, float64> const& baseline, float64 thresholdPercent) -> uint32;
+
+/**
+* @brief Number of threads multi-threaded benchmarks are run with, powers of two up to the hardware thread count.
+*/
+auto thread_counts() -> lib::array<uint32>;
+}
+
+#endif // !BENCH_HARNESS_HPP
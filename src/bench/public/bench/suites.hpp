@@ -0,0 +1,35 @@
+#pragma once
+#ifndef BENCH_SUITES_HPP
+#define BENCH_SUITES_HPP
+
+#include "harness.hpp"
+
+namespace bench
+{
+/**
+* @brief lib::array, small_array, map, set, paged_array, string, function and digraph against std, ankerl::unordered_dense and plf::colony.
+*/
+auto register_container_benchmarks(registry& benchmarks) -> void;
+
+/**
+* @brief The memory resources and core::sbf::Buffer.
+*/
+auto register_memory_benchmarks(registry& benchmarks) -> void;
+
+/**
+* @brief concurrent_map, work_stealing_deque, the job scheduler and the concurrent queues over a range of thread counts.
+*/
+auto register_concurrency_benchmarks(registry& benchmarks) -> void;
+
+/**
+* @brief Scalar against SIMD matrix math, the batch kernels, math::approx and math::pack.
+*/
+auto register_math_benchmarks(registry& benchmarks) -> void;
+
+/**
+* @brief lib::str search and comparison against std::string_view, and atom tables.
+*/
+auto register_text_benchmarks(registry& benchmarks) -> void;
+}
+
+#endif // !BENCH_SUITES_HPP
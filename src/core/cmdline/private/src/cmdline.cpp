@@ -316,13 +316,8 @@ auto ProgramOptions::_set_option_value(Option& option, std::string_view value) -
 		{
 		case OptionValueType::Boolean:
 		{
-			lib::string v{ value.data(), value.size() };
 			auto&& var = option.value<bool>();
-			if (!value.empty())
-			{
-				std::transform(v.begin(), v.end(), v.begin(), [](uint8 ch) -> uint8 { return static_cast<uint8>(std::tolower(ch)); });
-			}
-			var = (value.empty() || v == "true" || v == "1");
+			var = (value.empty() || lib::str::equals_ignore_case(value, "true") || value == "1");
 			break;
 		}
 		case OptionValueType::Int:
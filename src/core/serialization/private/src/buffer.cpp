@@ -4,6 +4,12 @@ namespace core
 {
 namespace sbf
 {
+auto memory_tracker() -> lib::tracking_memory_resource&
+{
+	static lib::tracking_memory_resource tracker{ "core::sbf::Buffer" };
+	return tracker;
+}
+
 Buffer::~Buffer()
 {
 	free();
@@ -39,7 +45,7 @@ auto Buffer::write(void const* data, size_t sizeBytes) -> bool
 		m_writtenBytes += sizeBytes;
 	}
 
-	return byteOffsetAfterWrite < m_info.blockCapacity;
+	return byteOffsetAfterWrite <= m_info.blockCapacity;
 }
 
 auto Buffer::data() -> void_pointer
@@ -87,6 +93,10 @@ auto Buffer::free() -> void
 	if (m_data != nullptr)
 	{
 		m_allocator.deallocate_bytes(m_data, m_info.blockCapacity, alignof(value_type));
+		memory_tracker().record_deallocation(m_info.blockCapacity);
+
+		m_data = nullptr;
+		m_writtenBytes = 0;
 	}
 }
 
@@ -97,8 +107,12 @@ auto Buffer::_allocate_memory() -> bool
 	{
 		// TODO(afiq):
 		// Call assert system.
+		return false;
 	}
-	return m_data != nullptr;
+
+	memory_tracker().record_allocation(m_info.blockCapacity);
+
+	return true;
 }
 
 MonotonicBuffer::MonotonicBuffer(lib::memory_resource& memoryResource) :
@@ -2,7 +2,7 @@
 #define SERIALIZATION_BUFFER_HPP
 
 #include <span>
-#include "lib/memory.hpp"
+#include "lib/tracking_memory_resource.hpp"
 
 namespace core
 {
@@ -13,6 +13,11 @@ struct BufferInfo
 	size_t blockCapacity = 4_KiB;
 };
 
+/**
+* Accounts for the blocks of every Buffer, whichever resource they are allocated from.
+*/
+auto memory_tracker() -> lib::tracking_memory_resource&;
+
 /**
 * 
 */
@@ -60,7 +65,7 @@ public:
 		size_t const bytesRequired = sizeof(T) * count;
 		size_t const byteOffsetAfterWrite = m_writtenBytes + bytesRequired;
 
-		if (byteOffsetAfterWrite < m_info.blockCapacity)
+		if (byteOffsetAfterWrite <= m_info.blockCapacity)
 		{
 			T* begin	= reinterpret_cast<T*>(m_data + m_writtenBytes);
 			T* end		= reinterpret_cast<T*>(m_data + (m_writtenBytes + bytesRequired));
@@ -70,23 +75,34 @@ public:
 			m_writtenBytes += bytesRequired;
 		}
 
-		return byteOffsetAfterWrite < m_info.blockCapacity;
+		return byteOffsetAfterWrite <= m_info.blockCapacity;
 	}
 
+	/**
+	* Reserves space for count elements of T at the end of the buffer so the caller can write into it directly.
+	* The reserved space counts as written. Returns an empty span if the buffer does not have enough capacity.
+	*/
 	template <typename T>
 	auto reserve_for(size_t count) -> std::span<T> requires (std::is_standard_layout_v<T>&& std::is_trivially_copyable_v<T>)
 	{
 		if (m_data == nullptr && !_allocate_memory())
 		{
-			return false;
+			return {};
 		}
 
 		size_t const bytesRequired = sizeof(T) * count;
 		size_t const byteOffsetAfterWrite = m_writtenBytes + bytesRequired;
 
+		if (byteOffsetAfterWrite > m_info.blockCapacity)
+		{
+			return {};
+		}
+
 		T* ptr = reinterpret_cast<T*>(m_data + m_writtenBytes);
 
-		return (byteOffsetAfterWrite < m_info.blockCapacity) ? std::span{ ptr, count } : std::span<T>{};
+		m_writtenBytes += bytesRequired;
+
+		return std::span{ ptr, count };
 	}
 
 	auto data() -> void_pointer;
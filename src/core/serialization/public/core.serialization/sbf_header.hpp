@@ -5,8 +5,10 @@
 
 #include "lib/common.hpp"
 
+// Bumped whenever the layout of a section changes in a way older readers cannot handle.
+// 2: render::MeshViewInfo gained the vertex encoding, the index type and the mesh bounds.
 #ifndef SBF_VERSION_MAJOR
-#define SBF_VERSION_MAJOR 1
+#define SBF_VERSION_MAJOR 2
 #endif // !SBF_VERSION_MAJOR
 
 #ifndef SBF_VERSION_MINOR
@@ -409,11 +409,14 @@ auto CommandRecorder::dispatch_indirect(DispatchIndirectInfo const& info) -> voi
 	vkCmdDispatchIndirect(self.handle, vkbuffer.handle, info.offset);
 }
 
+/**
+* Most events carry a couple of barriers at most, so they are kept inline instead of being reallocated every time the buffer below is cleared.
+*/
 struct SplitBarrierDependencyInfoBuffer
 {
-	lib::array<VkMemoryBarrier2> vkMemoryBarriers = {};
-	lib::array<VkBufferMemoryBarrier2> vkBufferBarriers = {};
-	lib::array<VkImageMemoryBarrier2> vkImageBarriers = {};
+	lib::small_array<VkMemoryBarrier2, 4> vkMemoryBarriers = {};
+	lib::small_array<VkBufferMemoryBarrier2, 4> vkBufferBarriers = {};
+	lib::small_array<VkImageMemoryBarrier2, 4> vkImageBarriers = {};
 };
 
 /**
@@ -509,6 +512,12 @@ auto CommandRecorder::wait_events(std::span<EventWaitInfo const> const& infos) -
 			splitBarrierInfo.vkImageBarriers.push_back(self.get_image_barrier_info(vkdevice, barrier));
 		}
 
+		splitBarrierEventBuffer.push_back(vkevent.handle);
+	}
+
+	// Filled in once every event has been recorded, the barriers are stored inline and move whenever splitBarrierInfoBuffer grows.
+	for (auto const& splitBarrierInfo : splitBarrierInfoBuffer)
+	{
 		dependencyInfoBuffer.emplace_back(
 			VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
 			nullptr,
@@ -520,7 +529,6 @@ auto CommandRecorder::wait_events(std::span<EventWaitInfo const> const& infos) -
 			static_cast<uint32>(splitBarrierInfo.vkImageBarriers.size()),
 			splitBarrierInfo.vkImageBarriers.data()
 		);
-		splitBarrierEventBuffer.push_back(vkevent.handle);
 	}
 
 	vkCmdWaitEvents2(self.handle, static_cast<uint32>(splitBarrierEventBuffer.size()), splitBarrierEventBuffer.data(), dependencyInfoBuffer.data());
@@ -4,6 +4,7 @@
 
 #include <span>
 #include "lib/string.hpp"
+#include "lib/small_array.hpp"
 #include "lib/bit_mask.hpp"
 #include "constants.hpp"
 
@@ -293,10 +294,10 @@ struct ColorAttachment
 struct RasterPipelineInfo
 {
 	std::string name;
-	lib::array<ColorAttachment> colorAttachments;
+	lib::small_array<ColorAttachment, 4> colorAttachments;
 	Format depthAttachmentFormat;
 	Format stencilAttachmentFormat;
-	lib::array<VertexInputBinding> vertexInputBindings;
+	lib::small_array<VertexInputBinding, 4> vertexInputBindings;
 	RasterizationStateInfo rasterization;
 	DepthTestInfo depthTest;
 	TopologyType topology;
@@ -0,0 +1,219 @@
+#include "lib/atom.hpp"
+
+namespace lib
+{
+/**
+* The characters follow the entry, with a null terminator after them.
+*/
+struct atom_table::entry
+{
+	uint64 hash;
+	uint32 length;
+
+	auto chars() const -> char const* { return reinterpret_cast<char const*>(this + 1); }
+};
+
+/**
+* Open addressing table from strings to atoms, with linear probing. The slots follow the header.
+* A slot holds the upper 32 bits of the string's hash next to the atom so that most mismatches are rejected without touching the entry. Zero marks an empty slot, atom 0 is never stored.
+*
+* Tables are only ever replaced, never resized in place. A reader that is still probing a replaced table sees every atom that existed when it was replaced.
+*/
+struct alignas(std::atomic<uint64>) atom_table::lookup
+{
+	size_t mask;
+
+	auto slots() -> std::atomic<uint64>* { return reinterpret_cast<std::atomic<uint64>*>(this + 1); }
+	auto slots() const -> std::atomic<uint64> const* { return reinterpret_cast<std::atomic<uint64> const*>(this + 1); }
+};
+
+static constexpr size_t INITIAL_LOOKUP_CAPACITY = 1024;
+static constexpr uint64 HASH_TAG_MASK = 0xFFFFFFFF00000000ull;
+
+atom_table::atom_table(memory_resource* upstream) :
+	m_arena{ monotonic_memory_resource::default_block_size_v, upstream },
+	m_mutex{},
+	m_lookup{},
+	m_count{ 0 },
+	m_pages{}
+{
+	m_lookup.store(_make_lookup(INITIAL_LOOKUP_CAPACITY), std::memory_order_relaxed);
+
+	// The null atom, so that str() and hash() work on it like on any other atom.
+	_add(std::string_view{ "" }, hash_bytes("", 0));
+}
+
+// Everything, the pages and lookup tables included, lives in the arena.
+atom_table::~atom_table() = default;
+
+auto atom_table::intern(std::string_view name) -> atom
+{
+	if (name.empty())
+	{
+		return atom{};
+	}
+
+	uint64 const nameHash = hash_bytes(name.data(), name.size());
+
+	if (atom const existing = _find(*m_lookup.load(std::memory_order_acquire), name, nameHash); existing.valid())
+	{
+		return existing;
+	}
+
+	std::lock_guard lock{ m_mutex };
+
+	// Another thread may have added it in between.
+	lookup* table = m_lookup.load(std::memory_order_relaxed);
+
+	if (atom const existing = _find(*table, name, nameHash); existing.valid())
+	{
+		return existing;
+	}
+
+	uint32 const index = _add(name, nameHash);
+
+	// Kept at most half full so that probes stay short.
+	if (size_t{ index } * 2 > table->mask)
+	{
+		lookup* grown = _make_lookup((table->mask + 1) * 2);
+
+		for (uint32 i = 1; i < index; ++i)
+		{
+			_insert(*grown, _entry(i)->hash, i);
+		}
+
+		m_lookup.store(grown, std::memory_order_release);
+		table = grown;
+	}
+
+	_insert(*table, nameHash, index);
+
+	return atom{ index };
+}
+
+auto atom_table::find(std::string_view name) const -> atom
+{
+	if (name.empty())
+	{
+		return atom{};
+	}
+
+	return _find(*m_lookup.load(std::memory_order_acquire), name, hash_bytes(name.data(), name.size()));
+}
+
+auto atom_table::str(atom value) const -> std::string_view
+{
+	entry const* e = _entry(value.value);
+	return std::string_view{ e->chars(), e->length };
+}
+
+auto atom_table::hash(atom value) const -> uint64
+{
+	return _entry(value.value)->hash;
+}
+
+auto atom_table::_entry(uint32 index) const -> entry const*
+{
+	ASSERTION(index < size(), "Atom does not belong to this table.");
+
+	page_type const* page = m_pages[index / page_size_v].load(std::memory_order_acquire);
+	return page[index % page_size_v].load(std::memory_order_acquire);
+}
+
+auto atom_table::_find(lookup const& table, std::string_view name, uint64 nameHash) const -> atom
+{
+	std::atomic<uint64> const* slots = table.slots();
+	uint64 const tag = nameHash & HASH_TAG_MASK;
+
+	for (size_t i = nameHash & table.mask;; i = (i + 1) & table.mask)
+	{
+		uint64 const slot = slots[i].load(std::memory_order_acquire);
+
+		if (slot == 0)
+		{
+			return atom{};
+		}
+
+		if ((slot & HASH_TAG_MASK) == tag)
+		{
+			uint32 const index = static_cast<uint32>(slot);
+			entry const* e = _entry(index);
+
+			if (e->length == name.size() && std::memcmp(e->chars(), name.data(), name.size()) == 0)
+			{
+				return atom{ index };
+			}
+		}
+	}
+}
+
+auto atom_table::_add(std::string_view name, uint64 nameHash) -> uint32
+{
+	uint32 const index = m_count.load(std::memory_order_relaxed);
+
+	ASSERTION(index < max_atoms_v, "Atom table is full.");
+
+	void* memory = m_arena.allocate(sizeof(entry) + name.size() + 1, alignof(entry));
+	entry* e = new (memory) entry{ .hash = nameHash, .length = static_cast<uint32>(name.size()) };
+
+	char* chars = reinterpret_cast<char*>(e + 1);
+	std::memcpy(chars, name.data(), name.size());
+	chars[name.size()] = '\0';
+
+	std::atomic<page_type*>& pageSlot = m_pages[index / page_size_v];
+	page_type* page = pageSlot.load(std::memory_order_relaxed);
+
+	if (page == nullptr)
+	{
+		page = static_cast<page_type*>(m_arena.allocate(sizeof(page_type) * page_size_v, alignof(page_type)));
+
+		for (uint32 i = 0; i < page_size_v; ++i)
+		{
+			new (&page[i]) page_type{ nullptr };
+		}
+
+		pageSlot.store(page, std::memory_order_release);
+	}
+
+	page[index % page_size_v].store(e, std::memory_order_release);
+	m_count.store(index + 1, std::memory_order_release);
+
+	return index;
+}
+
+auto atom_table::_make_lookup(size_t capacity) -> lookup*
+{
+	void* memory = m_arena.allocate(sizeof(lookup) + sizeof(std::atomic<uint64>) * capacity, alignof(lookup));
+	lookup* table = new (memory) lookup{ .mask = capacity - 1 };
+
+	std::atomic<uint64>* slots = table->slots();
+
+	for (size_t i = 0; i < capacity; ++i)
+	{
+		new (&slots[i]) std::atomic<uint64>{ 0 };
+	}
+
+	return table;
+}
+
+auto atom_table::_insert(lookup& table, uint64 nameHash, uint32 index) -> void
+{
+	std::atomic<uint64>* slots = table.slots();
+
+	size_t i = nameHash & table.mask;
+
+	while (slots[i].load(std::memory_order_relaxed) != 0)
+	{
+		i = (i + 1) & table.mask;
+	}
+
+	// Publishes the entry, readers that see the slot also see what _add() wrote.
+	slots[i].store((nameHash & HASH_TAG_MASK) | index, std::memory_order_release);
+}
+
+auto global_atom_table() -> atom_table&
+{
+	static atom_table table{};
+	return table;
+}
+}
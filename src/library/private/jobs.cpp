@@ -0,0 +1,368 @@
+#include "lib/jobs.hpp"
+
+namespace lib
+{
+namespace jobs
+{
+static constexpr uint32 INVALID_WORKER_INDEX = std::numeric_limits<uint32>::max();
+
+/**
+* Lets schedule() push into the calling worker's deque when it is called from within a running job.
+*/
+static thread_local scheduler* t_scheduler = nullptr;
+static thread_local uint32 t_workerIndex = INVALID_WORKER_INDEX;
+
+counter::counter(uint32 initial) :
+	m_value{ initial },
+	m_mutex{},
+	m_condition{},
+	m_waiters{},
+	m_signaled{ initial == 0 }
+{}
+
+counter::~counter()
+{
+	ASSERTION(m_waiters == nullptr, "Counter destroyed while tasks are still waiting on it.");
+}
+
+auto counter::add(uint32 count) -> void
+{
+	if (m_value.fetch_add(count, std::memory_order_acq_rel) == 0)
+	{
+		std::lock_guard lock{ m_mutex };
+		m_signaled = false;
+	}
+}
+
+auto counter::signal() -> void
+{
+	uint32 const previous = m_value.fetch_sub(1, std::memory_order_acq_rel);
+
+	ASSERTION(previous != 0, "Counter signaled more times than it was added to.");
+
+	if (previous != 1)
+	{
+		return;
+	}
+
+	job* waiters = nullptr;
+
+	{
+		std::lock_guard lock{ m_mutex };
+
+		// Someone may have added to the counter again in between.
+		if (m_value.load(std::memory_order_acquire) != 0)
+		{
+			return;
+		}
+
+		m_signaled = true;
+		waiters = std::exchange(m_waiters, nullptr);
+
+		m_condition.notify_all();
+	}
+
+	// The counter may be gone by now, only the detached list is touched.
+	while (waiters != nullptr)
+	{
+		job* waiter = waiters;
+		waiters = waiter->next;
+
+		waiter->next = nullptr;
+		waiter->owner->schedule(*waiter);
+	}
+}
+
+auto counter::_enqueue_waiter(job& waiter) -> bool
+{
+	std::lock_guard lock{ m_mutex };
+
+	if (m_signaled)
+	{
+		return false;
+	}
+
+	ASSERTION(waiter.owner != nullptr, "Only tasks started on a scheduler can await a counter.");
+
+	waiter.next = m_waiters;
+	m_waiters = &waiter;
+
+	return true;
+}
+
+auto scheduler::job_queue::push(job& j) -> void
+{
+	std::lock_guard lock{ mutex };
+
+	j.next = nullptr;
+
+	if (tail != nullptr)
+	{
+		tail->next = &j;
+	}
+	else
+	{
+		head = &j;
+	}
+	tail = &j;
+
+	size.fetch_add(1, std::memory_order_release);
+}
+
+auto scheduler::job_queue::pop() -> job*
+{
+	if (size.load(std::memory_order_acquire) == 0)
+	{
+		return nullptr;
+	}
+
+	std::lock_guard lock{ mutex };
+
+	job* j = head;
+
+	if (j != nullptr)
+	{
+		head = j->next;
+
+		if (head == nullptr)
+		{
+			tail = nullptr;
+		}
+
+		j->next = nullptr;
+		size.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	return j;
+}
+
+scheduler::scheduler(scheduler_info const& info) :
+	m_deques{},
+	m_threads{},
+	m_workerCount{ (info.workerCount != 0) ? info.workerCount : std::max(std::thread::hardware_concurrency(), 1u) },
+	m_ioThreadCount{ info.ioThreadCount },
+	m_highQueue{},
+	m_normalQueue{},
+	m_ioQueue{},
+	m_sleepMutex{},
+	m_wake{},
+	m_ioWake{},
+	m_epoch{ 0 },
+	m_sleepers{ 0 },
+	m_stop{ false }
+{
+	m_deques = std::make_unique<work_stealing_deque<job*>[]>(m_workerCount);
+	m_threads.reserve(m_workerCount + m_ioThreadCount);
+
+	for (uint32 i = 0; i < m_workerCount; ++i)
+	{
+		m_threads.emplace_back([this, i]() -> void { _worker_loop(i); });
+	}
+
+	for (uint32 i = 0; i < m_ioThreadCount; ++i)
+	{
+		m_threads.emplace_back([this]() -> void { _io_loop(); });
+	}
+}
+
+scheduler::~scheduler()
+{
+	{
+		std::lock_guard lock{ m_sleepMutex };
+
+		m_stop = true;
+		m_epoch.fetch_add(1, std::memory_order_seq_cst);
+	}
+	m_wake.notify_all();
+	m_ioWake.notify_all();
+
+	for (auto& thread : m_threads)
+	{
+		thread.join();
+	}
+}
+
+auto scheduler::schedule(job& j) -> void
+{
+	ASSERTION(j.execute != nullptr, "Scheduling a job that has nothing to execute.");
+
+	j.owner = this;
+
+	if (j.priority == priority::io && m_ioThreadCount != 0)
+	{
+		m_ioQueue.push(j);
+
+		{
+			std::lock_guard lock{ m_sleepMutex };
+		}
+		m_ioWake.notify_one();
+
+		return;
+	}
+
+	if (j.priority == priority::high)
+	{
+		m_highQueue.push(j);
+	}
+	else if (t_scheduler == this)
+	{
+		m_deques[t_workerIndex].push(&j);
+	}
+	else
+	{
+		m_normalQueue.push(j);
+	}
+
+	_wake_one();
+}
+
+auto scheduler::wait(counter& c) -> void
+{
+	if (t_scheduler == this)
+	{
+		uint32 const index = t_workerIndex;
+
+		while (!c.done())
+		{
+			if (job* j = _find_job(index); j != nullptr)
+			{
+				j->execute(j);
+				continue;
+			}
+
+			// Nothing to help with, the jobs that are left are running elsewhere.
+			std::unique_lock lock{ c.m_mutex };
+			c.m_condition.wait_for(lock, std::chrono::milliseconds{ 1 }, [&c]() -> bool { return c.m_signaled; });
+		}
+	}
+
+	// Returning only once signal() is done with the counter lets the caller destroy it right away.
+	std::unique_lock lock{ c.m_mutex };
+	c.m_condition.wait(lock, [&c]() -> bool { return c.m_signaled; });
+}
+
+auto scheduler::current() -> scheduler*
+{
+	return t_scheduler;
+}
+
+auto scheduler::_worker_loop(uint32 index) -> void
+{
+	t_scheduler = this;
+	t_workerIndex = index;
+
+	while (true)
+	{
+		if (job* j = _find_job(index); j != nullptr)
+		{
+			j->execute(j);
+			continue;
+		}
+
+		// Announce the intent to sleep before looking one last time. A producer that misses the announcement pushed early enough for the search to find its job.
+		uint64 const epoch = m_epoch.load(std::memory_order_seq_cst);
+
+		m_sleepers.fetch_add(1, std::memory_order_seq_cst);
+
+		if (job* j = _find_job(index); j != nullptr)
+		{
+			m_sleepers.fetch_sub(1, std::memory_order_seq_cst);
+			j->execute(j);
+			continue;
+		}
+
+		std::unique_lock lock{ m_sleepMutex };
+
+		m_wake.wait(lock, [this, epoch]() -> bool { return m_stop || m_epoch.load(std::memory_order_seq_cst) != epoch; });
+		m_sleepers.fetch_sub(1, std::memory_order_seq_cst);
+
+		if (m_stop)
+		{
+			break;
+		}
+	}
+
+	t_scheduler = nullptr;
+	t_workerIndex = INVALID_WORKER_INDEX;
+}
+
+auto scheduler::_io_loop() -> void
+{
+	while (true)
+	{
+		if (job* j = m_ioQueue.pop(); j != nullptr)
+		{
+			j->execute(j);
+			continue;
+		}
+
+		std::unique_lock lock{ m_sleepMutex };
+
+		m_ioWake.wait(lock, [this]() -> bool { return m_stop || m_ioQueue.size.load(std::memory_order_acquire) != 0; });
+
+		if (m_stop && m_ioQueue.size.load(std::memory_order_acquire) == 0)
+		{
+			break;
+		}
+	}
+}
+
+auto scheduler::_find_job(uint32 index) -> job*
+{
+	if (job* j = m_highQueue.pop(); j != nullptr)
+	{
+		return j;
+	}
+
+	// Newest first, it is the most likely to still be in cache.
+	if (std::optional<job*> j = m_deques[index].pop(); j.has_value())
+	{
+		return *j;
+	}
+
+	if (job* j = m_normalQueue.pop(); j != nullptr)
+	{
+		return j;
+	}
+
+	// Oldest first, it is the furthest away from what the victim is working on.
+	for (uint32 i = 1; i < m_workerCount; ++i)
+	{
+		if (std::optional<job*> j = m_deques[(index + i) % m_workerCount].steal(); j.has_value())
+		{
+			return *j;
+		}
+	}
+
+	return nullptr;
+}
+
+auto scheduler::_wake_one() -> void
+{
+	// Pairs with the announcement in _worker_loop(), either the worker sees the job or this sees the worker.
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	if (m_sleepers.load(std::memory_order_seq_cst) == 0)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard lock{ m_sleepMutex };
+		m_epoch.fetch_add(1, std::memory_order_seq_cst);
+	}
+	m_wake.notify_one();
+}
+
+auto scheduler::_wants_more_jobs() const -> bool
+{
+	// Threads outside of the scheduler hand out everything they can, they never steal work back.
+	if (t_scheduler != this)
+	{
+		return true;
+	}
+
+	return m_deques[t_workerIndex].empty() || m_sleepers.load(std::memory_order_relaxed) != 0;
+}
+}
+}
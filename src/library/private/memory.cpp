@@ -1,3 +1,4 @@
+#include <atomic>
 #include <cstdlib>
 #include <cstring>
 #include "lib/memory.hpp"
@@ -99,9 +100,23 @@ auto default_memory_resource::do_is_equal(memory_resource const& other) -> bool
 	return this == std::addressof(other);
 }
 
-auto get_default_resource() noexcept -> memory_resource*
+static auto system_resource() noexcept -> memory_resource*
 {
 	static default_memory_resource _default = {};
 	return &_default;
 }
+
+static std::atomic<memory_resource*> g_defaultResource = nullptr;
+
+auto get_default_resource() noexcept -> memory_resource*
+{
+	memory_resource* resource = g_defaultResource.load(std::memory_order_acquire);
+	return (resource != nullptr) ? resource : system_resource();
+}
+
+auto set_default_resource(memory_resource* resource) noexcept -> memory_resource*
+{
+	memory_resource* previous = g_defaultResource.exchange(resource, std::memory_order_acq_rel);
+	return (previous != nullptr) ? previous : system_resource();
+}
 }
\ No newline at end of file
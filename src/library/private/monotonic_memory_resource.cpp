@@ -0,0 +1,252 @@
+#include "lib/monotonic_memory_resource.hpp"
+#include "virtual_memory.hpp"
+
+namespace lib
+{
+/**
+* Lives at the start of every block. A reservation is a single block that is never followed by another.
+*/
+struct alignas(std::max_align_t) monotonic_memory_resource::block
+{
+	block* next;
+	size_t size;	// Including this header.
+
+	auto begin() -> std::byte* { return reinterpret_cast<std::byte*>(this) + sizeof(block); }
+	auto end() -> std::byte* { return reinterpret_cast<std::byte*>(this) + size; }
+};
+
+static constexpr size_t MAX_BLOCK_SIZE = 64_MiB;
+static constexpr size_t COMMIT_GRANULARITY = 64_KiB;
+
+static auto align_up(std::byte* pointer, size_t alignment) -> std::byte*
+{
+	return reinterpret_cast<std::byte*>((reinterpret_cast<uintptr_t>(pointer) + alignment - 1) & ~(alignment - 1));
+}
+
+monotonic_memory_resource::monotonic_memory_resource(size_t initialBlockSize, memory_resource* upstream) :
+	m_upstream{ upstream },
+	m_head{},
+	m_current{},
+	m_cursor{},
+	m_end{},
+	m_committed{},
+	m_reservationSize{},
+	m_nextBlockSize{ std::max(initialBlockSize, sizeof(block) * 2) }
+{}
+
+monotonic_memory_resource::monotonic_memory_resource(virtual_reservation reservation) :
+	m_upstream{ get_default_resource() },
+	m_head{},
+	m_current{},
+	m_cursor{},
+	m_end{},
+	m_committed{},
+	m_reservationSize{},
+	m_nextBlockSize{ default_block_size_v }	// Falls back to chained blocks if the reservation fails.
+{
+	size_t const pageSize = virtual_memory::page_size();
+	size_t const size = (std::max(reservation.size, pageSize) + pageSize - 1) & ~(pageSize - 1);
+
+	void* memory = virtual_memory::reserve(size);
+
+	if (memory == nullptr || !virtual_memory::commit(memory, pageSize))
+	{
+		ASSERTION(false, "Failed to reserve address space for the arena.");
+		virtual_memory::release(memory, size);
+		return;
+	}
+
+	m_head = new (memory) block{ .next = nullptr, .size = size };
+	m_committed = static_cast<std::byte*>(memory) + pageSize;
+	m_reservationSize = size;
+
+	_use_block(m_head);
+}
+
+monotonic_memory_resource::~monotonic_memory_resource()
+{
+	if (m_committed != nullptr)
+	{
+		virtual_memory::release(m_head, m_reservationSize);
+		return;
+	}
+
+	for (block* b = m_head; b != nullptr;)
+	{
+		block* next = b->next;
+		m_upstream->deallocate(b, b->size, alignof(block));
+		b = next;
+	}
+}
+
+auto monotonic_memory_resource::rewind(marker const& marker) -> void
+{
+	if (marker.block == nullptr)
+	{
+		reset();
+		return;
+	}
+
+	m_current = static_cast<block*>(marker.block);
+	m_cursor = marker.cursor;
+	m_end = m_current->end();
+}
+
+auto monotonic_memory_resource::reset() -> void
+{
+	if (m_head != nullptr)
+	{
+		_use_block(m_head);
+	}
+}
+
+auto monotonic_memory_resource::release() -> void
+{
+	if (m_committed != nullptr)
+	{
+		// Keep the page holding the header.
+		std::byte* const firstPage = reinterpret_cast<std::byte*>(m_head) + virtual_memory::page_size();
+
+		if (m_committed > firstPage)
+		{
+			virtual_memory::decommit(firstPage, static_cast<size_t>(m_committed - firstPage));
+			m_committed = firstPage;
+		}
+
+		_use_block(m_head);
+		return;
+	}
+
+	for (block* b = m_head; b != nullptr;)
+	{
+		block* next = b->next;
+		m_upstream->deallocate(b, b->size, alignof(block));
+		b = next;
+	}
+
+	m_head = m_current = nullptr;
+	m_cursor = m_end = nullptr;
+}
+
+auto monotonic_memory_resource::do_allocate(size_t size, size_t alignment) -> void*
+{
+	std::byte* pointer = align_up(m_cursor, alignment);
+
+	if (m_cursor != nullptr &&
+		pointer + size <= m_end)
+	{
+		if (m_committed != nullptr &&
+			pointer + size > m_committed &&
+			!_commit_until(pointer + size))
+		{
+			return nullptr;
+		}
+
+		m_cursor = pointer + size;
+		return pointer;
+	}
+
+	return _allocate_from_next_block(size, alignment);
+}
+
+auto monotonic_memory_resource::do_deallocate([[maybe_unused]] void* p, [[maybe_unused]] size_t bytes, [[maybe_unused]] size_t alignment) -> void
+{}
+
+auto monotonic_memory_resource::do_is_equal(memory_resource const& other) -> bool
+{
+	return this == std::addressof(other);
+}
+
+auto monotonic_memory_resource::_allocate_from_next_block(size_t size, size_t alignment) -> void*
+{
+	// A reservation can not grow.
+	if (m_committed != nullptr)
+	{
+		ASSERTION(false, "Allocation exceeded the arena's reservation.");
+		return nullptr;
+	}
+
+	// Reuse the blocks kept from before the last reset first.
+	block* tail = m_current;
+
+	for (block* b = (m_current != nullptr) ? m_current->next : m_head; b != nullptr; b = b->next)
+	{
+		tail = b;
+
+		if (align_up(b->begin(), alignment) + size <= b->end())
+		{
+			_use_block(b);
+
+			std::byte* pointer = align_up(m_cursor, alignment);
+			m_cursor = pointer + size;
+
+			return pointer;
+		}
+	}
+
+	size_t const required = sizeof(block) + size + alignment;
+	size_t const blockSize = std::max(m_nextBlockSize, required);
+
+	void* memory = m_upstream->allocate(blockSize, alignof(block));
+
+	if (memory == nullptr)
+	{
+		return nullptr;
+	}
+
+	m_nextBlockSize = std::min(m_nextBlockSize * 2, MAX_BLOCK_SIZE);
+
+	block* b = new (memory) block{ .next = nullptr, .size = blockSize };
+
+	if (tail != nullptr)
+	{
+		// Blocks skipped over above stay in the chain.
+		b->next = tail->next;
+		tail->next = b;
+	}
+	else
+	{
+		m_head = b;
+	}
+
+	_use_block(b);
+
+	std::byte* pointer = align_up(m_cursor, alignment);
+	m_cursor = pointer + size;
+
+	return pointer;
+}
+
+auto monotonic_memory_resource::_commit_until(std::byte* end) -> bool
+{
+	std::byte* const limit = m_head->end();
+	std::byte* target = align_up(end, COMMIT_GRANULARITY);
+
+	if (target > limit)
+	{
+		target = limit;
+	}
+
+	if (!virtual_memory::commit(m_committed, static_cast<size_t>(target - m_committed)))
+	{
+		return false;
+	}
+
+	m_committed = target;
+
+	return true;
+}
+
+auto monotonic_memory_resource::_use_block(block* b) -> void
+{
+	m_current = b;
+	m_cursor = b->begin();
+	m_end = b->end();
+}
+
+auto thread_frame_arena() -> monotonic_memory_resource&
+{
+	thread_local monotonic_memory_resource arena{ 256_KiB };
+	return arena;
+}
+}
@@ -0,0 +1,505 @@
+#include <array>
+#include "lib/slab_memory_resource.hpp"
+#include "virtual_memory.hpp"
+
+namespace lib
+{
+/**
+* Lives at the start of every slab. The blocks follow the header, the first one starting at the header size rounded up to the block size.
+*/
+struct slab_memory_resource::slab
+{
+	heap* owner;
+	slab* previous;
+	slab* next;
+	void* localFree;					// Only touched by the owning thread.
+	std::atomic<void*> remoteFree;		// Pushed onto by other threads, drained by the owning thread.
+	std::byte* blocks;
+	uint32 blockSize;
+	uint32 capacity;
+	uint32 bumped;						// Blocks handed out at least once. Blocks past it have never been touched.
+	uint32 used;
+	uint32 sizeClass;
+	bool full;
+};
+
+/**
+* Slabs that belong to a single thread. Shared between the resource and the thread that uses it, whichever lets go last deletes it.
+*/
+struct slab_memory_resource::heap
+{
+	struct slab_list
+	{
+		slab* head;
+		uint32 count;
+	};
+
+	struct size_class
+	{
+		slab_list partial;	// Slabs that can still hand out blocks.
+		slab_list full;
+	};
+
+	uint64 resourceId;
+	std::atomic_uint32_t refCount;
+	std::atomic_bool abandoned;
+	heap* next;			// Next heap of the resource, guarded by m_heapMutex.
+	heap* threadNext;	// Next heap of the thread.
+	std::array<size_class, size_class_count_v> classes;
+};
+
+/**
+* Heaps the calling thread allocates from, one per resource it has used.
+*/
+struct slab_memory_resource::thread_cache
+{
+	heap* head = nullptr;
+	heap* last = nullptr;
+
+	~thread_cache()
+	{
+		for (heap* h = head; h != nullptr;)
+		{
+			heap* next = h->threadNext;
+
+			// Lets the resource hand the heap to another thread. The resource is gone if this was the last reference.
+			h->abandoned.store(true, std::memory_order_release);
+
+			if (h->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				delete h;
+			}
+			h = next;
+		}
+
+		head = last = nullptr;
+	}
+};
+
+static std::atomic_uint64_t g_slabResourceId = 1;
+
+namespace
+{
+template <typename slab_type, typename list_type>
+auto link_slab(list_type& list, slab_type& s) -> void
+{
+	s.previous = nullptr;
+	s.next = list.head;
+
+	if (list.head != nullptr)
+	{
+		list.head->previous = &s;
+	}
+	list.head = &s;
+	++list.count;
+}
+
+template <typename slab_type, typename list_type>
+auto unlink_slab(list_type& list, slab_type& s) -> void
+{
+	if (s.previous != nullptr)
+	{
+		s.previous->next = s.next;
+	}
+	else
+	{
+		list.head = s.next;
+	}
+
+	if (s.next != nullptr)
+	{
+		s.next->previous = s.previous;
+	}
+
+	s.previous = s.next = nullptr;
+	--list.count;
+}
+
+/**
+* Moves the blocks freed by other threads onto the owner's free list.
+*/
+template <typename slab_type>
+auto collect_remote_frees(slab_type& s) -> bool
+{
+	if (s.remoteFree.load(std::memory_order_relaxed) == nullptr)
+	{
+		return false;
+	}
+
+	void* list = s.remoteFree.exchange(nullptr, std::memory_order_acquire);
+
+	if (list == nullptr)
+	{
+		return false;
+	}
+
+	void* tail = list;
+	uint32 count = 1;
+
+	for (void* next = *static_cast<void**>(tail); next != nullptr; next = *static_cast<void**>(tail))
+	{
+		tail = next;
+		++count;
+	}
+
+	*static_cast<void**>(tail) = s.localFree;
+	s.localFree = list;
+	s.used -= count;
+
+	return true;
+}
+
+template <typename slab_type>
+auto pop_block(slab_type& s) -> void*
+{
+	void* block = s.localFree;
+
+	if (block == nullptr && collect_remote_frees(s))
+	{
+		block = s.localFree;
+	}
+
+	if (block != nullptr)
+	{
+		s.localFree = *static_cast<void**>(block);
+	}
+	else if (s.bumped < s.capacity)
+	{
+		block = s.blocks + static_cast<size_t>(s.bumped++) * s.blockSize;
+	}
+	else
+	{
+		return nullptr;
+	}
+
+	++s.used;
+
+	return block;
+}
+}
+
+slab_memory_resource::slab_memory_resource(memory_resource* upstream) :
+	m_upstream{ upstream },
+	m_id{ g_slabResourceId.fetch_add(1, std::memory_order_relaxed) },
+	m_heapMutex{},
+	m_heaps{},
+	m_slabCount{ 0 }
+{}
+
+slab_memory_resource::~slab_memory_resource()
+{
+	std::lock_guard lock{ m_heapMutex };
+
+	for (heap* h = m_heaps; h != nullptr;)
+	{
+		heap* next = h->next;
+
+		for (heap::size_class& sizeClass : h->classes)
+		{
+			for (heap::slab_list* list : { &sizeClass.partial, &sizeClass.full })
+			{
+				while (list->head != nullptr)
+				{
+					slab* s = list->head;
+					unlink_slab(*list, *s);
+					virtual_memory::release(s, slab_size_v);
+				}
+			}
+		}
+
+		// A thread that still holds on to the heap deletes it when it exits.
+		if (h->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			delete h;
+		}
+		h = next;
+	}
+
+	m_heaps = nullptr;
+	m_slabCount.store(0, std::memory_order_relaxed);
+}
+
+auto slab_memory_resource::trim() -> void
+{
+	heap* owner = _local_heap(false);
+
+	if (owner == nullptr)
+	{
+		return;
+	}
+
+	for (heap::size_class& sizeClass : owner->classes)
+	{
+		for (slab* s = sizeClass.full.head; s != nullptr;)
+		{
+			slab* next = s->next;
+
+			if (collect_remote_frees(*s))
+			{
+				unlink_slab(sizeClass.full, *s);
+				link_slab(sizeClass.partial, *s);
+				s->full = false;
+			}
+			s = next;
+		}
+
+		for (slab* s = sizeClass.partial.head; s != nullptr;)
+		{
+			slab* next = s->next;
+
+			collect_remote_frees(*s);
+
+			if (s->used == 0)
+			{
+				_release_slab(*owner, *s);
+			}
+			s = next;
+		}
+	}
+}
+
+auto slab_memory_resource::do_allocate(size_t size, size_t alignment) -> void*
+{
+	size_t const sizeClass = size_class_of(size, alignment);
+
+	if (sizeClass == size_class_count_v)
+	{
+		return m_upstream->allocate(size, alignment);
+	}
+
+	heap* owner = _local_heap(true);
+
+	if (owner == nullptr)
+	{
+		return m_upstream->allocate(size, alignment);
+	}
+
+	return _allocate_block(*owner, sizeClass);
+}
+
+auto slab_memory_resource::do_deallocate(void* p, size_t bytes, size_t alignment) -> void
+{
+	if (p == nullptr)
+	{
+		return;
+	}
+
+	if (size_class_of(bytes, alignment) == size_class_count_v)
+	{
+		m_upstream->deallocate(p, bytes, alignment);
+		return;
+	}
+
+	slab* s = reinterpret_cast<slab*>(reinterpret_cast<uintptr_t>(p) & ~(slab_size_v - 1));
+
+	ASSERTION(s->blockSize >= bytes, "Block was not allocated with the same size and alignment it is being freed with.");
+
+	if (heap* owner = _local_heap(false); owner == s->owner)
+	{
+		_free_block(*owner, *s, p);
+		return;
+	}
+
+	// Freed by a thread that does not own the slab. The owner picks the block up later.
+	void* head = s->remoteFree.load(std::memory_order_relaxed);
+
+	do
+	{
+		*static_cast<void**>(p) = head;
+	} while (!s->remoteFree.compare_exchange_weak(head, p, std::memory_order_release, std::memory_order_relaxed));
+}
+
+auto slab_memory_resource::do_is_equal(memory_resource const& other) -> bool
+{
+	return this == std::addressof(other);
+}
+
+auto slab_memory_resource::_thread_cache() -> thread_cache&
+{
+	thread_local thread_cache cache;
+	return cache;
+}
+
+auto slab_memory_resource::_local_heap(bool create) -> heap*
+{
+	thread_cache& cache = _thread_cache();
+
+	// Resources are told apart by id rather than by address, a new resource may be constructed where a destroyed one used to be.
+	if (cache.last != nullptr && cache.last->resourceId == m_id)
+	{
+		return cache.last;
+	}
+
+	for (heap* h = cache.head; h != nullptr; h = h->threadNext)
+	{
+		if (h->resourceId == m_id)
+		{
+			cache.last = h;
+			return h;
+		}
+	}
+
+	if (!create)
+	{
+		return nullptr;
+	}
+
+	heap* h = _acquire_heap();
+
+	if (h != nullptr)
+	{
+		h->threadNext = cache.head;
+		cache.head = h;
+		cache.last = h;
+	}
+
+	return h;
+}
+
+auto slab_memory_resource::_acquire_heap() -> heap*
+{
+	std::lock_guard lock{ m_heapMutex };
+
+	// Adopt the slabs of a thread that has exited before starting a new heap.
+	for (heap* h = m_heaps; h != nullptr; h = h->next)
+	{
+		bool abandoned = true;
+
+		if (h->abandoned.compare_exchange_strong(abandoned, false, std::memory_order_acq_rel, std::memory_order_relaxed))
+		{
+			h->refCount.fetch_add(1, std::memory_order_relaxed);
+			h->threadNext = nullptr;
+			return h;
+		}
+	}
+
+	heap* h = new (std::nothrow) heap{
+		.resourceId = m_id,
+		.refCount = 2,
+		.abandoned = false,
+		.next = m_heaps,
+		.threadNext = nullptr,
+		.classes = {}
+	};
+
+	if (h != nullptr)
+	{
+		m_heaps = h;
+	}
+
+	return h;
+}
+
+auto slab_memory_resource::_allocate_block(heap& owner, size_t sizeClass) -> void*
+{
+	heap::size_class& lists = owner.classes[sizeClass];
+
+	while (slab* s = lists.partial.head)
+	{
+		if (void* block = pop_block(*s); block != nullptr)
+		{
+			return block;
+		}
+
+		unlink_slab(lists.partial, *s);
+		link_slab(lists.full, *s);
+		s->full = true;
+	}
+
+	// Before asking the OS for more, see if other threads have given blocks back to the full slabs.
+	for (slab* s = lists.full.head; s != nullptr;)
+	{
+		slab* next = s->next;
+
+		if (collect_remote_frees(*s))
+		{
+			unlink_slab(lists.full, *s);
+			link_slab(lists.partial, *s);
+			s->full = false;
+		}
+		s = next;
+	}
+
+	slab* s = lists.partial.head;
+
+	if (s == nullptr)
+	{
+		s = _new_slab(owner, sizeClass);
+	}
+
+	return (s != nullptr) ? pop_block(*s) : nullptr;
+}
+
+auto slab_memory_resource::_free_block(heap& owner, slab& s, void* p) -> void
+{
+	*static_cast<void**>(p) = s.localFree;
+	s.localFree = p;
+	--s.used;
+
+	heap::size_class& lists = owner.classes[s.sizeClass];
+
+	if (s.full)
+	{
+		unlink_slab(lists.full, s);
+		link_slab(lists.partial, s);
+		s.full = false;
+	}
+
+	// Keep a single slab around so that a size class that keeps emptying and refilling does not go back and forth with the OS.
+	if (s.used == 0 && lists.partial.count > 1)
+	{
+		_release_slab(owner, s);
+	}
+}
+
+auto slab_memory_resource::_new_slab(heap& owner, size_t sizeClass) -> slab*
+{
+	void* memory = virtual_memory::reserve(slab_size_v, slab_size_v);
+
+	if (memory == nullptr)
+	{
+		return nullptr;
+	}
+
+	if (!virtual_memory::commit(memory, slab_size_v))
+	{
+		virtual_memory::release(memory, slab_size_v);
+		return nullptr;
+	}
+
+	size_t const blockSize = min_block_size_v << sizeClass;
+	size_t const offset = (sizeof(slab) + blockSize - 1) & ~(blockSize - 1);
+
+	slab* s = new (memory) slab{
+		.owner = &owner,
+		.previous = nullptr,
+		.next = nullptr,
+		.localFree = nullptr,
+		.remoteFree = nullptr,
+		.blocks = static_cast<std::byte*>(memory) + offset,
+		.blockSize = static_cast<uint32>(blockSize),
+		.capacity = static_cast<uint32>((slab_size_v - offset) / blockSize),
+		.bumped = 0,
+		.used = 0,
+		.sizeClass = static_cast<uint32>(sizeClass),
+		.full = false
+	};
+
+	link_slab(owner.classes[sizeClass].partial, *s);
+	m_slabCount.fetch_add(1, std::memory_order_relaxed);
+
+	return s;
+}
+
+auto slab_memory_resource::_release_slab(heap& owner, slab& s) -> void
+{
+	ASSERTION(s.used == 0 && !s.full);
+
+	unlink_slab(owner.classes[s.sizeClass].partial, s);
+
+	s.~slab();
+	virtual_memory::release(&s, slab_size_v);
+
+	m_slabCount.fetch_sub(1, std::memory_order_relaxed);
+}
+}
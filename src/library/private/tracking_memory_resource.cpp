@@ -0,0 +1,275 @@
+#include <cstring>
+#include "lib/tracking_memory_resource.hpp"
+
+namespace lib
+{
+/**
+* Intrusive list of every live tracking resource.
+*/
+struct tracking_memory_resource::registry
+{
+	std::mutex mutex;
+	tracking_memory_resource* head = nullptr;
+	tracking_memory_resource* tail = nullptr;
+
+	static auto get() -> registry&
+	{
+		static registry instance;
+		return instance;
+	}
+};
+
+static thread_local tracking_memory_resource::call_site* t_currentCallSite = nullptr;
+
+tracking_memory_resource::call_site::call_site(std::source_location location) :
+	m_location{ location },
+	m_previous{ t_currentCallSite }
+{
+	t_currentCallSite = this;
+}
+
+tracking_memory_resource::call_site::~call_site()
+{
+	t_currentCallSite = m_previous;
+}
+
+tracking_memory_resource::tracking_memory_resource(literal_t tag, memory_resource* upstream, uint32 sampleRate) :
+	m_upstream{ upstream },
+	m_tag{ tag },
+	m_liveBytes{},
+	m_peakBytes{},
+	m_totalBytes{},
+	m_liveAllocations{},
+	m_totalAllocations{},
+	m_sampleRate{ sampleRate },
+	m_sampleCounter{},
+	m_histogram{},
+	m_callSiteMutex{},
+	m_callSites{},
+	m_callSiteCount{},
+	m_next{},
+	m_previous{}
+{
+	registry& r = registry::get();
+	std::lock_guard lock{ r.mutex };
+
+	m_previous = r.tail;
+
+	if (r.tail != nullptr)
+	{
+		r.tail->m_next = this;
+	}
+	else
+	{
+		r.head = this;
+	}
+	r.tail = this;
+}
+
+tracking_memory_resource::~tracking_memory_resource()
+{
+	registry& r = registry::get();
+	std::lock_guard lock{ r.mutex };
+
+	(m_previous != nullptr ? m_previous->m_next : r.head) = m_next;
+	(m_next != nullptr ? m_next->m_previous : r.tail) = m_previous;
+}
+
+auto tracking_memory_resource::record_allocation(size_t size) -> void
+{
+	_on_allocate(size);
+}
+
+auto tracking_memory_resource::record_deallocation(size_t size) -> void
+{
+	_on_deallocate(size);
+}
+
+auto tracking_memory_resource::snapshot() const -> statistics
+{
+	statistics result{
+		.liveBytes			= m_liveBytes.load(std::memory_order_relaxed),
+		.peakBytes			= m_peakBytes.load(std::memory_order_relaxed),
+		.totalBytes			= m_totalBytes.load(std::memory_order_relaxed),
+		.liveAllocations	= m_liveAllocations.load(std::memory_order_relaxed),
+		.totalAllocations	= m_totalAllocations.load(std::memory_order_relaxed),
+		.histogram			= {}
+	};
+
+	for (size_t i = 0; i < histogram_bucket_count_v; ++i)
+	{
+		result.histogram[i] = m_histogram[i].load(std::memory_order_relaxed);
+	}
+
+	return result;
+}
+
+auto tracking_memory_resource::call_sites(std::span<call_site_statistics> out) const -> size_t
+{
+	size_t count = 0;
+
+	{
+		std::lock_guard lock{ m_callSiteMutex };
+
+		count = std::min(out.size(), m_callSiteCount);
+
+		std::partial_sort_copy(
+			m_callSites.begin(), m_callSites.begin() + m_callSiteCount,
+			out.begin(), out.begin() + count,
+			[](call_site_statistics const& a, call_site_statistics const& b) { return a.sampledBytes > b.sampledBytes; }
+		);
+	}
+
+	return count;
+}
+
+auto tracking_memory_resource::reset_peak() -> void
+{
+	m_peakBytes.store(m_liveBytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+auto tracking_memory_resource::dump(string& out) const -> void
+{
+	statistics const stats = snapshot();
+
+	out.append("[{}] live: {} bytes in {} allocations, peak: {} bytes, total: {} bytes in {} allocations\n",
+		m_tag, stats.liveBytes, stats.liveAllocations, stats.peakBytes, stats.totalBytes, stats.totalAllocations
+	);
+
+	if constexpr (detailed_v)
+	{
+		for (size_t i = 0; i < histogram_bucket_count_v; ++i)
+		{
+			if (stats.histogram[i] == 0)
+			{
+				continue;
+			}
+
+			if (i + 1 < histogram_bucket_count_v)
+			{
+				out.append("\t<= {} bytes: {}\n", size_t{ 16 } << i, stats.histogram[i]);
+			}
+			else
+			{
+				out.append("\t>  {} bytes: {}\n", size_t{ 16 } << (i - 1), stats.histogram[i]);
+			}
+		}
+
+		std::array<call_site_statistics, max_call_sites_v> sites;
+		size_t const siteCount = call_sites(sites);
+		uint32 const sampleRate = std::max(sample_rate(), 1u);
+
+		for (size_t i = 0; i < siteCount; ++i)
+		{
+			call_site_statistics const& site = sites[i];
+
+			out.append("\t{}:{} {}: ~{} bytes in ~{} allocations\n",
+				site.location.file_name(), site.location.line(), site.location.function_name(),
+				site.sampledBytes * sampleRate, site.sampledAllocations * sampleRate
+			);
+		}
+	}
+}
+
+auto tracking_memory_resource::dump_all(string& out) -> void
+{
+	registry& r = registry::get();
+	std::lock_guard lock{ r.mutex };
+
+	for (tracking_memory_resource* resource = r.head; resource != nullptr; resource = resource->m_next)
+	{
+		resource->dump(out);
+	}
+}
+
+auto tracking_memory_resource::do_allocate(size_t size, size_t alignment) -> void*
+{
+	void* p = m_upstream->allocate(size, alignment);
+
+	if (p != nullptr)
+	{
+		_on_allocate(size);
+	}
+
+	return p;
+}
+
+auto tracking_memory_resource::do_deallocate(void* p, size_t bytes, size_t alignment) -> void
+{
+	if (p == nullptr)
+	{
+		return;
+	}
+
+	m_upstream->deallocate(p, bytes, alignment);
+	_on_deallocate(bytes);
+}
+
+auto tracking_memory_resource::do_is_equal(memory_resource const& other) -> bool
+{
+	return this == std::addressof(other);
+}
+
+auto tracking_memory_resource::_on_allocate(size_t size) -> void
+{
+	size_t const live = m_liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+	size_t peak = m_peakBytes.load(std::memory_order_relaxed);
+
+	while (live > peak && !m_peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed));
+
+	m_totalBytes.fetch_add(size, std::memory_order_relaxed);
+	m_liveAllocations.fetch_add(1, std::memory_order_relaxed);
+	m_totalAllocations.fetch_add(1, std::memory_order_relaxed);
+
+	if constexpr (detailed_v)
+	{
+		m_histogram[histogram_bucket_of(size)].fetch_add(1, std::memory_order_relaxed);
+
+		if (t_currentCallSite != nullptr)
+		{
+			_sample_call_site(size);
+		}
+	}
+}
+
+auto tracking_memory_resource::_on_deallocate(size_t size) -> void
+{
+	m_liveBytes.fetch_sub(size, std::memory_order_relaxed);
+	m_liveAllocations.fetch_sub(1, std::memory_order_relaxed);
+}
+
+auto tracking_memory_resource::_sample_call_site(size_t size) -> void
+{
+	uint32 const sampleRate = m_sampleRate.load(std::memory_order_relaxed);
+
+	if (sampleRate == 0 ||
+		m_sampleCounter.fetch_add(1, std::memory_order_relaxed) % sampleRate != 0)
+	{
+		return;
+	}
+
+	std::source_location const& location = t_currentCallSite->m_location;
+
+	std::lock_guard lock{ m_callSiteMutex };
+
+	for (size_t i = 0; i < m_callSiteCount; ++i)
+	{
+		call_site_statistics& site = m_callSites[i];
+
+		if (site.location.line() == location.line() &&
+			site.location.column() == location.column() &&
+			std::strcmp(site.location.file_name(), location.file_name()) == 0)
+		{
+			++site.sampledAllocations;
+			site.sampledBytes += size;
+			return;
+		}
+	}
+
+	// Sites past the limit are dropped, the totals still account for them.
+	if (m_callSiteCount < max_call_sites_v)
+	{
+		m_callSites[m_callSiteCount++] = call_site_statistics{ .location = location, .sampledAllocations = 1, .sampledBytes = size };
+	}
+}
+}
@@ -0,0 +1,138 @@
+#include "virtual_memory.hpp"
+
+#ifdef _WIN64
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace lib::virtual_memory
+{
+auto page_size() -> size_t
+{
+#ifdef _WIN64
+	static size_t const size = []() -> size_t
+	{
+		SYSTEM_INFO info = {};
+		GetSystemInfo(&info);
+		return static_cast<size_t>(info.dwPageSize);
+	}();
+#else
+	static size_t const size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+	return size;
+}
+
+#ifdef _WIN64
+static auto allocation_granularity() -> size_t
+{
+	static size_t const granularity = []() -> size_t
+	{
+		SYSTEM_INFO info = {};
+		GetSystemInfo(&info);
+		return static_cast<size_t>(info.dwAllocationGranularity);
+	}();
+	return granularity;
+}
+#endif
+
+auto reserve(size_t size, size_t alignment) -> void*
+{
+	ASSERTION(alignment == 0 || (alignment & (alignment - 1)) == 0, "Alignment needs to be a power of 2!");
+
+#ifdef _WIN64
+	if (alignment <= allocation_granularity())
+	{
+		return VirtualAlloc(nullptr, size, MEM_RESERVE, PAGE_NOACCESS);
+	}
+
+	// Windows can not release part of a reservation. Find an aligned address in an oversized reservation and try to claim it, another thread may get there first.
+	for (uint32 attempt = 0; attempt < 8; ++attempt)
+	{
+		void* probe = VirtualAlloc(nullptr, size + alignment, MEM_RESERVE, PAGE_NOACCESS);
+
+		if (probe == nullptr)
+		{
+			return nullptr;
+		}
+
+		uintptr_t const aligned = (reinterpret_cast<uintptr_t>(probe) + alignment - 1) & ~(alignment - 1);
+
+		VirtualFree(probe, 0, MEM_RELEASE);
+
+		if (void* pointer = VirtualAlloc(reinterpret_cast<void*>(aligned), size, MEM_RESERVE, PAGE_NOACCESS); pointer != nullptr)
+		{
+			return pointer;
+		}
+	}
+	return nullptr;
+#else
+	size_t const padding = (alignment > page_size()) ? alignment : 0;
+	void* probe = mmap(nullptr, size + padding, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+
+	if (probe == MAP_FAILED)
+	{
+		return nullptr;
+	}
+
+	if (padding == 0)
+	{
+		return probe;
+	}
+
+	// Trim the unaligned head and the tail of the oversized mapping.
+	uintptr_t const begin = reinterpret_cast<uintptr_t>(probe);
+	uintptr_t const aligned = (begin + alignment - 1) & ~(alignment - 1);
+	size_t const head = aligned - begin;
+	size_t const tail = padding - head;
+
+	if (head != 0)
+	{
+		munmap(probe, head);
+	}
+
+	if (tail != 0)
+	{
+		munmap(reinterpret_cast<void*>(aligned + size), tail);
+	}
+
+	return reinterpret_cast<void*>(aligned);
+#endif
+}
+
+auto commit(void* pointer, size_t size) -> bool
+{
+#ifdef _WIN64
+	return VirtualAlloc(pointer, size, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+#else
+	return mprotect(pointer, size, PROT_READ | PROT_WRITE) == 0;
+#endif
+}
+
+auto decommit(void* pointer, size_t size) -> void
+{
+#ifdef _WIN64
+	VirtualFree(pointer, size, MEM_DECOMMIT);
+#else
+	// Replacing the pages with a fresh inaccessible mapping drops their contents and keeps the range reserved.
+	mmap(pointer, size, PROT_NONE, MAP_FIXED | MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+#endif
+}
+
+auto release(void* pointer, [[maybe_unused]] size_t size) -> void
+{
+	if (pointer == nullptr)
+	{
+		return;
+	}
+
+#ifdef _WIN64
+	VirtualFree(pointer, 0, MEM_RELEASE);
+#else
+	munmap(pointer, size);
+#endif
+}
+}
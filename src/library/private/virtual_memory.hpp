@@ -0,0 +1,39 @@
+#pragma once
+#ifndef LIB_VIRTUAL_MEMORY_HPP
+#define LIB_VIRTUAL_MEMORY_HPP
+
+#include "lib/common.hpp"
+
+/**
+* Thin wrappers over the operating system's virtual memory API. Only meant to be used by the library's memory resources.
+*/
+namespace lib::virtual_memory
+{
+/**
+* @brief Size of a page. Commits and decommits happen at this granularity.
+*/
+auto page_size() -> size_t;
+
+/**
+* @brief Reserves address space without backing it with memory. Returns nullptr on failure.
+* @param alignment Power of two. Values below the allocation granularity of the OS are ignored.
+*/
+auto reserve(size_t size, size_t alignment = 0) -> void*;
+
+/**
+* @brief Backs reserved pages with zero-initialized memory.
+*/
+auto commit(void* pointer, size_t size) -> bool;
+
+/**
+* @brief Hands the pages back to the OS while keeping the address space reserved.
+*/
+auto decommit(void* pointer, size_t size) -> void;
+
+/**
+* @brief Releases address space obtained through reserve(). size must match what was reserved.
+*/
+auto release(void* pointer, size_t size) -> void;
+}
+
+#endif // !LIB_VIRTUAL_MEMORY_HPP
@@ -112,7 +112,7 @@ public:
 	{
 		array_const_iterator tmp = *this;
 		tmp -= offset;
-		return *tmp;
+		return tmp;
 	}
 
 	constexpr difference_type operator-(array_const_iterator const& it) const noexcept
@@ -310,7 +310,7 @@ public:
 	{
 		if (this != &other)
 		{
-			_destruct(0, m_len);
+			clear();
 			_deep_copy(other);
 		}
 		return *this;
@@ -355,12 +355,7 @@ public:
 
 	constexpr void reserve(size_t size)
 	{
-		if (size < m_capacity)
-		{
-			size_t const numDestroyed = _destruct(size - 1, m_capacity);
-			m_len -= numDestroyed;
-		}
-		else
+		if (size > m_capacity)
 		{
 			_grow(size);
 		}
@@ -370,8 +365,7 @@ public:
 	{
 		if (count < m_len)
 		{
-			size_t const numDestroyed = _destruct(count - 1, m_len - 1);
-			m_len -= numDestroyed;
+			m_len -= _destruct(count, m_len);
 		}
 		else if (count > m_capacity)
 		{
@@ -380,17 +374,19 @@ public:
 
 		for (size_t i = m_len; i < count; ++i)
 		{
-			emplace_back(value_type{});
+			emplace_back();
 		}
 	}
 
+	/**
+	* Every new element is constructed from the same arguments, so they are passed on as lvalues. Forwarding them would move from them more than once.
+	*/
 	template <typename... Args>
 	constexpr void resize(size_t count, Args&&... args)
 	{
 		if (count < m_len)
 		{
-			size_t const numDestroyed = _destruct(count - 1, m_len - 1);
-			m_len -= numDestroyed;
+			m_len -= _destruct(count, m_len);
 		}
 		else if (count >= m_capacity)
 		{
@@ -399,7 +395,7 @@ public:
 
 		for (size_t i = m_len; i < count; i++)
 		{
-			emplace_back(std::forward<Args>(args)...);
+			emplace_back(args...);
 		}
 	}
 
@@ -430,15 +426,16 @@ public:
 	{
 		ASSERTION(pos >= cbegin() && pos <= cend(), "Iterator is not within the range of the array.");
 
-		bool const insertAtEnd = pos == cend();
 		size_t const position = std::distance(cbegin(), pos);
 		size_t const count = 1;
+		// Built up front since the arguments may refer to elements that are about to be relocated.
+		value_type value{ std::forward<Args>(args)... };
 
 		_try_grow_for_insert(count);
 		// This is the position that we want to insert out value in.
-		iterator it = _prepare_for_insert(insertAtEnd, position, count);
+		iterator it = _prepare_for_insert(position, count);
 
-		return _emplace_at(it, count, std::forward<Args>(args)...);
+		return _emplace_at(it, count, std::move(value));
 	}
 
 	constexpr size_t push(value_type const& element)
@@ -489,45 +486,44 @@ public:
 	{
 		ASSERTION(pos >= cbegin() && pos <= cend(), "Iterator is not within the range of the array.");
 
-		bool const insertAtEnd = pos == cend();
 		size_t const position = std::distance(cbegin(), pos);
+		// The value may be an element of this array.
+		value_type const copy{ value };
 
 		_try_grow_for_insert(count);
 
-		iterator it = _prepare_for_insert(insertAtEnd, position, count);
+		iterator it = _prepare_for_insert(position, count);
 
-		return _emplace_at(it, count, value);
+		return _emplace_at(it, count, copy);
 	}
 
-	template <typename InputIterator>
+	template <std::input_iterator InputIterator>
 	constexpr iterator insert(const_iterator pos, InputIterator first, InputIterator last)
 	{
 		ASSERTION(pos >= cbegin() && pos <= cend(), "Iterator is not within the range of the array.");
 
-		bool const insertAtEnd = pos == cend();
 		size_t const position = std::distance(cbegin(), pos);
-		size_t const count = std::distance(first, last);
+		size_t const count = static_cast<size_t>(std::distance(first, last));
 
 		_try_grow_for_insert(count);
 
-		iterator it = _prepare_for_insert(insertAtEnd, position, count);
+		iterator it = _prepare_for_insert(position, count);
 
-		return _insert_at(it, count, &(*first));
+		return _insert_at(it, first, last);
 	}
 
 	constexpr iterator insert(const_iterator pos, std::initializer_list<value_type> list)
 	{
 		ASSERTION(pos >= cbegin() && pos <= cend(), "Iterator is not within the range of the array.");
 
-		bool const insertAtEnd = pos == cend();
 		size_t const position = std::distance(cbegin(), pos);
 		size_t const count = list.size();
 
 		_try_grow_for_insert(count);
 
-		iterator it = _prepare_for_insert(insertAtEnd, position, count);
+		iterator it = _prepare_for_insert(position, count);
 
-		return _insert_at(it, count, list.begin());
+		return _insert_at(it, list.begin(), list.end());
 	}
 
 	constexpr size_t append(std::initializer_list<value_type> list)
@@ -598,11 +594,9 @@ public:
 	{
 		// The element should reside within the container's length.
 		ASSERTION(index < m_len);
-		// count here means the number of elements to shift forward to close the gap.
-		size_t const count = m_len - index;
-
 		_destruct(index, index + 1);
-		_shift_forward(&m_box.data[index + 1], &m_box.data[index], count);
+		// Close the gap left behind by the element.
+		relocate(m_box.data + index + 1, m_box.data + index, m_len - index - 1);
 
 		--m_len;
 	}
@@ -619,11 +613,10 @@ public:
 		ASSERTION(pos >= cbegin() && pos <= cend() && "Iterator is not within the range of the array.");
 
 		size_t const index = std::distance(cbegin(), pos);
-		// count here means the number of elements to shift forward to close the gap.
-		size_t const count = m_len - index;
 
 		_destruct(index, index + 1);
-		_shift_forward(&m_box.data[index + 1], &m_box.data[index], count);
+		// Close the gap left behind by the element.
+		relocate(m_box.data + index + 1, m_box.data + index, m_len - index - 1);
 
 		--m_len;
 
@@ -634,10 +627,9 @@ public:
 	{
 		size_t const from = std::distance(cbegin(), begin);
 		size_t const to = std::distance(cbegin(), end);
-		size_t const count = m_len - to;
 
 		_destruct(from, to);
-		_shift_forward(&m_box.data[to], &m_box.data[to + 1], count);
+		relocate(m_box.data + to, m_box.data + from, m_len - to);
 
 		m_len -= (to - from);
 
@@ -683,6 +675,8 @@ public:
 
 	constexpr size_t    size_bytes() const { return bytes(); }
 
+	constexpr allocator_type get_allocator() const { return static_cast<allocator_type const&>(m_box); }
+
 	constexpr reference front   () { return *data(); }
 	constexpr reference back    () { return *(data() + (m_len - 1)); }
 
@@ -718,17 +712,7 @@ private:
 
 		if (m_len)
 		{
-			if constexpr (std::is_standard_layout_v<value_type> && std::is_trivially_move_assignable_v<value_type>)
-			{
-				std::memcpy(temp, m_box.data, m_len * sizeof(value_type));
-			}
-			else
-			{
-				for (size_t i = 0; i < m_len; ++i)
-				{
-					new (temp + i) value_type{ std::move(m_box.data[i]) };
-				}
-			}
+			relocate(m_box.data, temp, m_len);
 		}
 
 		if (m_box.data)
@@ -755,45 +739,6 @@ private:
 		return m_box.data[pos];
 	}
 
-	constexpr void _shift_forward(pointer src, pointer dst, size_t count)
-	{
-		while (count)
-		{
-			if constexpr (std::is_move_assignable_v<value_type>)
-			{
-				*dst = std::move(*src);
-			}
-			else
-			{
-				new (dst) value_type{ std::move(*src) };
-			}
-			++dst;
-			++src;
-			--count;
-		}
-	}
-
-	constexpr void _shift_backwards(pointer src, pointer dst, size_t count)
-	{
-		dst = dst + count - 1;
-		src = src + count - 1;
-
-		while (count)
-		{
-			if constexpr (std::is_move_assignable_v<value_type>)
-			{
-				*dst = std::move(*src);
-			}
-			else
-			{
-				new (dst) value_type{ std::move(*src) };
-			}
-			--dst;
-			--src;
-			--count;
-		}
-	}
-
 	constexpr void _try_grow_for_insert(size_t count)
 	{
 		if (count > (m_capacity - m_len))
@@ -805,39 +750,26 @@ private:
 	/**
 	* \brief "count" is the number of elements being inserted into the container.
 	*/
-	constexpr iterator _prepare_for_insert(bool insertAtEnd, size_t position, size_t count)
+	constexpr iterator _prepare_for_insert(size_t position, size_t count)
 	{
-		// This is the tail index prior to inserting the elements.
-		size_t const tail = m_len - 1;
-
-		// First we resize the container to fit the number of elements that we are inserting.
-		resize(m_len + count);
+		// Move the tail out of the way, leaving a gap of uninitialized slots for the new elements.
+		relocate(m_box.data + position, m_box.data + position + count, m_len - position);
 
-		if (count && !insertAtEnd)
-		{
-			size_t const elementCount = tail - position + 1;
-			pointer src = &m_box.data[position];
-			pointer dst = &m_box.data[position + count];
-
-			// Shift elements backwards to fill the padding created.
-			_shift_backwards(src, dst, elementCount);
-		}
+		m_len += count;
 
 		return iterator{ m_box.data + position, *this };
 	}
 
-	constexpr iterator _insert_at(iterator pos, size_t count, value_type const* data)
+	/**
+	* \brief Walks the source range instead of reading it through a pointer, it does not have to be contiguous.
+	*/
+	template <std::input_iterator InputIterator>
+	constexpr iterator _insert_at(iterator pos, InputIterator first, InputIterator last)
 	{
 		iterator copy = pos;
-		if (data)
+		for (; first != last; ++first, ++pos)
 		{
-			while (count)
-			{
-				new (pos.m_data) value_type{ *(data) };
-				++pos;
-				++data;
-				--count;
-			}
+			new (pos.data()) value_type{ *first };
 		}
 		return copy;
 	}
@@ -864,7 +796,7 @@ private:
 
 		m_len = other.size();
 
-		if constexpr (std::is_standard_layout_v<value_type> && std::is_trivially_copyable_v<value_type>)
+		if constexpr (std::is_trivially_copyable_v<value_type>)
 		{
 			std::memcpy(m_box.data, other.m_box.data, sizeof(value_type) * other.size());
 		}
@@ -872,7 +804,7 @@ private:
 		{
 			for (size_t i = 0; i < other.m_len; i++)
 			{
-				m_box.data[i] = other.m_box.data[i];
+				new (m_box.data + i) value_type{ other.m_box.data[i] };
 			}
 		}
 	}
@@ -883,6 +815,9 @@ private:
 	size_t m_len;
 	size_t m_capacity;
 };
+
+template <typename T, typename allocator, typename growth_policy>
+struct is_trivially_relocatable<array<T, allocator, growth_policy>> : std::true_type {};
 }
 
 #endif // !LIB_ARRAY_HPP
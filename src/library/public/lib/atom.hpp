@@ -0,0 +1,111 @@
+#pragma once
+#ifndef LIB_ATOM_HPP
+#define LIB_ATOM_HPP
+
+#include <atomic>
+#include <mutex>
+#include <string_view>
+#include "api.h"
+#include "hash.hpp"
+#include "monotonic_memory_resource.hpp"
+
+namespace lib
+{
+/**
+* @brief Handle to a string interned in an atom_table. Two atoms of the same table are equal if and only if their strings are.
+* The null atom stands for the empty string.
+*/
+struct atom
+{
+	uint32 value = 0;
+
+	constexpr auto valid() const -> bool { return value != 0; }
+	constexpr auto operator==(atom const&) const -> bool = default;
+};
+
+template <>
+struct hash<atom>
+{
+	using is_avalanching = void;
+
+	constexpr auto operator()(atom value) const noexcept -> uint64
+	{
+		return hash_mix(static_cast<uint64>(value.value));
+	}
+};
+
+/**
+* String interning table. Every distinct string is stored once and handed out as a 32 bit atom, atoms are dense and start at 1.
+*
+* Strings live in an arena owned by the table and stay at the same address until the table is destroyed, so the views returned by str() never dangle.
+* Along with each string the table keeps its lib::hash_bytes hash, the same hash lib::hash uses for string keys.
+*
+* find(), str() and hash() never take a lock. intern() only locks when it has to add a string, readers keep going while that happens.
+* Atoms are never removed.
+*/
+class atom_table : non_copyable_non_movable
+{
+public:
+	static constexpr uint32 page_size_v = 4096;
+	static constexpr uint32 max_pages_v = 1024;
+	static constexpr uint32 max_atoms_v = page_size_v * max_pages_v;
+
+	LIB_API atom_table(memory_resource* upstream = get_default_resource());
+	LIB_API ~atom_table();
+
+	/**
+	* @brief Returns the atom of the string, adding it to the table if it is not in there yet.
+	*/
+	LIB_API auto intern(std::string_view name) -> atom;
+
+	/**
+	* @brief Returns the atom of the string, or the null atom if the string has not been interned.
+	*/
+	LIB_API auto find(std::string_view name) const -> atom;
+
+	/**
+	* @brief The interned string. It is followed by a null terminator that is not part of the view.
+	*/
+	LIB_API auto str(atom value) const -> std::string_view;
+
+	/**
+	* @brief The precomputed lib::hash_bytes of the interned string.
+	*/
+	LIB_API auto hash(atom value) const -> uint64;
+
+	/**
+	* @brief Number of atoms handed out, counting the null atom. Every atom below this value is valid.
+	*/
+	auto size() const -> uint32 { return m_count.load(std::memory_order_acquire); }
+
+private:
+	struct entry;
+	struct lookup;
+
+	using page_type = std::atomic<entry const*>;
+
+	monotonic_memory_resource m_arena;
+	std::mutex m_mutex;
+	std::atomic<lookup*> m_lookup;
+	std::atomic<uint32> m_count;
+	std::atomic<page_type*> m_pages[max_pages_v];
+
+	auto _entry(uint32 index) const -> entry const*;
+	auto _find(lookup const& table, std::string_view name, uint64 nameHash) const -> atom;
+	auto _add(std::string_view name, uint64 nameHash) -> uint32;
+	auto _make_lookup(size_t capacity) -> lookup*;
+	auto _insert(lookup& table, uint64 nameHash, uint32 index) -> void;
+};
+
+/**
+* @brief Process wide table for pipeline URIs, asset names and anything else that is looked up by name at runtime.
+*/
+LIB_API auto global_atom_table() -> atom_table&;
+
+inline auto intern(std::string_view str) -> atom
+{
+	return global_atom_table().intern(str);
+}
+}
+
+#endif // !LIB_ATOM_HPP
@@ -55,6 +55,12 @@ using wide_literal_t	= const wchar_t*;
 
 namespace lib
 {
+/**
+* @brief Assumed size of a cache line. Used to keep data written by different threads on separate cache lines.
+* std::hardware_destructive_interference_size is not used since GCC warns about it being ABI unstable when used in headers.
+*/
+inline constexpr size_t cache_line_size_v = 64;
+
 /**
 * @brief The copy constructor and copy assignment operator is implicitly deleted if there is an explicit declaration of the move constructor and move assignment operator.
 */
@@ -0,0 +1,325 @@
+#pragma once
+#ifndef LIB_CONCURRENT_MAP_HPP
+#define LIB_CONCURRENT_MAP_HPP
+
+#include <array>
+#include <mutex>
+#include <shared_mutex>
+#include "array.hpp"
+#include "map.hpp"
+
+namespace lib
+{
+/**
+* @brief Hash map that can be shared between threads.
+* Keys are spread over a fixed number of shards, each being a lib::map with its own reader / writer lock. Threads only contend when their keys land in the same shard.
+* 
+* Lookups return copies instead of references since another thread can rehash the shard as soon as its lock is released.
+* Use visit() to work on a stored value in place.
+*/
+template <
+	typename key, 
+	typename value, 
+	size_t shard_count = 16, 
+	provides_memory in_allocator = allocator<typename map_traits<key, value>::type>, 
+	typename hasher = hash<key>, 
+	std::derived_from<container_growth_policy> growth_policy = shift_growth_policy<4>, 
+	typename layout = robin_hood_layout
+>
+class concurrent_map : non_copyable_non_movable
+{
+public:
+	static_assert(std::has_single_bit(shard_count), "concurrent_map's shard count must be a power of two.");
+
+	using map_type		= map<key, value, in_allocator, hasher, growth_policy, layout>;
+	using key_type		= typename map_type::key_type;
+	using value_type	= typename map_type::value_type;
+
+	concurrent_map() = default;
+	~concurrent_map() = default;
+
+	auto contains(key_type const& in_key) const -> bool
+	{
+		shard const& s = _shard_for(in_key);
+		std::shared_lock lock{ s.mutex };
+
+		return s.map.contains(in_key);
+	}
+
+	template <transparent_key<hasher, key_type> K>
+	auto contains(K const& in_key) const -> bool
+	{
+		shard const& s = _shard_for(in_key);
+		std::shared_lock lock{ s.mutex };
+
+		return s.map.contains(in_key);
+	}
+
+	/**
+	* Returns a copy of the value stored under the key, or std::nullopt if the key does not exist.
+	*/
+	auto find(key_type const& in_key) const -> std::optional<value_type>
+	{
+		return _find(in_key);
+	}
+
+	template <transparent_key<hasher, key_type> K>
+	auto find(K const& in_key) const -> std::optional<value_type>
+	{
+		return _find(in_key);
+	}
+
+	/**
+	* Returns a copy of the value stored under the key. The value is constructed from the arguments if the key does not exist yet.
+	* The bool is true when the value was inserted by this call.
+	*/
+	template <typename... Args>
+	auto find_or_emplace(key_type const& in_key, Args&&... args) -> std::pair<value_type, bool>
+	{
+		shard& s = _shard_for(in_key);
+
+		{
+			std::shared_lock lock{ s.mutex };
+
+			if (auto element = s.map.at(in_key); element.has_value())
+			{
+				return { element.value()->second, false };
+			}
+		}
+
+		std::lock_guard lock{ s.mutex };
+
+		// Another thread could have inserted the key between both locks.
+		if (auto element = s.map.at(in_key); element.has_value())
+		{
+			return { element.value()->second, false };
+		}
+
+		auto& element = s.map.emplace(in_key, value_type{ std::forward<Args>(args)... });
+
+		return { element.second, true };
+	}
+
+	/**
+	* Inserts the value or replaces the one stored under the key.
+	*/
+	template <typename V>
+	auto insert_or_assign(key_type const& in_key, V&& val) -> void
+	{
+		shard& s = _shard_for(in_key);
+		std::lock_guard lock{ s.mutex };
+
+		if (auto element = s.map.at(in_key); element.has_value())
+		{
+			element.value()->second = std::forward<V>(val);
+			return;
+		}
+
+		s.map.emplace(in_key, std::forward<V>(val));
+	}
+
+	/**
+	* Invokes fn with a reference to the value stored under the key while the key's shard is locked.
+	* fn must not access the concurrent_map. Returns false if the key does not exist.
+	*/
+	template <typename Fn>
+	auto visit(key_type const& in_key, Fn&& fn) -> bool
+	{
+		shard& s = _shard_for(in_key);
+		std::lock_guard lock{ s.mutex };
+
+		if (auto element = s.map.at(in_key); element.has_value())
+		{
+			fn(element.value()->second);
+			return true;
+		}
+		return false;
+	}
+
+	template <typename Fn>
+	auto visit(key_type const& in_key, Fn&& fn) const -> bool
+	{
+		shard const& s = _shard_for(in_key);
+		std::shared_lock lock{ s.mutex };
+
+		if (auto element = s.map.at(in_key); element.has_value())
+		{
+			fn(std::as_const(element.value()->second));
+			return true;
+		}
+		return false;
+	}
+
+	auto erase(key_type const& in_key) -> bool
+	{
+		shard& s = _shard_for(in_key);
+		std::lock_guard lock{ s.mutex };
+
+		return s.map.erase(in_key);
+	}
+
+	template <transparent_key<hasher, key_type> K>
+	auto erase(K const& in_key) -> bool
+	{
+		shard& s = _shard_for(in_key);
+		std::lock_guard lock{ s.mutex };
+
+		return s.map.erase(in_key);
+	}
+
+	/**
+	* Erases every element for which predicate(key, value) returns true. Shards are locked one at a time.
+	* @return Number of erased elements.
+	*/
+	template <typename Predicate>
+	auto erase_if(Predicate&& predicate) -> size_t
+	{
+		size_t count = 0;
+		lib::array<key_type> erased;
+
+		for (shard& s : m_shards)
+		{
+			std::lock_guard lock{ s.mutex };
+
+			erased.clear();
+
+			for (auto const& [k, v] : s.map)
+			{
+				if (predicate(k, v))
+				{
+					erased.push_back(k);
+				}
+			}
+
+			// Erasing moves elements around, so it can't be done while iterating.
+			for (key_type const& k : erased)
+			{
+				s.map.erase(k);
+			}
+
+			count += erased.size();
+		}
+
+		return count;
+	}
+
+	/**
+	* Invokes fn(key, value) on every element. Shards are read locked one at a time, so the elements seen are not a single point in time across shards.
+	* fn must not access the concurrent_map.
+	*/
+	template <typename Fn>
+	auto for_each(Fn&& fn) const -> void
+	{
+		for (shard const& s : m_shards)
+		{
+			std::shared_lock lock{ s.mutex };
+
+			for (auto const& [k, v] : s.map)
+			{
+				fn(k, v);
+			}
+		}
+	}
+
+	/**
+	* Copies every element out of the map, locking one shard at a time.
+	*/
+	auto snapshot() const -> lib::array<std::pair<key_type, value_type>>
+	{
+		lib::array<std::pair<key_type, value_type>> elements;
+
+		elements.reserve(size());
+
+		for_each([&elements](key_type const& k, value_type const& v) -> void { elements.emplace_back(k, v); });
+
+		return elements;
+	}
+
+	/**
+	* Sum of every shard's size. Only a hint while other threads are modifying the map.
+	*/
+	auto size() const -> size_t
+	{
+		size_t count = 0;
+
+		for (shard const& s : m_shards)
+		{
+			std::shared_lock lock{ s.mutex };
+			count += s.map.size();
+		}
+
+		return count;
+	}
+
+	auto empty() const -> bool
+	{
+		return size() == 0;
+	}
+
+	auto clear() -> void
+	{
+		for (shard& s : m_shards)
+		{
+			std::lock_guard lock{ s.mutex };
+			s.map.clear();
+		}
+	}
+
+private:
+	struct alignas(cache_line_size_v) shard
+	{
+		mutable std::shared_mutex mutex;
+		map_type map;
+	};
+
+	std::array<shard, shard_count> m_shards;
+
+	template <typename K>
+	auto _find(K const& in_key) const -> std::optional<value_type>
+	{
+		shard const& s = _shard_for(in_key);
+		std::shared_lock lock{ s.mutex };
+
+		if (auto element = s.map.at(in_key); element.has_value())
+		{
+			return element.value()->second;
+		}
+		return std::nullopt;
+	}
+
+	template <typename K>
+	static auto _shard_index(K const& in_key) -> size_t
+	{
+		if constexpr (shard_count == 1)
+		{
+			return 0;
+		}
+		else
+		{
+			uint64 hashValue = static_cast<uint64>(hasher{}(in_key));
+
+			if constexpr (!avalanching_hasher<hasher>)
+			{
+				hashValue = hash_mix(hashValue);
+			}
+
+			// The shards take the top bits, the maps inside them take the bottom bits.
+			return static_cast<size_t>(hashValue >> (64 - std::countr_zero(shard_count)));
+		}
+	}
+
+	template <typename K>
+	auto _shard_for(K const& in_key) -> shard&
+	{
+		return m_shards[_shard_index(in_key)];
+	}
+
+	template <typename K>
+	auto _shard_for(K const& in_key) const -> shard const&
+	{
+		return m_shards[_shard_index(in_key)];
+	}
+};
+}
+
+#endif // !LIB_CONCURRENT_MAP_HPP
@@ -0,0 +1,576 @@
+#pragma once
+#ifndef LIB_CONCURRENT_QUEUE_HPP
+#define LIB_CONCURRENT_QUEUE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <new>
+#include <optional>
+#include <span>
+#include "memory.hpp"
+
+namespace lib
+{
+/**
+* Bounded ring for exactly one producer and one consumer thread.
+*
+* Each side owns its index and keeps a cached copy of the other side's, the shared index is only read again when the cached one says the ring is full or empty.
+* The indices live on separate cache lines so that the two threads do not invalidate each other's line on every operation.
+* Batches move any number of elements with a single index update.
+*/
+template <typename T>
+requires std::is_nothrow_move_constructible_v<T>
+class spsc_queue : non_copyable_non_movable
+{
+public:
+	using value_type = T;
+
+	static constexpr size_t default_capacity_v = 1024;
+
+	/**
+	* @brief The capacity is rounded up to a power of two.
+	*/
+	spsc_queue(size_t capacity = default_capacity_v, memory_resource* resource = get_default_resource()) :
+		m_head{ 0 },
+		m_cachedTail{ 0 },
+		m_tail{ 0 },
+		m_cachedHead{ 0 },
+		m_slots{},
+		m_mask{ std::bit_ceil(std::max(capacity, size_t{ 2 })) - 1 },
+		m_resource{ resource }
+	{
+		m_slots = static_cast<T*>(m_resource->allocate(sizeof(T) * (m_mask + 1), alignof(T)));
+	}
+
+	~spsc_queue()
+	{
+		size_t const tail = m_tail.load(std::memory_order_relaxed);
+
+		for (size_t i = m_head.load(std::memory_order_relaxed); i != tail; ++i)
+		{
+			_slot(i)->~T();
+		}
+
+		m_resource->deallocate(m_slots, sizeof(T) * (m_mask + 1), alignof(T));
+	}
+
+	/**
+	* @brief Producer only. The element is only constructed when there is room for it.
+	*/
+	template <typename... Args>
+	auto try_emplace(Args&&... args) -> bool
+	{
+		size_t const tail = m_tail.load(std::memory_order_relaxed);
+
+		if (tail - m_cachedHead > m_mask)
+		{
+			m_cachedHead = m_head.load(std::memory_order_acquire);
+
+			if (tail - m_cachedHead > m_mask)
+			{
+				return false;
+			}
+		}
+
+		new (_slot(tail)) T{ std::forward<Args>(args)... };
+		m_tail.store(tail + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	auto try_push(T const& value) -> bool { return try_emplace(value); }
+	auto try_push(T&& value) -> bool { return try_emplace(std::move(value)); }
+
+	/**
+	* @brief Producer only. Moves as many elements from the front of values as there is room for.
+	* @return Number of elements pushed.
+	*/
+	auto try_push_batch(std::span<T> values) -> size_t
+	{
+		size_t const tail = m_tail.load(std::memory_order_relaxed);
+		size_t room = m_mask + 1 - (tail - m_cachedHead);
+
+		if (room < values.size())
+		{
+			m_cachedHead = m_head.load(std::memory_order_acquire);
+			room = m_mask + 1 - (tail - m_cachedHead);
+		}
+
+		size_t const count = std::min(room, values.size());
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			new (_slot(tail + i)) T{ std::move(values[i]) };
+		}
+
+		if (count != 0)
+		{
+			m_tail.store(tail + count, std::memory_order_release);
+		}
+
+		return count;
+	}
+
+	/**
+	* @brief Consumer only.
+	*/
+	auto try_pop() -> std::optional<T>
+	{
+		size_t const head = m_head.load(std::memory_order_relaxed);
+
+		if (head == m_cachedTail)
+		{
+			m_cachedTail = m_tail.load(std::memory_order_acquire);
+
+			if (head == m_cachedTail)
+			{
+				return std::nullopt;
+			}
+		}
+
+		T* slot = _slot(head);
+		std::optional<T> value{ std::move(*slot) };
+
+		slot->~T();
+		m_head.store(head + 1, std::memory_order_release);
+
+		return value;
+	}
+
+	/**
+	* @brief Consumer only. Moves up to out.size() elements into out.
+	* @return Number of elements popped.
+	*/
+	auto try_pop_batch(std::span<T> out) -> size_t
+	{
+		size_t const head = m_head.load(std::memory_order_relaxed);
+		size_t available = m_cachedTail - head;
+
+		if (available < out.size())
+		{
+			m_cachedTail = m_tail.load(std::memory_order_acquire);
+			available = m_cachedTail - head;
+		}
+
+		size_t const count = std::min(available, out.size());
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			T* slot = _slot(head + i);
+
+			out[i] = std::move(*slot);
+			slot->~T();
+		}
+
+		if (count != 0)
+		{
+			m_head.store(head + count, std::memory_order_release);
+		}
+
+		return count;
+	}
+
+	/**
+	* @brief Only a hint, the other side may have moved on by the time this returns.
+	*/
+	auto size() const -> size_t
+	{
+		return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+	}
+
+	auto empty() const -> bool { return size() == 0; }
+	auto capacity() const -> size_t { return m_mask + 1; }
+
+private:
+	// Consumer's line.
+	alignas(cache_line_size_v) std::atomic<size_t> m_head;
+	size_t m_cachedTail;
+
+	// Producer's line.
+	alignas(cache_line_size_v) std::atomic<size_t> m_tail;
+	size_t m_cachedHead;
+
+	alignas(cache_line_size_v) T* m_slots;
+	size_t m_mask;
+	memory_resource* m_resource;
+
+	auto _slot(size_t index) const -> T* { return m_slots + (index & m_mask); }
+};
+
+/**
+* Bounded queue for any number of producers and consumers (Dmitry Vyukov's bounded MPMC queue).
+*
+* Every cell carries a sequence number that tells whether it is ready to be written or read at a given position.
+* Producers and consumers claim positions with a CAS on their own index and never wait on each other unless the queue is full or empty.
+* Batches claim one position at a time, they save the caller the loop but not the CAS.
+*/
+template <typename T>
+requires std::is_nothrow_move_constructible_v<T>
+class mpmc_queue : non_copyable_non_movable
+{
+public:
+	using value_type = T;
+
+	static constexpr size_t default_capacity_v = 1024;
+
+	/**
+	* @brief The capacity is rounded up to a power of two.
+	*/
+	mpmc_queue(size_t capacity = default_capacity_v, memory_resource* resource = get_default_resource()) :
+		m_enqueue{ 0 },
+		m_dequeue{ 0 },
+		m_cells{},
+		m_mask{ std::bit_ceil(std::max(capacity, size_t{ 2 })) - 1 },
+		m_resource{ resource }
+	{
+		m_cells = static_cast<cell*>(m_resource->allocate(sizeof(cell) * (m_mask + 1), alignof(cell)));
+
+		for (size_t i = 0; i <= m_mask; ++i)
+		{
+			new (&m_cells[i].sequence) std::atomic<size_t>{ i };
+		}
+	}
+
+	~mpmc_queue()
+	{
+		size_t const enqueue = m_enqueue.load(std::memory_order_relaxed);
+
+		for (size_t i = m_dequeue.load(std::memory_order_relaxed); i != enqueue; ++i)
+		{
+			m_cells[i & m_mask].value()->~T();
+		}
+
+		m_resource->deallocate(m_cells, sizeof(cell) * (m_mask + 1), alignof(cell));
+	}
+
+	/**
+	* @brief Thread safe. The element is only constructed when there is room for it.
+	*/
+	template <typename... Args>
+	auto try_emplace(Args&&... args) -> bool
+	{
+		size_t position = m_enqueue.load(std::memory_order_relaxed);
+		cell* c = nullptr;
+
+		while (true)
+		{
+			c = &m_cells[position & m_mask];
+
+			size_t const sequence = c->sequence.load(std::memory_order_acquire);
+			intptr_t const difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+			if (difference == 0)
+			{
+				if (m_enqueue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+			else if (difference < 0)
+			{
+				// The cell still holds the element from one lap ago.
+				return false;
+			}
+			else
+			{
+				position = m_enqueue.load(std::memory_order_relaxed);
+			}
+		}
+
+		new (c->value()) T{ std::forward<Args>(args)... };
+		c->sequence.store(position + 1, std::memory_order_release);
+
+		return true;
+	}
+
+	auto try_push(T const& value) -> bool { return try_emplace(value); }
+	auto try_push(T&& value) -> bool { return try_emplace(std::move(value)); }
+
+	/**
+	* @brief Thread safe. Moves elements from the front of values until the queue is full. Other producers' elements may be interleaved with them.
+	* @return Number of elements pushed.
+	*/
+	auto try_push_batch(std::span<T> values) -> size_t
+	{
+		size_t count = 0;
+
+		while (count < values.size() && try_emplace(std::move(values[count])))
+		{
+			++count;
+		}
+
+		return count;
+	}
+
+	/**
+	* @brief Thread safe.
+	*/
+	auto try_pop() -> std::optional<T>
+	{
+		size_t position = m_dequeue.load(std::memory_order_relaxed);
+		cell* c = nullptr;
+
+		while (true)
+		{
+			c = &m_cells[position & m_mask];
+
+			size_t const sequence = c->sequence.load(std::memory_order_acquire);
+			intptr_t const difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+
+			if (difference == 0)
+			{
+				if (m_dequeue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+			else if (difference < 0)
+			{
+				// Nothing has been written to the cell at this position yet.
+				return std::nullopt;
+			}
+			else
+			{
+				position = m_dequeue.load(std::memory_order_relaxed);
+			}
+		}
+
+		T* slot = c->value();
+		std::optional<T> value{ std::move(*slot) };
+
+		slot->~T();
+
+		// Hands the cell to the producer that gets to it one lap later.
+		c->sequence.store(position + m_mask + 1, std::memory_order_release);
+
+		return value;
+	}
+
+	/**
+	* @brief Thread safe. Moves up to out.size() elements into out.
+	* @return Number of elements popped.
+	*/
+	auto try_pop_batch(std::span<T> out) -> size_t
+	{
+		size_t count = 0;
+
+		for (; count < out.size(); ++count)
+		{
+			std::optional<T> value = try_pop();
+
+			if (!value.has_value())
+			{
+				break;
+			}
+
+			out[count] = std::move(*value);
+		}
+
+		return count;
+	}
+
+	/**
+	* @brief Only a hint, other threads may have moved on by the time this returns.
+	*/
+	auto size() const -> size_t
+	{
+		size_t const dequeue = m_dequeue.load(std::memory_order_acquire);
+		size_t const enqueue = m_enqueue.load(std::memory_order_acquire);
+
+		return (enqueue > dequeue) ? enqueue - dequeue : 0;
+	}
+
+	auto empty() const -> bool { return size() == 0; }
+	auto capacity() const -> size_t { return m_mask + 1; }
+
+private:
+	struct cell
+	{
+		std::atomic<size_t> sequence;
+		alignas(T) std::byte storage[sizeof(T)];
+
+		auto value() -> T* { return std::launder(reinterpret_cast<T*>(storage)); }
+	};
+
+	alignas(cache_line_size_v) std::atomic<size_t> m_enqueue;
+	alignas(cache_line_size_v) std::atomic<size_t> m_dequeue;
+	alignas(cache_line_size_v) cell* m_cells;
+	size_t m_mask;
+	memory_resource* m_resource;
+};
+
+template <typename queue_type>
+concept bounded_queue = requires (queue_type& queue, typename queue_type::value_type value, std::span<typename queue_type::value_type> values)
+{
+	{ queue.try_push(std::move(value)) } -> std::same_as<bool>;
+	{ queue.try_pop() } -> std::same_as<std::optional<typename queue_type::value_type>>;
+	{ queue.try_push_batch(values) } -> std::same_as<size_t>;
+	{ queue.try_pop_batch(values) } -> std::same_as<size_t>;
+};
+
+/**
+* Adds blocking push and pop to spsc_queue or mpmc_queue. Threads sleep through std::atomic::wait while the queue is full or empty.
+*
+* Every operation bumps an epoch that sleepers wait on. The epoch is only notified when somebody is waiting, so a queue that never blocks never makes a system call.
+* All access has to go through the adapter, an element pushed to the underlying queue directly does not wake anyone up.
+*/
+template <bounded_queue queue_type>
+class blocking_queue : non_copyable_non_movable
+{
+public:
+	using value_type = typename queue_type::value_type;
+
+	blocking_queue(size_t capacity = queue_type::default_capacity_v, memory_resource* resource = get_default_resource()) :
+		m_queue{ capacity, resource },
+		m_pushed{ 0 },
+		m_popped{ 0 },
+		m_pushWaiters{ 0 },
+		m_popWaiters{ 0 }
+	{}
+
+	~blocking_queue() = default;
+
+	/**
+	* @brief Waits while the queue is full.
+	*/
+	auto push(value_type value) -> void
+	{
+		_wait_until(m_popped, m_pushWaiters, [&]() -> bool { return m_queue.try_push(std::move(value)); });
+		_signal(m_pushed, m_popWaiters, 1);
+	}
+
+	/**
+	* @brief Waits until every element has been pushed.
+	*/
+	auto push_batch(std::span<value_type> values) -> void
+	{
+		while (!values.empty())
+		{
+			size_t count = 0;
+
+			_wait_until(m_popped, m_pushWaiters, [&]() -> bool { return (count = m_queue.try_push_batch(values)) != 0; });
+			_signal(m_pushed, m_popWaiters, count);
+
+			values = values.subspan(count);
+		}
+	}
+
+	/**
+	* @brief Waits while the queue is empty.
+	*/
+	auto pop() -> value_type
+	{
+		std::optional<value_type> value;
+
+		_wait_until(m_pushed, m_popWaiters, [&]() -> bool { value = m_queue.try_pop(); return value.has_value(); });
+		_signal(m_popped, m_pushWaiters, 1);
+
+		return std::move(*value);
+	}
+
+	/**
+	* @brief Waits while the queue is empty, then takes up to out.size() elements.
+	* @return Number of elements popped, at least one unless out is empty.
+	*/
+	auto pop_batch(std::span<value_type> out) -> size_t
+	{
+		if (out.empty())
+		{
+			return 0;
+		}
+
+		size_t count = 0;
+
+		_wait_until(m_pushed, m_popWaiters, [&]() -> bool { return (count = m_queue.try_pop_batch(out)) != 0; });
+		_signal(m_popped, m_pushWaiters, count);
+
+		return count;
+	}
+
+	auto try_push(value_type value) -> bool
+	{
+		if (!m_queue.try_push(std::move(value)))
+		{
+			return false;
+		}
+
+		_signal(m_pushed, m_popWaiters, 1);
+
+		return true;
+	}
+
+	auto try_pop() -> std::optional<value_type>
+	{
+		std::optional<value_type> value = m_queue.try_pop();
+
+		if (value.has_value())
+		{
+			_signal(m_popped, m_pushWaiters, 1);
+		}
+
+		return value;
+	}
+
+	auto size() const -> size_t { return m_queue.size(); }
+	auto empty() const -> bool { return m_queue.empty(); }
+	auto capacity() const -> size_t { return m_queue.capacity(); }
+
+private:
+	queue_type m_queue;
+	alignas(cache_line_size_v) std::atomic<uint32> m_pushed;
+	alignas(cache_line_size_v) std::atomic<uint32> m_popped;
+	alignas(cache_line_size_v) std::atomic<uint32> m_pushWaiters;
+	alignas(cache_line_size_v) std::atomic<uint32> m_popWaiters;
+
+	/**
+	* Announces the waiter before reading the epoch and trying again, the same handshake the job scheduler uses for its sleepers.
+	* Either _signal() sees the waiter, or the waiter sees the epoch that _signal() bumped.
+	*/
+	template <typename Fn>
+	auto _wait_until(std::atomic<uint32>& epoch, std::atomic<uint32>& waiters, Fn&& attempt) -> void
+	{
+		if (attempt())
+		{
+			return;
+		}
+
+		waiters.fetch_add(1, std::memory_order_seq_cst);
+
+		while (true)
+		{
+			uint32 const current = epoch.load(std::memory_order_seq_cst);
+
+			if (attempt())
+			{
+				break;
+			}
+
+			epoch.wait(current, std::memory_order_seq_cst);
+		}
+
+		waiters.fetch_sub(1, std::memory_order_seq_cst);
+	}
+
+	auto _signal(std::atomic<uint32>& epoch, std::atomic<uint32>& waiters, size_t count) -> void
+	{
+		epoch.fetch_add(1, std::memory_order_seq_cst);
+
+		if (waiters.load(std::memory_order_seq_cst) == 0)
+		{
+			return;
+		}
+
+		if (count == 1)
+		{
+			epoch.notify_one();
+		}
+		else
+		{
+			epoch.notify_all();
+		}
+	}
+};
+}
+
+#endif // !LIB_CONCURRENT_QUEUE_HPP
@@ -2,6 +2,9 @@
 #ifndef LIB_DAG_HPP
 #define LIB_DAG_HPP
 
+#include <algorithm>
+#include <span>
+#include "map.hpp"
 #include "set.hpp"
 #include "array.hpp"
 
@@ -9,310 +12,448 @@ namespace lib
 {
 
 /**
-* Implementation of a directed acyclic graph (DAG).
-* This implementation of a DAG is not thread-safe. Sorting is done single-threadedly.
+* Directed graph with unique vertices.
+*
+* Vertices are numbered densely in insertion order. Edges are kept in a flat list while the graph is being built and are turned into a
+* compressed sparse row (CSR) adjacency, the successors of every vertex stored contiguously, the first time the graph is queried after it changed.
+* Duplicate edges are rejected in O(1) so building a graph with E edges is O(E), and sorting it is O(V + E).
+*
+* This implementation is not thread-safe, the adjacency is rebuilt lazily even through const member functions.
 */
 template <typename T, provides_memory in_allocator = allocator<T>>
 class digraph
 {
 private:
+	template <typename U>
+	using rebind_allocator_t = typename std::allocator_traits<in_allocator>::template rebind_alloc<U>;
+
 	struct graph_edge
 	{
-		size_t from;	// Index of the source vertex.
-		size_t to;		// Index of the destination vertex.
+		uint32 from;	// Index of the source vertex.
+		uint32 to;		// Index of the destination vertex.
 	};
 
+public:
 	using value_type		= T;
 	using const_reference	= value_type const&;
-	using vertex_set		= set<T, in_allocator>;
-	using edge_list			= array<graph_edge, in_allocator>;
+	using allocator_type	= in_allocator;
+	using index_type		= uint32;
+	using index_list		= array<index_type, rebind_allocator_t<index_type>>;
 
-	vertex_set	m_vertices;
-	edge_list	m_edges;
-	bool		m_is_acyclic;
+	static constexpr index_type invalid_index_v = std::numeric_limits<index_type>::max();
 
-	constexpr bool connection_exist(size_t from, size_t to) const
+	/**
+	* Result of a topological sort.
+	* When the graph has a cycle, "order" only holds the vertices that are not on or behind a cycle and "cycle" holds the vertices of one of the cycles in edge order.
+	*/
+	struct sort_result
 	{
-		for (graph_edge const& edge : m_edges)
-		{
-			if (edge.from == from && 
-				edge.to == to)
-			{
-				return true;
-			}
-		}
-		return false;
-	}
+		index_list order;
+		index_list cycle;
+
+		constexpr auto acyclic() const -> bool { return cycle.empty(); }
+	};
 
-	constexpr void release()
+	/**
+	* Vertices grouped into waves. Vertices within a wave do not depend on each other and only depend on vertices of earlier waves.
+	*/
+	struct level_list
 	{
-		m_vertices.release();
-		m_edges.release();
-	}
+		index_list vertices;
+		index_list offsets;		// Wave i is vertices[offsets[i], offsets[i + 1]).
 
-public:
+		constexpr auto size() const -> size_t { return offsets.empty() ? 0 : offsets.size() - 1; }
+		constexpr auto empty() const -> bool { return size() == 0; }
+
+		constexpr auto operator[](size_t level) const -> std::span<index_type const>
+		{
+			return std::span{ vertices.data() + offsets[level], vertices.data() + offsets[level + 1] };
+		}
+	};
 
 	constexpr digraph() :
-		m_vertices{}, m_edges{}, m_is_acyclic{ true }
+		digraph{ allocator_type{} }
 	{}
 
-	constexpr ~digraph() { release(); }
+	constexpr digraph(allocator_type const& allocator) :
+		m_vertices{ allocator },
+		m_indices{ allocator },
+		m_edgeKeys{ allocator },
+		m_edges{ allocator },
+		m_offsets{ allocator },
+		m_targets{ allocator },
+		m_dirty{}
+	{}
 
-	constexpr digraph(size_t capacity) :
-		digraph{}
+	constexpr digraph(size_t capacity, allocator_type const& allocator = allocator_type{}) :
+		digraph{ allocator }
 	{
-		m_vertices.reserve(capacity);
+		reserve(capacity, 0);
 	}
 
-	constexpr digraph(const digraph& rhs) :
-		m_vertices{}, m_edges{}, m_is_acyclic{ true }
-	{ 
-		*this = rhs; 
-	}
+	constexpr ~digraph() = default;
 
-	constexpr digraph(digraph&& rhs) :
-		m_vertices{}, m_edges{}, m_is_acyclic{ true } 
-	{ 
-		*this = std::move(rhs); 
-	}
+	constexpr digraph(digraph const&)				= default;
+	constexpr digraph(digraph&&)					= default;
+	constexpr digraph& operator=(digraph const&)	= default;
+	constexpr digraph& operator=(digraph&&)			= default;
 
-	constexpr digraph& operator=(const digraph& rhs)
+	constexpr auto reserve(size_t vertexCount, size_t edgeCount) -> void
 	{
-		if (this != &rhs)
-		{
-			m_vertices = rhs.m_vertices;
-			m_edges = rhs.m_edges;
-		}
-		return *this;
+		m_vertices.reserve(vertexCount);
+		m_indices.reserve(vertexCount);
+		m_edgeKeys.reserve(edgeCount);
+		m_edges.reserve(edgeCount);
 	}
 
-	constexpr digraph& operator=(digraph&& rhs)
+	/**
+	* Adds a new unique vertex into the graph.
+	* Returns the index of the vertex, which is the existing one's if the vertex is already in the graph.
+	*/
+	template <typename... ForwardType>
+	constexpr auto add_vertex(ForwardType&&... args) -> index_type
 	{
-		if (this != &rhs)
-		{
-			m_vertices = std::move(rhs.m_vertices);
-			m_edges = std::move(rhs.m_edges);
+		T key{ std::forward<ForwardType>(args)... };
 
-			new (&rhs) digraph{};
+		if (index_type const index = vertex_index(key); index != invalid_index_v)
+		{
+			return index;
 		}
-		return *this;
+
+		index_type const index = static_cast<index_type>(m_vertices.size());
+
+		m_indices.emplace(key, index);
+		m_vertices.push_back(std::move(key));
+		m_dirty = true;
+
+		return index;
 	}
 
 	/**
-	* Adds a new unique vertex into the graph.
+	* Adds an edge from "from" to "to", adding either vertex into the graph if it does not exist yet.
+	* Returns false if the edge already exists.
 	*/
-	template <typename... ForwardType>
-	constexpr void add_vertex(ForwardType&&... args)
+	constexpr auto add_edge(const_reference from, const_reference to) -> bool
 	{
-		T key{ std::forward<ForwardType>(args)... };
-		m_vertices.try_emplace(key, std::move(key));
+		index_type const source = add_vertex(from);
+		index_type const destination = add_vertex(to);
+
+		return add_edge_between(source, destination);
 	}
 
 	/**
-	* Adds a new unique vertex into the graph and creates an edge that symbolizes the relationship between those two vertices.
+	* Adds an edge between two vertices that are already in the graph.
+	* Returns false if the edge already exists.
 	*/
-	template <typename... ForwardType>
-	constexpr void add_edge(T&& from, ForwardType&&... args)
+	constexpr auto add_edge_between(index_type from, index_type to) -> bool
 	{
-		m_is_acyclic = false;
-		T to{ std::forward<ForwardType>(args)... };
+		ASSERTION(from < m_vertices.size() && to < m_vertices.size() && "Vertex index is out of range!");
 
-		if (from != to)
+		if (m_edgeKeys.contains(_edge_key(from, to)))
 		{
-			m_is_acyclic = true;
-
-			auto result = m_vertices.try_insert(to, std::move(to));
-			size_t bucket = result.value_or(vertex_set::invalid_bucket_v);
-
-			if (bucket == Vertices_t::invalid_bucket())
-			{
-				bucket = m_vertices.bucket(to);
-			}
-
-			size_t parent = m_vertices.bucket(from);
+			return false;
+		}
 
-			if (parent == vertex_set::invalid_bucket_v)
-			{
-				parent = m_vertices.insert(std::move(from));
-			}
+		m_edgeKeys.insert(_edge_key(from, to));
+		m_edges.push_back(graph_edge{ .from = from, .to = to });
+		m_dirty = true;
 
-			if (!connection_exist(parent, bucket))
-			{
-				m_edges.emplace(parent, bucket);
-			}
-		}
+		return true;
 	}
 
-	constexpr bool relationship_exist(const T& from, const T& to)
+	constexpr auto relationship_exist(const_reference from, const_reference to) const -> bool
 	{
-		size_t a = m_vertices.bucket(from);
-		size_t b = m_vertices.bucket(to);
+		index_type const a = vertex_index(from);
+		index_type const b = vertex_index(to);
 
-		return connection_exist(a, b);
+		return a != invalid_index_v &&
+			b != invalid_index_v &&
+			m_edgeKeys.contains(_edge_key(a, b));
 	}
 
-	constexpr bool is_acyclic() const
+	/**
+	* Returns invalid_index_v if the vertex is not in the graph.
+	*/
+	constexpr auto vertex_index(const_reference key) const -> index_type
 	{
-		return m_is_acyclic;
+		auto const result = m_indices.at(key);
+		return result.has_value() ? (*result)->second : invalid_index_v;
 	}
 
-	// TODO(Afiq):
-	// Introduce this in the future.
-	/*bool remove_vertex(ConstRefType vertex)
+	constexpr auto vertex(index_type index) const -> const_reference
 	{
-		size_t bucket = m_vertices.bucket(vertex);
-		if (bucket == Vertices_t::invalid_bucket())
-		{
-			return false;
-		}
+		return m_vertices[index];
+	}
 
-		m_vertices.erase(vertex);
+	constexpr auto vertices() const -> std::span<value_type const>
+	{
+		return std::span{ m_vertices.data(), m_vertices.size() };
+	}
 
-		for (size_t i = 0; i < m_edges.length();)
-		{
-			const Edge& edge = m_edges[i];
-			if (edge.from == bucket ||
-				edge.to == bucket)
-			{
-				m_edges.pop_at(i);
-				continue;
-			}
-			++i;
-		}
+	/**
+	* Vertices that "index" has an edge to, in the order the edges were added.
+	*/
+	constexpr auto successors(index_type index) const -> std::span<index_type const>
+	{
+		_build_adjacency();
+		return std::span{ m_targets.data() + m_offsets[index], m_targets.data() + m_offsets[index + 1] };
+	}
 
-		return true;
-	}*/
+	constexpr auto num_edges() const -> size_t
+	{
+		return m_edges.size();
+	}
 
-	constexpr size_t num_edges() const
-	{ 
-		return m_edges.size(); 
+	constexpr auto num_vertices() const -> size_t
+	{
+		return m_vertices.size();
 	}
 
-	constexpr size_t num_vertices() const
-	{ 
-		return m_vertices.size(); 
+	constexpr auto num_edges_for_vertex(const_reference key) const -> size_t
+	{
+		index_type const index = vertex_index(key);
+		return (index != invalid_index_v) ? successors(index).size() : 0;
 	}
 
-	constexpr size_t num_edges_for_vertex(ConstRefType key) const
+	constexpr auto is_acyclic() const -> bool
 	{
-		size_t count = 0;
-		const size_t bucket = m_vertices.bucket(key);
-		if (bucket != vertex_set::invalid_bucket_v)
-		{
-			for (graph_edge const& edge : m_edges)
-			{
-				if (edge.from == bucket)
-				{
-					++count;
-				}
-			}
-		}
-		return count;
+		return topological_order().acyclic();
 	}
 
 	/**
 	* Clears the content of the graph.
 	*/
-	constexpr void clear()
+	constexpr auto clear() -> void
 	{
 		m_vertices.clear();
-		m_edges.empty();
+		m_indices.clear();
+		m_edgeKeys.clear();
+		m_edges.clear();
+		m_offsets.clear();
+		m_targets.clear();
+		m_dirty = false;
 	}
 
 	/**
-	* Topological sort.
-	* 
-	* Returns an ascending ordered list of T based on it's dependencies.
-	* If the graph is cyclic, the method returns an empty list.
+	* Topological sort using Kahn's algorithm.
 	*/
-	constexpr array<T, in_allocator> sort()
+	constexpr auto topological_order() const -> sort_result
 	{
-		array<T, in_allocator> result{ m_vertices.size() };
+		_build_adjacency();
+
+		index_list inDegree = _in_degrees();
+		sort_result result{ .order = index_list{ m_vertices.get_allocator() }, .cycle = index_list{ m_vertices.get_allocator() } };
 
-		// Make copies of edges and vertices so that we don't modify the DAG's internal data.
-		edge_list	edges = m_edges;
-		vertex_set	vertices = m_vertices;
+		result.order.reserve(m_vertices.size());
+
+		for (index_type v = 0; v < m_vertices.size(); ++v)
+		{
+			if (inDegree[v] == 0)
+			{
+				result.order.push_back(v);
+			}
+		}
 
-		auto loop_edges = [&](size_t& node, graph_edge* pEdge) -> bool 
+		// The order doubles as the queue, everything before "head" has been visited.
+		for (size_t head = 0; head < result.order.size(); ++head)
 		{
-			// Check if the node being passed into this lambda contain any edges.
-			for (graph_edge const& e : edges)
+			for (index_type const to : successors(result.order[head]))
 			{
-				// If the current node contains an edge, we set the current node to the vertex at the other end of the edge.
-				// The edge is then cached in "pEdge". Doing this ensures that we can traverse back to the previous node.
-				// When this lambda returns true, the algorithm will continue traversing down the graph until a child it finds a node with no edges.
-				if (e.from == node)
+				if (--inDegree[to] == 0)
 				{
-					node = e.to;
-					*pEdge = e;
-					return true;
+					result.order.push_back(to);
 				}
 			}
+		}
+
+		if (result.order.size() != m_vertices.size())
+		{
+			result.cycle = _find_cycle(inDegree);
+		}
+
+		return result;
+	}
+
+	/**
+	* Groups vertices into waves that can each be processed in parallel, the first wave holding the vertices without dependencies.
+	* Every vertex is placed in the earliest wave possible. Vertices on or behind a cycle are left out, topological_order() reports the cycle.
+	*/
+	constexpr auto levelize() const -> level_list
+	{
+		_build_adjacency();
+
+		index_list inDegree = _in_degrees();
+		level_list levels{ .vertices = index_list{ m_vertices.get_allocator() }, .offsets = index_list{ m_vertices.get_allocator() } };
 
-			// With the method that we've employed, we are only able to cache a single edge traversal.
-			// To mitigate this, if the algorithm is stuck in the previous node, we change the node's value to -1.
-			// This will trigger the algorithm to traverse a new "random" node in the "visit_node" lambda.
-			if (node == pEdge->from)
+		levels.vertices.reserve(m_vertices.size());
+
+		for (index_type v = 0; v < m_vertices.size(); ++v)
+		{
+			if (inDegree[v] == 0)
 			{
-				pEdge->from = static_cast<size_t>(-1);
+				levels.vertices.push_back(v);
 			}
+		}
+
+		size_t begin = 0;
+
+		while (begin < levels.vertices.size())
+		{
+			size_t const end = levels.vertices.size();
 
-			// This is an optimization; remove all edges that were visited for faster iteration time in the step above.
-			// Cater for edge cases where the graph only has 1 node and no-edges.
-			if (edges.size())
+			levels.offsets.push_back(static_cast<index_type>(begin));
+
+			for (size_t i = begin; i < end; ++i)
 			{
-				auto removePredicate = [node](graph_edge const& e) -> bool { return e.to == node; };
-				auto it = std::remove_if(edges.begin(), edges.end(), removePredicate);
-				edges.erase(it, edges.end());
+				for (index_type const to : successors(levels.vertices[i]))
+				{
+					if (--inDegree[to] == 0)
+					{
+						levels.vertices.push_back(to);
+					}
+				}
 			}
 
-			// Returning false tells the algorithm that this is a node with no edges and can be pushed into the result list.
-			// Also allows us to remove the node from the vertex list.
-			return false;
-		};
+			begin = end;
+		}
 
-		auto visit_node = [&](size_t& node) -> void
+		if (!levels.offsets.empty())
 		{
-			// This is the edges cache. 
-			graph_edge e{ static_cast<size_t>(-1), static_cast<size_t>(-1) };
-
-			// Loop through all of edges in the edges list until we've reached a node with no edge.
-			while (loop_edges(node, &e));
-			// Get the element for the vertex list.
-			auto element = vertices.element_at_bucket(node);
-			// Add the element into the result list.
-			result.emplace(*element.value());
-			// Remove the element from the copy of the vertex list.
-			vertices.erase(*element.value());
-			// Traverse back up the graph.
-			node = e.from;
-
-			// When the node is set to -1 in "loop_edges" lambda, we fetch a new node from the vertex list.
-			if (node == -1 && vertices.size())
+			levels.offsets.push_back(static_cast<index_type>(levels.vertices.size()));
+		}
+
+		return levels;
+	}
+
+	/**
+	* Topological sort.
+	*
+	* Returns an ascending ordered list of T based on it's dependencies.
+	* If the graph is cyclic, the method returns an empty list.
+	*/
+	constexpr auto sort() const -> array<T, in_allocator>
+	{
+		array<T, in_allocator> result{ m_vertices.get_allocator() };
+		sort_result const order = topological_order();
+
+		if (order.acyclic())
+		{
+			result.reserve(order.order.size());
+
+			for (index_type const v : order.order)
 			{
-				node = vertices.bucket(*vertices.begin());
+				result.push_back(m_vertices[v]);
 			}
-		};
+		}
+
+		return result;
+	}
 
-		// Topological sort is only possible when the graph is acyclic.
-		// This means any of the vertices in the vertex list do not depend on themself.
-		if (is_acyclic())
+private:
+	array<T, in_allocator> m_vertices;
+	map<T, index_type, rebind_allocator_t<typename map_traits<T, index_type>::type>> m_indices;
+	set<uint64, rebind_allocator_t<uint64>> m_edgeKeys;
+	array<graph_edge, rebind_allocator_t<graph_edge>> m_edges;
+	mutable index_list m_offsets;	// Successors of vertex v are m_targets[m_offsets[v], m_offsets[v + 1]).
+	mutable index_list m_targets;
+	mutable bool m_dirty;
+
+	static constexpr auto _edge_key(index_type from, index_type to) -> uint64
+	{
+		return (static_cast<uint64>(from) << 32) | to;
+	}
+
+	/**
+	* Counting sort of the edges by their source vertex.
+	*/
+	constexpr auto _build_adjacency() const -> void
+	{
+		if (!m_dirty && m_offsets.size() == m_vertices.size() + 1)
+		{
+			return;
+		}
+
+		m_offsets.assign(m_vertices.size() + 1, 0);
+		m_targets.resize(m_edges.size());
+
+		for (graph_edge const& edge : m_edges)
+		{
+			++m_offsets[edge.from + 1];
+		}
+
+		for (size_t i = 1; i < m_offsets.size(); ++i)
+		{
+			m_offsets[i] += m_offsets[i - 1];
+		}
+
+		// Borrows the slot of the next vertex as the write cursor, then shifts the offsets back into place.
+		for (graph_edge const& edge : m_edges)
+		{
+			m_targets[m_offsets[edge.from]++] = edge.to;
+		}
+
+		for (size_t i = m_offsets.size() - 1; i > 0; --i)
+		{
+			m_offsets[i] = m_offsets[i - 1];
+		}
+		m_offsets[0] = 0;
+
+		m_dirty = false;
+	}
+
+	constexpr auto _in_degrees() const -> index_list
+	{
+		index_list inDegree{ m_vertices.size(), 0u, m_vertices.get_allocator() };
+
+		for (index_type const to : m_targets)
 		{
-			// Pick a "random" vertex from the vertices array so that we can start traversing the graph.
-			// "Node" and "Vertex" used interchangeably within the context of this function.
-			size_t node = vertices.bucket(*vertices.begin());
+			++inDegree[to];
+		}
 
-			// Continuously loop through the vertices until all of them have been visited.
-			while (vertices.length())
+		return inDegree;
+	}
+
+	/**
+	* Every vertex that Kahn's algorithm could not reach still has a predecessor that it could not reach either.
+	* Walking those predecessors backwards has to come back around to a vertex it has already been through.
+	*/
+	constexpr auto _find_cycle(index_list const& inDegree) const -> index_list
+	{
+		index_list cycle{ m_vertices.get_allocator() };
+		index_list predecessor{ m_vertices.size(), invalid_index_v, m_vertices.get_allocator() };
+		index_type start = invalid_index_v;
+
+		for (graph_edge const& edge : m_edges)
+		{
+			if (inDegree[edge.from] != 0 && inDegree[edge.to] != 0)
 			{
-				visit_node(node);
+				predecessor[edge.to] = edge.from;
+				start = edge.to;
 			}
+		}
 
-			// We reverse the contents of the array so that nodes that have no/minimal dependencies appear first in the array.
-			std::reverse(result.begin(), result.end());
+		if (start == invalid_index_v)
+		{
+			return cycle;
 		}
 
-		return result;
+		index_list visited{ m_vertices.size(), 0u, m_vertices.get_allocator() };
+		index_type v = start;
+
+		while (visited[v] == 0)
+		{
+			visited[v] = 1;
+			v = predecessor[v];
+		}
+
+		for (index_type const first = v; cycle.empty() || v != first; v = predecessor[v])
+		{
+			cycle.push_back(v);
+		}
+
+		std::reverse(cycle.begin(), cycle.end());
+
+		return cycle;
 	}
 };
 
@@ -429,6 +429,8 @@ public:
 		{
 			m_vtbl.op(fn::detail::Op::Move, &m_storage.accessor, &rhs.m_storage.accessor);
 		}
+		// The box belongs to this function now, rhs must not destroy it again.
+		rhs._reset();
 	}
 
 	constexpr auto operator=(function&& rhs) noexcept -> function&
@@ -439,6 +441,7 @@ public:
 
 			m_vtbl = std::move(rhs.m_vtbl);
 			m_storage = std::exchange(rhs.m_storage, {});
+			rhs._reset();
 		}
 		return *this;
 	}
@@ -1,15 +1,266 @@
 #pragma once
+#include <bit>
+#include <climits>
+#include <cstring>
 #include <limits>
+#include <span>
+#include <string>
+#include <string_view>
 #include <type_traits>
 #ifndef LIB_HPPASH_HPP
 #define LIB_HPPASH_HPP
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define LIB_HASH_AVX2 1
+#define LIB_HASH_SSE2 1
+#elif defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define LIB_HASH_AVX2 0
+#define LIB_HASH_SSE2 1
+#else
+#define LIB_HASH_AVX2 0
+#define LIB_HASH_SSE2 0
+#endif
+
+#if !defined(__SIZEOF_INT128__) && (defined(_M_X64) || defined(_M_AMD64))
+#include <intrin.h>
+#endif
+
 #include "memory.hpp"
 #include "utility.hpp"
 
 namespace lib
 {
 
+/**
+* @brief Full 64 x 64 -> 128 bit multiplication. The low half is returned in lo and the high half in hi.
+*/
+constexpr auto multiply_128(uint64 a, uint64 b, uint64& lo, uint64& hi) -> void
+{
+#if defined(__SIZEOF_INT128__)
+	// __int128 is a GCC and Clang extension, __extension__ keeps -pedantic from rejecting it.
+	__extension__ typedef unsigned __int128 uint128;
+
+	uint128 const product = static_cast<uint128>(a) * b;
+	lo = static_cast<uint64>(product);
+	hi = static_cast<uint64>(product >> 64);
+#else
+	if !consteval
+	{
+#if defined(_M_X64) || defined(_M_AMD64)
+		lo = _umul128(a, b, &hi);
+		return;
+#endif
+	}
+
+	uint64 const aLo = a & 0xFFFFFFFFull;
+	uint64 const aHi = a >> 32;
+	uint64 const bLo = b & 0xFFFFFFFFull;
+	uint64 const bHi = b >> 32;
+
+	uint64 const ll = aLo * bLo;
+	uint64 const lh = aLo * bHi;
+	uint64 const hl = aHi * bLo;
+	uint64 const hh = aHi * bHi;
+
+	uint64 const mid = (ll >> 32) + (lh & 0xFFFFFFFFull) + (hl & 0xFFFFFFFFull);
+
+	lo = (mid << 32) | (ll & 0xFFFFFFFFull);
+	hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+#endif
+}
+
+/**
+* @brief Multiplies both values into 128 bits and folds the halves together.
+*/
+constexpr auto hash_fold(uint64 a, uint64 b) -> uint64
+{
+	uint64 lo = 0;
+	uint64 hi = 0;
+
+	multiply_128(a, b, lo, hi);
+
+	return lo ^ hi;
+}
+
+/**
+* @brief Mixes a single 64 bit value so that every input bit affects every output bit.
+*/
+constexpr auto hash_mix(uint64 value) -> uint64
+{
+	return hash_fold(value, 0x9E3779B97F4A7C15ull);
+}
+
+/**
+* @brief wyhash (https://github.com/wangyi-fudan/wyhash).
+*/
+inline auto hash_bytes(void const* data, size_t length, uint64 seed = 0) -> uint64
+{
+	static constexpr uint64 secret[4] = { 0x2D358DCCAA6C78A5ull, 0x8BB84B93962EACC9ull, 0x4B33A62ED433D4A3ull, 0x4D5A2DA51DE1AA47ull };
+
+	auto read_64 = [](std::byte const* p) -> uint64
+	{
+		uint64 value;
+		std::memcpy(&value, p, sizeof(uint64));
+		return value;
+	};
+
+	auto read_32 = [](std::byte const* p) -> uint64
+	{
+		uint32 value;
+		std::memcpy(&value, p, sizeof(uint32));
+		return value;
+	};
+
+	std::byte const* p = static_cast<std::byte const*>(data);
+
+	uint64 a = 0;
+	uint64 b = 0;
+
+	seed ^= hash_fold(seed ^ secret[0], secret[1]);
+
+	if (length <= 16)
+	{
+		if (length >= 4)
+		{
+			size_t const offset = (length >> 3) << 2;
+
+			a = (read_32(p) << 32) | read_32(p + offset);
+			b = (read_32(p + length - 4) << 32) | read_32(p + length - 4 - offset);
+		}
+		else if (length > 0)
+		{
+			a = (std::to_integer<uint64>(p[0]) << 16) | (std::to_integer<uint64>(p[length >> 1]) << 8) | std::to_integer<uint64>(p[length - 1]);
+		}
+	}
+	else
+	{
+		size_t remaining = length;
+
+		if (remaining > 48)
+		{
+			uint64 see1 = seed;
+			uint64 see2 = seed;
+
+			do
+			{
+				seed = hash_fold(read_64(p) ^ secret[1], read_64(p + 8) ^ seed);
+				see1 = hash_fold(read_64(p + 16) ^ secret[2], read_64(p + 24) ^ see1);
+				see2 = hash_fold(read_64(p + 32) ^ secret[3], read_64(p + 40) ^ see2);
+
+				p += 48;
+				remaining -= 48;
+			} while (remaining > 48);
+
+			seed ^= see1 ^ see2;
+		}
+
+		while (remaining > 16)
+		{
+			seed = hash_fold(read_64(p) ^ secret[1], read_64(p + 8) ^ seed);
+
+			p += 16;
+			remaining -= 16;
+		}
+
+		a = read_64(p + remaining - 16);
+		b = read_64(p + remaining - 8);
+	}
+
+	a ^= secret[1];
+	b ^= seed;
+
+	multiply_128(a, b, a, b);
+
+	return hash_fold(a ^ secret[0] ^ length, b ^ secret[1]);
+}
+
+/**
+* @brief Default hasher of lib containers. Produces 64 bit hashes that avalanche, which lets the containers reduce them with a mask.
+* Types without a specialization are hashed with std::hash and then mixed.
+*/
+template <typename T>
+struct hash
+{
+	using is_avalanching = void;
+
+	auto operator()(T const& value) const noexcept -> uint64
+	{
+		return hash_mix(static_cast<uint64>(std::hash<T>{}(value)));
+	}
+};
+
+template <typename T>
+requires (std::is_integral_v<T> || std::is_enum_v<T>)
+struct hash<T>
+{
+	using is_avalanching = void;
+
+	constexpr auto operator()(T value) const noexcept -> uint64
+	{
+		if constexpr (std::is_enum_v<T>)
+		{
+			return hash_mix(static_cast<uint64>(static_cast<std::underlying_type_t<T>>(value)));
+		}
+		else
+		{
+			return hash_mix(static_cast<uint64>(value));
+		}
+	}
+};
+
+template <typename T>
+struct hash<T*>
+{
+	using is_avalanching = void;
+
+	auto operator()(T* value) const noexcept -> uint64
+	{
+		return hash_mix(static_cast<uint64>(reinterpret_cast<uintptr_t>(value)));
+	}
+};
+
+/**
+* @brief Hashes the characters of a string. Transparent, any string type that converts to a std::basic_string_view can be used for lookups.
+*/
+template <typename char_type>
+struct string_hash
+{
+	using is_avalanching	= void;
+	using is_transparent	= void;
+
+	template <typename T>
+	requires std::is_constructible_v<std::basic_string_view<char_type>, T const&>
+	auto operator()(T const& str) const noexcept -> uint64
+	{
+		std::basic_string_view<char_type> const view{ str };
+		return hash_bytes(view.data(), view.size() * sizeof(char_type));
+	}
+};
+
+template <typename char_type, typename traits>
+struct hash<std::basic_string_view<char_type, traits>> : string_hash<char_type> {};
+
+template <typename char_type, typename traits, typename allocator_type>
+struct hash<std::basic_string<char_type, traits, allocator_type>> : string_hash<char_type> {};
+
+/**
+* @brief Lookup keys that can be used in place of key_type. Requires the hasher to be transparent and the key to be comparable with key_type.
+*/
+template <typename K, typename hasher, typename key_type>
+concept transparent_key = 
+	!std::same_as<std::remove_cvref_t<K>, key_type> &&
+	requires { typename hasher::is_transparent; } && 
+	requires (hasher const& h, K const& key, key_type const& other)
+	{
+		h(key);
+		{ other == key } -> std::convertible_to<bool>;
+	};
+
+template <typename hasher>
+concept avalanching_hasher = requires { typename hasher::is_avalanching; };
+
 template <size_t limit>
 struct probe_sequence_length_limit
 {
@@ -22,6 +273,147 @@ struct load_factor_limit
 	static constexpr float32 value = factor;
 };
 
+/**
+* @brief Linear probing with Robin Hood displacement and backward shifting deletion. Every bucket caches its key's hash and probe sequence length.
+*/
+struct robin_hood_layout
+{
+	using load_factor = load_factor_limit<0.75f>;
+};
+
+/**
+* @brief Open addressing with one control byte per bucket, holding 7 bits of the key's hash or the empty / deleted state.
+* Lookups match a whole group of control bytes at a time, 32 with AVX2, 16 with SSE2 and 8 otherwise, and only compare keys whose 7 bits matched.
+* Capacity is always a power of two.
+*/
+struct group_probing_layout
+{
+	using load_factor = load_factor_limit<0.875f>;
+};
+
+/**
+* @brief A group of control bytes of a group_probing_layout container, loaded at once.
+* Matches are returned as a bit mask, use index() to convert the lowest set bit into an offset within the group.
+*/
+struct control_group
+{
+	using control_type = uint8;
+
+	static constexpr control_type empty_v	= 0x80;
+	static constexpr control_type deleted_v	= 0xFE;
+
+#if LIB_HASH_AVX2
+	using mask_type = uint32;
+
+	static constexpr size_t width = 32;
+	static constexpr uint32 shift = 0;
+
+	__m256i controls;
+
+	explicit control_group(control_type const* data) :
+		controls{ _mm256_loadu_si256(reinterpret_cast<__m256i const*>(data)) }
+	{}
+
+	auto match(control_type h2) const -> mask_type
+	{
+		return static_cast<mask_type>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_set1_epi8(static_cast<char>(h2)), controls)));
+	}
+
+	auto match_empty() const -> mask_type
+	{
+		return match(empty_v);
+	}
+
+	auto match_empty_or_deleted() const -> mask_type
+	{
+		// Empty and deleted are the only negative control values apart from -1, which is never stored.
+		return static_cast<mask_type>(_mm256_movemask_epi8(_mm256_cmpgt_epi8(_mm256_set1_epi8(-1), controls)));
+	}
+#elif LIB_HASH_SSE2
+	using mask_type = uint32;
+
+	static constexpr size_t width = 16;
+	static constexpr uint32 shift = 0;
+
+	__m128i controls;
+
+	explicit control_group(control_type const* data) :
+		controls{ _mm_loadu_si128(reinterpret_cast<__m128i const*>(data)) }
+	{}
+
+	auto match(control_type h2) const -> mask_type
+	{
+		return static_cast<mask_type>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(h2)), controls)));
+	}
+
+	auto match_empty() const -> mask_type
+	{
+		return match(empty_v);
+	}
+
+	auto match_empty_or_deleted() const -> mask_type
+	{
+		// Empty and deleted are the only negative control values apart from -1, which is never stored.
+		return static_cast<mask_type>(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), controls)));
+	}
+#else
+	using mask_type = uint64;
+
+	static constexpr size_t width = 8;
+	static constexpr uint32 shift = 3;
+
+	static constexpr uint64 lsbs = 0x0101010101010101ull;
+	static constexpr uint64 msbs = 0x8080808080808080ull;
+
+	uint64 controls;
+
+	explicit control_group(control_type const* data) :
+		controls{}
+	{
+		// Assumes a little endian target, the first control byte has to end up in the lowest bits.
+		std::memcpy(&controls, data, sizeof(uint64));
+	}
+
+	auto match(control_type h2) const -> mask_type
+	{
+		// Can report a false positive next to a real match, which is harmless since keys are compared afterwards.
+		uint64 const x = controls ^ (lsbs * h2);
+		return (x - lsbs) & ~x & msbs;
+	}
+
+	auto match_empty() const -> mask_type
+	{
+		return controls & ~(controls << 6) & msbs;
+	}
+
+	auto match_empty_or_deleted() const -> mask_type
+	{
+		return controls & ~(controls << 7) & msbs;
+	}
+#endif
+
+	static constexpr auto index(mask_type mask) -> size_t
+	{
+		return static_cast<size_t>(std::countr_zero(mask)) >> shift;
+	}
+
+	static constexpr auto next(mask_type mask) -> mask_type
+	{
+		return mask & (mask - 1);
+	}
+
+	static constexpr auto leading(mask_type mask) -> size_t
+	{
+		constexpr size_t unused = (sizeof(mask_type) * CHAR_BIT) - (width << shift);
+		return (static_cast<size_t>(std::countl_zero(mask)) - unused) >> shift;
+	}
+
+	static constexpr auto trailing(mask_type mask) -> size_t
+	{
+		return static_cast<size_t>(std::countr_zero(mask)) >> shift;
+	}
+};
+
 // TODO:
 // [x] Implement min, max and normal load factor.
 // [x] Figure out how to pack load factor variable without making the container exceed 40 bytes.
@@ -33,8 +425,9 @@ template <
 	typename hasher, 
 	std::derived_from<container_growth_policy> growth_policy, 
 	provides_memory allocator, 
+	typename layout = robin_hood_layout,
 	typename probe_distance_limit = probe_sequence_length_limit<4096>,
-	typename default_load_factor = load_factor_limit<0.75f>
+	typename default_load_factor = typename layout::load_factor
 >
 class hash_container_base
 {
@@ -49,16 +442,17 @@ protected:
 	using const_type			= type const;
 	using pointer				= type*;
 	using const_pointer			= type const*;
-	using interface_type		= std::conditional_t<std::is_same_v<key_type, value_type>, const_type, type>;
+	using interface_type		= std::conditional_t<std::is_same_v<type, key_type>, const_type, type>;
 	using allocator_type		= allocator;
 
 	static constexpr bucket_value_type invalid_bucket_v = std::numeric_limits<bucket_value_type>::max();
+	static constexpr size_t min_capacity_v = 8;
 
 	friend class hash_container_const_iterator;
 
 	struct bucket_info
 	{
-		hash_value_type	hash;		// Hash value for keys are cached to save computation time.
+		hash_value_type	hash;		// 32 bits of the key's hash, never 0. Compared before the keys themselves are.
 		uint32			psl;		// The value of each bucket's probe sequence length has to be cached for backshift deletion to work.
 
 		constexpr void reset() { hash = psl = 0; }
@@ -90,8 +484,8 @@ public:
 				// This logic is here to just skip empty buckets.
 				bucket_info* end = hash->m_box->metadata->pBucketInfo + hash->m_capacity;
 
-				while (info->is_empty() &&
-					   info != end)
+				while (info != end &&
+					   info->is_empty())
 				{
 					++info;
 				}
@@ -174,7 +568,7 @@ public:
 	}
 
 	constexpr hash_container_base(hash_container_base const& other) :
-		hash_container_base{ std::allocator_traits<allocator_type>::select_on_containere_copy_construction(other.m_box) }
+		hash_container_base{ std::allocator_traits<allocator_type>::select_on_container_copy_construction(other.m_box) }
 	{
 		_deep_copy(other);
 	}
@@ -199,7 +593,7 @@ public:
 	{
 		if (this != &other)
 		{
-			_destruct(0, m_capacity);
+			_clear();
 			_deep_copy(other);
 		}
 		return *this;
@@ -241,10 +635,11 @@ public:
 			}
 		}
 
+		m_box->metadata = nullptr;
+		m_box->data = nullptr;
+
 		m_len = m_capacity = 0;
 		m_maxLoadFactor = default_load_factor::value;
-
-		m_box.~box_type();
 	}
 
 	constexpr size_t	size		() const { return m_len; }
@@ -260,6 +655,37 @@ public:
 		}
 	}
 
+	/**
+	* @brief Fills the histogram with the number of elements found after each probe length, i.e. histogram[i] counts the elements that sit i buckets past their ideal bucket.
+	* The last entry also counts every longer probe.
+	* @return The longest probe length.
+	*/
+	constexpr size_t probe_length_histogram(std::span<size_t> histogram) const
+	{
+		std::fill(histogram.begin(), histogram.end(), size_t{ 0 });
+
+		size_t longest = 0;
+
+		for (size_t i = 0; i < m_capacity; ++i)
+		{
+			bucket_info const& info = _info()[i];
+
+			if (info.is_empty())
+			{
+				continue;
+			}
+
+			longest = std::max<size_t>(longest, info.psl);
+
+			if (!histogram.empty())
+			{
+				++histogram[std::min<size_t>(info.psl, histogram.size() - 1)];
+			}
+		}
+
+		return longest;
+	}
+
 	iterator		begin	()		 { return iterator{ m_box->metadata ? m_box->metadata->pBucketInfo : nullptr, this }; }
 	iterator		end		()		 { return iterator{ m_box->metadata ? m_box->metadata->pBucketInfo + m_capacity : nullptr, this }; }
 	const_iterator	begin	() const { return const_iterator{ m_box->metadata ? m_box->metadata->pBucketInfo : nullptr, this }; }
@@ -285,6 +711,14 @@ protected:
 	constexpr bucket_info*	_info() const	{ return m_box->metadata->pBucketInfo; }
 	constexpr pointer		_data() const	{ return m_box->data; }
 
+	constexpr bool _is_occupied(bucket_value_type bucket) const { return bucket < m_capacity && !_info()[bucket].is_empty(); }
+
+	constexpr void _clear()
+	{
+		_destruct(0, m_capacity);
+		m_len = 0;
+	}
+
 	template <typename Arg>
 	constexpr void _destroy(Arg& element)
 	{
@@ -299,16 +733,7 @@ protected:
 			// Because not every bucket is filled, we need to check if the hash is actually set.
 			if (!m_box->metadata->pBucketInfo[i].is_empty())
 			{
-				if constexpr (std::is_same_v<key_type, value_type>)
-				{
-					_destroy(m_box->data[i]);
-				}
-				else
-				{
-					_destroy(m_box->data[i].first);
-					_destroy(m_box->data[i].second);
-				}
-				m_box->data[i].~type();
+				_destroy(m_box->data[i]);
 			}
 			m_box->metadata->pBucketInfo[i].reset();
 		}
@@ -323,12 +748,19 @@ protected:
 		}
 	}	
 
+	/**
+	* Rehashes into a power of two capacity that is at least the requested amount and can hold the current elements.
+	*/
 	constexpr void _reserve(size_t capacity)
 	{
 		using byte_allocator = typename std::allocator_traits<allocator_type>::template rebind_alloc<std::byte>;
 
 		byte_allocator byteAllocator{ m_box.resource() };
 
+		size_t const required = static_cast<size_t>(static_cast<float32>(m_len) / m_maxLoadFactor) + 1;
+
+		capacity = std::bit_ceil(std::max({ capacity, required, min_capacity_v }));
+
 		size_t const metadataCapacity = sizeof(metadata) + (sizeof(bucket_info) * capacity);
 		std::byte* pBuffer = std::allocator_traits<byte_allocator>::allocate(byteAllocator, metadataCapacity);
 
@@ -351,40 +783,34 @@ protected:
 		size_t const capacityOld = m_capacity;
 		m_capacity = capacity;
 
+		if (capacityOld == 0)
+		{
+			return;
+		}
+
 		// Rehash container when buckets are occupied.
 		if (size())
 		{
-			// hash container's length needs to be reassigned if the container is downsized.
-			if (size() > m_capacity)
-			{
-				m_len = m_capacity;
-			}
-
-			_rehash(dataOld, metadataOld->pBucketInfo, size());
-
-			// Destruct old elements that were not moved.
-			for (size_t i = 0; i < capacityOld; ++i)
-			{
-				dataOld[i].~type();
-			}
+			_rehash(dataOld, metadataOld->pBucketInfo, capacityOld);
+		}
 
-			if (metadataOld != nullptr)
-			{
-				std::allocator_traits<byte_allocator>::deallocate(byteAllocator, reinterpret_cast<std::byte*>(metadataOld), sizeof(metadata) * (sizeof(bucket_info) * capacityOld));
-			}
+		if (metadataOld != nullptr)
+		{
+			std::allocator_traits<byte_allocator>::deallocate(byteAllocator, reinterpret_cast<std::byte*>(metadataOld), sizeof(metadata) + (sizeof(bucket_info) * capacityOld));
+		}
 
-			if (dataOld != nullptr)
-			{
-				std::allocator_traits<allocator_type>::deallocate(m_box, dataOld, capacityOld);
-			}
+		if (dataOld != nullptr)
+		{
+			std::allocator_traits<allocator_type>::deallocate(m_box, dataOld, capacityOld);
 		}
 	}
 
 		
-	constexpr bucket_value_type _get_impl(key_type const& key) const
+	template <typename K = key_type>
+	constexpr bucket_value_type _get_impl(K const& key) const
 	{
 		bucket_value_type bucket = invalid_bucket_v;
-		if (m_capacity != 0)
+		if (m_len != 0)
 		{
 			std::optional res = _find_key(key);
 			if (res.has_value())
@@ -395,9 +821,29 @@ protected:
 		return bucket;
 	}
 
+	/**
+	* Elements with the same key are replaced.
+	*/
 	template <typename... Args>
 	constexpr bucket_value_type _emplace_internal(Args&&... arguments)
 	{
+		// Construct the to-be-inserted element once, its key is needed to look for an element to replace.
+		mutable_type element{ std::forward<Args>(arguments)... };
+
+		uint64 const hash = _hashify(traits::extract_key(element));
+
+		if (m_len != 0)
+		{
+			if (std::optional const bucket = _find_key(traits::extract_key(element), hash); bucket.has_value())
+			{
+				// The key is the same, so the bucket's hash and psl stay valid.
+				_destroy(m_box->data[bucket.value()]);
+				_construct_at(bucket.value(), element);
+
+				return bucket.value();
+			}
+		}
+
 		// Technically, now that we've added load factor in, we will never run out of empty buckets in the container.
 		if (!_num_free_buckets() || 
 			load_factor() > max_load_factor())
@@ -410,22 +856,21 @@ protected:
 		}
 		++m_len;
 
-		return _emplace_impl(std::forward<Args>(arguments)...);
+		return _emplace_impl(hash, std::move(element));
 	}
 
 	// Implementation of remove method.
 	// Backward shifting deletion.
-	constexpr bool _remove_impl(key_type const& key)
+	template <typename K = key_type>
+	constexpr bool _remove_impl(K const& key)
 	{
-		std::optional res = _find_key(key);
+		bucket_value_type bucket = _get_impl(key);
 
-		if (!res.has_value())
+		if (bucket == invalid_bucket_v)
 		{
 			return false;
 		}
 
-		bucket_value_type bucket = res.value();
-
 		_destruct(bucket, bucket + 1);
 		// Move the bucket to the next one so the object can be shifted down.
 		bucket = _next_bucket(bucket);
@@ -447,14 +892,19 @@ private:
 
 	constexpr auto _deep_copy(hash_container_base const& other) -> void
 	{
-		if (m_capacity < other.m_capacity)
+		if (other.m_len == 0)
 		{
-			_reserve(other.m_capacity);
+			return;
 		}
 
-		m_len = other.m_len;
+		// Buckets depend on the capacity, elements can only be copied into the same bucket when both capacities match.
+		if (m_capacity != other.m_capacity)
+		{
+			release();
+			_reserve(other.m_capacity);
+		}
 
-		[[maybe_unused]] size_t count = m_len;
+		m_maxLoadFactor = other.m_maxLoadFactor;
 
 		bucket_info* bucketInfo		= m_box->metadata->pBucketInfo;
 		bucket_info* rhsBucketInfo	= other.m_box->metadata->pBucketInfo;
@@ -466,10 +916,10 @@ private:
 				continue;
 			}
 			bucketInfo[i] = rhsBucketInfo[i];
-			reinterpret_cast<mutable_type&>(m_box->data[i]) = other.m_box->data[i];
-
-			--count;
+			new (m_box->data + i) type{ other.m_box->data[i] };
 		}
+
+		m_len = other.m_len;
 	}
 
 	// Helper function to swap contents.
@@ -483,12 +933,12 @@ private:
 			mutable_type& data = *reinterpret_cast<mutable_type*>(&m_box->data[bucket]);
 
 			std::memcpy(&tmp, &data, sizeof(mutable_type));
-			new (&data) mutable_type{ std::move(element.first), std::move(element.second) };
+			std::memcpy(&data, &element, sizeof(mutable_type));
 			std::memcpy(&element, &tmp, sizeof(mutable_type));
 		}
 		else
 		{
-			if constexpr (std::is_same_v<key_type, value_type>)
+			if constexpr (std::is_same_v<type, key_type>)
 			{
 				type& data = *const_cast<type*>(&m_box->data[bucket]);
 				mutable_type tmp{ std::move(data) };
@@ -512,27 +962,35 @@ private:
 
 		bucket_info& dst = m_box->metadata->pBucketInfo[bucket];
 
-		uint32 psl = dst.psl;
-		// Swap the contents of the bucket info.
-		dst.hash = info.hash;
-		dst.psl = info.psl;
-		// Update the current bucket's psl with the one that's being swapped out.
-		info.psl = psl;
+		// Swap the contents of the bucket info, the element being carried forward takes the evicted element's hash and psl.
+		std::swap(dst, info);
+	}
+
+	// Moves the element into a bucket whose previous element, if any, has already been destroyed.
+	constexpr void _construct_at(bucket_value_type bucket, mutable_type& element)
+	{
+		if constexpr (std::is_same_v<type, key_type>)
+		{
+			new (m_box->data + bucket) type{ std::move(element) };
+		}
+		else
+		{
+			new (m_box->data + bucket) type{ std::move(element.first), std::move(element.second) };
+		}
 	}
 
 	// Implementation of emplace method.
 	// For a map, arguments NEEDS to be a std::pair or Pair struct with a key() method specified.
 	template <typename... Args>
-	constexpr bucket_value_type _emplace_impl(Args&&... args)
+	constexpr bucket_value_type _emplace_impl(uint64 hash, Args&&... args)
 	{
 		// Construct the to-be-inserted element once.
 		mutable_type element{ std::forward<Args>(args)... };
 
-		hash_value_type const hash = _hashify(traits::extract_key(element));
 		bucket_info* p_info = _info();
 		bucket_value_type bucket = _bucket_for_hash(hash);
 
-		bucket_info inserting_info{ .hash = hash };
+		bucket_info inserting_info{ .hash = _fingerprint(hash), .psl = 0 };
 		bucket_value_type first_swapped_bucket = std::numeric_limits<bucket_value_type>::max();
 
 		while (!p_info[bucket].is_empty())
@@ -554,15 +1012,7 @@ private:
 			++inserting_info.psl;
 		}
 
-		// Store the element.
-		if constexpr (std::is_same_v<key_type, value_type>)
-		{
-			new (m_box->data + bucket) type{ std::move(element) };
-		}
-		else
-		{
-			new (m_box->data + bucket) type{ std::move(element.first), std::move(element.second) };
-		}
+		_construct_at(bucket, element);
 
 		p_info[bucket].hash = inserting_info.hash;
 		p_info[bucket].psl	= inserting_info.psl;
@@ -570,40 +1020,44 @@ private:
 		return (first_swapped_bucket != std::numeric_limits<bucket_value_type>::max()) ? first_swapped_bucket : bucket;
 	}
 
-	constexpr void _rehash(type* sourceData, bucket_info* sourceInfo, size_t count)
+	constexpr void _rehash(type* sourceData, bucket_info* sourceInfo, size_t sourceCapacity)
 	{
-		for (size_t i = 0; count != 0 && i < m_capacity; ++i)
+		for (size_t i = 0; i < sourceCapacity; ++i)
 		{
 			// hash value of 0 means the bucket is empty.
 			if (sourceInfo[i].is_empty()) 
 			{ 
 				continue; 
 			}
-			_emplace_impl(std::move(sourceData[i]));
-			--count;
+			mutable_type& element = reinterpret_cast<mutable_type&>(sourceData[i]);
+
+			_emplace_impl(_hashify(traits::extract_key(element)), std::move(element));
+			sourceData[i].~type();
 		}
 	}
 
 	constexpr bucket_value_type _previous_bucket(bucket_value_type current) const
 	{
-		bucket_value_type bucket = current - 1;
-		if (bucket == std::numeric_limits<bucket_value_type>::max())
-		{
-			bucket = m_capacity - 1;
-		}
-		return bucket % m_capacity;
+		return (current - 1) & (m_capacity - 1);
 	}
 
 
 	constexpr bucket_value_type _next_bucket(bucket_value_type current) const
 	{
-		return (current + 1) % m_capacity;
+		return (current + 1) & (m_capacity - 1);
 	}
 
 
-	constexpr std::optional<bucket_value_type> _find_key(key_type const& key) const
+	template <typename K>
+	constexpr std::optional<bucket_value_type> _find_key(K const& key) const
 	{
-		const hash_value_type hash = _hashify(key);
+		return _find_key(key, _hashify(key));
+	}
+
+	template <typename K>
+	constexpr std::optional<bucket_value_type> _find_key(K const& key, uint64 hash) const
+	{
+		hash_value_type const fingerprint = _fingerprint(hash);
 
 		bucket_value_type bucket = _bucket_for_hash(hash);
 		size_t probeSequence = 0;
@@ -613,7 +1067,8 @@ private:
 		while (probeSequence <= p_info[bucket].psl &&
 			!p_info[bucket].is_empty())
 		{
-			if (traits::compare_keys(key, traits::extract_key(m_box->data[bucket])))
+			if (p_info[bucket].hash == fingerprint &&
+				traits::compare_keys(key, traits::extract_key(m_box->data[bucket])))
 			{
 				return std::make_optional(bucket);
 			}
@@ -626,71 +1081,672 @@ private:
 	constexpr void _back_shift_bucket(size_t to, size_t from)
 	{
 		bucket_info* p_info = _info();
-		p_info[to] = std::move(p_info[from]);
+		p_info[to] = p_info[from];
+
+		// The destination bucket has already been destructed, so the element is moved into it and the source is destroyed after.
+		new (m_box->data + to) type{ std::move(reinterpret_cast<mutable_type&>(m_box->data[from])) };
+
+		// Reduce the bucket's psl by 1.
+		--p_info[to].psl;
+		_destruct(from, from + 1);
+	}
+
+	constexpr size_t _num_free_buckets() const
+	{
+		return m_capacity - size();
+	}
 
-		if constexpr (std::is_trivially_copyable_v<key_type> && std::is_trivially_copyable_v<value_type>)
+	constexpr bucket_value_type _bucket_for_hash(uint64 hash) const
+	{
+		if constexpr (avalanching_hasher<hasher>)
 		{
-			std::memcpy(&const_cast<key_type&>(m_box->data[to].first), &const_cast<key_type&>(m_box->data[from].first), sizeof(key_type));
-			// Take sets into account.
-			if constexpr (!std::is_same_v<key_type, value_type>)
-			{
-				std::memcpy(&m_box->data[to].second, &m_box->data[from].second, sizeof(value_type));
+			return static_cast<bucket_value_type>(hash & (m_capacity - 1));
+		}
+		else
+		{
+			// Fibonacci hashing, the multiplication spreads the hasher's low quality bits into the top bits which are then used as the bucket.
+			return static_cast<bucket_value_type>((hash * 0x9E3779B97F4A7C15ull) >> std::countl_zero(m_capacity - 1));
+		}
+	}
+
+	template <typename K>
+	constexpr uint64 _hashify(K const& key) const
+	{
+		return static_cast<uint64>(hasher{}(key));
+	}
+
+	static constexpr hash_value_type _fingerprint(uint64 hash)
+	{
+		// Taken from the bits that do not pick the bucket. The lowest bit is set so that 0 keeps meaning empty.
+		return static_cast<hash_value_type>(hash >> 32) | 1u;
+	}
+
+	constexpr bool _grow_on_next_insert() const
+	{
+		return m_box->metadata->growOnNextInsert;
+	}
+
+	constexpr void _toggle_grow_on_next_insert()
+	{
+		m_box->metadata->growOnNextInsert ^= true;
+	}
+};
+
+
+/**
+* @brief hash_container_base using group_probing_layout.
+* Buckets are probed a control group at a time with triangular steps between groups. Erased buckets become tombstones unless no probe sequence could have passed through them.
+*/
+template <
+	typename traits, 
+	typename hasher, 
+	std::derived_from<container_growth_policy> growth_policy, 
+	provides_memory allocator, 
+	typename probe_distance_limit,
+	typename default_load_factor
+>
+class hash_container_base<traits, hasher, growth_policy, allocator, group_probing_layout, probe_distance_limit, default_load_factor>
+{
+protected:
+
+	using hash_value_type		= uint64;
+	using bucket_value_type		= size_t;
+	using control_type			= control_group::control_type;
+	using key_type				= typename traits::key_type;
+	using value_type			= typename traits::value_type;
+	using type					= typename traits::type;
+	using mutable_type			= typename traits::mutable_type;
+	using const_type			= type const;
+	using pointer				= type*;
+	using const_pointer			= type const*;
+	using interface_type		= std::conditional_t<std::is_same_v<type, key_type>, const_type, type>;
+	using allocator_type		= allocator;
+
+	static constexpr bucket_value_type invalid_bucket_v = std::numeric_limits<bucket_value_type>::max();
+	static constexpr size_t group_width_v = control_group::width;
+
+	friend class hash_container_const_iterator;
+
+public:
+
+	struct hash_container_const_iterator
+	{
+		using pointer	= type const*;
+		using reference	= type const&;
+
+		constexpr hash_container_const_iterator() = default;
+		constexpr ~hash_container_const_iterator() = default;
+
+		constexpr hash_container_const_iterator(control_type const* data, hash_container_base const* hash_map) :
+			control{ data }, hash{ hash_map }
+		{
+			if (data)
+			{
+				control_type const* end = hash->_control() + hash->m_capacity;
+
+				while (control != end && 
+					!_is_full(*control))
+				{
+					++control;
+				}
 			}
 		}
-		else 
+
+		hash_container_const_iterator(hash_container_const_iterator const&)				= default;
+		hash_container_const_iterator(hash_container_const_iterator&&)					= default;
+		hash_container_const_iterator& operator=(hash_container_const_iterator const&)	= default;
+		hash_container_const_iterator& operator=(hash_container_const_iterator&&)		= default;
+
+		friend constexpr bool operator== (hash_container_const_iterator const& lhs, hash_container_const_iterator const& rhs)
+		{
+			return  lhs.control == rhs.control;
+		}
+
+		constexpr reference	operator* () const { return hash->_data()[bucket()]; }
+		constexpr pointer	operator->() const { return &hash->_data()[bucket()]; }
+
+		constexpr bucket_value_type bucket() const { return static_cast<bucket_value_type>(control - hash->_control()); }
+
+		constexpr hash_container_const_iterator& operator++()
+		{
+			control_type const* end = hash->_control() + hash->m_capacity;
+
+			do
+			{
+				++control;
+			} while (control != end && !_is_full(*control));
+
+			return *this;
+		}
+
+		control_type const* control;
+		hash_container_base const* hash;
+	};
+
+	struct hash_container_iterator : hash_container_const_iterator
+	{
+		using super		= hash_container_const_iterator;
+		using pointer	= type*;
+		using reference = type&;
+
+		using super::hash_container_const_iterator;
+
+		constexpr reference	operator* () const { return this->hash->_data()[this->bucket()]; }
+		constexpr pointer	operator->() const { return &this->hash->_data()[this->bucket()]; }
+	};
+
+	using iterator			= hash_container_iterator;
+	using const_iterator	= hash_container_const_iterator;
+
+	constexpr hash_container_base() :
+		m_box{}, 
+		m_len{}, 
+		m_capacity{}, 
+		m_growthLeft{},
+		m_maxLoadFactor{ default_load_factor::value }
+	{}
+
+	constexpr hash_container_base(allocator_type const& in_allocator) :
+		m_box{ stored_type{}, in_allocator }, 
+		m_len{}, 
+		m_capacity{},
+		m_growthLeft{},
+		m_maxLoadFactor{ default_load_factor::value }
+	{}
+
+	constexpr ~hash_container_base() { release(); }
+
+	constexpr hash_container_base(size_t length, allocator_type const& in_allocator = allocator_type{}) :
+		hash_container_base{ in_allocator }
+	{
+		_reserve(length);
+	}
+
+	constexpr hash_container_base(hash_container_base const& other) :
+		hash_container_base{ std::allocator_traits<allocator_type>::select_on_container_copy_construction(other.m_box) }
+	{
+		_deep_copy(other);
+	}
+
+	constexpr hash_container_base(hash_container_base&& other) :
+		m_box{ std::exchange(other.m_box, {}) },
+		m_len{ std::exchange(other.m_len, {}) },
+		m_capacity{ std::exchange(other.m_capacity, {}) },
+		m_growthLeft{ std::exchange(other.m_growthLeft, {}) },
+		m_maxLoadFactor{ std::exchange(other.m_maxLoadFactor, default_load_factor::value) }
+	{}
+
+	constexpr hash_container_base(std::initializer_list<type> const& initializer, allocator_type const& in_allocator = allocator_type{}) :
+		hash_container_base{ in_allocator }
+	{
+		for (type const& pair : initializer)
+		{
+			_emplace_internal(pair);
+		}
+	}
+
+	hash_container_base& operator=(hash_container_base const& other)
+	{
+		if (this != &other)
 		{
-			if constexpr (std::is_move_assignable_v<key_type>)
+			_clear();
+			_deep_copy(other);
+		}
+		return *this;
+	}
+
+	hash_container_base& operator=(hash_container_base&& other)
+	{
+		if (this != &other)
+		{
+			release();
+
+			m_box = std::exchange(other.m_box, {});
+			m_len = std::exchange(other.m_len, {});
+			m_capacity = std::exchange(other.m_capacity, {});
+			m_growthLeft = std::exchange(other.m_growthLeft, {});
+			m_maxLoadFactor = std::exchange(other.m_maxLoadFactor, default_load_factor::value);
+		}
+		return *this;
+	}
+
+	constexpr void release()
+	{
+		if (m_capacity)
+		{
+			_destruct(0, m_capacity);
+			_deallocate(m_box->control, m_box->data, m_capacity);
+		}
+
+		m_box->control = nullptr;
+		m_box->data = nullptr;
+
+		m_len = m_capacity = m_growthLeft = 0;
+		m_maxLoadFactor = default_load_factor::value;
+	}
+
+	constexpr size_t	size		() const { return m_len; }
+	constexpr size_t	capacity	() const { return m_capacity; }
+	constexpr bool		empty		() const { return m_len == 0; }
+	constexpr float32	load_factor	() const { return static_cast<float32>(m_len) / static_cast<float32>(m_capacity); }
+	constexpr float32	max_load_factor() const { return m_maxLoadFactor; }
+	/**
+	* @brief Takes effect the next time the container rehashes.
+	*/
+	constexpr void		max_load_factor(float32 factor) 
+	{
+		if (factor > 0.f && factor < 1.f)
+		{
+			m_maxLoadFactor = factor; 
+		}
+	}
+
+	/**
+	* @brief Fills the histogram with the number of elements found after each probe length, i.e. histogram[i] counts the elements that sit i groups past their ideal group.
+	* The last entry also counts every longer probe.
+	* @return The longest probe length.
+	*/
+	constexpr size_t probe_length_histogram(std::span<size_t> histogram) const
+	{
+		std::fill(histogram.begin(), histogram.end(), size_t{ 0 });
+
+		size_t longest = 0;
+		size_t const mask = m_capacity - 1;
+
+		for (size_t i = 0; i < m_capacity; ++i)
+		{
+			if (!_is_full(_control()[i]))
 			{
-				const_cast<key_type&>(m_box->data[to].first) = std::move(const_cast<key_type&>(m_box->data[from].first));
+				continue;
 			}
-			else 
+
+			size_t position = _h1(_hashify(traits::extract_key(m_box->data[i]))) & mask;
+			size_t stride = 0;
+			size_t probes = 0;
+
+			// Retrace the probe sequence until it reaches the group that holds the bucket.
+			while (((i - position) & mask) >= group_width_v)
 			{
-				const_cast<key_type&>(m_box->data[to].first) = m_box->data[from].first;
-				const_cast<key_type&>(m_box->data[from].first).~key_type();
+				stride += group_width_v;
+				position = (position + stride) & mask;
+				++probes;
 			}
-			
-			if constexpr (!std::is_same_v<key_type, value_type>)
+
+			longest = std::max(longest, probes);
+
+			if (!histogram.empty())
 			{
-				if constexpr (std::is_move_assignable_v<value_type>)
-				{
-					m_box->data[to].second = std::move(m_box->data[from].second);
-				}
-				else
+				++histogram[std::min(probes, histogram.size() - 1)];
+			}
+		}
+
+		return longest;
+	}
+
+	iterator		begin	()		 { return iterator{ m_box->control, this }; }
+	iterator		end		()		 { return iterator{ m_box->control ? m_box->control + m_capacity : nullptr, this }; }
+	const_iterator	begin	() const { return const_iterator{ m_box->control, this }; }
+	const_iterator	end		() const { return const_iterator{ m_box->control ? m_box->control + m_capacity : nullptr, this }; }
+	const_iterator	cbegin	() const { return const_iterator{ m_box->control, this }; }
+	const_iterator	cend	() const { return const_iterator{ m_box->control ? m_box->control + m_capacity : nullptr, this }; }
+
+protected:
+
+	struct stored_type
+	{
+		control_type* control;
+		pointer data;
+	};
+
+	using box_type = box<stored_type, allocator_type>;
+
+	box_type m_box;
+	size_t	m_len;
+	size_t	m_capacity;
+	size_t	m_growthLeft;	// Number of empty buckets that can still be claimed before the container has to rehash.
+	float32 m_maxLoadFactor;
+
+	constexpr control_type*	_control() const	{ return m_box->control; }
+	constexpr pointer		_data() const		{ return m_box->data; }
+
+	constexpr bool _is_occupied(bucket_value_type bucket) const { return bucket < m_capacity && _is_full(_control()[bucket]); }
+
+	constexpr void _destruct(size_t from, size_t to)
+	{
+		control_type* control = _control();
+
+		for (size_t i = from; i < to; ++i)
+		{
+			if (_is_full(control[i]))
+			{
+				_destroy_at(i);
+			}
+		}
+	}
+
+	constexpr void _clear()
+	{
+		if (m_capacity == 0)
+		{
+			return;
+		}
+
+		_destruct(0, m_capacity);
+		std::memset(_control(), control_group::empty_v, m_capacity + group_width_v);
+
+		m_len = 0;
+		m_growthLeft = _growth_limit(m_capacity);
+	}
+
+	/**
+	* Rehashes into a power of two capacity that is at least the requested amount and can hold the current elements.
+	*/
+	constexpr void _reserve(size_t capacity)
+	{
+		size_t const required = static_cast<size_t>(static_cast<float32>(m_len) / m_maxLoadFactor) + 1;
+
+		_rehash(std::bit_ceil(std::max({ capacity, required, group_width_v })));
+	}
+
+	template <typename K = key_type>
+	constexpr bucket_value_type _get_impl(K const& key) const
+	{
+		if (m_len == 0)
+		{
+			return invalid_bucket_v;
+		}
+		return _find_key(key, _hashify(key));
+	}
+
+	/**
+	* Elements with the same key are replaced.
+	*/
+	template <typename... Args>
+	constexpr bucket_value_type _emplace_internal(Args&&... arguments)
+	{
+		// Construct the to-be-inserted element once.
+		mutable_type element{ std::forward<Args>(arguments)... };
+
+		hash_value_type const hash = _hashify(traits::extract_key(element));
+
+		if (m_len != 0)
+		{
+			if (bucket_value_type const bucket = _find_key(traits::extract_key(element), hash); bucket != invalid_bucket_v)
+			{
+				_destroy_at(bucket);
+				_construct_at(bucket, std::move(element));
+
+				return bucket;
+			}
+		}
+
+		bucket_value_type bucket = (m_capacity != 0) ? _find_free_bucket(hash) : invalid_bucket_v;
+
+		// Reusing a tombstone does not use up an empty bucket, so only claiming an empty one needs to be paid for.
+		if (bucket == invalid_bucket_v || 
+			(m_growthLeft == 0 && _control()[bucket] == control_group::empty_v))
+		{
+			_grow();
+			bucket = _find_free_bucket(hash);
+		}
+
+		if (_control()[bucket] == control_group::empty_v)
+		{
+			--m_growthLeft;
+		}
+
+		_set_control(bucket, _h2(hash));
+		_construct_at(bucket, std::move(element));
+		++m_len;
+
+		return bucket;
+	}
+
+	template <typename K = key_type>
+	constexpr bool _remove_impl(K const& key)
+	{
+		bucket_value_type const bucket = _get_impl(key);
+
+		if (bucket == invalid_bucket_v)
+		{
+			return false;
+		}
+
+		_destroy_at(bucket);
+
+		// The bucket can go back to being empty if it never filled up a whole group window, since no probe sequence would have continued past it.
+		size_t const mask = m_capacity - 1;
+		control_group::mask_type const emptyBefore = control_group{ _control() + ((bucket - group_width_v) & mask) }.match_empty();
+		control_group::mask_type const emptyAfter = control_group{ _control() + bucket }.match_empty();
+
+		if (emptyBefore && 
+			emptyAfter && 
+			(control_group::trailing(emptyAfter) + control_group::leading(emptyBefore)) < group_width_v)
+		{
+			_set_control(bucket, control_group::empty_v);
+			++m_growthLeft;
+		}
+		else
+		{
+			_set_control(bucket, control_group::deleted_v);
+		}
+
+		--m_len;
+
+		return true;
+	}
+
+private:
+
+	static constexpr bool _is_full(control_type control) { return (control & 0x80) == 0; }
+
+	static constexpr control_type _h2(hash_value_type hash) { return static_cast<control_type>(hash & 0x7F); }
+
+	static constexpr hash_value_type _h1(hash_value_type hash) { return hash >> 7; }
+
+	template <typename K>
+	constexpr hash_value_type _hashify(K const& key) const
+	{
+		if constexpr (avalanching_hasher<hasher>)
+		{
+			return static_cast<hash_value_type>(hasher{}(key));
+		}
+		else
+		{
+			// std::hash is the identity for integers, which would put consecutive keys in the same group with the same 7 bits.
+			return hash_mix(static_cast<hash_value_type>(hasher{}(key)));
+		}
+	}
+
+	constexpr size_t _growth_limit(size_t capacity) const
+	{
+		// At least one bucket is always kept empty so that every probe sequence terminates.
+		return std::min(static_cast<size_t>(static_cast<float32>(capacity) * m_maxLoadFactor), capacity - 1);
+	}
+
+	constexpr void _set_control(bucket_value_type bucket, control_type control)
+	{
+		_control()[bucket] = control;
+
+		// The first group is mirrored after the last bucket so groups can be loaded past the end without wrapping.
+		if (bucket < group_width_v)
+		{
+			_control()[m_capacity + bucket] = control;
+		}
+	}
+
+	template <typename K>
+	constexpr bucket_value_type _find_key(K const& key, hash_value_type hash) const
+	{
+		size_t const mask = m_capacity - 1;
+		size_t position = _h1(hash) & mask;
+		size_t stride = 0;
+
+		control_type const h2 = _h2(hash);
+
+		while (true)
+		{
+			control_group const group{ _control() + position };
+
+			for (auto match = group.match(h2); match != 0; match = control_group::next(match))
+			{
+				bucket_value_type const bucket = (position + control_group::index(match)) & mask;
+
+				if (traits::compare_keys(key, traits::extract_key(m_box->data[bucket])))
 				{
-					m_box->data[to].second = m_box->data[from].second;
-					m_box->data[from].second.~value_type();
+					return bucket;
 				}
 			}
+
+			if (group.match_empty())
+			{
+				return invalid_bucket_v;
+			}
+
+			// Triangular steps visit every group once when the capacity is a power of two.
+			stride += group_width_v;
+			position = (position + stride) & mask;
 		}
+	}
 
-		// Reduce the bucket's psl by 1.
-		--p_info[to].psl;
-		_destruct(from, from + 1);
+	constexpr bucket_value_type _find_free_bucket(hash_value_type hash) const
+	{
+		size_t const mask = m_capacity - 1;
+		size_t position = _h1(hash) & mask;
+		size_t stride = 0;
+
+		while (true)
+		{
+			if (auto const free = control_group{ _control() + position }.match_empty_or_deleted(); free != 0)
+			{
+				return (position + control_group::index(free)) & mask;
+			}
+
+			stride += group_width_v;
+			position = (position + stride) & mask;
+		}
 	}
 
-	constexpr size_t _num_free_buckets() const
+	constexpr void _grow()
 	{
-		return m_capacity - size();
+		// Mostly tombstones, clean them up without growing.
+		if (m_capacity != 0 && m_len < (_growth_limit(m_capacity) / 2))
+		{
+			_rehash(m_capacity);
+		}
+		else
+		{
+			_reserve(std::max(growth_policy::new_capacity(m_capacity), m_capacity + 1));
+		}
+	}
+
+	constexpr void _rehash(size_t capacity)
+	{
+		using byte_allocator = typename std::allocator_traits<allocator_type>::template rebind_alloc<std::byte>;
+
+		byte_allocator byteAllocator{ m_box.resource() };
+
+		control_type* controlOld = _control();
+		pointer dataOld = _data();
+		size_t const capacityOld = m_capacity;
+
+		m_box->control = reinterpret_cast<control_type*>(std::allocator_traits<byte_allocator>::allocate(byteAllocator, capacity + group_width_v));
+		m_box->data = std::allocator_traits<allocator_type>::allocate(m_box, capacity);
+
+		std::memset(m_box->control, control_group::empty_v, capacity + group_width_v);
+
+		m_capacity = capacity;
+		m_growthLeft = _growth_limit(capacity) - m_len;
+
+		if (capacityOld == 0)
+		{
+			return;
+		}
+
+		for (size_t i = 0; i < capacityOld; ++i)
+		{
+			if (!_is_full(controlOld[i]))
+			{
+				continue;
+			}
+
+			mutable_type& element = reinterpret_cast<mutable_type&>(dataOld[i]);
+
+			hash_value_type const hash = _hashify(traits::extract_key(element));
+			bucket_value_type const bucket = _find_free_bucket(hash);
+
+			_set_control(bucket, _h2(hash));
+			_construct_at(bucket, std::move(element));
+
+			dataOld[i].~type();
+		}
+
+		_deallocate(controlOld, dataOld, capacityOld);
 	}
 
-	constexpr bucket_value_type _bucket_for_hash(hash_value_type hash) const
+	constexpr void _deallocate(control_type* control, pointer data, size_t capacity)
 	{
-		return hash % m_capacity;
+		using byte_allocator = typename std::allocator_traits<allocator_type>::template rebind_alloc<std::byte>;
+
+		byte_allocator byteAllocator{ m_box.resource() };
+
+		if (control != nullptr)
+		{
+			std::allocator_traits<byte_allocator>::deallocate(byteAllocator, reinterpret_cast<std::byte*>(control), capacity + group_width_v);
+		}
+
+		if (data != nullptr)
+		{
+			std::allocator_traits<allocator_type>::deallocate(m_box, data, capacity);
+		}
 	}
 
-	constexpr uint32 _hashify(key_type const& key) const
+	constexpr void _construct_at(bucket_value_type bucket, mutable_type&& element)
 	{
-		return static_cast<uint32>(hasher{}(key));
+		if constexpr (std::is_same_v<type, key_type>)
+		{
+			new (m_box->data + bucket) type{ std::move(element) };
+		}
+		else
+		{
+			new (m_box->data + bucket) type{ std::move(element.first), std::move(element.second) };
+		}
 	}
 
-	constexpr bool _grow_on_next_insert() const
+	constexpr void _destroy_at(bucket_value_type bucket)
 	{
-		return m_box->metadata->growOnNextInsert;
+		m_box->data[bucket].~type();
 	}
 
-	constexpr void _toggle_grow_on_next_insert()
+	constexpr auto _deep_copy(hash_container_base const& other) -> void
 	{
-		m_box->metadata->growOnNextInsert ^= true;
+		if (other.m_len == 0)
+		{
+			return;
+		}
+
+		m_maxLoadFactor = other.m_maxLoadFactor;
+
+		if (m_capacity != other.m_capacity)
+		{
+			release();
+			m_maxLoadFactor = other.m_maxLoadFactor;
+			_rehash(other.m_capacity);
+		}
+
+		// Same capacity and hash function, so every element can stay in its bucket.
+		std::memcpy(_control(), other._control(), m_capacity + group_width_v);
+
+		for (size_t i = 0; i < m_capacity; ++i)
+		{
+			if (_is_full(other._control()[i]))
+			{
+				new (m_box->data + i) type{ other.m_box->data[i] };
+			}
+		}
+
+		m_len = other.m_len;
+		m_growthLeft = other.m_growthLeft;
 	}
 };
 
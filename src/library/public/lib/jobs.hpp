@@ -0,0 +1,550 @@
+#pragma once
+#ifndef LIB_JOBS_HPP
+#define LIB_JOBS_HPP
+
+#include <atomic>
+#include <concepts>
+#include <condition_variable>
+#include <coroutine>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include "array.hpp"
+#include "work_stealing_deque.hpp"
+
+namespace lib
+{
+namespace jobs
+{
+class scheduler;
+class counter;
+
+enum class priority : uint8
+{
+	high,	// Runs before anything else that is queued.
+	normal,
+	io		// Runs on the scheduler's IO threads so that blocking calls do not hold up a worker.
+};
+
+/**
+* Unit of work the scheduler runs. Spawned functions and coroutine tasks are jobs, the scheduler never copies or frees them.
+*/
+struct job
+{
+	void (*execute)(job* self) = nullptr;
+	job* next = nullptr;	// Intrusive link for the injection queues and the waiter list of a counter.
+	scheduler* owner = nullptr;
+	jobs::priority priority = priority::normal;
+};
+
+/**
+* Counts outstanding jobs. Jobs spawned with a counter signal it when they complete.
+*
+* A counter can be waited on with scheduler::wait() or co_await-ed from a task. Awaiting tasks are rescheduled on their own scheduler when the counter reaches zero instead of blocking a thread.
+* A counter must outlive every job that signals it. It is safe to destroy one as soon as a wait on it returns.
+*/
+class counter : lib::non_copyable_non_movable
+{
+public:
+	struct awaiter
+	{
+		counter& target;
+
+		auto await_ready() const noexcept -> bool { return false; }
+
+		template <typename Promise>
+		requires std::derived_from<Promise, job>
+		auto await_suspend(std::coroutine_handle<Promise> handle) -> bool { return target._enqueue_waiter(handle.promise()); }
+
+		auto await_resume() const noexcept -> void {}
+	};
+
+	LIB_API counter(uint32 initial = 0);
+	LIB_API ~counter();
+
+	/**
+	* @brief Must be called before the jobs it accounts for are spawned.
+	*/
+	LIB_API auto add(uint32 count = 1) -> void;
+	LIB_API auto signal() -> void;
+
+	/**
+	* @brief Only a hint while jobs are still running, wait on the counter to synchronize with them.
+	*/
+	auto value() const -> uint32 { return m_value.load(std::memory_order_acquire); }
+	auto done() const -> bool { return value() == 0; }
+
+	auto operator co_await() -> awaiter { return awaiter{ *this }; }
+private:
+	friend class scheduler;
+
+	std::atomic<uint32> m_value;
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	job* m_waiters;
+	bool m_signaled;	// Guarded by m_mutex. Set once signal() no longer touches the counter.
+
+	LIB_API auto _enqueue_waiter(job& waiter) -> bool;
+};
+
+template <typename T = void>
+class task;
+
+namespace detail
+{
+struct promise_base : job
+{
+	std::coroutine_handle<> handle;
+	std::coroutine_handle<> continuation;
+	counter* completion = nullptr;
+	bool detached = false;
+
+	/**
+	* Coroutine frames come from the default memory resource like every other allocation in lib.
+	* The resource is stored in front of the frame and the frame goes back to it, even if the default resource changed in the meantime.
+	*/
+	static constexpr size_t FRAME_HEADER_SIZE = alignof(std::max_align_t);
+
+	static_assert(sizeof(memory_resource*) <= FRAME_HEADER_SIZE);
+
+	static auto operator new(size_t size) -> void*
+	{
+		memory_resource* resource = get_default_resource();
+		std::byte* memory = static_cast<std::byte*>(resource->allocate(FRAME_HEADER_SIZE + size));
+
+		*reinterpret_cast<memory_resource**>(memory) = resource;
+
+		return memory + FRAME_HEADER_SIZE;
+	}
+
+	static auto operator delete(void* p, size_t size) -> void
+	{
+		std::byte* memory = static_cast<std::byte*>(p) - FRAME_HEADER_SIZE;
+		memory_resource* resource = *reinterpret_cast<memory_resource**>(memory);
+
+		resource->deallocate(memory, FRAME_HEADER_SIZE + size);
+	}
+
+	/**
+	* Set as "execute" of every task when its frame is created, so that a child task that suspends on a counter can be rescheduled like a top level one.
+	*/
+	static auto resume(job* self) -> void { static_cast<promise_base*>(self)->handle.resume(); }
+
+	struct final_awaiter
+	{
+		auto await_ready() const noexcept -> bool { return false; }
+
+		template <typename Promise>
+		auto await_suspend(std::coroutine_handle<Promise> handle) noexcept -> std::coroutine_handle<>
+		{
+			promise_base& promise = handle.promise();
+			std::coroutine_handle<> continuation = promise.continuation;
+			counter* completion = promise.completion;
+
+			if (promise.detached)
+			{
+				handle.destroy();
+			}
+
+			// Whoever waits on the counter may destroy the frame from here on.
+			if (completion != nullptr)
+			{
+				completion->signal();
+			}
+
+			return (continuation) ? continuation : std::noop_coroutine();
+		}
+
+		auto await_resume() const noexcept -> void {}
+	};
+
+	auto initial_suspend() const noexcept -> std::suspend_always { return {}; }
+	auto final_suspend() const noexcept -> final_awaiter { return {}; }
+	auto unhandled_exception() const noexcept -> void { std::terminate(); }
+};
+
+template <typename T>
+struct promise : promise_base
+{
+	std::optional<T> result;
+
+	auto get_return_object() -> task<T>;
+
+	template <typename U>
+	requires std::convertible_to<U, T>
+	auto return_value(U&& value) -> void { result.emplace(std::forward<U>(value)); }
+};
+
+template <>
+struct promise<void> : promise_base
+{
+	auto get_return_object() -> task<void>;
+	auto return_void() const noexcept -> void {}
+};
+}
+
+/**
+* Lazily started coroutine. A task does not run until it is co_await-ed, spawned or run on a scheduler.
+*
+* Awaiting a task runs it inline on the awaiting thread and resumes the awaiting task when it completes, the child inherits the parent's scheduler and priority.
+* Spawning a task detaches it, the frame is freed when the coroutine completes.
+*/
+template <typename T>
+class task : lib::non_copyable
+{
+public:
+	using value_type = T;
+	using promise_type = detail::promise<T>;
+	using handle_type = std::coroutine_handle<promise_type>;
+
+	struct awaiter
+	{
+		handle_type handle;
+
+		auto await_ready() const noexcept -> bool { return false; }
+
+		template <typename Promise>
+		requires std::derived_from<Promise, job>
+		auto await_suspend(std::coroutine_handle<Promise> parent) noexcept -> std::coroutine_handle<>
+		{
+			promise_type& promise = handle.promise();
+
+			promise.continuation = parent;
+			promise.owner = parent.promise().owner;
+			promise.priority = parent.promise().priority;
+
+			return handle;
+		}
+
+		auto await_resume() -> T
+		{
+			if constexpr (!std::is_void_v<T>)
+			{
+				ASSERTION(handle.promise().result.has_value(), "Task completed without a value.");
+				return std::move(*handle.promise().result);
+			}
+		}
+	};
+
+	task() = default;
+	explicit task(handle_type handle) : m_handle{ handle } {}
+
+	~task() { _destroy(); }
+
+	task(task&& rhs) noexcept : m_handle{ std::exchange(rhs.m_handle, nullptr) } {}
+
+	auto operator=(task&& rhs) noexcept -> task&
+	{
+		if (this != &rhs)
+		{
+			_destroy();
+			m_handle = std::exchange(rhs.m_handle, nullptr);
+		}
+		return *this;
+	}
+
+	auto valid() const -> bool { return m_handle != nullptr; }
+	auto done() const -> bool { return m_handle && m_handle.done(); }
+
+	auto operator co_await() && noexcept -> awaiter
+	{
+		ASSERTION(valid(), "Awaiting an empty task.");
+		return awaiter{ m_handle };
+	}
+private:
+	friend class scheduler;
+
+	handle_type m_handle;
+
+	auto _destroy() -> void
+	{
+		if (m_handle)
+		{
+			m_handle.destroy();
+			m_handle = nullptr;
+		}
+	}
+
+	auto _release() -> handle_type { return std::exchange(m_handle, nullptr); }
+};
+
+namespace detail
+{
+template <typename T>
+auto promise<T>::get_return_object() -> task<T>
+{
+	handle = std::coroutine_handle<promise<T>>::from_promise(*this);
+	execute = &promise_base::resume;
+	return task<T>{ std::coroutine_handle<promise<T>>::from_promise(*this) };
+}
+
+inline auto promise<void>::get_return_object() -> task<void>
+{
+	handle = std::coroutine_handle<promise<void>>::from_promise(*this);
+	execute = &promise_base::resume;
+	return task<void>{ std::coroutine_handle<promise<void>>::from_promise(*this) };
+}
+}
+
+struct scheduler_info
+{
+	uint32 workerCount = 0;		// 0 uses one worker per hardware thread.
+	uint32 ioThreadCount = 1;	// 0 runs IO jobs on the workers.
+};
+
+/**
+* Work stealing thread pool.
+*
+* Every worker owns a Chase-Lev deque. Jobs scheduled from a worker go into its deque, the worker takes the newest job first and steals the oldest job from other workers when it runs out.
+* Jobs scheduled from other threads and high priority jobs go through shared injection queues. IO jobs run on dedicated threads.
+*
+* Every job must have completed before the scheduler is destroyed.
+*/
+class scheduler : lib::non_copyable_non_movable
+{
+public:
+	LIB_API scheduler(scheduler_info const& info = {});
+	LIB_API ~scheduler();
+
+	/**
+	* @brief Thread safe. Runs "fn" as a job and signals "completion", if any, once it returns.
+	*/
+	template <std::invocable F>
+	auto spawn(F&& fn, counter* completion = nullptr, jobs::priority priority = priority::normal) -> void
+	{
+		using callable_type = callable_job<std::decay_t<F>>;
+
+		if (completion != nullptr)
+		{
+			completion->add();
+		}
+
+		memory_resource* resource = get_default_resource();
+		void* memory = resource->allocate(sizeof(callable_type), alignof(callable_type));
+		callable_type* callable = new (memory) callable_type{ std::forward<F>(fn), completion, resource };
+
+		callable->execute = &callable_type::run;
+		callable->owner = this;
+		callable->priority = priority;
+
+		schedule(*callable);
+	}
+
+	/**
+	* @brief Thread safe. Detaches "t" and schedules it. "completion", if any, is signaled once the coroutine completes.
+	*/
+	auto spawn(task<void>&& t, counter* completion = nullptr, jobs::priority priority = priority::normal) -> void
+	{
+		ASSERTION(t.valid(), "Spawning an empty task.");
+
+		if (completion != nullptr)
+		{
+			completion->add();
+		}
+
+		detail::promise<void>& promise = t._release().promise();
+
+		promise.owner = this;
+		promise.priority = priority;
+		promise.completion = completion;
+		promise.detached = true;
+
+		schedule(promise);
+	}
+
+	/**
+	* @brief Thread safe. Queues a job that has already been set up.
+	*/
+	LIB_API auto schedule(job& j) -> void;
+
+	/**
+	* @brief Blocks until "c" reaches zero. Workers keep running other jobs while they wait.
+	*/
+	LIB_API auto wait(counter& c) -> void;
+
+	/**
+	* @brief Runs "t" on the scheduler and blocks until it completes.
+	*/
+	template <typename T>
+	auto run(task<T>&& t, jobs::priority priority = priority::normal) -> T
+	{
+		ASSERTION(t.valid(), "Running an empty task.");
+
+		counter completion{ 1 };
+		detail::promise<T>& promise = t.m_handle.promise();
+
+		promise.owner = this;
+		promise.priority = priority;
+		promise.completion = &completion;
+
+		schedule(promise);
+		wait(completion);
+
+		if constexpr (!std::is_void_v<T>)
+		{
+			return std::move(*promise.result);
+		}
+	}
+
+	/**
+	* @brief Calls "fn" over [begin, end) and returns once every call has returned.
+	*
+	* "fn" is called either with a sub range, fn(first, last), or with every index, fn(i). It is called concurrently so it must be safe to do so.
+	* The range is split lazily. A range is only halved while the running worker has no other queued work or another worker is idle, so the number of jobs adapts to the load instead of being fixed up front.
+	* Ranges are never split below "grain" indices. 0 picks a grain that leaves a few ranges per worker.
+	*/
+	template <std::integral I, typename F>
+	requires (std::invocable<F&, I, I> || std::invocable<F&, I>)
+	auto parallel_for(I begin, I end, F&& fn, I grain = 0) -> void
+	{
+		if (begin >= end)
+		{
+			return;
+		}
+
+		if (grain == 0)
+		{
+			grain = std::max(static_cast<I>((end - begin) / static_cast<I>(8 * (m_workerCount + 1))), I{ 1 });
+		}
+
+		counter completion{ 1 };
+		range_job<I, std::remove_reference_t<F>> root{ {}, begin, end, grain, &fn, &completion, nullptr };
+
+		root.execute = &range_job<I, std::remove_reference_t<F>>::run;
+		root.owner = this;
+
+		// The calling thread takes the first range itself instead of idling.
+		root.execute(&root);
+
+		wait(completion);
+	}
+
+	auto worker_count() const -> uint32 { return m_workerCount; }
+
+	/**
+	* @return Scheduler that owns the calling thread, null when called from a thread outside of any scheduler.
+	*/
+	LIB_API static auto current() -> scheduler*;
+private:
+	template <typename F>
+	struct callable_job : job
+	{
+		F fn;
+		counter* completion;
+		memory_resource* resource;	// The job was allocated from it and is freed through it.
+
+		callable_job(F&& fn_, counter* completion_, memory_resource* resource_) : job{}, fn{ std::move(fn_) }, completion{ completion_ }, resource{ resource_ } {}
+		callable_job(F const& fn_, counter* completion_, memory_resource* resource_) : job{}, fn{ fn_ }, completion{ completion_ }, resource{ resource_ } {}
+
+		static auto run(job* self) -> void
+		{
+			callable_job* callable = static_cast<callable_job*>(self);
+			counter* c = callable->completion;
+			memory_resource* resource = callable->resource;
+
+			callable->fn();
+			callable->~callable_job();
+			resource->deallocate(callable, sizeof(callable_job), alignof(callable_job));
+
+			if (c != nullptr)
+			{
+				c->signal();
+			}
+		}
+	};
+
+	template <typename I, typename F>
+	struct range_job : job
+	{
+		I begin;
+		I end;
+		I grain;
+		F* fn;
+		counter* completion;
+		memory_resource* resource;	// Split off ranges are allocated from it and free themselves through it. Null for the root, which lives on the caller's stack.
+
+		static auto run(job* self) -> void
+		{
+			range_job* range = static_cast<range_job*>(self);
+			scheduler& owner = *range->owner;
+
+			while (range->end - range->begin > range->grain &&
+				owner._wants_more_jobs())
+			{
+				I const middle = range->begin + (range->end - range->begin) / 2;
+
+				memory_resource* resource = get_default_resource();
+				void* memory = resource->allocate(sizeof(range_job), alignof(range_job));
+				range_job* split = new (memory) range_job{ {}, middle, range->end, range->grain, range->fn, range->completion, resource };
+
+				split->execute = &range_job::run;
+				split->owner = &owner;
+				split->priority = range->priority;
+
+				range->completion->add();
+				owner.schedule(*split);
+
+				range->end = middle;
+			}
+
+			if constexpr (std::invocable<F&, I, I>)
+			{
+				(*range->fn)(range->begin, range->end);
+			}
+			else
+			{
+				for (I i = range->begin; i < range->end; ++i)
+				{
+					(*range->fn)(i);
+				}
+			}
+
+			counter* c = range->completion;
+
+			if (range->resource != nullptr)
+			{
+				range->resource->deallocate(range, sizeof(range_job), alignof(range_job));
+			}
+
+			c->signal();
+		}
+	};
+
+	/**
+	* Mutex guarded FIFO for jobs that do not go into a worker's deque.
+	*/
+	struct job_queue
+	{
+		std::mutex mutex;
+		job* head = nullptr;
+		job* tail = nullptr;
+		std::atomic<size_t> size = 0;	// Lets workers skip the lock when the queue is empty.
+
+		auto push(job& j) -> void;
+		auto pop() -> job*;
+	};
+
+	std::unique_ptr<work_stealing_deque<job*>[]> m_deques;
+	lib::array<std::jthread> m_threads;
+	uint32 m_workerCount;
+	uint32 m_ioThreadCount;
+	job_queue m_highQueue;
+	job_queue m_normalQueue;
+	job_queue m_ioQueue;
+	std::mutex m_sleepMutex;
+	std::condition_variable m_wake;
+	std::condition_variable m_ioWake;
+	std::atomic<uint64> m_epoch;		// Bumped under m_sleepMutex whenever sleeping workers should look for work again.
+	std::atomic<uint32> m_sleepers;
+	bool m_stop;
+
+	auto _worker_loop(uint32 index) -> void;
+	auto _io_loop() -> void;
+	auto _find_job(uint32 index) -> job*;
+	auto _wake_one() -> void;
+	LIB_API auto _wants_more_jobs() const -> bool;
+};
+}
+}
+
+#endif // !LIB_JOBS_HPP
@@ -33,17 +33,26 @@ struct map_traits
 	{
 		return a == b;
 	}
+
+	template <typename K>
+	static constexpr bool compare_keys(K const& a, key_type const& b)
+	{
+		return b == a;
+	}
 };
 
 // TODO:
 // Figure out a way to emplace elements without specifying a key and just let the Traits::extract_key work.
 
-template <typename key, typename value, provides_memory in_allocator = allocator<typename map_traits<key, value>::type>, typename hasher = std::hash<key>, std::derived_from<container_growth_policy> growth_policy = shift_growth_policy<4>>
+/**
+* @brief Hash map. The layout can be either robin_hood_layout or group_probing_layout.
+*/
+template <typename key, typename value, provides_memory in_allocator = allocator<typename map_traits<key, value>::type>, typename hasher = hash<key>, std::derived_from<container_growth_policy> growth_policy = shift_growth_policy<4>, typename layout = robin_hood_layout>
 class map : 
-	public hash_container_base<map_traits<key, value>, hasher, growth_policy, in_allocator>
+	public hash_container_base<map_traits<key, value>, hasher, growth_policy, in_allocator, layout>
 {
 public:
-	using super				= hash_container_base<map_traits<key, value>, hasher, growth_policy, in_allocator>;
+	using super				= hash_container_base<map_traits<key, value>, hasher, growth_policy, in_allocator, layout>;
 	using type				= typename super::interface_type;			// std::pair<const key_type, value_type>
 	using key_type			= typename super::key_type;
 	using value_type		= typename super::value_type;
@@ -71,6 +80,15 @@ public:
 		return super::_get_impl(in_key) != invalid_bucket_v;
 	}
 
+	/**
+	* Heterogeneous lookup, e.g. a std::string_view against lib::string keys. Requires a transparent hasher.
+	*/
+	template <transparent_key<hasher, key_type> K>
+	constexpr bool contains(K const& in_key) const
+	{
+		return super::_get_impl(in_key) != invalid_bucket_v;
+	}
+
 	/**
 	* Returns an optional with a Ref to the stored type.
 	* If the key does not exist, a std::nullopt is returned instead.
@@ -81,10 +99,16 @@ public:
 		return (bucket != invalid_bucket_v) ? std::optional{ ref<type>{ super::_data()[bucket] } } : std::nullopt;
 	}
 
+	template <transparent_key<hasher, key_type> K>
+	constexpr std::optional<ref<type>> at(K const& in_key) const
+	{
+		const bucket_value_type bucket = super::_get_impl(in_key);
+		return (bucket != invalid_bucket_v) ? std::optional{ ref<type>{ super::_data()[bucket] } } : std::nullopt;
+	}
+
 	constexpr void clear()
 	{
-		super::_destruct(0, super::capacity());
-		super::m_len = 0;
+		super::_clear();
 	}
 
 	/**
@@ -144,14 +168,26 @@ public:
 		return super::_remove_impl(in_key);
 	}
 
+	template <transparent_key<hasher, key_type> K>
+	constexpr bool erase(K const& in_key)
+	{
+		return super::_remove_impl(in_key);
+	}
+
 	constexpr bucket_value_type bucket(key_type const& in_key) const
 	{
 		return super::_get_impl(in_key);
 	}
 
+	template <transparent_key<hasher, key_type> K>
+	constexpr bucket_value_type bucket(K const& in_key) const
+	{
+		return super::_get_impl(in_key);
+	}
+
 	constexpr type& element_at_bucket(bucket_value_type bucket)
 	{
-		ASSERTION(!super::_info()[bucket].is_empty() && "Bucket value supplied is invalid!");
+		ASSERTION(super::_is_occupied(bucket) && "Bucket value supplied is invalid!");
 		return super::_data()[bucket];
 	}
 };
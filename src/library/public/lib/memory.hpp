@@ -67,6 +67,13 @@ private:
 
 LIB_API auto get_default_resource() noexcept -> memory_resource*;
 
+/**
+* @brief Replaces the resource handed to allocators that are not given one explicitly. Allocators that already exist keep the resource they were created with.
+* @param resource Passing nullptr restores the library's default resource.
+* @return The previous default resource.
+*/
+LIB_API auto set_default_resource(memory_resource* resource) noexcept -> memory_resource*;
+
 template <typename T>
 concept can_allocate_memory = requires (T allocator)
 {
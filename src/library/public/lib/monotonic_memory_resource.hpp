@@ -0,0 +1,108 @@
+#pragma once
+#ifndef LIB_MONOTONIC_MEMORY_RESOURCE_HPP
+#define LIB_MONOTONIC_MEMORY_RESOURCE_HPP
+
+#include "memory.hpp"
+
+namespace lib
+{
+/**
+* Arena that bump allocates and never frees individual allocations. deallocate() is a no-op, everything is handed back at once through reset() or rewind().
+*
+* By default memory comes from a chain of blocks requested from the upstream resource, each block twice the size of the previous one.
+* Blocks are kept around when the arena is reset, so an arena that is reused every frame stops allocating once it has grown to fit the frame.
+* Alternatively the arena can reserve a single range of address space up front and commit pages as the bump pointer reaches them. Addresses then stay contiguous, but allocations past the reservation fail.
+*
+* Not thread safe. Destructors of objects allocated from the arena are not called.
+*/
+class monotonic_memory_resource : public memory_resource
+{
+public:
+	static constexpr size_t default_block_size_v = 64_KiB;
+
+	/**
+	* Requests a reserve-then-commit arena of "size" bytes.
+	*/
+	struct virtual_reservation
+	{
+		size_t size;
+	};
+
+	/**
+	* Position of the bump pointer, see mark() and rewind().
+	*/
+	struct marker
+	{
+		void* block;
+		std::byte* cursor;
+	};
+
+	/**
+	* Rewinds the arena to where it was on construction once it goes out of scope.
+	*/
+	class scope : lib::non_copyable_non_movable
+	{
+	public:
+		scope(monotonic_memory_resource& arena) :
+			m_arena{ arena },
+			m_marker{ arena.mark() }
+		{}
+
+		~scope() { m_arena.rewind(m_marker); }
+	private:
+		monotonic_memory_resource& m_arena;
+		marker m_marker;
+	};
+
+	LIB_API monotonic_memory_resource(size_t initialBlockSize = default_block_size_v, memory_resource* upstream = get_default_resource());
+	LIB_API explicit monotonic_memory_resource(virtual_reservation reservation);
+	LIB_API ~monotonic_memory_resource() override;
+
+	auto mark() const -> marker { return marker{ .block = m_current, .cursor = m_cursor }; }
+
+	/**
+	* @brief Frees everything allocated after the marker was taken. Markers taken after this one are invalidated.
+	*/
+	LIB_API auto rewind(marker const& marker) -> void;
+
+	/**
+	* @brief Frees everything in O(1). Blocks and committed pages are kept for reuse.
+	*/
+	LIB_API auto reset() -> void;
+
+	/**
+	* @brief Frees everything and hands the blocks, or the committed pages, back to their source.
+	*/
+	LIB_API auto release() -> void;
+
+	auto upstream_resource() const -> memory_resource* { return m_upstream; }
+
+private:
+	struct block;
+
+	memory_resource* m_upstream;
+	block* m_head;
+	block* m_current;
+	std::byte* m_cursor;
+	std::byte* m_end;
+	std::byte* m_committed;		// End of the committed pages of a reservation. Null for chained arenas.
+	size_t m_reservationSize;
+	size_t m_nextBlockSize;
+
+	LIB_API virtual auto do_allocate(size_t size, size_t alignment) -> void* override;
+	LIB_API virtual auto do_deallocate(void* p, size_t bytes, size_t alignment) -> void override;
+	LIB_API virtual auto do_is_equal(memory_resource const& other) -> bool override;
+
+	auto _allocate_from_next_block(size_t size, size_t alignment) -> void*;
+	auto _commit_until(std::byte* end) -> bool;
+	auto _use_block(block* block) -> void;
+};
+
+/**
+* @brief Arena owned by the calling thread for scratch memory that does not outlive the current frame or job.
+* Reset it at the start of the frame, or wrap the work in a monotonic_memory_resource::scope so that nested users do not free each other's memory.
+*/
+LIB_API auto thread_frame_arena() -> monotonic_memory_resource&;
+}
+
+#endif // !LIB_MONOTONIC_MEMORY_RESOURCE_HPP
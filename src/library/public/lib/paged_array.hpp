@@ -2,30 +2,61 @@
 #ifndef LIB_PAGED_ARRAY_HPP
 #define LIB_PAGED_ARRAY_HPP
 
-#include <span>
 #include <array>
-#include "type.hpp"
-#include "array.hpp"
+#include <atomic>
+#include <bit>
+#include <limits>
+#include "common.hpp"
 
 namespace lib
 {
-template <typename T, uint16 PAGE_SIZE>
+/**
+* @brief Generational slot map. Elements live in fixed size pages that never move once allocated, so their addresses stay stable.
+*
+* emplace(), insert(), erase() and clear(page) are lock-free and can be called from any number of threads.
+* Erased slots are recycled through a lock-free free list whose head carries a tag to guard against ABA.
+* Every slot has a version that is odd while occupied and even while free. Erasing a slot bumps its version, invalidating every index to it.
+* Iteration walks each page's occupancy bitmask and skips the holes.
+*
+* The container does not protect an element from being erased while another thread is still using it.
+* Iterating while other threads insert or erase elements is not safe either.
+*/
+template <typename T, uint16 PAGE_SIZE, uint32 MAX_PAGES = 4096>
 class paged_array
 {
+	static_assert(PAGE_SIZE != 0, "PAGE_SIZE must not be 0.");
+	static_assert(MAX_PAGES != 0 && MAX_PAGES <= std::numeric_limits<uint16>::max() + 1u, "MAX_PAGES must be addressable by index::page.");
+
+	static constexpr uint32 NULL_SLOT			= std::numeric_limits<uint32>::max();
+	static constexpr size_t MASK_BITS			= 64;
+	static constexpr size_t MASK_WORD_COUNT		= (static_cast<size_t>(PAGE_SIZE) + MASK_BITS - 1) / MASK_BITS;
 public:
-	using element_type = T;
+	using element_type	= T;
+	using value_type	= T;
+	using size_type		= size_t;
 
 	struct page_buffer
 	{
-		using data_buffer	 = std::array<element_type, PAGE_SIZE>;
-		using version_buffer = std::array<std::atomic_uint32_t, PAGE_SIZE>;
+		struct alignas(alignof(element_type)) storage
+		{
+			std::byte data[sizeof(element_type)];
+		};
 
-		data_buffer		buffer;
-		version_buffer	version;
-		size_t			tail; // This marks the current end index of the buffer above.
-	};
+		using data_buffer		= std::array<storage, PAGE_SIZE>;
+		using version_buffer	= std::array<std::atomic_uint32_t, PAGE_SIZE>;
+		using link_buffer		= std::array<std::atomic_uint32_t, PAGE_SIZE>;
+		using occupancy_buffer	= std::array<std::atomic<uint64>, MASK_WORD_COUNT>;
+
+		data_buffer			buffer;
+		version_buffer		version;	// Odd while the slot is occupied, even while it is free.
+		link_buffer			next;		// Next slot in the free list.
+		occupancy_buffer	occupancy;	// A set bit marks an occupied slot.
 
-	using element_page = std::unique_ptr<page_buffer>;
+		auto element(size_t offset) -> element_type*
+		{
+			return std::launder(reinterpret_cast<element_type*>(buffer[offset].data));
+		}
+	};
 
 	/**
 	* index can no longer be 4 bytes. The slot version count needs to be included with the index.
@@ -50,511 +81,516 @@ public:
 		{
 			return std::bit_cast<index>(value);
 		}
-	};
 
-	paged_array() = default;
+		/**
+		* @brief Occupied slots always have an odd version, so an index with an even version never refers to an element.
+		*/
+		[[nodiscard]] constexpr auto valid() const -> bool
+		{
+			return (version & 1u) != 0;
+		}
 
-	~paged_array() { release(); }
+		constexpr auto operator==(index const&) const -> bool = default;
+	};
 
-	constexpr auto operator[](index idx) const -> element_type&
+	template <typename container_type, typename element_value_type>
+	class iterator_base
 	{
-		size_t const page = static_cast<size_t>(idx.page);
-		size_t const offset = static_cast<size_t>(idx.offset);
-
-		ASSERTION(page < m_pages.size(), "Page in index exceeded page count of the container.");
-		ASSERTION(offset < m_pages[page]->buffer.size(), "Offset in index exceeded buffer capacity of the page.");
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type		= element_value_type;
+		using difference_type	= ptrdiff_t;
+		using pointer			= value_type*;
+		using reference			= value_type&;
 
-		[[maybe_unused]] uint32 const ver = m_pages[page]->version[offset].load(std::memory_order_acquire);
+		iterator_base() = default;
 
-		ASSERTION(idx.version == ver, "Version do not match! Data retrieved is faulty.");
-
-		return m_pages[page]->buffer[offset];
-	}
+		auto operator*() const -> reference
+		{
+			return *m_container->_page(m_page)->element(_offset());
+		}
 
-	constexpr auto at(index idx) const -> element_type*
-	{
-		size_t const page = static_cast<size_t>(idx.page);
-		size_t const offset = static_cast<size_t>(idx.offset);
+		auto operator->() const -> pointer
+		{
+			return m_container->_page(m_page)->element(_offset());
+		}
 
-		if (page < m_pages.size() &&
-			offset < m_pages[page]->buffer.size() &&
-			idx.version == m_pages[page]->version[offset].load(std::memory_order_acquire))
+		auto operator++() -> iterator_base&
 		{
-			return &m_pages[page]->buffer[offset];
+			m_mask &= m_mask - 1;
+			_skip_holes();
+			return *this;
 		}
-		return nullptr;
-	}
 
-	template <typename... Args>
-	std::pair<index, element_type&> emplace(Args&&... args)
-	{
-		auto result = get_slot();
-		new (&result.second) element_type{ std::forward<Args>(args)... };
-		return result;
-	}
+		auto operator++(int) -> iterator_base
+		{
+			iterator_base it = *this;
+			++(*this);
+			return it;
+		}
 
-	std::pair<index, element_type&> insert(element_type const& ele)
-	{
-		return emplace(ele);
-	}
+		/**
+		* @brief Index of the element the iterator points to.
+		*/
+		auto index() const -> typename paged_array::index
+		{
+			size_t const offset = _offset();
 
-	std::pair<index, element_type&> insert(element_type&& ele)
-	{
-		return emplace(std::move(ele));
-	}
+			return typename paged_array::index{
+				.page = static_cast<uint16>(m_page),
+				.offset = static_cast<uint16>(offset),
+				.version = m_container->_page(m_page)->version[offset].load(std::memory_order_acquire)
+			};
+		}
 
-	//std::pair<index, element_type&> request()
-	//{
-	//	return get_slot();
-	//}
+		auto operator==(iterator_base const& rhs) const -> bool
+		{
+			return m_page == rhs.m_page && m_word == rhs.m_word && m_mask == rhs.m_mask;
+		}
 
-	void erase(index idx)
-	{
-		size_t const page = static_cast<size_t>(idx.page);
-		size_t const offset = static_cast<size_t>(idx.offset);
+		operator iterator_base<paged_array const, element_type const>() const requires (!std::is_const_v<container_type>)
+		{
+			iterator_base<paged_array const, element_type const> it;
+			it.m_container = m_container;
+			it.m_pageCount = m_pageCount;
+			it.m_page = m_page;
+			it.m_word = m_word;
+			it.m_mask = m_mask;
+			return it;
+		}
+	private:
+		friend class paged_array;
+
+		template <typename, typename>
+		friend class iterator_base;
+
+		container_type* m_container = nullptr;
+		size_t m_pageCount	= 0;
+		size_t m_page		= 0;
+		size_t m_word		= 0;
+		uint64 m_mask		= 0;
+
+		iterator_base(container_type* container, size_t page) :
+			m_container{ container },
+			m_pageCount{ container->page_count() },
+			m_page{ page }
+		{
+			if (m_page < m_pageCount)
+			{
+				_load_mask();
+				_skip_holes();
+			}
+		}
 
-		ASSERTION(page < m_pages.size(), "Page in index exceeded page count of the container.");
-		if (page < m_pages.size())
+		auto _offset() const -> size_t
 		{
-			auto& buffer = m_pages[page]->buffer;
+			return m_word * MASK_BITS + static_cast<size_t>(std::countr_zero(m_mask));
+		}
 
-			ASSERTION(offset < buffer.size(), "Offset in index exceeded buffer capacity of the page.");
+		auto _load_mask() -> void
+		{
+			auto const* page = m_container->_page(m_page);
+			m_mask = (page != nullptr) ? page->occupancy[m_word].load(std::memory_order_acquire) : 0;
+		}
 
-			if (offset < buffer.size())
+		/**
+		* @brief Moves onto the next occupied slot, or onto end() if there is none left.
+		*/
+		auto _skip_holes() -> void
+		{
+			while (m_mask == 0)
 			{
-				std::atomic_uint32_t& versionCounter = m_pages[page]->version[offset];
-
-				if (idx.version == versionCounter.load(std::memory_order_acquire))
+				if (++m_word == MASK_WORD_COUNT)
 				{
-					buffer[offset].~element_type();
-					m_indices.push_back(idx);
+					m_word = 0;
 
-					versionCounter.fetch_add(1, std::memory_order_relaxed);
+					if (++m_page >= m_pageCount)
+					{
+						m_page = m_pageCount;
+						return;
+					}
 				}
+				_load_mask();
 			}
 		}
-	}
+	};
 
-	//size_t page_count() const
-	//{
-	//	return m_current;
-	//}
-
-	//index index_of(element_type const* ele) const
-	//{
-	//	size_t const num_pages = m_current + 1;
-	//	for (size_t i = 0; i < num_pages; ++i)
-	//	{
-	//		page_buffer const& currentPage = *m_pages[i].get();
-	//		if (ele >= currentPage.buffer.data() && 
-	//			ele < currentPage.buffer.data() + currentPage.buffer.size())
-	//		{
-	//			size_t offset = ele - currentPage.buffer.data();
-	//			uint32 const ver = currentPage.version[offset].load(std::memory_order_relaxed);
-
-	//			return index{ .page = static_cast<uint16>(i), .offset = static_cast<uint16>(offset), .version = ver };
-	//		}
-	//	}
-	//	return index::from(std::numeric_limits<uint32>::max());
-	//}
-
-	//index index_of(element_type const& ele) const
-	//{
-	//	return index_of(&ele);
-	//}
+	using iterator			= iterator_base<paged_array, element_type>;
+	using const_iterator	= iterator_base<paged_array const, element_type const>;
 
-	/**
-	* Clears the content of a page that conincides with the supplied index.
-	*/
-	auto clear(size_t pidx) -> void
-	{
-		ASSERTION(pidx < m_pages.size(), "Page index exceeded number of pages available in the pool");
-		if (pidx < m_pages.size())
-		{
-			element_page& page = m_pages[pidx];
+	paged_array() = default;
 
-			for (size_t i = 0; element_type& ele : page->buffer)
-			{
-				if (i >= page->tail)
-				{
-					break;
-				}
-				ele.~element_type();
+	~paged_array() { release(); }
 
-				uint32 const val = page->version[i].load(std::memory_order_acquire);
-				page->version[i].compare_exchange_strong(val, 0, std::memory_order_relaxed);
+	paged_array(paged_array const&) = delete;
+	paged_array(paged_array&&) = delete;
 
-				++i;
-			}
+	auto operator=(paged_array const&) -> paged_array& = delete;
+	auto operator=(paged_array&&) -> paged_array& = delete;
 
-			page->tail = 0;
+	auto operator[](index idx) const -> element_type&
+	{
+		[[maybe_unused]] page_buffer* page = _page(idx.page);
 
-			auto it = std::remove_if(
-				m_indices.begin(),
-				m_indices.end(),
-				[pidx](index const& idx) -> bool
-				{
-					return pidx == static_cast<size_t>(idx.page);
-				}
-			);
+		ASSERTION(page != nullptr, "Page in index has not been allocated.");
+		ASSERTION(idx.offset < PAGE_SIZE, "Offset in index exceeded buffer capacity of the page.");
+		ASSERTION(idx.version == page->version[idx.offset].load(std::memory_order_acquire), "Version do not match! Data retrieved is faulty.");
 
-			m_indices.erase(it, m_indices.end());
-		}
+		return *_page(idx.page)->element(idx.offset);
 	}
 
 	/**
-	* Clears the contents of the container.
+	* @brief Returns nullptr if the index does not refer to a live element.
 	*/
-	auto clear() -> void
+	auto at(index idx) const -> element_type*
 	{
-		for (element_page& page : m_pages)
-		{
-			for (size_t i = 0; element_type& ele : page->buffer)
-			{
-				if (i >= page->tail)
-				{
-					break;
-				}
-
-				ele.~element_type();
-			}
+		page_buffer* page = _page(idx.page);
 
-			page->tail = 0;
+		if (page != nullptr &&
+			idx.offset < PAGE_SIZE &&
+			idx.valid() &&
+			idx.version == page->version[idx.offset].load(std::memory_order_acquire))
+		{
+			return page->element(idx.offset);
 		}
-
-		m_indices.clear();
+		return nullptr;
 	}
 
-	auto release() -> void
+	auto contains(index idx) const -> bool
 	{
-		clear();
-		
-		m_pages.clear();
+		return at(idx) != nullptr;
 	}
 
-private:
-	array<element_page> m_pages		= {};
-	array<index>		m_indices	= {};
-	size_t				m_current	= {};
-
-	std::pair<index, element_type&> get_slot()
+	/**
+	* @brief Thread safe. Returns an invalid index and nullptr when every page is in use.
+	*/
+	template <typename... Args>
+	auto emplace(Args&&... args) -> std::pair<index, element_type*>
 	{
-		if (m_current == m_pages.capacity() ||
-			m_pages[m_current]->tail == m_pages[m_current]->buffer.size())
-		{
-			auto it		= m_pages.emplace(m_pages.end(), std::make_unique<page_buffer>());
-			m_current	= std::distance(m_pages.begin(), it);
-		}
-
-		element_type* element = nullptr;
-		index idx = {};
+		uint32 const slot = _acquire_slot();
 
-		if (m_indices.size())
+		if (slot == NULL_SLOT)
 		{
-			idx = m_indices.back();
-
-			size_t const page	= static_cast<size_t>(idx.page);
-			size_t const offset = static_cast<size_t>(idx.offset);
-
-			m_indices.pop();
-
-			element		= &m_pages[page]->buffer[offset];
-			idx.version = m_pages[page]->version[offset].load(std::memory_order_acquire);
+			return std::pair<index, element_type*>{ index{}, nullptr };
 		}
-		else
-		{
-			ref pg = m_pages[m_current];
 
-			idx.page	= static_cast<uint16>(m_current);
-			idx.offset	= static_cast<uint16>(pg->tail);
-			idx.version = pg->version[pg->tail].load(std::memory_order_acquire);
+		size_t const pidx	= slot / PAGE_SIZE;
+		size_t const offset = slot % PAGE_SIZE;
 
-			element = &pg->buffer[pg->tail++];
-		}
+		page_buffer* page = _page(pidx);
+		element_type* element = new (page->buffer[offset].data) element_type{ std::forward<Args>(args)... };
 
-		return std::pair<index, element_type&>{ idx, *element };
-	}
-};
+		// The slot is owned by this thread until its version is published.
+		// The occupancy bit goes up first so that a concurrent clear(page) can never take the slot between the two stores and leave the bit behind.
+		uint32 const version = page->version[offset].load(std::memory_order_relaxed) + 1;
 
-template <size_t N>
-struct pool_page_size
-{
-	static constexpr size_t value = N;
-};
+		page->occupancy[offset / MASK_BITS].fetch_or(uint64{ 1 } << (offset % MASK_BITS), std::memory_order_release);
+		page->version[offset].store(version, std::memory_order_release);
 
-template <
-	typename AllocatorType, 
-	typename PoolPageSize,
-	typename SizeType = type<size_t>
->
-struct pool_config
-{
-	type<AllocatorType> allocator;
-	type<PoolPageSize> pool_size;
-	type<SizeType> size_type = {};
-};
+		m_size.fetch_add(1, std::memory_order_relaxed);
 
-template <typename T, pool_config config = { .allocator = type_v<allocator<T>>, .pool_size = type_v<pool_page_size<4_KiB / sizeof(T)>> }>
-class pool
-{
-public:
-	struct pool_const_iterator
-	{
-		using value_type 		= T;
-		using difference_type 	= ptrdiff_t;
-		using pointer 			= value_type const*;
-		using reference 		= value_type const&;
-
-		pointer m_data;
-	};
+		return std::pair<index, element_type*>{ index{ .page = static_cast<uint16>(pidx), .offset = static_cast<uint16>(offset), .version = version }, element };
+	}
 
-	struct pool_iterator : public pool_const_iterator
+	auto insert(element_type const& ele) -> std::pair<index, element_type*>
 	{
-		using super = pool_const_iterator;
-
-		using typename super::value_type;
-		using typename super::difference_type;
-		using pointer = value_type*;
-		using reference = value_type&;
-	};
-
-	using allocator_type 	= typename decltype(config.allocator)::type;
-	using size_type			= typename decltype(config.size_type)::type;
-	using difference_type 	= ptrdiff_t;
-	using value_type 		= T;
-	using pointer 			= value_type*;
-	using const_pointer 	= value_type const*;
-	using reference 		= value_type&;
-	using const_reference 	= value_type const&;
-	using iterator 			= pool_iterator;
-	using const_iterator 	= pool_const_iterator;
-
-	constexpr pool() = default;
+		return emplace(ele);
+	}
 
-	constexpr ~pool()
+	auto insert(element_type&& ele) -> std::pair<index, element_type*>
 	{
-		_release();
+		return emplace(std::move(ele));
 	}
 
-	// TODO(afiq):
-	// Figure out copy construction & copy assignment.
-	// Copy should be similar to an unordered map, the "structure" need not be the same.
-
-	pool(pool&& rhs) :
-		m_allocator{ std::exchange(rhs.m_allocator, {}) },
-		m_begin{ std::exchange(rhs.m_begin, {}) },
-		m_end{ std::exchange(rhs.m_end, {}) },
-		m_pFreelist( std::exchange(rhs.m_pFreelist, {}) ),
-		m_freelistTail( std::exchange(rhs.m_freelistTail, {}) )
-	{}
-
-	auto operator=(pool&& rhs) -> pool&
+	/**
+	* @brief Thread safe. Only one of several threads erasing the same index succeeds.
+	* @return false if the index does not refer to a live element.
+	*/
+	auto erase(index idx) -> bool
 	{
-		if (this != &rhs)
-		{
-			_release();
+		page_buffer* page = _page(idx.page);
 
-			m_allocator = std::exchange(rhs.m_allocator, {});
-			m_begin = std::exchange(rhs.m_begin, {});
-			m_end = std::exchange(rhs.m_end, {});
-			m_pFreelist = std::exchange(rhs.m_pFreelist, {});
-			m_freelistTail = std::exchange(rhs.m_freelistTail, {});
-
-			// No placement new is needed to be done on rhs as it is already in an valid but unspecified state.
+		if (page == nullptr ||
+			idx.offset >= PAGE_SIZE ||
+			!idx.valid())
+		{
+			return false;
 		}
-		return *this;
-	}
 
-	template <typename... Args>
-	constexpr auto emplace(Args&&... args) -> iterator
-	{
-		if (m_pFreelist == nullptr)
+		uint32 expected = idx.version;
+
+		if (!page->version[idx.offset].compare_exchange_strong(expected, idx.version + 1, std::memory_order_acq_rel, std::memory_order_relaxed))
 		{
-			_request_page();
+			return false;
 		}
 
-		return _try_emplace_at(m_pFreelist, std::forward<Args>(args)...);
-	};
+		_destroy_slot(*page, idx.offset);
 
-	// A problem will arise when we implement shrink to fit.
-	// How do we know that a page has nothing stored and can be removed?
-	// Perhaps we can have an element count variable in the page itself that tells us how many objects are being stored in that page.
-	// But that would mean we need to store the page pointer inside of the iterator itself.
-	// Seems necessary because we don't have a way to tell us which page is the data pointer in the iterator from (if we're strictly avoiding pointer math).
+		uint32 const slot = static_cast<uint32>(idx.page) * PAGE_SIZE + idx.offset;
 
-private:
+		_push_free_slots(*page, slot, slot);
 
-	using pool_page_size_type = typename decltype(config.page_size)::type;
+		return true;
+	}
 
-	/*
-	* Points to the next available index.
+	/**
+	* @brief Thread safe. Erases every element in the page and hands all of its slots back to the free list in a single exchange.
+	* Elements inserted into the page while it is being cleared may or may not be erased.
+	* @return Number of elements erased.
 	*/
-	struct free_node
+	auto clear(size_t pidx) -> size_t
 	{
-		free_node* next;
-	};
+		ASSERTION(pidx < MAX_PAGES, "Page index exceeded number of pages available in the pool");
 
-	struct alignas(alignof(value_type)) storage
-	{
-		using stored_type = std::conditional_t<sizeof(free_node) < sizeof(value_type), value_type, free_node>;
+		page_buffer* page = _page(pidx);
 
-		std::byte data[sizeof(stored_type)];
-	};
+		if (page == nullptr)
+		{
+			return 0;
+		}
 
-	struct page
-	{
-		storage* buffer;
-		free_node* nextFreeNode;
-		page* previous;
-		page* next;
-		size_t size;
-	};
+		uint32 const base = static_cast<uint32>(pidx) * PAGE_SIZE;
+		uint32 first = NULL_SLOT;
+		uint32 last = NULL_SLOT;
+		size_t count = 0;
 
-	using storage_allocator_type 	= typename std::allocator_traits<allocator_type>::template rebind_alloc<storage>;
-	using page_allocator_type 		= typename std::allocator_traits<allocator_type>::template rebind_alloc<page>;
+		for (size_t word = 0; word < MASK_WORD_COUNT; ++word)
+		{
+			uint64 mask = page->occupancy[word].load(std::memory_order_acquire);
 
-	using page_pointer 			= page*;
-	using free_node_pointer 	= free_node*;
+			for (; mask != 0; mask &= mask - 1)
+			{
+				size_t const offset = word * MASK_BITS + static_cast<size_t>(std::countr_zero(mask));
+				uint32 version = page->version[offset].load(std::memory_order_acquire);
 
-	allocator_type m_allocator;
-	page_pointer m_pageHead;	// This is the beginning of the page linked-list
-	page_pointer m_pageTail;	// This is the end of the page linked-list
-	free_node_pointer m_freelistHead;
-	free_node_pointer m_freelistTail;
+				// Lost to a concurrent erase.
+				if ((version & 1u) == 0 ||
+					!page->version[offset].compare_exchange_strong(version, version + 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+				{
+					continue;
+				}
 
-	template <typename... Args>
-	constexpr auto _try_emplace_at(free_node_pointer& ptr, Args&&... args) -> iterator
-	{
-		pointer data = nullptr;
+				_destroy_slot(*page, offset);
 
-		if (ptr)
-		{
-			auto location = ptr;
-			// Move the freelist head onto the next node.
-			ptr = ptr->next;
-			// To avoid UB, we need to end the lifetime of the freelist_node.
-			location->~free_node();
+				uint32 const slot = base + static_cast<uint32>(offset);
 
-			data = new (reinterpret_cast<pointer>(location)) value_type{ std::forward<Args>(args)... };
+				// Chain the slots together so that they are handed back at once.
+				if (last == NULL_SLOT)
+				{
+					last = slot;
+				}
+				else
+				{
+					page->next[offset].store(first, std::memory_order_relaxed);
+				}
+				first = slot;
+
+				++count;
+			}
+		}
+
+		if (count != 0)
+		{
+			_push_free_slots(*page, first, last);
 		}
 
-		return iterator{ data };
+		return count;
 	}
 
-	constexpr auto _request_page() -> void
-	{				
-		auto np = _allocate_page();
-		
-		if (!np)
+	/**
+	* @brief Thread safe, in the same sense as clear(size_t). Every index handed out before the call is invalidated.
+	*/
+	auto clear() -> void
+	{
+		size_t const count = page_count();
+
+		for (size_t i = 0; i < count; ++i)
 		{
-			return;
+			clear(i);
 		}
+	}
 
-		np->buffer = _allocate_and_construct_storage_buffer_in_page(*np);
+	/**
+	* @brief Not thread safe. Destroys every element and frees all pages.
+	*/
+	auto release() -> void
+	{
+		size_t const count = page_count();
 
-		if (!np->buffer)
+		for (size_t i = 0; i < count; ++i)
 		{
-			return;
-		}
+			page_buffer* page = m_pages[i].exchange(nullptr, std::memory_order_acq_rel);
 
-		_setup_begin_and_end_page(*np);
+			if (page == nullptr)
+			{
+				continue;
+			}
 
-		_setup_page_freelist(*np);
+			if constexpr (!std::is_trivially_destructible_v<element_type>)
+			{
+				for (size_t word = 0; word < MASK_WORD_COUNT; ++word)
+				{
+					for (uint64 mask = page->occupancy[word].load(std::memory_order_relaxed); mask != 0; mask &= mask - 1)
+					{
+						page->element(word * MASK_BITS + static_cast<size_t>(std::countr_zero(mask)))->~element_type();
+					}
+				}
+			}
 
-		_setup_free_list(*np);
+			delete page;
+		}
+
+		m_freeHead.store(_pack_head(0, NULL_SLOT), std::memory_order_relaxed);
+		m_cursor.store(0, std::memory_order_relaxed);
+		m_pageCount.store(0, std::memory_order_relaxed);
+		m_size.store(0, std::memory_order_relaxed);
 	}
 
-	constexpr auto _allocate_page() -> page*
+	auto size() const -> size_t
 	{
-		page_allocator_type allocator{ m_allocator.resource() };
+		return m_size.load(std::memory_order_relaxed);
+	}
 
-		// Allocate a new page buffer. np - new page.
-		auto np = std::allocator_traits<page_allocator_type>::allocate(allocator, sizeof(page));
+	auto empty() const -> bool
+	{
+		return size() == 0;
+	}
 
-		if (np)
-		{
-			// Start the lifetime of the buffer.
-			std::construct_at(np);
-		}
+	/**
+	* @brief One past the highest page that has been allocated.
+	*/
+	auto page_count() const -> size_t
+	{
+		return m_pageCount.load(std::memory_order_acquire);
+	}
 
-		return np;
+	static constexpr auto max_size() -> size_t
+	{
+		return static_cast<size_t>(MAX_PAGES) * PAGE_SIZE;
 	}
 
-	constexpr auto _allocate_and_construct_storage_buffer_in_page(page& pg) -> storage*
+	auto begin() -> iterator { return iterator{ this, 0 }; }
+	auto end() -> iterator { return iterator{ this, page_count() }; }
+	auto begin() const -> const_iterator { return const_iterator{ this, 0 }; }
+	auto end() const -> const_iterator { return const_iterator{ this, page_count() }; }
+	auto cbegin() const -> const_iterator { return begin(); }
+	auto cend() const -> const_iterator { return end(); }
+
+private:
+	std::unique_ptr<std::atomic<page_buffer*>[]> m_pages = std::make_unique<std::atomic<page_buffer*>[]>(MAX_PAGES);
+	alignas(cache_line_size_v) std::atomic<uint64> m_freeHead	= _pack_head(0, NULL_SLOT);	// Tag in the upper 32 bits, slot in the lower 32 bits.
+	alignas(cache_line_size_v) std::atomic_uint32_t m_cursor	= 0;						// Next slot that has never been handed out.
+	std::atomic_size_t m_pageCount = 0;
+	alignas(cache_line_size_v) std::atomic_size_t m_size = 0;
+
+	static constexpr auto _pack_head(uint32 tag, uint32 slot) -> uint64
 	{
-		storage_allocator_type allocator{ m_allocator.resource() };
+		return (static_cast<uint64>(tag) << 32) | slot;
+	}
 
-		auto ptr = std::allocator_traits<storage_allocator_type>::allocate(allocator, pool_page_size_type::value * sizeof(storage));
+	static constexpr auto _head_tag(uint64 head) -> uint32
+	{
+		return static_cast<uint32>(head >> 32);
+	}
 
-		if (ptr)
-		{
-			std::memset(ptr, 0, pool_page_size_type::value * sizeof(storage));
-		}
+	static constexpr auto _head_slot(uint64 head) -> uint32
+	{
+		return static_cast<uint32>(head);
+	}
 
-		return ptr;
+	auto _page(size_t pidx) const -> page_buffer*
+	{
+		return (pidx < MAX_PAGES) ? m_pages[pidx].load(std::memory_order_acquire) : nullptr;
 	}
 
-	constexpr auto _setup_begin_and_end_page(page& pg) -> void
+	/**
+	* @brief Pops a slot off the free list, or takes a fresh slot from the cursor when the free list is empty.
+	*/
+	auto _acquire_slot() -> uint32
 	{
-		// Assign the next pointer in m_end to the newly allocated page.
-		if (m_end != nullptr)
+		uint64 head = m_freeHead.load(std::memory_order_acquire);
+
+		while (_head_slot(head) != NULL_SLOT)
 		{
-			m_end->next = &pg;
+			uint32 const slot = _head_slot(head);
+			// May be stale if another thread pops and pushes the slot back in between, the tag makes the exchange below fail if that happens.
+			uint32 const next = _page(slot / PAGE_SIZE)->next[slot % PAGE_SIZE].load(std::memory_order_relaxed);
+
+			if (m_freeHead.compare_exchange_weak(head, _pack_head(_head_tag(head) + 1, next), std::memory_order_acquire, std::memory_order_acquire))
+			{
+				return slot;
+			}
 		}
 
-		pg.previous = m_end;
-		m_end = &pg;
+		uint32 slot = m_cursor.load(std::memory_order_relaxed);
 
-		// If this is the first time the page is allocated, we need to set the m_begin page_pointer.
-		if (m_begin == nullptr)
+		// The cursor never moves past max_size() so that it can not wrap around.
+		do
 		{
-			m_begin = m_end;
+			if (slot >= max_size())
+			{
+				return NULL_SLOT;
+			}
+		} while (!m_cursor.compare_exchange_weak(slot, slot + 1, std::memory_order_relaxed));
+
+		if (!_ensure_page(slot / PAGE_SIZE))
+		{
+			return NULL_SLOT;
 		}
+
+		return slot;
 	}
 
-	constexpr auto _setup_page_freelist(page& pg) -> void
+	/**
+	* @brief Allocates the page if no other thread has done so yet. Threads racing for the same page agree on a single allocation.
+	*/
+	auto _ensure_page(size_t pidx) -> bool
 	{
-		free_node dummyhead = {};
-		free_node_pointer tail = &dummyhead;
+		page_buffer* page = m_pages[pidx].load(std::memory_order_acquire);
 
-		// Start the lifetime of each element storage in the buffer as a freelist head.
-		for (auto&& storage : std::span{ pg.buffer, pool_page_size_type::value })
+		if (page == nullptr)
 		{
-			free_node_pointer node = reinterpret_cast<free_node_pointer>(storage.data);
-			// start lifetime.
-			std::construct_at(node);
+			page_buffer* allocated = new (std::nothrow) page_buffer;
+
+			if (allocated == nullptr)
+			{
+				return false;
+			}
 
-			tail->next = node;
-			tail = node;
+			if (!m_pages[pidx].compare_exchange_strong(page, allocated, std::memory_order_acq_rel, std::memory_order_acquire))
+			{
+				delete allocated;
+			}
 		}
-		// Set the freelist head in the page to the first free byte buffer in the storage.
-		pg.nextFreeNode = dummyhead.next;
+
+		size_t count = m_pageCount.load(std::memory_order_relaxed);
+
+		while (count <= pidx &&
+			!m_pageCount.compare_exchange_weak(count, pidx + 1, std::memory_order_release, std::memory_order_relaxed));
+
+		return true;
 	}
 
-	constexpr auto _setup_free_list(page& pg) -> void
+	auto _destroy_slot(page_buffer& page, size_t offset) -> void
 	{
-		if (m_pFreelist == nullptr)
-		{
-			m_pFreelist = pg.nextFreeNode;
-		}
+		page.occupancy[offset / MASK_BITS].fetch_and(~(uint64{ 1 } << (offset % MASK_BITS)), std::memory_order_release);
+		page.element(offset)->~element_type();
 
-		std::span buffer{ pg.buffer, pool_page_size_type::value };
-
-		if (m_freelistTail == nullptr)
-		{
-			m_freelistTail = reinterpret_cast<free_node_pointer>(&buffer.back().data);
-		}
-		else
-		{
-			m_freelistTail->next = pg.nextFreeNode;
-			m_freelistTail = reinterpret_cast<free_node_pointer>(&buffer.back().data);
-		}
+		m_size.fetch_sub(1, std::memory_order_relaxed);
 	}
 
-	constexpr auto _release() -> void
+	/**
+	* @brief Pushes a chain of slots linked through page_buffer::next onto the free list. last must live in page.
+	*/
+	auto _push_free_slots(page_buffer& page, uint32 first, uint32 last) -> void
 	{
-		// TODO(afiq):
-		// Implement release.
+		std::atomic_uint32_t& link = page.next[last % PAGE_SIZE];
+		uint64 head = m_freeHead.load(std::memory_order_relaxed);
+
+		do
+		{
+			link.store(_head_slot(head), std::memory_order_relaxed);
+		} while (!m_freeHead.compare_exchange_weak(head, _pack_head(_head_tag(head) + 1, first), std::memory_order_release, std::memory_order_relaxed));
 	}
 };
 
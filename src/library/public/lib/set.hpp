@@ -24,15 +24,24 @@ struct set_traits
 	{
 		return a == b;
 	}
+
+	template <typename K>
+	static constexpr bool compare_keys(K const& a, key_type const& b)
+	{
+		return b == a;
+	}
 };
 
-template <typename key, provides_memory in_allocator = allocator<typename set_traits<key>::type>, typename hasher = std::hash<key>, std::derived_from<container_growth_policy> growth_policy = shift_growth_policy<4>>
+/**
+* @brief Hash set. The layout can be either robin_hood_layout or group_probing_layout.
+*/
+template <typename key, provides_memory in_allocator = allocator<typename set_traits<key>::type>, typename hasher = hash<key>, std::derived_from<container_growth_policy> growth_policy = shift_growth_policy<4>, typename layout = robin_hood_layout>
 class set :
-	public hash_container_base<set_traits<key>, hasher, growth_policy, in_allocator>
+	public hash_container_base<set_traits<key>, hasher, growth_policy, in_allocator, layout>
 {
 private:
 
-	using super				= hash_container_base<set_traits<key>, hasher, growth_policy, in_allocator>;
+	using super				= hash_container_base<set_traits<key>, hasher, growth_policy, in_allocator, layout>;
 	using type				= typename super::interface_type;
 	using key_type			= typename super::key_type;
 	using value_type		= typename super::value_type;
@@ -51,9 +60,18 @@ public:
 		return super::_get_impl(in_key) != invalid_bucket_v;
 	}
 
+	/**
+	* Heterogeneous lookup, e.g. a std::string_view against lib::string keys. Requires a transparent hasher.
+	*/
+	template <transparent_key<hasher, key_type> K>
+	constexpr bool contains(K const& in_key) const
+	{
+		return super::_get_impl(in_key) != invalid_bucket_v;
+	}
+
 	constexpr void clear()
 	{
-		super::_destruct(0, super::capacity());
+		super::_clear();
 	}
 
 	constexpr void reserve(size_t capacity)
@@ -79,14 +97,26 @@ public:
 		return super::_remove_impl(in_key);
 	}
 
+	template <transparent_key<hasher, key_type> K>
+	constexpr bool erase(K const& in_key)
+	{
+		return super::_remove_impl(in_key);
+	}
+
 	constexpr bucket_value_type bucket(key_type const& in_key) const
 	{
 		return super::_get_impl(in_key);
 	}
 
+	template <transparent_key<hasher, key_type> K>
+	constexpr bucket_value_type bucket(K const& in_key) const
+	{
+		return super::_get_impl(in_key);
+	}
+
 	constexpr type& element_at_bucket(bucket_value_type bucket) const
 	{
-		ASSERTION(super::_info()[bucket].value() != nullptr && "Bucket value supplied is invalid!");
+		ASSERTION(super::_is_occupied(bucket) && "Bucket value supplied is invalid!");
 		return super::_data()[bucket];
 	}
 };
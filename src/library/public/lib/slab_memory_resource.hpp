@@ -0,0 +1,84 @@
+#pragma once
+#ifndef LIB_SLAB_MEMORY_RESOURCE_HPP
+#define LIB_SLAB_MEMORY_RESOURCE_HPP
+
+#include <atomic>
+#include <mutex>
+#include "memory.hpp"
+
+namespace lib
+{
+/**
+* Memory resource for small, fixed size blocks such as container nodes and short strings.
+*
+* Requests are rounded up to a power of two size class between min_block_size_v and max_block_size_v and carved out of 64 KiB slabs obtained straight from the OS.
+* Every thread allocates from its own set of slabs without taking a lock. Blocks freed by a thread that does not own the slab are pushed onto the slab's lock-free remote free list and picked up by the owner the next time it runs out of room.
+* Slabs that become empty are handed back to the OS, except for one that is kept around per size class to avoid thrashing.
+* Anything larger than max_block_size_v, or aligned to more than its own size class, is forwarded to the upstream resource.
+*
+* Slabs of a thread that exits are adopted by the next thread that starts allocating from the resource.
+*/
+class slab_memory_resource : public memory_resource
+{
+public:
+	static constexpr size_t min_block_size_v	= 16;
+	static constexpr size_t max_block_size_v	= 4_KiB;
+	static constexpr size_t slab_size_v			= 64_KiB;
+	static constexpr size_t size_class_count_v	= std::countr_zero(max_block_size_v) - std::countr_zero(min_block_size_v) + 1;
+
+	LIB_API slab_memory_resource(memory_resource* upstream = get_default_resource());
+	LIB_API ~slab_memory_resource() override;
+
+	/**
+	* @brief Collects the blocks other threads have freed into the calling thread's slabs and returns every empty slab to the OS.
+	*/
+	LIB_API auto trim() -> void;
+
+	auto upstream_resource() const -> memory_resource* { return m_upstream; }
+
+	/**
+	* @brief Number of slabs currently held from the OS across all threads.
+	*/
+	auto slab_count() const -> size_t { return m_slabCount.load(std::memory_order_relaxed); }
+
+	/**
+	* @return Size class serving the request, or size_class_count_v if the request goes to the upstream resource.
+	*/
+	static constexpr auto size_class_of(size_t size, size_t alignment) -> size_t
+	{
+		size_t const blockSize = std::bit_ceil(std::max({ size, alignment, min_block_size_v }));
+
+		if (blockSize > max_block_size_v)
+		{
+			return size_class_count_v;
+		}
+		return static_cast<size_t>(std::countr_zero(blockSize) - std::countr_zero(min_block_size_v));
+	}
+
+private:
+	struct slab;
+	struct heap;
+	struct thread_cache;
+
+	memory_resource* m_upstream;
+	uint64 m_id;
+	std::mutex m_heapMutex;
+	heap* m_heaps;
+	std::atomic_size_t m_slabCount;
+
+	LIB_API virtual auto do_allocate(size_t size, size_t alignment) -> void* override;
+	LIB_API virtual auto do_deallocate(void* p, size_t bytes, size_t alignment) -> void override;
+	LIB_API virtual auto do_is_equal(memory_resource const& other) -> bool override;
+
+	static auto _thread_cache() -> thread_cache&;
+
+	auto _local_heap(bool create) -> heap*;
+	auto _acquire_heap() -> heap*;
+	auto _allocate_block(heap& owner, size_t sizeClass) -> void*;
+	auto _free_block(heap& owner, slab& slab, void* p) -> void;
+	auto _new_slab(heap& owner, size_t sizeClass) -> slab*;
+	auto _release_slab(heap& owner, slab& slab) -> void;
+};
+}
+
+#endif // !LIB_SLAB_MEMORY_RESOURCE_HPP
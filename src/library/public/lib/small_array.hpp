@@ -0,0 +1,544 @@
+#pragma once
+#ifndef LIB_SMALL_ARRAY_HPP
+#define LIB_SMALL_ARRAY_HPP
+
+#include "array.hpp"
+
+namespace lib
+{
+/**
+* Array with room for N elements inside the object itself.
+*
+* Elements live in the inline buffer until the array outgrows it, after which they spill onto the heap like lib::array.
+* Meant for the many short lived arrays that hold a handful of elements, where the heap allocation costs more than the work done with the elements.
+* Moving a small_array whose elements are still inline relocates the elements, so pointers to them do not survive the move.
+*/
+template <
+	typename T,
+	size_t N,
+	typename allocator = allocator<T>,
+	std::derived_from<container_growth_policy> growth_policy = shift_growth_policy<4>
+>
+class small_array final
+{
+public:
+
+	static_assert(std::is_reference_v<T> == false, "small_array does not support storing reference types.");
+	static_assert(N != 0, "small_array needs room for at least one element, use lib::array otherwise.");
+
+	using value_type                = T;
+	using allocator_type            = allocator;
+	using size_type                 = size_t;
+	using difference_type           = std::ptrdiff_t;
+	using reference                 = value_type&;
+	using const_reference           = value_type const&;
+	using pointer                   = value_type*;
+	using const_pointer             = value_type const*;
+	using iterator                  = array_iterator<small_array>;
+	using const_iterator            = array_const_iterator<small_array>;
+	using const_reverse_iterator    = reverse_iterator<const_iterator>;
+	using reverse_iterator          = reverse_iterator<iterator>;
+
+	static constexpr size_t inline_capacity_v = N;
+
+	constexpr small_array() :
+		m_box{}, m_len{}, m_capacity{ N }
+	{
+		m_box.data = _inline_data();
+	}
+
+	constexpr small_array(allocator_type const& in_allocator) :
+		m_box{ nullptr, in_allocator }, m_len{}, m_capacity{ N }
+	{
+		m_box.data = _inline_data();
+	}
+
+	constexpr ~small_array()
+	{
+		release();
+	}
+
+	constexpr small_array(size_t length, allocator_type const& in_allocator = allocator_type{}) :
+		small_array(in_allocator)
+	{
+		reserve(length);
+	}
+
+	constexpr small_array(size_t count, value_type const& value, allocator_type const& in_allocator = allocator_type{}) :
+		small_array(in_allocator)
+	{
+		assign(count, value);
+	}
+
+	template <std::input_iterator input_iterator>
+	constexpr small_array(input_iterator first, input_iterator last, allocator_type const& in_allocator = allocator_type{}) :
+		small_array(in_allocator)
+	{
+		assign(first, last);
+	}
+
+	constexpr small_array(std::initializer_list<value_type> list, allocator_type const& in_allocator = allocator_type{}) :
+		small_array(in_allocator)
+	{
+		append(list);
+	}
+
+	constexpr small_array(small_array const& other) :
+		small_array(std::allocator_traits<allocator_type>::select_on_container_copy_construction(other.m_box))
+	{
+		_deep_copy(other);
+	}
+
+	constexpr small_array(small_array&& other) :
+		small_array(static_cast<allocator_type const&>(other.m_box))
+	{
+		_steal(other);
+	}
+
+	constexpr small_array& operator= (small_array const& other)
+	{
+		if (this != &other)
+		{
+			clear();
+			_deep_copy(other);
+		}
+		return *this;
+	}
+
+	constexpr small_array& operator= (small_array&& other)
+	{
+		if (this != &other)
+		{
+			release();
+			_steal(other);
+		}
+		return *this;
+	}
+
+	constexpr value_type& operator[] (size_t index) const
+	{
+		ASSERTION(index < m_len, "The index specified exceeded the internal buffer size of the array!");
+		return m_box.data[index];
+	}
+
+	constexpr bool operator==(small_array const& rhs) const
+	{
+		return std::equal(begin(), end(), rhs.begin(), rhs.end());
+	}
+
+	constexpr void reserve(size_t size)
+	{
+		if (size > m_capacity)
+		{
+			_grow(size);
+		}
+	}
+
+	constexpr void resize(size_t count)
+	{
+		if (count < m_len)
+		{
+			m_len -= _destruct(count, m_len);
+			return;
+		}
+
+		reserve(count);
+
+		for (size_t i = m_len; i < count; ++i)
+		{
+			emplace_back();
+		}
+	}
+
+	/**
+	* Every new element is constructed from the same arguments, so they are passed on as lvalues. Forwarding them would move from them more than once.
+	*/
+	template <typename... Args>
+	constexpr void resize(size_t count, Args&&... args)
+	{
+		if (count < m_len)
+		{
+			m_len -= _destruct(count, m_len);
+			return;
+		}
+
+		reserve(count);
+
+		for (size_t i = m_len; i < count; ++i)
+		{
+			emplace_back(args...);
+		}
+	}
+
+	/**
+	* Destroys every element and hands the heap buffer, if any, back to the allocator. The array is left using its inline buffer.
+	*/
+	constexpr void release()
+	{
+		_destruct(0, m_len);
+
+		if (!is_inline())
+		{
+			std::allocator_traits<allocator_type>::deallocate(m_box, m_box.data, m_capacity);
+		}
+		m_box.data = _inline_data();
+		m_capacity = N;
+		m_len = 0;
+	}
+
+	template <typename... Args>
+	constexpr reference emplace_back(Args&&... args)
+	{
+		if (m_len == m_capacity)
+		{
+			_grow();
+		}
+		new (m_box.data + m_len) value_type{ std::forward<Args>(args)... };
+		return m_box.data[m_len++];
+	}
+
+	template <typename... Args>
+	constexpr iterator emplace(const_iterator pos, Args&&... args)
+	{
+		ASSERTION(pos >= cbegin() && pos <= cend(), "Iterator is not within the range of the array.");
+
+		size_t const position = std::distance(cbegin(), pos);
+		// Built up front since the arguments may refer to elements that are about to be relocated.
+		value_type value{ std::forward<Args>(args)... };
+
+		pointer slot = _prepare_for_insert(position, 1);
+		new (slot) value_type{ std::move(value) };
+
+		return iterator{ slot, *this };
+	}
+
+	constexpr size_t push(value_type const& element)
+	{
+		emplace_back(element);
+		return m_len - 1;
+	}
+
+	constexpr size_t push(value_type&& element)
+	{
+		emplace_back(std::move(element));
+		return m_len - 1;
+	}
+
+	constexpr void push_back(value_type const& element)
+	{
+		emplace_back(element);
+	}
+
+	constexpr void push_back(value_type&& element)
+	{
+		emplace_back(std::move(element));
+	}
+
+	constexpr iterator insert(const_iterator pos, value_type const& value)
+	{
+		return emplace(pos, value);
+	}
+
+	constexpr iterator insert(const_iterator pos, value_type&& value)
+	{
+		return emplace(pos, std::move(value));
+	}
+
+	constexpr iterator insert(const_iterator pos, size_type count, value_type const& value)
+	{
+		ASSERTION(pos >= cbegin() && pos <= cend(), "Iterator is not within the range of the array.");
+
+		size_t const position = std::distance(cbegin(), pos);
+		// The value may be an element of this array.
+		value_type const copy{ value };
+
+		pointer slot = _prepare_for_insert(position, count);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			new (slot + i) value_type{ copy };
+		}
+
+		return iterator{ slot, *this };
+	}
+
+	template <std::input_iterator input_iterator>
+	constexpr iterator insert(const_iterator pos, input_iterator first, input_iterator last)
+	{
+		ASSERTION(pos >= cbegin() && pos <= cend(), "Iterator is not within the range of the array.");
+
+		size_t const position = std::distance(cbegin(), pos);
+		size_t const count = static_cast<size_t>(std::distance(first, last));
+
+		pointer slot = _prepare_for_insert(position, count);
+
+		for (pointer it = slot; first != last; ++first, ++it)
+		{
+			new (it) value_type{ *first };
+		}
+
+		return iterator{ slot, *this };
+	}
+
+	constexpr iterator insert(const_iterator pos, std::initializer_list<value_type> list)
+	{
+		return insert(pos, list.begin(), list.end());
+	}
+
+	constexpr size_t append(std::initializer_list<value_type> list)
+	{
+		reserve(m_len + list.size());
+
+		for (value_type const& value : list)
+		{
+			emplace_back(value);
+		}
+		return m_len - 1;
+	}
+
+	constexpr void assign(size_t count, value_type const& value)
+	{
+		clear();
+		reserve(count);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			emplace_back(value);
+		}
+	}
+
+	template <std::input_iterator input_iterator>
+	constexpr void assign(input_iterator first, input_iterator last)
+	{
+		clear();
+		reserve(static_cast<size_t>(std::distance(first, last)));
+
+		for (; first != last; ++first)
+		{
+			emplace_back(*first);
+		}
+	}
+
+	constexpr void assign(std::initializer_list<value_type> list)
+	{
+		clear();
+		append(list);
+	}
+
+	constexpr void pop(size_t count = 1)
+	{
+		ASSERTION(count <= m_len);
+
+		m_len -= _destruct(m_len - count, m_len);
+	}
+
+	constexpr void pop_back(size_t count = 1)
+	{
+		pop(count);
+	}
+
+	constexpr void pop_at(size_t index)
+	{
+		// The element should reside within the container's length.
+		ASSERTION(index < m_len);
+
+		_destruct(index, index + 1);
+		// Close the gap left behind by the element.
+		relocate(m_box.data + index + 1, m_box.data + index, m_len - index - 1);
+
+		--m_len;
+	}
+
+	constexpr void pop_at(const_iterator pos)
+	{
+		pop_at(static_cast<size_t>(std::distance(cbegin(), pos)));
+	}
+
+	constexpr iterator erase(const_iterator pos)
+	{
+		ASSERTION(pos >= cbegin() && pos < cend() && "Iterator is not within the range of the array.");
+
+		size_t const index = std::distance(cbegin(), pos);
+
+		pop_at(index);
+
+		return iterator{ m_box.data + index, *this };
+	}
+
+	constexpr iterator erase(const_iterator begin, const_iterator end)
+	{
+		size_t const from = std::distance(cbegin(), begin);
+		size_t const to = std::distance(cbegin(), end);
+
+		_destruct(from, to);
+		relocate(m_box.data + to, m_box.data + from, m_len - to);
+
+		m_len -= (to - from);
+
+		return iterator{ m_box.data + from, *this };
+	}
+
+	constexpr bool empty() const
+	{
+		return m_len == 0;
+	}
+
+	constexpr void clear()
+	{
+		_destruct(0, m_len);
+		m_len = 0;
+	}
+
+	/**
+	* True while the elements live in the inline buffer.
+	*/
+	constexpr bool is_inline() const
+	{
+		return m_box.data == _inline_data();
+	}
+
+	constexpr size_t index_of(value_type const& element) const
+	{
+		return index_of(&element);
+	}
+
+	constexpr size_t index_of(value_type const* element) const
+	{
+		// Object must reside within the boundaries of the array.
+		ASSERTION(element >= m_box.data && element < m_box.data + m_capacity);
+
+		return static_cast<size_t>(element - m_box.data);
+	}
+
+	constexpr size_t    size    () const { return m_len; }
+	constexpr size_t    capacity() const { return m_capacity; }
+	constexpr pointer   data    () const { return m_box.data; }
+	constexpr size_t    bytes   () const { return m_len * sizeof(value_type); }
+
+	constexpr size_t    size_bytes() const { return bytes(); }
+
+	constexpr allocator_type get_allocator() const { return static_cast<allocator_type const&>(m_box); }
+
+	constexpr reference front   () { return *data(); }
+	constexpr reference back    () { return *(data() + (m_len - 1)); }
+
+	constexpr const_reference front ()  const    { return *data(); }
+	constexpr const_reference back  ()  const    { return *(data() + (m_len - 1)); }
+
+	constexpr iterator                  begin   ()          { return iterator(m_box.data, *this); }
+	constexpr iterator                  end     ()          { return iterator(m_box.data + m_len, *this); }
+	constexpr const_iterator            begin   () const    { return const_iterator(m_box.data, *this); }
+	constexpr const_iterator            end     () const    { return const_iterator(m_box.data + m_len, *this); }
+	constexpr const_iterator            cbegin  () const    { return const_iterator(m_box.data, *this); }
+	constexpr const_iterator            cend    () const    { return const_iterator(m_box.data + m_len, *this); }
+	constexpr reverse_iterator          rbegin  ()          { return reverse_iterator(end()); }
+	constexpr reverse_iterator          rend    ()          { return reverse_iterator(begin()); }
+	constexpr const_reverse_iterator    rbegin  () const    { return const_reverse_iterator(end()); }
+	constexpr const_reverse_iterator    rend    () const    { return const_reverse_iterator(begin()); }
+	constexpr const_reverse_iterator    crbegin () const    { return const_reverse_iterator(end()); }
+	constexpr const_reverse_iterator    crend   () const    { return const_reverse_iterator(begin()); }
+
+private:
+	struct alignas(alignof(value_type)) storage
+	{
+		std::byte data[sizeof(value_type) * N];
+	};
+
+	using box_type = box<pointer, allocator_type>;
+
+	box_type m_box;
+	size_t m_len;
+	size_t m_capacity;
+	storage m_inline;
+
+	constexpr pointer _inline_data() const
+	{
+		return reinterpret_cast<pointer>(const_cast<std::byte*>(m_inline.data));
+	}
+
+	constexpr void _grow(size_t size = 0)
+	{
+		size_t const oldCapacity = m_capacity;
+		size_t const capacity = (size != 0) ? size : growth_policy::new_capacity(m_capacity);
+
+		pointer temp = std::allocator_traits<allocator_type>::allocate(m_box, capacity);
+
+		relocate(m_box.data, temp, m_len);
+
+		if (!is_inline())
+		{
+			std::allocator_traits<allocator_type>::deallocate(m_box, m_box.data, oldCapacity);
+		}
+
+		m_box.data = temp;
+		m_capacity = capacity;
+	}
+
+	constexpr size_t _destruct(size_t from, size_t to)
+	{
+		if constexpr (!std::is_trivially_destructible_v<value_type>)
+		{
+			for (size_t i = from; i < to; ++i)
+			{
+				m_box.data[i].~value_type();
+			}
+		}
+		return to - from;
+	}
+
+	/**
+	* Opens a gap of "count" uninitialized slots at "position" and returns a pointer to the first of them.
+	*/
+	constexpr pointer _prepare_for_insert(size_t position, size_t count)
+	{
+		if (count > (m_capacity - m_len))
+		{
+			_grow(growth_policy::new_capacity(m_len + count));
+		}
+
+		relocate(m_box.data + position, m_box.data + position + count, m_len - position);
+
+		m_len += count;
+
+		return m_box.data + position;
+	}
+
+	constexpr auto _deep_copy(small_array const& other) -> void
+	{
+		reserve(other.size());
+
+		if constexpr (std::is_trivially_copyable_v<value_type>)
+		{
+			std::memcpy(m_box.data, other.m_box.data, sizeof(value_type) * other.size());
+		}
+		else
+		{
+			for (size_t i = 0; i < other.m_len; ++i)
+			{
+				new (m_box.data + i) value_type{ other.m_box.data[i] };
+			}
+		}
+
+		m_len = other.size();
+	}
+
+	/**
+	* Takes over the heap buffer of "other", or relocates its elements when they are still inline. "other" is left empty and inline.
+	*/
+	constexpr auto _steal(small_array& other) -> void
+	{
+		if (other.is_inline())
+		{
+			relocate(other.m_box.data, m_box.data, other.m_len);
+		}
+		else
+		{
+			m_box.data = std::exchange(other.m_box.data, other._inline_data());
+			m_capacity = std::exchange(other.m_capacity, N);
+		}
+		m_len = std::exchange(other.m_len, 0);
+	}
+};
+}
+
+#endif // !LIB_SMALL_ARRAY_HPP
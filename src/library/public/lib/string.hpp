@@ -9,6 +9,8 @@
 #include <fmt/std.h>
 #include "array.hpp"
 #include "concepts.hpp"
+#include "hash.hpp"
+#include "string_search.hpp"
 
 namespace lib
 {
@@ -32,13 +34,13 @@ struct null_terminator<wchar_t>
 template <is_char_type T>
 constexpr inline T null_v = null_terminator<T>::value;
 
+/**
+* Forwards to std::char_traits, which lowers to the vectorized strlen and wcslen of the C runtime.
+*/
 template <is_char_type T>
-auto strlen(const T* str) -> size_t
+constexpr auto strlen(const T* str) -> size_t
 {
-	const T* ch = str;
-	size_t length = 0;
-	for (; *ch != null_v<T>; ++ch, ++length);
-	return length;
+	return std::char_traits<T>::length(str);
 }
 
 /**
@@ -65,6 +67,8 @@ public:
     using iterator          = array_iterator<basic_string>;
     using const_iterator    = array_const_iterator<basic_string>;
 
+	static constexpr size_type npos = std::basic_string_view<value_type>::npos;
+
 	constexpr basic_string() :
 		m_box{},
 		m_len{ 0 },
@@ -368,6 +372,83 @@ public:
 		return *this;
 	}
 
+	/**
+	* Search and case-insensitive comparison with std::basic_string_view semantics.
+	* Narrow strings use the vectorized implementations in string_search.hpp, the other character types fall back to std::basic_string_view.
+	*/
+	auto find(value_type ch, size_type pos = 0) const -> size_type
+	{
+		if constexpr (std::same_as<value_type, char>)
+		{
+			return lib::str::find(_view(), ch, pos);
+		}
+		else
+		{
+			return _view().find(ch, pos);
+		}
+	}
+
+	auto find(std::basic_string_view<value_type> needle, size_type pos = 0) const -> size_type
+	{
+		if constexpr (std::same_as<value_type, char>)
+		{
+			return lib::str::find(_view(), needle, pos);
+		}
+		else
+		{
+			return _view().find(needle, pos);
+		}
+	}
+
+	auto rfind(value_type ch, size_type pos = npos) const -> size_type
+	{
+		if constexpr (std::same_as<value_type, char>)
+		{
+			return lib::str::rfind(_view(), ch, pos);
+		}
+		else
+		{
+			return _view().rfind(ch, pos);
+		}
+	}
+
+	auto rfind(std::basic_string_view<value_type> needle, size_type pos = npos) const -> size_type
+	{
+		if constexpr (std::same_as<value_type, char>)
+		{
+			return lib::str::rfind(_view(), needle, pos);
+		}
+		else
+		{
+			return _view().rfind(needle, pos);
+		}
+	}
+
+	auto find_first_of(std::basic_string_view<value_type> set, size_type pos = 0) const -> size_type
+	{
+		if constexpr (std::same_as<value_type, char>)
+		{
+			return lib::str::find_first_of(_view(), set, pos);
+		}
+		else
+		{
+			return _view().find_first_of(set, pos);
+		}
+	}
+
+	/**
+	* Only available on narrow strings, folds ASCII only.
+	*/
+	auto compare_ignore_case(std::basic_string_view<value_type> other) const -> int32 requires std::same_as<value_type, char>
+	{
+		return lib::str::compare_ignore_case(_view(), other);
+	}
+
+	auto equals_ignore_case(std::basic_string_view<value_type> other) const -> bool requires std::same_as<value_type, char>
+	{
+		return lib::str::equals_ignore_case(_view(), other);
+	}
+
 	constexpr pointer       data() { return _data(); }
 	constexpr const_pointer data()  const { return _data(); }
 	constexpr const_pointer c_str()	const { return _data(); }
@@ -479,6 +560,11 @@ private:
 		return is_small_string() ? m_box->buf : m_box->ptr;
 	}
 
+	constexpr auto _view() const -> std::basic_string_view<value_type>
+	{
+		return std::basic_string_view<value_type>{ _data(), m_len };
+	}
+
     constexpr void _grow(size_t length)
     {
         bool const wasPrevSmallString = is_small_string();
@@ -740,25 +826,25 @@ public:
     constexpr basic_hash_string_view(const_pointer str) :
         super{ str }
     {
-        m_hash = static_cast<T>((std::hash<super>{})(*this));
+        m_hash = static_cast<T>(hash_bytes(super::data(), super::size() * sizeof(char_type)));
     }
     constexpr basic_hash_string_view(const_pointer str, size_type count) :
         super{ str, count }
     {
-        m_hash = static_cast<T>((std::hash<super>{})(*this));
+        m_hash = static_cast<T>(hash_bytes(super::data(), super::size() * sizeof(char_type)));
     };
     template <typename start_iterator, typename end_iterator>
     constexpr basic_hash_string_view(start_iterator first, end_iterator last) :
         super{ first, last }
     {
-        m_hash = static_cast<T>((std::hash<super>{})(*this));
+        m_hash = static_cast<T>(hash_bytes(super::data(), super::size() * sizeof(char_type)));
     }
 
     template <typename StringView_t = super>
     constexpr basic_hash_string_view(StringView_t&& strView) :
         super{ std::forward<StringView_t>(strView) }
     {
-        m_hash = static_cast<T>((std::hash<super>{})(*this));
+        m_hash = static_cast<T>(hash_bytes(super::data(), super::size() * sizeof(char_type)));
     }
 
     constexpr basic_hash_string_view& operator=(basic_hash_string_view const& rhs) = default;
@@ -905,6 +991,15 @@ public:
 using string_pool   = basic_string_pool<char, 16_KiB>;
 using wstring_pool  = basic_string_pool<wchar_t, 32_KiB>;
 
+template <is_char_type char_type, provides_memory in_allocator, std::derived_from<container_growth_policy> growth_policy>
+struct hash<basic_string<char_type, in_allocator, growth_policy>> : string_hash<char_type> {};
+
+/**
+* The small string buffer is addressed through the capacity flag rather than a pointer back into the object.
+*/
+template <is_char_type char_type, provides_memory in_allocator, std::derived_from<container_growth_policy> growth_policy>
+struct is_trivially_relocatable<basic_string<char_type, in_allocator, growth_policy>> : std::true_type {};
+
 }
 
 template<>
@@ -912,14 +1007,7 @@ struct std::hash<lib::string>
 {
     size_t operator()(const lib::string& str) const noexcept
     {
-        using value_type = typename lib::string::value_type;
-        std::hash<value_type> hasher;
-        size_t result = 0;
-        for (value_type const& c : str)
-        {
-            result += hasher(c);
-        }
-        return result;
+        return static_cast<size_t>(lib::hash_bytes(str.data(), str.size()));
     }
 };
 
@@ -928,7 +1016,7 @@ struct std::hash<lib::hash_string_view>
 {
     size_t operator()(lib::hash_string_view const& strView) const noexcept
     {
-        return (std::hash<std::string_view>{})(strView.to_string_view());
+        return static_cast<size_t>(strView.hash());
     }
 };
 
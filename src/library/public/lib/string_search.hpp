@@ -0,0 +1,509 @@
+#pragma once
+#ifndef LIB_STRING_SEARCH_HPP
+#define LIB_STRING_SEARCH_HPP
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <string_view>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define LIB_STRING_AVX2 1
+#define LIB_STRING_SSE2 1
+#elif defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define LIB_STRING_AVX2 0
+#define LIB_STRING_SSE2 1
+#else
+#define LIB_STRING_AVX2 0
+#define LIB_STRING_SSE2 0
+#endif
+
+#include "hash.hpp"
+
+/**
+* Vectorized search and comparison over narrow strings. Shader define parsing, pipeline lookups and the command line all scan std::string_view,
+* so these take views and lib::string forwards to them.
+*
+* Every function follows the std::string_view semantics of the operation it is named after and returns std::string_view::npos when nothing is found.
+* Blocks of 16 (SSE2) or 32 (AVX2) bytes are only loaded while they lie entirely inside the string, the remainder is handled a byte at a time,
+* so nothing is read past the end of the view.
+*
+* Case-insensitive operations fold ASCII only, bytes outside of 'A' to 'Z' are compared as they are.
+*/
+namespace lib
+{
+namespace str
+{
+inline constexpr size_t npos = std::string_view::npos;
+
+namespace detail
+{
+/**
+* Sets up to 8 characters are matched with one compare per character per block. Larger sets are looked up in a bitmap a byte at a time.
+*/
+inline constexpr size_t small_set_v = 8;
+
+constexpr auto fold_case(char ch) -> uint8
+{
+	uint8 const byte = static_cast<uint8>(ch);
+	return (static_cast<uint8>(byte - 'A') < 26) ? static_cast<uint8>(byte | 0x20) : byte;
+}
+
+constexpr auto highest_bit(uint32 mask) -> size_t
+{
+	return static_cast<size_t>(31 - std::countl_zero(mask));
+}
+
+#if LIB_STRING_SSE2
+inline auto load_16(char const* p) -> __m128i
+{
+	return _mm_loadu_si128(reinterpret_cast<__m128i const*>(p));
+}
+
+inline auto match_16(char const* p, __m128i ch) -> uint32
+{
+	return static_cast<uint32>(_mm_movemask_epi8(_mm_cmpeq_epi8(load_16(p), ch)));
+}
+
+/**
+* @brief Bit i is set when the needle's first character is at p[i] and its last character is at p[i + length - 1].
+*/
+inline auto match_ends_16(char const* p, size_t length, __m128i first, __m128i last) -> uint32
+{
+	__m128i const head = _mm_cmpeq_epi8(load_16(p), first);
+	__m128i const tail = _mm_cmpeq_epi8(load_16(p + length - 1), last);
+
+	return static_cast<uint32>(_mm_movemask_epi8(_mm_and_si128(head, tail)));
+}
+
+/**
+* @brief Adds 0x20 to 'A' to 'Z'. Shifting 'A' to -128 leaves the upper case letters as the only bytes below -102 in a signed compare.
+*/
+inline auto fold_case_16(__m128i x) -> __m128i
+{
+	__m128i const shifted = _mm_add_epi8(x, _mm_set1_epi8(static_cast<char>(128 - 'A')));
+	__m128i const upper = _mm_cmplt_epi8(shifted, _mm_set1_epi8(static_cast<char>(-128 + 26)));
+
+	return _mm_or_si128(x, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+#endif
+
+#if LIB_STRING_AVX2
+inline auto load_32(char const* p) -> __m256i
+{
+	return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p));
+}
+
+inline auto match_32(char const* p, __m256i ch) -> uint32
+{
+	return static_cast<uint32>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(load_32(p), ch)));
+}
+
+inline auto match_ends_32(char const* p, size_t length, __m256i first, __m256i last) -> uint32
+{
+	__m256i const head = _mm256_cmpeq_epi8(load_32(p), first);
+	__m256i const tail = _mm256_cmpeq_epi8(load_32(p + length - 1), last);
+
+	return static_cast<uint32>(_mm256_movemask_epi8(_mm256_and_si256(head, tail)));
+}
+
+inline auto fold_case_32(__m256i x) -> __m256i
+{
+	__m256i const shifted = _mm256_add_epi8(x, _mm256_set1_epi8(static_cast<char>(128 - 'A')));
+	__m256i const upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(-128 + 26)), shifted);
+
+	return _mm256_or_si256(x, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+}
+#endif
+
+#if LIB_STRING_SSE2
+/**
+* @brief Candidate masks of 64 consecutive positions. Testing one mask per 64 bytes keeps the loop from stalling on a branch per block when matches are rare.
+*/
+inline auto match_ends_64(char const* p, size_t length, char first, char last) -> uint64
+{
+#if LIB_STRING_AVX2
+	__m256i const first32 = _mm256_set1_epi8(first);
+	__m256i const last32 = _mm256_set1_epi8(last);
+	return static_cast<uint64>(match_ends_32(p, length, first32, last32)) | (static_cast<uint64>(match_ends_32(p + 32, length, first32, last32)) << 32);
+#else
+	__m128i const first16 = _mm_set1_epi8(first);
+	__m128i const last16 = _mm_set1_epi8(last);
+	return static_cast<uint64>(match_ends_16(p, length, first16, last16)) | (static_cast<uint64>(match_ends_16(p + 16, length, first16, last16)) << 16) |
+		(static_cast<uint64>(match_ends_16(p + 32, length, first16, last16)) << 32) | (static_cast<uint64>(match_ends_16(p + 48, length, first16, last16)) << 48);
+#endif
+}
+#endif
+
+/**
+* @brief Checks the characters between the needle's ends, which the candidate masks have already matched.
+*/
+inline auto matches_inside(char const* p, std::string_view needle) -> bool
+{
+	return std::memcmp(p + 1, needle.data() + 1, needle.size() - 2) == 0;
+}
+}
+
+inline auto find(std::string_view haystack, char ch, size_t pos = 0) -> size_t
+{
+	char const* const p = haystack.data();
+	size_t const size = haystack.size();
+
+	if (pos >= size)
+	{
+		return npos;
+	}
+
+	// The C runtimes ship a vectorized memchr that is unrolled further than the blocks used here.
+	void const* const match = std::memchr(p + pos, ch, size - pos);
+
+	return (match != nullptr) ? static_cast<size_t>(static_cast<char const*>(match) - p) : npos;
+}
+
+/**
+* @brief Compares the first and last character of the needle against every position in a block at once, only positions where both match are compared in full.
+*/
+inline auto find(std::string_view haystack, std::string_view needle, size_t pos = 0) -> size_t
+{
+	char const* const p = haystack.data();
+	size_t const size = haystack.size();
+	size_t const length = needle.size();
+
+	if (length == 0)
+	{
+		return (pos <= size) ? pos : npos;
+	}
+
+	if (length == 1)
+	{
+		return find(haystack, needle[0], pos);
+	}
+
+	if (pos > size || size - pos < length)
+	{
+		return npos;
+	}
+
+	// One past the last position the needle can start at.
+	size_t const end = size - length + 1;
+	size_t i = pos;
+
+#if LIB_STRING_SSE2
+	for (; i + 64 <= end; i += 64)
+	{
+		for (uint64 mask = detail::match_ends_64(p + i, length, needle.front(), needle.back()); mask != 0; mask &= mask - 1)
+		{
+			size_t const candidate = i + static_cast<size_t>(std::countr_zero(mask));
+
+			if (detail::matches_inside(p + candidate, needle))
+			{
+				return candidate;
+			}
+		}
+	}
+
+	__m128i const first16 = _mm_set1_epi8(needle.front());
+	__m128i const last16 = _mm_set1_epi8(needle.back());
+
+	for (; i + 16 <= end; i += 16)
+	{
+		for (uint32 mask = detail::match_ends_16(p + i, length, first16, last16); mask != 0; mask &= mask - 1)
+		{
+			size_t const candidate = i + static_cast<size_t>(std::countr_zero(mask));
+
+			if (detail::matches_inside(p + candidate, needle))
+			{
+				return candidate;
+			}
+		}
+	}
+#endif
+
+	for (; i < end; ++i)
+	{
+		if (p[i] == needle.front() && p[i + length - 1] == needle.back() && detail::matches_inside(p + i, needle))
+		{
+			return i;
+		}
+	}
+
+	return npos;
+}
+
+inline auto rfind(std::string_view haystack, char ch, size_t pos = npos) -> size_t
+{
+	char const* const p = haystack.data();
+
+	if (haystack.empty())
+	{
+		return npos;
+	}
+
+	// Positions below end are searched, blocks are taken from the back.
+	size_t end = std::min(pos, haystack.size() - 1) + 1;
+
+#if LIB_STRING_AVX2
+	__m256i const ch32 = _mm256_set1_epi8(ch);
+
+	for (; end >= 32; end -= 32)
+	{
+		if (uint32 const mask = detail::match_32(p + end - 32, ch32); mask != 0)
+		{
+			return end - 32 + detail::highest_bit(mask);
+		}
+	}
+#endif
+#if LIB_STRING_SSE2
+	__m128i const ch16 = _mm_set1_epi8(ch);
+
+	for (; end >= 16; end -= 16)
+	{
+		if (uint32 const mask = detail::match_16(p + end - 16, ch16); mask != 0)
+		{
+			return end - 16 + detail::highest_bit(mask);
+		}
+	}
+#endif
+
+	while (end != 0)
+	{
+		if (p[--end] == ch)
+		{
+			return end;
+		}
+	}
+
+	return npos;
+}
+
+inline auto rfind(std::string_view haystack, std::string_view needle, size_t pos = npos) -> size_t
+{
+	char const* const p = haystack.data();
+	size_t const size = haystack.size();
+	size_t const length = needle.size();
+
+	if (length == 0)
+	{
+		return std::min(pos, size);
+	}
+
+	if (length == 1)
+	{
+		return rfind(haystack, needle[0], pos);
+	}
+
+	if (length > size)
+	{
+		return npos;
+	}
+
+	size_t end = std::min(pos, size - length) + 1;
+
+#if LIB_STRING_AVX2
+	__m256i const first32 = _mm256_set1_epi8(needle.front());
+	__m256i const last32 = _mm256_set1_epi8(needle.back());
+
+	for (; end >= 32; end -= 32)
+	{
+		size_t const base = end - 32;
+
+		for (uint32 mask = detail::match_ends_32(p + base, length, first32, last32); mask != 0;)
+		{
+			size_t const bit = detail::highest_bit(mask);
+
+			if (detail::matches_inside(p + base + bit, needle))
+			{
+				return base + bit;
+			}
+
+			mask &= ~(1u << bit);
+		}
+	}
+#endif
+#if LIB_STRING_SSE2
+	__m128i const first16 = _mm_set1_epi8(needle.front());
+	__m128i const last16 = _mm_set1_epi8(needle.back());
+
+	for (; end >= 16; end -= 16)
+	{
+		size_t const base = end - 16;
+
+		for (uint32 mask = detail::match_ends_16(p + base, length, first16, last16); mask != 0;)
+		{
+			size_t const bit = detail::highest_bit(mask);
+
+			if (detail::matches_inside(p + base + bit, needle))
+			{
+				return base + bit;
+			}
+
+			mask &= ~(1u << bit);
+		}
+	}
+#endif
+
+	while (end != 0)
+	{
+		--end;
+
+		if (p[end] == needle.front() && p[end + length - 1] == needle.back() && detail::matches_inside(p + end, needle))
+		{
+			return end;
+		}
+	}
+
+	return npos;
+}
+
+inline auto find_first_of(std::string_view haystack, std::string_view set, size_t pos = 0) -> size_t
+{
+	char const* const p = haystack.data();
+	size_t const size = haystack.size();
+
+	if (pos >= size || set.empty())
+	{
+		return npos;
+	}
+
+	if (set.size() == 1)
+	{
+		return find(haystack, set[0], pos);
+	}
+
+	uint64 table[4] = {};
+
+	for (char const ch : set)
+	{
+		uint8 const byte = static_cast<uint8>(ch);
+		table[byte >> 6] |= 1ull << (byte & 63);
+	}
+
+	size_t i = pos;
+
+	if (set.size() <= detail::small_set_v)
+	{
+#if LIB_STRING_AVX2
+		for (; i + 32 <= size; i += 32)
+		{
+			__m256i const block = detail::load_32(p + i);
+			__m256i hits = _mm256_setzero_si256();
+
+			for (char const ch : set)
+			{
+				hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(block, _mm256_set1_epi8(ch)));
+			}
+
+			if (uint32 const mask = static_cast<uint32>(_mm256_movemask_epi8(hits)); mask != 0)
+			{
+				return i + static_cast<size_t>(std::countr_zero(mask));
+			}
+		}
+#endif
+#if LIB_STRING_SSE2
+		for (; i + 16 <= size; i += 16)
+		{
+			__m128i const block = detail::load_16(p + i);
+			__m128i hits = _mm_setzero_si128();
+
+			for (char const ch : set)
+			{
+				hits = _mm_or_si128(hits, _mm_cmpeq_epi8(block, _mm_set1_epi8(ch)));
+			}
+
+			if (uint32 const mask = static_cast<uint32>(_mm_movemask_epi8(hits)); mask != 0)
+			{
+				return i + static_cast<size_t>(std::countr_zero(mask));
+			}
+		}
+#endif
+	}
+
+	for (; i < size; ++i)
+	{
+		uint8 const byte = static_cast<uint8>(p[i]);
+
+		if ((table[byte >> 6] >> (byte & 63)) & 1)
+		{
+			return i;
+		}
+	}
+
+	return npos;
+}
+
+/**
+* @brief Three-way comparison of the case folded strings.
+* @return Negative when lhs orders before rhs, zero when they are equal and positive otherwise. Bytes are compared unsigned, like std::char_traits<char>::compare.
+*/
+inline auto compare_ignore_case(std::string_view lhs, std::string_view rhs) -> int32
+{
+	char const* const a = lhs.data();
+	char const* const b = rhs.data();
+	size_t const count = std::min(lhs.size(), rhs.size());
+
+	size_t i = 0;
+
+#if LIB_STRING_AVX2
+	for (; i + 32 <= count; i += 32)
+	{
+		__m256i const x = detail::fold_case_32(detail::load_32(a + i));
+		__m256i const y = detail::fold_case_32(detail::load_32(b + i));
+
+		if (uint32 const mask = ~static_cast<uint32>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y))); mask != 0)
+		{
+			i += static_cast<size_t>(std::countr_zero(mask));
+			return (detail::fold_case(a[i]) < detail::fold_case(b[i])) ? -1 : 1;
+		}
+	}
+#endif
+#if LIB_STRING_SSE2
+	for (; i + 16 <= count; i += 16)
+	{
+		__m128i const x = detail::fold_case_16(detail::load_16(a + i));
+		__m128i const y = detail::fold_case_16(detail::load_16(b + i));
+
+		if (uint32 const mask = static_cast<uint32>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, y))) ^ 0xFFFFu; mask != 0)
+		{
+			i += static_cast<size_t>(std::countr_zero(mask));
+			return (detail::fold_case(a[i]) < detail::fold_case(b[i])) ? -1 : 1;
+		}
+	}
+#endif
+
+	for (; i < count; ++i)
+	{
+		uint8 const x = detail::fold_case(a[i]);
+		uint8 const y = detail::fold_case(b[i]);
+
+		if (x != y)
+		{
+			return (x < y) ? -1 : 1;
+		}
+	}
+
+	if (lhs.size() == rhs.size())
+	{
+		return 0;
+	}
+
+	return (lhs.size() < rhs.size()) ? -1 : 1;
+}
+
+inline auto equals_ignore_case(std::string_view lhs, std::string_view rhs) -> bool
+{
+	return lhs.size() == rhs.size() && compare_ignore_case(lhs, rhs) == 0;
+}
+
+/**
+* @brief Same hash as lib::hash<std::string_view> and lib::hash<lib::string>, so keys hashed ahead of time can be looked up in lib::map.
+*/
+inline auto hash(std::string_view str, uint64 seed = 0) -> uint64
+{
+	return hash_bytes(str.data(), str.size(), seed);
+}
+}
+}
+
+#endif // !LIB_STRING_SEARCH_HPP
@@ -0,0 +1,156 @@
+#pragma once
+#ifndef LIB_TRACKING_MEMORY_RESOURCE_HPP
+#define LIB_TRACKING_MEMORY_RESOURCE_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <source_location>
+#include <span>
+#include "memory.hpp"
+#include "string.hpp"
+
+/**
+* Size histograms and call sites are only recorded when this is non-zero. Release builds keep the byte and allocation counters only.
+*/
+#ifndef LIB_DETAILED_MEMORY_TRACKING
+#ifdef RELEASE
+#define LIB_DETAILED_MEMORY_TRACKING 0
+#else
+#define LIB_DETAILED_MEMORY_TRACKING 1
+#endif
+#endif
+
+namespace lib
+{
+/**
+* Memory resource that forwards to an upstream resource and keeps statistics about the allocations that pass through it under a tag.
+*
+* Every live tracking resource is registered globally so that all tags can be dumped at once with dump_all().
+* Memory that does not come from the resource, e.g. GPU staging buffers or blocks owned by a caller supplied resource, can be accounted for with record_allocation() and record_deallocation().
+*
+* Call sites are attributed through call_site scopes. One in every "sampleRate" allocations made while a scope is active on the calling thread is recorded against the scope's location.
+*/
+class tracking_memory_resource : public memory_resource
+{
+public:
+	static constexpr bool detailed_v = LIB_DETAILED_MEMORY_TRACKING != 0;
+	static constexpr size_t histogram_bucket_count_v = 24;	// Powers of two from 16 bytes, the last bucket takes everything larger.
+	static constexpr size_t max_call_sites_v = 64;
+	static constexpr uint32 default_sample_rate_v = 64;
+
+	struct statistics
+	{
+		size_t liveBytes;
+		size_t peakBytes;
+		size_t totalBytes;
+		uint64 liveAllocations;
+		uint64 totalAllocations;
+		std::array<uint64, histogram_bucket_count_v> histogram;
+	};
+
+	struct call_site_statistics
+	{
+		std::source_location location;
+		uint64 sampledAllocations;
+		size_t sampledBytes;
+	};
+
+	/**
+	* Attributes allocations made on the calling thread to the location the scope is constructed at until it goes out of scope.
+	*/
+	class call_site : lib::non_copyable_non_movable
+	{
+	public:
+		LIB_API call_site(std::source_location location = std::source_location::current());
+		LIB_API ~call_site();
+	private:
+		friend class tracking_memory_resource;
+
+		std::source_location m_location;
+		call_site* m_previous;
+	};
+
+	LIB_API tracking_memory_resource(literal_t tag, memory_resource* upstream = get_default_resource(), uint32 sampleRate = default_sample_rate_v);
+	LIB_API ~tracking_memory_resource() override;
+
+	/**
+	* @brief Accounts for memory that was not allocated through this resource.
+	*/
+	LIB_API auto record_allocation(size_t size) -> void;
+
+	/**
+	* @brief Accounts for the release of memory that was passed to record_allocation().
+	*/
+	LIB_API auto record_deallocation(size_t size) -> void;
+
+	/**
+	* @brief Snapshot of the counters. Counters are updated independently so the snapshot may be off by allocations in flight on other threads.
+	*/
+	LIB_API auto snapshot() const -> statistics;
+
+	/**
+	* @brief Copies the recorded call sites into "out", most sampled bytes first.
+	*/
+	LIB_API auto call_sites(std::span<call_site_statistics> out) const -> size_t;
+
+	/**
+	* @brief Restarts peak tracking from the current number of live bytes.
+	*/
+	LIB_API auto reset_peak() -> void;
+
+	/**
+	* @brief Appends a human readable report of the statistics and call sites to "out".
+	*/
+	LIB_API auto dump(string& out) const -> void;
+
+	/**
+	* @brief Appends the report of every live tracking resource to "out", in the order they were constructed.
+	*/
+	LIB_API static auto dump_all(string& out) -> void;
+
+	auto tag() const -> literal_t { return m_tag; }
+	auto sample_rate() const -> uint32 { return m_sampleRate.load(std::memory_order_relaxed); }
+	auto set_sample_rate(uint32 sampleRate) -> void { m_sampleRate.store(sampleRate, std::memory_order_relaxed); }
+	auto upstream_resource() const -> memory_resource* { return m_upstream; }
+
+	/**
+	* @return Histogram bucket that allocations of "size" bytes are counted in.
+	*/
+	static constexpr auto histogram_bucket_of(size_t size) -> size_t
+	{
+		size_t const bucket = static_cast<size_t>(std::bit_width(std::max(size, size_t{ 1 }) - 1));
+		return std::clamp(bucket, size_t{ 4 }, histogram_bucket_count_v + 3) - 4;
+	}
+
+private:
+	struct registry;
+
+	memory_resource* m_upstream;
+	literal_t m_tag;
+	std::atomic<size_t> m_liveBytes;
+	std::atomic<size_t> m_peakBytes;
+	std::atomic<size_t> m_totalBytes;
+	std::atomic<uint64> m_liveAllocations;
+	std::atomic<uint64> m_totalAllocations;
+	std::atomic<uint32> m_sampleRate;
+	std::atomic<uint32> m_sampleCounter;
+	std::array<std::atomic<uint64>, histogram_bucket_count_v> m_histogram;
+	mutable std::mutex m_callSiteMutex;
+	std::array<call_site_statistics, max_call_sites_v> m_callSites;
+	size_t m_callSiteCount;
+	tracking_memory_resource* m_next;	// Next registered resource, guarded by the registry's mutex.
+	tracking_memory_resource* m_previous;
+
+	LIB_API virtual auto do_allocate(size_t size, size_t alignment) -> void* override;
+	LIB_API virtual auto do_deallocate(void* p, size_t bytes, size_t alignment) -> void override;
+	LIB_API virtual auto do_is_equal(memory_resource const& other) -> bool override;
+
+	auto _on_allocate(size_t size) -> void;
+	auto _on_deallocate(size_t size) -> void;
+	auto _sample_call_site(size_t size) -> void;
+};
+}
+
+#endif // !LIB_TRACKING_MEMORY_RESOURCE_HPP
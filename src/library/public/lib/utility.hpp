@@ -2,6 +2,7 @@
 #ifndef LIB_UTILITY_HPP
 #define LIB_UTILITY_HPP
 
+#include <cstring>
 #include "common.hpp"
 
 namespace lib
@@ -185,6 +186,53 @@ struct rebound_container<Container<OldType, Args...>, NewType>
 
 template <typename Container, typename NewType>
 using rebound_container_t = typename rebound_container<Container, NewType>::type;
+/**
+* @brief Marks types that can be moved to a new address with a plain memcpy, without running a move constructor or destructor.
+* Trivially copyable types qualify automatically. Other types opt in by specializing the trait, which containers use to grow, insert and erase with memmove.
+* Only specialize it for types that never point into themselves.
+*/
+template <typename T>
+struct is_trivially_relocatable : std::bool_constant<std::is_trivially_copyable_v<T>> {};
+
+template <typename T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+template <typename T, typename deleter>
+struct is_trivially_relocatable<std::unique_ptr<T, deleter>> : is_trivially_relocatable<deleter> {};
+
+/**
+* @brief Moves count objects from src into the uninitialized memory at dst and ends the lifetime of the objects left in src.
+* The two ranges may overlap.
+*/
+template <typename T>
+constexpr auto relocate(T* src, T* dst, size_t count) -> void
+{
+	if (src == dst || count == 0)
+	{
+		return;
+	}
+
+	if constexpr (is_trivially_relocatable_v<T>)
+	{
+		std::memmove(static_cast<void*>(dst), static_cast<void const*>(src), count * sizeof(T));
+	}
+	else if (dst < src)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			new (dst + i) T{ std::move(src[i]) };
+			src[i].~T();
+		}
+	}
+	else
+	{
+		for (size_t i = count; i-- > 0;)
+		{
+			new (dst + i) T{ std::move(src[i]) };
+			src[i].~T();
+		}
+	}
+}
 }
 
 #endif // !LIB_UTILITY_HPP
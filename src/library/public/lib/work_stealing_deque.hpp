@@ -0,0 +1,191 @@
+#pragma once
+#ifndef LIB_WORK_STEALING_DEQUE_HPP
+#define LIB_WORK_STEALING_DEQUE_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <optional>
+#include "memory.hpp"
+
+namespace lib
+{
+/**
+* Chase-Lev work stealing deque.
+*
+* The owning thread pushes and pops at the bottom without contention. Any other thread can steal from the top, the oldest element first.
+* The only contended operation is taking the last element, which the owner and the thieves settle with a CAS on the top index.
+*
+* The ring grows when it is full. Rings that have been outgrown are kept until the deque is destroyed as a thief could still be reading from one.
+*/
+template <typename T>
+requires (std::is_trivially_copyable_v<T> && std::atomic<T>::is_always_lock_free)
+class work_stealing_deque : non_copyable_non_movable
+{
+public:
+	static constexpr size_t default_capacity_v = 256;
+
+	work_stealing_deque(size_t capacity = default_capacity_v, memory_resource* resource = get_default_resource()) :
+		m_top{ 0 },
+		m_bottom{ 0 },
+		m_ring{},
+		m_resource{ resource }
+	{
+		m_ring.store(_make_ring(std::bit_ceil(std::max(capacity, size_t{ 2 })), nullptr), std::memory_order_relaxed);
+	}
+
+	~work_stealing_deque()
+	{
+		for (ring* r = m_ring.load(std::memory_order_relaxed); r != nullptr;)
+		{
+			ring* previous = r->previous;
+			m_resource->deallocate(r, sizeof(ring) + r->capacity * sizeof(std::atomic<T>), alignof(ring));
+			r = previous;
+		}
+	}
+
+	/**
+	* @brief Owner only.
+	*/
+	auto push(T value) -> void
+	{
+		int64 const bottom = m_bottom.load(std::memory_order_relaxed);
+		int64 const top = m_top.load(std::memory_order_acquire);
+		ring* r = m_ring.load(std::memory_order_relaxed);
+
+		if (bottom - top >= static_cast<int64>(r->capacity))
+		{
+			r = _grow(r, top, bottom);
+		}
+
+		r->store(bottom, value);
+		m_bottom.store(bottom + 1, std::memory_order_release);
+	}
+
+	/**
+	* @brief Owner only. Takes the newest element.
+	*/
+	auto pop() -> std::optional<T>
+	{
+		int64 const bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+		ring* r = m_ring.load(std::memory_order_relaxed);
+
+		// Claims the bottom slot before looking at the top, a thief that reads the old bottom races for it through the CAS below.
+		m_bottom.store(bottom, std::memory_order_seq_cst);
+
+		int64 top = m_top.load(std::memory_order_seq_cst);
+
+		if (top > bottom)
+		{
+			m_bottom.store(bottom + 1, std::memory_order_seq_cst);
+			return std::nullopt;
+		}
+
+		T value = r->load(bottom);
+
+		if (top == bottom)
+		{
+			bool const won = m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+
+			m_bottom.store(bottom + 1, std::memory_order_seq_cst);
+
+			if (!won)
+			{
+				return std::nullopt;
+			}
+		}
+
+		return value;
+	}
+
+	/**
+	* @brief Thread safe. Takes the oldest element. Fails when the deque is empty or another thread took the element first.
+	*/
+	auto steal() -> std::optional<T>
+	{
+		int64 top = m_top.load(std::memory_order_seq_cst);
+		int64 const bottom = m_bottom.load(std::memory_order_seq_cst);
+
+		if (top >= bottom)
+		{
+			return std::nullopt;
+		}
+
+		ring* r = m_ring.load(std::memory_order_acquire);
+		T value = r->load(top);
+
+		if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		{
+			return std::nullopt;
+		}
+
+		return value;
+	}
+
+	/**
+	* @brief Only a hint when called by a thread other than the owner.
+	*/
+	auto size() const -> size_t
+	{
+		int64 const bottom = m_bottom.load(std::memory_order_relaxed);
+		int64 const top = m_top.load(std::memory_order_relaxed);
+
+		return (bottom > top) ? static_cast<size_t>(bottom - top) : 0;
+	}
+
+	auto empty() const -> bool { return size() == 0; }
+
+private:
+	/**
+	* The slots follow the header in the same allocation.
+	*/
+	struct alignas(std::atomic<T>) ring
+	{
+		size_t capacity;
+		ring* previous;
+
+		auto slot(int64 index) const -> std::atomic<T>&
+		{
+			std::atomic<T>* slots = reinterpret_cast<std::atomic<T>*>(const_cast<ring*>(this) + 1);
+			return slots[static_cast<size_t>(index) & (capacity - 1)];
+		}
+
+		auto load(int64 index) const -> T { return slot(index).load(std::memory_order_relaxed); }
+		auto store(int64 index, T value) -> void { slot(index).store(value, std::memory_order_relaxed); }
+	};
+
+	alignas(cache_line_size_v) std::atomic<int64> m_top;
+	alignas(cache_line_size_v) std::atomic<int64> m_bottom;
+	alignas(cache_line_size_v) std::atomic<ring*> m_ring;
+	memory_resource* m_resource;
+
+	auto _make_ring(size_t capacity, ring* previous) -> ring*
+	{
+		void* memory = m_resource->allocate(sizeof(ring) + capacity * sizeof(std::atomic<T>), alignof(ring));
+		ring* r = new (memory) ring{ .capacity = capacity, .previous = previous };
+
+		for (size_t i = 0; i < capacity; ++i)
+		{
+			new (&r->slot(static_cast<int64>(i))) std::atomic<T>{};
+		}
+
+		return r;
+	}
+
+	auto _grow(ring* r, int64 top, int64 bottom) -> ring*
+	{
+		ring* grown = _make_ring(r->capacity * 2, r);
+
+		for (int64 i = top; i < bottom; ++i)
+		{
+			grown->store(i, r->load(i));
+		}
+
+		m_ring.store(grown, std::memory_order_release);
+
+		return grown;
+	}
+};
+}
+
+#endif // !LIB_WORK_STEALING_DEQUE_HPP
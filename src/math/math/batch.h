@@ -0,0 +1,1105 @@
+#pragma once
+#ifndef MATH_LIBRARY_BATCH_H
+#define MATH_LIBRARY_BATCH_H
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <span>
+#include "quaternion.h"
+
+namespace math
+{
+/**
+* Kernels that work on many objects at once. Vectors are passed as structure of arrays, one span per component, so that every SIMD lane works on a different object. Quaternions are passed as plain arrays and transposed in registers.
+* Every kernel has an SSE path and an AVX2 path that is picked at runtime when the CPU supports it. Platforms without SSE fall back to scalar code.
+*/
+namespace batch
+{
+inline constexpr uint32 no_parent_v = std::numeric_limits<uint32>::max();
+
+struct vector3_view
+{
+    std::span<float32 const> x;
+    std::span<float32 const> y;
+    std::span<float32 const> z;
+
+    constexpr auto size() const -> size_t { return x.size(); }
+};
+
+struct vector3_span
+{
+    std::span<float32> x;
+    std::span<float32> y;
+    std::span<float32> z;
+
+    constexpr auto size() const -> size_t { return x.size(); }
+
+    constexpr operator vector3_view() const { return vector3_view{ x, y, z }; }
+};
+
+/**
+* Clip space planes as (normal, distance). Normals point into the frustum and are normalized, so a point p is inside a plane when dot(normal, p) + distance >= 0.
+*/
+struct frustum
+{
+    vec4 planes[6];	// Left, right, bottom, top, near, far.
+};
+
+/**
+* @return Number of 64 bit words needed for a visibility mask of "count" objects.
+*/
+constexpr auto visibility_words(size_t count) -> size_t
+{
+    return (count + 63) / 64;
+}
+
+/**
+* Gribb-Hartmann plane extraction for a view projection matrix with Vulkan's [0, 1] depth range.
+*/
+inline auto extract_frustum(mat4 const& viewProjection) -> frustum
+{
+    mat4 const& m = viewProjection;
+
+    vec4 const row0{ m.m00, m.m10, m.m20, m.m30 };
+    vec4 const row1{ m.m01, m.m11, m.m21, m.m31 };
+    vec4 const row2{ m.m02, m.m12, m.m22, m.m32 };
+    vec4 const row3{ m.m03, m.m13, m.m23, m.m33 };
+
+    frustum result{
+        .planes = {
+            row3 + row0,
+            row3 - row0,
+            row3 + row1,
+            row3 - row1,
+            row2,
+            row3 - row2
+        }
+    };
+
+    for (vec4& plane : result.planes)
+    {
+        float32 const length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+        plane /= length;
+    }
+
+    return result;
+}
+
+namespace detail
+{
+inline auto transform_scalar(mat4 const& m, vector3_view in, vector3_span out, float32 w, size_t begin) -> void
+{
+    for (size_t i = begin; i < in.size(); ++i)
+    {
+        float32 const x = in.x[i];
+        float32 const y = in.y[i];
+        float32 const z = in.z[i];
+
+        out.x[i] = m.m00 * x + m.m10 * y + m.m20 * z + m.m30 * w;
+        out.y[i] = m.m01 * x + m.m11 * y + m.m21 * z + m.m31 * w;
+        out.z[i] = m.m02 * x + m.m12 * y + m.m22 * z + m.m32 * w;
+    }
+}
+
+inline auto sphere_visible(frustum const& f, float32 x, float32 y, float32 z, float32 radius) -> bool
+{
+    for (vec4 const& plane : f.planes)
+    {
+        if (plane.x * x + plane.y * y + plane.z * z + plane.w < -radius)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline auto aabb_visible(frustum const& f, float32 x, float32 y, float32 z, float32 ex, float32 ey, float32 ez) -> bool
+{
+    for (vec4 const& plane : f.planes)
+    {
+        // Distance of the corner furthest along the plane's normal.
+        float32 const reach = std::fabs(plane.x) * ex + std::fabs(plane.y) * ey + std::fabs(plane.z) * ez;
+
+        if (plane.x * x + plane.y * y + plane.z * z + plane.w + reach < 0.f)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline auto set_visible(std::span<uint64> visibility, size_t index) -> void
+{
+    visibility[index >> 6] |= uint64{ 1 } << (index & 63);
+}
+
+#if MATH_SIMD_SSE2
+inline auto transform_sse(mat4 const& m, vector3_view in, vector3_span out, float32 w) -> size_t
+{
+    __m128 const c0x = _mm_set1_ps(m.m00), c0y = _mm_set1_ps(m.m01), c0z = _mm_set1_ps(m.m02);
+    __m128 const c1x = _mm_set1_ps(m.m10), c1y = _mm_set1_ps(m.m11), c1z = _mm_set1_ps(m.m12);
+    __m128 const c2x = _mm_set1_ps(m.m20), c2y = _mm_set1_ps(m.m21), c2z = _mm_set1_ps(m.m22);
+    __m128 const tx = _mm_set1_ps(m.m30 * w), ty = _mm_set1_ps(m.m31 * w), tz = _mm_set1_ps(m.m32 * w);
+
+    size_t const count = in.size() & ~size_t{ 3 };
+
+    for (size_t i = 0; i < count; i += 4)
+    {
+        __m128 const x = _mm_loadu_ps(in.x.data() + i);
+        __m128 const y = _mm_loadu_ps(in.y.data() + i);
+        __m128 const z = _mm_loadu_ps(in.z.data() + i);
+
+        _mm_storeu_ps(out.x.data() + i, simd::madd(c2x, z, simd::madd(c1x, y, simd::madd(c0x, x, tx))));
+        _mm_storeu_ps(out.y.data() + i, simd::madd(c2y, z, simd::madd(c1y, y, simd::madd(c0y, x, ty))));
+        _mm_storeu_ps(out.z.data() + i, simd::madd(c2z, z, simd::madd(c1z, y, simd::madd(c0z, x, tz))));
+    }
+
+    return count;
+}
+
+MATH_SIMD_TARGET_AVX2 inline auto transform_avx2(mat4 const& m, vector3_view in, vector3_span out, float32 w) -> size_t
+{
+    __m256 const c0x = _mm256_set1_ps(m.m00), c0y = _mm256_set1_ps(m.m01), c0z = _mm256_set1_ps(m.m02);
+    __m256 const c1x = _mm256_set1_ps(m.m10), c1y = _mm256_set1_ps(m.m11), c1z = _mm256_set1_ps(m.m12);
+    __m256 const c2x = _mm256_set1_ps(m.m20), c2y = _mm256_set1_ps(m.m21), c2z = _mm256_set1_ps(m.m22);
+    __m256 const tx = _mm256_set1_ps(m.m30 * w), ty = _mm256_set1_ps(m.m31 * w), tz = _mm256_set1_ps(m.m32 * w);
+
+    size_t const count = in.size() & ~size_t{ 7 };
+
+    for (size_t i = 0; i < count; i += 8)
+    {
+        __m256 const x = _mm256_loadu_ps(in.x.data() + i);
+        __m256 const y = _mm256_loadu_ps(in.y.data() + i);
+        __m256 const z = _mm256_loadu_ps(in.z.data() + i);
+
+        _mm256_storeu_ps(out.x.data() + i, _mm256_fmadd_ps(c2x, z, _mm256_fmadd_ps(c1x, y, _mm256_fmadd_ps(c0x, x, tx))));
+        _mm256_storeu_ps(out.y.data() + i, _mm256_fmadd_ps(c2y, z, _mm256_fmadd_ps(c1y, y, _mm256_fmadd_ps(c0y, x, ty))));
+        _mm256_storeu_ps(out.z.data() + i, _mm256_fmadd_ps(c2z, z, _mm256_fmadd_ps(c1z, y, _mm256_fmadd_ps(c0z, x, tz))));
+    }
+
+    return count;
+}
+
+inline auto cull_spheres_sse(frustum const& f, vector3_view centers, std::span<float32 const> radii, std::span<uint64> visibility) -> size_t
+{
+    // Plane components broadcast to every lane.
+    __m128 nx[6], ny[6], nz[6], d[6];
+
+    for (size_t p = 0; p < 6; ++p)
+    {
+        nx[p] = _mm_set1_ps(f.planes[p].x);
+        ny[p] = _mm_set1_ps(f.planes[p].y);
+        nz[p] = _mm_set1_ps(f.planes[p].z);
+        d[p] = _mm_set1_ps(f.planes[p].w);
+    }
+
+    size_t const count = centers.size() & ~size_t{ 3 };
+
+    for (size_t i = 0; i < count; i += 4)
+    {
+        __m128 const x = _mm_loadu_ps(centers.x.data() + i);
+        __m128 const y = _mm_loadu_ps(centers.y.data() + i);
+        __m128 const z = _mm_loadu_ps(centers.z.data() + i);
+        __m128 const negativeRadius = _mm_sub_ps(_mm_setzero_ps(), _mm_loadu_ps(radii.data() + i));
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+        for (size_t p = 0; p < 6; ++p)
+        {
+            __m128 const distance = simd::madd(nz[p], z, simd::madd(ny[p], y, simd::madd(nx[p], x, d[p])));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negativeRadius));
+        }
+
+        visibility[i >> 6] |= static_cast<uint64>(_mm_movemask_ps(inside)) << (i & 63);
+    }
+
+    return count;
+}
+
+MATH_SIMD_TARGET_AVX2 inline auto cull_spheres_avx2(frustum const& f, vector3_view centers, std::span<float32 const> radii, std::span<uint64> visibility) -> size_t
+{
+    // Plane components broadcast to every lane.
+    __m256 nx[6], ny[6], nz[6], d[6];
+
+    for (size_t p = 0; p < 6; ++p)
+    {
+        nx[p] = _mm256_set1_ps(f.planes[p].x);
+        ny[p] = _mm256_set1_ps(f.planes[p].y);
+        nz[p] = _mm256_set1_ps(f.planes[p].z);
+        d[p] = _mm256_set1_ps(f.planes[p].w);
+    }
+
+    size_t const count = centers.size() & ~size_t{ 7 };
+
+    for (size_t i = 0; i < count; i += 8)
+    {
+        __m256 const x = _mm256_loadu_ps(centers.x.data() + i);
+        __m256 const y = _mm256_loadu_ps(centers.y.data() + i);
+        __m256 const z = _mm256_loadu_ps(centers.z.data() + i);
+        __m256 const negativeRadius = _mm256_sub_ps(_mm256_setzero_ps(), _mm256_loadu_ps(radii.data() + i));
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+        for (size_t p = 0; p < 6; ++p)
+        {
+            __m256 const distance = _mm256_fmadd_ps(nz[p], z, _mm256_fmadd_ps(ny[p], y, _mm256_fmadd_ps(nx[p], x, d[p])));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negativeRadius, _CMP_GE_OQ));
+        }
+
+        visibility[i >> 6] |= static_cast<uint64>(_mm256_movemask_ps(inside)) << (i & 63);
+    }
+
+    return count;
+}
+
+inline auto cull_aabbs_sse(frustum const& f, vector3_view centers, vector3_view extents, std::span<uint64> visibility) -> size_t
+{
+    // Plane components broadcast to every lane. The absolute normals give each box's reach towards the plane.
+    __m128 nx[6], ny[6], nz[6], d[6];
+    __m128 ax[6], ay[6], az[6];
+    __m128 const signMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+
+    for (size_t p = 0; p < 6; ++p)
+    {
+        nx[p] = _mm_set1_ps(f.planes[p].x);
+        ny[p] = _mm_set1_ps(f.planes[p].y);
+        nz[p] = _mm_set1_ps(f.planes[p].z);
+        d[p] = _mm_set1_ps(f.planes[p].w);
+
+        ax[p] = _mm_and_ps(nx[p], signMask);
+        ay[p] = _mm_and_ps(ny[p], signMask);
+        az[p] = _mm_and_ps(nz[p], signMask);
+    }
+
+    size_t const count = centers.size() & ~size_t{ 3 };
+
+    for (size_t i = 0; i < count; i += 4)
+    {
+        __m128 const x = _mm_loadu_ps(centers.x.data() + i);
+        __m128 const y = _mm_loadu_ps(centers.y.data() + i);
+        __m128 const z = _mm_loadu_ps(centers.z.data() + i);
+        __m128 const ex = _mm_loadu_ps(extents.x.data() + i);
+        __m128 const ey = _mm_loadu_ps(extents.y.data() + i);
+        __m128 const ez = _mm_loadu_ps(extents.z.data() + i);
+
+        __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+        for (size_t p = 0; p < 6; ++p)
+        {
+            __m128 distance = simd::madd(nz[p], z, simd::madd(ny[p], y, simd::madd(nx[p], x, d[p])));
+            distance = simd::madd(az[p], ez, simd::madd(ay[p], ey, simd::madd(ax[p], ex, distance)));
+            inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_setzero_ps()));
+        }
+
+        visibility[i >> 6] |= static_cast<uint64>(_mm_movemask_ps(inside)) << (i & 63);
+    }
+
+    return count;
+}
+
+MATH_SIMD_TARGET_AVX2 inline auto cull_aabbs_avx2(frustum const& f, vector3_view centers, vector3_view extents, std::span<uint64> visibility) -> size_t
+{
+    // Plane components broadcast to every lane. The absolute normals give each box's reach towards the plane.
+    __m256 nx[6], ny[6], nz[6], d[6];
+    __m256 ax[6], ay[6], az[6];
+    __m256 const signMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+
+    for (size_t p = 0; p < 6; ++p)
+    {
+        nx[p] = _mm256_set1_ps(f.planes[p].x);
+        ny[p] = _mm256_set1_ps(f.planes[p].y);
+        nz[p] = _mm256_set1_ps(f.planes[p].z);
+        d[p] = _mm256_set1_ps(f.planes[p].w);
+
+        ax[p] = _mm256_and_ps(nx[p], signMask);
+        ay[p] = _mm256_and_ps(ny[p], signMask);
+        az[p] = _mm256_and_ps(nz[p], signMask);
+    }
+
+    size_t const count = centers.size() & ~size_t{ 7 };
+
+    for (size_t i = 0; i < count; i += 8)
+    {
+        __m256 const x = _mm256_loadu_ps(centers.x.data() + i);
+        __m256 const y = _mm256_loadu_ps(centers.y.data() + i);
+        __m256 const z = _mm256_loadu_ps(centers.z.data() + i);
+        __m256 const ex = _mm256_loadu_ps(extents.x.data() + i);
+        __m256 const ey = _mm256_loadu_ps(extents.y.data() + i);
+        __m256 const ez = _mm256_loadu_ps(extents.z.data() + i);
+
+        __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+        for (size_t p = 0; p < 6; ++p)
+        {
+            __m256 distance = _mm256_fmadd_ps(nz[p], z, _mm256_fmadd_ps(ny[p], y, _mm256_fmadd_ps(nx[p], x, d[p])));
+            distance = _mm256_fmadd_ps(az[p], ez, _mm256_fmadd_ps(ay[p], ey, _mm256_fmadd_ps(ax[p], ex, distance)));
+            inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_GE_OQ));
+        }
+
+        visibility[i >> 6] |= static_cast<uint64>(_mm256_movemask_ps(inside)) << (i & 63);
+    }
+
+    return count;
+}
+
+MATH_SIMD_TARGET_AVX2 inline auto multiply_avx2(float32 const* l, float32 const* r, float32* out) -> void
+{
+    __m256 const c0 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(l));
+    __m256 const c1 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(l + 4));
+    __m256 const c2 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(l + 8));
+    __m256 const c3 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(l + 12));
+
+    __m256 const r01 = _mm256_loadu_ps(r);
+    __m256 const r23 = _mm256_loadu_ps(r + 8);
+
+    __m256 res01 = _mm256_mul_ps(c0, _mm256_shuffle_ps(r01, r01, 0x00));
+    __m256 res23 = _mm256_mul_ps(c0, _mm256_shuffle_ps(r23, r23, 0x00));
+    res01 = _mm256_fmadd_ps(c1, _mm256_shuffle_ps(r01, r01, 0x55), res01);
+    res23 = _mm256_fmadd_ps(c1, _mm256_shuffle_ps(r23, r23, 0x55), res23);
+    res01 = _mm256_fmadd_ps(c2, _mm256_shuffle_ps(r01, r01, 0xAA), res01);
+    res23 = _mm256_fmadd_ps(c2, _mm256_shuffle_ps(r23, r23, 0xAA), res23);
+    res01 = _mm256_fmadd_ps(c3, _mm256_shuffle_ps(r01, r01, 0xFF), res01);
+    res23 = _mm256_fmadd_ps(c3, _mm256_shuffle_ps(r23, r23, 0xFF), res23);
+
+    _mm256_storeu_ps(out, res01);
+    _mm256_storeu_ps(out + 8, res23);
+}
+
+MATH_SIMD_TARGET_AVX2 inline auto compose_avx2(std::span<mat4 const> local, std::span<uint32 const> parents, std::span<mat4> world) -> void
+{
+    for (size_t i = 0; i < local.size(); ++i)
+    {
+        ASSERTION(parents[i] == no_parent_v || parents[i] < i);
+
+        if (parents[i] == no_parent_v)
+        {
+            world[i] = local[i];
+            continue;
+        }
+
+        multiply_avx2(&world[parents[i]].m00, &local[i].m00, &world[i].m00);
+    }
+}
+#endif
+}
+
+/**
+* @brief out[i] = m * (in[i], 1). "out" may be the same as "in".
+*/
+inline auto transform_points(mat4 const& m, vector3_view in, vector3_span out) -> void
+{
+    ASSERTION(in.y.size() == in.size() && in.z.size() == in.size() && out.size() >= in.size());
+
+    size_t done = 0;
+
+#if MATH_SIMD_SSE2
+    done = simd::cpu_supports_avx2() ? detail::transform_avx2(m, in, out, 1.f) : detail::transform_sse(m, in, out, 1.f);
+#endif
+
+    detail::transform_scalar(m, in, out, 1.f, done);
+}
+
+/**
+* @brief out[i] = m * (in[i], 0), the translation is ignored. Normals have to be transformed by the inverse transpose of the matrix used for positions. "out" may be the same as "in".
+*/
+inline auto transform_directions(mat4 const& m, vector3_view in, vector3_span out) -> void
+{
+    ASSERTION(in.y.size() == in.size() && in.z.size() == in.size() && out.size() >= in.size());
+
+    size_t done = 0;
+
+#if MATH_SIMD_SSE2
+    done = simd::cpu_supports_avx2() ? detail::transform_avx2(m, in, out, 0.f) : detail::transform_sse(m, in, out, 0.f);
+#endif
+
+    detail::transform_scalar(m, in, out, 0.f, done);
+}
+
+/**
+* @brief world[i] = world[parents[i]] * local[i], or local[i] for roots whose parent is no_parent_v.
+* Parents must come before their children, i.e. parents[i] < i, so that a single pass over the hierarchy resolves every level.
+*/
+inline auto compose_world_matrices(std::span<mat4 const> local, std::span<uint32 const> parents, std::span<mat4> world) -> void
+{
+    ASSERTION(parents.size() == local.size() && world.size() >= local.size());
+
+#if MATH_SIMD_SSE2
+    if (simd::cpu_supports_avx2())
+    {
+        detail::compose_avx2(local, parents, world);
+        return;
+    }
+#endif
+
+    for (size_t i = 0; i < local.size(); ++i)
+    {
+        ASSERTION(parents[i] == no_parent_v || parents[i] < i);
+
+        world[i] = (parents[i] == no_parent_v) ? local[i] : world[parents[i]] * local[i];
+    }
+}
+
+/**
+* @brief Sets bit i of "visibility" when sphere i intersects the frustum. "visibility" needs visibility_words(count) words and is overwritten.
+*/
+inline auto cull_spheres(frustum const& f, vector3_view centers, std::span<float32 const> radii, std::span<uint64> visibility) -> void
+{
+    ASSERTION(radii.size() == centers.size() && visibility.size() >= visibility_words(centers.size()));
+
+    std::fill_n(visibility.data(), visibility_words(centers.size()), uint64{ 0 });
+
+    size_t done = 0;
+
+#if MATH_SIMD_SSE2
+    done = simd::cpu_supports_avx2() ? detail::cull_spheres_avx2(f, centers, radii, visibility) : detail::cull_spheres_sse(f, centers, radii, visibility);
+#endif
+
+    for (size_t i = done; i < centers.size(); ++i)
+    {
+        if (detail::sphere_visible(f, centers.x[i], centers.y[i], centers.z[i], radii[i]))
+        {
+            detail::set_visible(visibility, i);
+        }
+    }
+}
+
+/**
+* @brief Sets bit i of "visibility" when the box with center i and half extents i intersects the frustum. "visibility" needs visibility_words(count) words and is overwritten.
+*/
+inline auto cull_aabbs(frustum const& f, vector3_view centers, vector3_view extents, std::span<uint64> visibility) -> void
+{
+    ASSERTION(extents.size() == centers.size() && visibility.size() >= visibility_words(centers.size()));
+
+    std::fill_n(visibility.data(), visibility_words(centers.size()), uint64{ 0 });
+
+    size_t done = 0;
+
+#if MATH_SIMD_SSE2
+    done = simd::cpu_supports_avx2() ? detail::cull_aabbs_avx2(f, centers, extents, visibility) : detail::cull_aabbs_sse(f, centers, extents, visibility);
+#endif
+
+    for (size_t i = done; i < centers.size(); ++i)
+    {
+        if (detail::aabb_visible(f, centers.x[i], centers.y[i], centers.z[i], extents.x[i], extents.y[i], extents.z[i]))
+        {
+            detail::set_visible(visibility, i);
+        }
+    }
+}
+
+namespace detail
+{
+/**
+* Coefficients of the polynomial slerp from "A Fast and Accurate Algorithm for Computing SLERP" (Eberly). It needs no trigonometry.
+* 12 terms with the last one scaled by mu keep the weights within 1e-6 of sin(t * angle) / sin(angle) over the whole arc.
+*/
+inline constexpr int32 slerp_terms_v = 12;
+
+struct slerp_polynomial
+{
+    float32 u[slerp_terms_v];
+    float32 v[slerp_terms_v];
+};
+
+inline constexpr slerp_polynomial slerp_polynomial_v = []() -> slerp_polynomial
+{
+    constexpr float64 mu = 1.89375;
+
+    slerp_polynomial result{};
+
+    for (int32 i = 0; i < slerp_terms_v; ++i)
+    {
+        float64 const n = static_cast<float64>(i + 1);
+        float64 const scale = (i == slerp_terms_v - 1) ? mu : 1.0;
+
+        result.u[i] = static_cast<float32>(scale / (n * (2.0 * n + 1.0)));
+        result.v[i] = static_cast<float32>(scale * n / (2.0 * n + 1.0));
+    }
+
+    return result;
+}();
+
+inline auto slerp_scalar(quat const& from, quat to, float32 t) -> quat
+{
+    float32 cosine = dot(from, to);
+
+    // Takes the shorter arc.
+    if (cosine < 0.f)
+    {
+        to = to * -1.f;
+        cosine = -cosine;
+    }
+
+    float32 const cosineMinusOne = cosine - 1.f;
+    float32 const d = 1.f - t;
+    float32 const tt = t * t;
+    float32 const dd = d * d;
+
+    float32 ct = 1.f;
+    float32 cd = 1.f;
+
+    for (int32 i = slerp_terms_v - 1; i >= 0; --i)
+    {
+        ct = 1.f + (slerp_polynomial_v.u[i] * tt - slerp_polynomial_v.v[i]) * cosineMinusOne * ct;
+        cd = 1.f + (slerp_polynomial_v.u[i] * dd - slerp_polynomial_v.v[i]) * cosineMinusOne * cd;
+    }
+
+    return from * (d * cd) + to * (t * ct);
+}
+
+inline auto nlerp_scalar(quat const& from, quat to, float32 t) -> quat
+{
+    if (dot(from, to) < 0.f)
+    {
+        to = to * -1.f;
+    }
+
+    return normalized(from + (to - from) * t);
+}
+
+/**
+* out = translation * rotation * scale.
+*/
+inline auto compose_scalar(quat const& q, float32 tx, float32 ty, float32 tz, float32 sx, float32 sy, float32 sz, mat4& out) -> void
+{
+    mat3 const r = mat3_cast(q);
+
+    out.m00 = r.m00 * sx; out.m01 = r.m01 * sx; out.m02 = r.m02 * sx; out.m03 = 0.f;
+    out.m10 = r.m10 * sy; out.m11 = r.m11 * sy; out.m12 = r.m12 * sy; out.m13 = 0.f;
+    out.m20 = r.m20 * sz; out.m21 = r.m21 * sz; out.m22 = r.m22 * sz; out.m23 = 0.f;
+    out.m30 = tx;         out.m31 = ty;         out.m32 = tz;         out.m33 = 1.f;
+}
+
+#if MATH_SIMD_SSE2
+/**
+* The SIMD paths load 4 (SSE) or 8 (AVX2) quaternions and transpose them so that q[0] holds every w, q[1] every x and so on.
+*/
+inline auto load_quaternions(quat const* in, __m128 (&q)[4]) -> void
+{
+    for (size_t k = 0; k < 4; ++k)
+    {
+        q[k] = _mm_loadu_ps(&in[k].w);
+    }
+    _MM_TRANSPOSE4_PS(q[0], q[1], q[2], q[3]);
+}
+
+inline auto store_quaternions(quat* out, __m128 (&q)[4]) -> void
+{
+    _MM_TRANSPOSE4_PS(q[0], q[1], q[2], q[3]);
+
+    for (size_t k = 0; k < 4; ++k)
+    {
+        _mm_storeu_ps(&out[k].w, q[k]);
+    }
+}
+
+inline auto normalize_quaternions_sse(__m128 (&q)[4]) -> void
+{
+    __m128 const lengthSquared = simd::madd(q[3], q[3], simd::madd(q[2], q[2], simd::madd(q[1], q[1], _mm_mul_ps(q[0], q[0]))));
+    __m128 const valid = _mm_cmpgt_ps(lengthSquared, _mm_setzero_ps());
+    __m128 const scale = _mm_div_ps(_mm_set1_ps(1.f), _mm_sqrt_ps(lengthSquared));
+
+    // Zero length quaternions become the identity, same as normalized().
+    q[0] = simd::select(valid, _mm_mul_ps(q[0], scale), _mm_set1_ps(1.f));
+    q[1] = _mm_and_ps(valid, _mm_mul_ps(q[1], scale));
+    q[2] = _mm_and_ps(valid, _mm_mul_ps(q[2], scale));
+    q[3] = _mm_and_ps(valid, _mm_mul_ps(q[3], scale));
+}
+
+inline auto multiply_quaternions_sse(__m128 const (&l)[4], __m128 const (&r)[4], __m128 (&out)[4]) -> void
+{
+    out[0] = _mm_sub_ps(_mm_mul_ps(l[0], r[0]), simd::madd(l[1], r[1], simd::madd(l[2], r[2], _mm_mul_ps(l[3], r[3]))));
+    out[1] = _mm_sub_ps(simd::madd(l[0], r[1], simd::madd(r[0], l[1], _mm_mul_ps(l[2], r[3]))), _mm_mul_ps(l[3], r[2]));
+    out[2] = _mm_sub_ps(simd::madd(l[0], r[2], simd::madd(r[0], l[2], _mm_mul_ps(l[3], r[1]))), _mm_mul_ps(l[1], r[3]));
+    out[3] = _mm_sub_ps(simd::madd(l[0], r[3], simd::madd(r[0], l[3], _mm_mul_ps(l[1], r[2]))), _mm_mul_ps(l[2], r[1]));
+}
+
+/**
+* Flips "to" onto the same hemisphere as "from". @return |dot(from, to)|.
+*/
+inline auto align_quaternions_sse(__m128 const (&from)[4], __m128 (&to)[4]) -> __m128
+{
+    __m128 const cosine = simd::madd(from[3], to[3], simd::madd(from[2], to[2], simd::madd(from[1], to[1], _mm_mul_ps(from[0], to[0]))));
+    __m128 const sign = _mm_and_ps(cosine, _mm_set1_ps(-0.f));
+
+    for (size_t k = 0; k < 4; ++k)
+    {
+        to[k] = _mm_xor_ps(to[k], sign);
+    }
+
+    return _mm_xor_ps(cosine, sign);
+}
+
+inline auto slerp_quaternions_sse(__m128 const (&from)[4], __m128 (&to)[4], __m128 t, __m128 (&out)[4]) -> void
+{
+    __m128 const one = _mm_set1_ps(1.f);
+    __m128 const cosineMinusOne = _mm_sub_ps(align_quaternions_sse(from, to), one);
+    __m128 const d = _mm_sub_ps(one, t);
+    __m128 const tt = _mm_mul_ps(t, t);
+    __m128 const dd = _mm_mul_ps(d, d);
+
+    __m128 ct = one;
+    __m128 cd = one;
+
+    for (int32 i = slerp_terms_v - 1; i >= 0; --i)
+    {
+        __m128 const u = _mm_set1_ps(slerp_polynomial_v.u[i]);
+        __m128 const v = _mm_set1_ps(slerp_polynomial_v.v[i]);
+
+        ct = simd::madd(_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(u, tt), v), cosineMinusOne), ct, one);
+        cd = simd::madd(_mm_mul_ps(_mm_sub_ps(_mm_mul_ps(u, dd), v), cosineMinusOne), cd, one);
+    }
+
+    ct = _mm_mul_ps(ct, t);
+    cd = _mm_mul_ps(cd, d);
+
+    for (size_t k = 0; k < 4; ++k)
+    {
+        out[k] = simd::madd(from[k], cd, _mm_mul_ps(to[k], ct));
+    }
+}
+
+MATH_SIMD_TARGET_AVX2 inline auto transpose_lanes(__m256 (&q)[4]) -> void
+{
+    __m256 const t0 = _mm256_unpacklo_ps(q[0], q[1]);
+    __m256 const t1 = _mm256_unpacklo_ps(q[2], q[3]);
+    __m256 const t2 = _mm256_unpackhi_ps(q[0], q[1]);
+    __m256 const t3 = _mm256_unpackhi_ps(q[2], q[3]);
+
+    q[0] = _mm256_shuffle_ps(t0, t1, 0x44);
+    q[1] = _mm256_shuffle_ps(t0, t1, 0xEE);
+    q[2] = _mm256_shuffle_ps(t2, t3, 0x44);
+    q[3] = _mm256_shuffle_ps(t2, t3, 0xEE);
+}
+
+/**
+* Quaternion k goes into the low half of register k, quaternion k + 4 into the high half. The transpose works within each half.
+*/
+MATH_SIMD_TARGET_AVX2 inline auto load_quaternions(quat const* in, __m256 (&q)[4]) -> void
+{
+    for (size_t k = 0; k < 4; ++k)
+    {
+        q[k] = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(&in[k].w)), _mm_loadu_ps(&in[k + 4].w), 1);
+    }
+    transpose_lanes(q);
+}
+
+MATH_SIMD_TARGET_AVX2 inline auto store_lanes(float32* low, float32* high, __m256 (&q)[4], size_t stride) -> void
+{
+    transpose_lanes(q);
+
+    for (size_t k = 0; k < 4; ++k)
+    {
+        _mm_storeu_ps(low + k * stride, _mm256_castps256_ps128(q[k]));
+        _mm_storeu_ps(high + k * stride, _mm256_extractf128_ps(q[k], 1));
+    }
+}
+
+MATH_SIMD_TARGET_AVX2 inline auto store_quaternions(quat* out, __m256 (&q)[4]) -> void
+{
+    store_lanes(&out[0].w, &out[4].w, q, sizeof(quat) / sizeof(float32));
+}
+
+MATH_SIMD_TARGET_AVX2 inline auto normalize_quaternions_avx2(__m256 (&q)[4]) -> void
+{
+    __m256 const lengthSquared = _mm256_fmadd_ps(q[3], q[3], _mm256_fmadd_ps(q[2], q[2], _mm256_fmadd_ps(q[1], q[1], _mm256_mul_ps(q[0], q[0]))));
+    __m256 const valid = _mm256_cmp_ps(lengthSquared, _mm256_setzero_ps(), _CMP_GT_OQ);
+    __m256 const scale = _mm256_div_ps(_mm256_set1_ps(1.f), _mm256_sqrt_ps(lengthSquared));
+
+    q[0] = _mm256_blendv_ps(_mm256_set1_ps(1.f), _mm256_mul_ps(q[0], scale), valid);
+    q[1] = _mm256_and_ps(valid, _mm256_mul_ps(q[1], scale));
+    q[2] = _mm256_and_ps(valid, _mm256_mul_ps(q[2], scale));
+    q[3] = _mm256_and_ps(valid, _mm256_mul_ps(q[3], scale));
+}
+
+MATH_SIMD_TARGET_AVX2 inline auto multiply_quaternions_avx2(__m256 const (&l)[4], __m256 const (&r)[4], __m256 (&out)[4]) -> void
+{
+    out[0] = _mm256_fmsub_ps(l[0], r[0], _mm256_fmadd_ps(l[1], r[1], _mm256_fmadd_ps(l[2], r[2], _mm256_mul_ps(l[3], r[3]))));
+    out[1] = _mm256_fmadd_ps(l[0], r[1], _mm256_fmadd_ps(r[0], l[1], _mm256_fmsub_ps(l[2], r[3], _mm256_mul_ps(l[3], r[2]))));
+    out[2] = _mm256_fmadd_ps(l[0], r[2], _mm256_fmadd_ps(r[0], l[2], _mm256_fmsub_ps(l[3], r[1], _mm256_mul_ps(l[1], r[3]))));
+    out[3] = _mm256_fmadd_ps(l[0], r[3], _mm256_fmadd_ps(r[0], l[3], _mm256_fmsub_ps(l[1], r[2], _mm256_mul_ps(l[2], r[1]))));
+}
+
+MATH_SIMD_TARGET_AVX2 inline auto align_quaternions_avx2(__m256 const (&from)[4], __m256 (&to)[4]) -> __m256
+{
+    __m256 const cosine = _mm256_fmadd_ps(from[3], to[3], _mm256_fmadd_ps(from[2], to[2], _mm256_fmadd_ps(from[1], to[1], _mm256_mul_ps(from[0], to[0]))));
+    __m256 const sign = _mm256_and_ps(cosine, _mm256_set1_ps(-0.f));
+
+    for (size_t k = 0; k < 4; ++k)
+    {
+        to[k] = _mm256_xor_ps(to[k], sign);
+    }
+
+    return _mm256_xor_ps(cosine, sign);
+}
+
+MATH_SIMD_TARGET_AVX2 inline auto slerp_quaternions_avx2(__m256 const (&from)[4], __m256 (&to)[4], __m256 t, __m256 (&out)[4]) -> void
+{
+    __m256 const one = _mm256_set1_ps(1.f);
+    __m256 const cosineMinusOne = _mm256_sub_ps(align_quaternions_avx2(from, to), one);
+    __m256 const d = _mm256_sub_ps(one, t);
+    __m256 const tt = _mm256_mul_ps(t, t);
+    __m256 const dd = _mm256_mul_ps(d, d);
+
+    __m256 ct = one;
+    __m256 cd = one;
+
+    for (int32 i = slerp_terms_v - 1; i >= 0; --i)
+    {
+        __m256 const u = _mm256_set1_ps(slerp_polynomial_v.u[i]);
+        __m256 const v = _mm256_set1_ps(slerp_polynomial_v.v[i]);
+
+        ct = _mm256_fmadd_ps(_mm256_mul_ps(_mm256_fmsub_ps(u, tt, v), cosineMinusOne), ct, one);
+        cd = _mm256_fmadd_ps(_mm256_mul_ps(_mm256_fmsub_ps(u, dd, v), cosineMinusOne), cd, one);
+    }
+
+    ct = _mm256_mul_ps(ct, t);
+    cd = _mm256_mul_ps(cd, d);
+
+    for (size_t k = 0; k < 4; ++k)
+    {
+        out[k] = _mm256_fmadd_ps(from[k], cd, _mm256_mul_ps(to[k], ct));
+    }
+}
+
+inline auto normalize_sse(std::span<quat const> in, std::span<quat> out) -> size_t
+{
+    size_t const count = in.size() & ~size_t{ 3 };
+
+    for (size_t i = 0; i < count; i += 4)
+    {
+        __m128 q[4];
+
+        load_quaternions(in.data() + i, q);
+        normalize_quaternions_sse(q);
+        store_quaternions(out.data() + i, q);
+    }
+
+    return count;
+}
+
+MATH_SIMD_TARGET_AVX2 inline auto normalize_avx2(std::span<quat const> in, std::span<quat> out) -> size_t
+{
+    size_t const count = in.size() & ~size_t{ 7 };
+
+    for (size_t i = 0; i < count; i += 8)
+    {
+        __m256 q[4];
+
+        load_quaternions(in.data() + i, q);
+        normalize_quaternions_avx2(q);
+        store_quaternions(out.data() + i, q);
+    }
+
+    return count;
+}
+
+inline auto multiply_sse(std::span<quat const> l, std::span<quat const> r, std::span<quat> out) -> size_t
+{
+    size_t const count = l.size() & ~size_t{ 3 };
+
+    for (size_t i = 0; i < count; i += 4)
+    {
+        __m128 a[4], b[4], result[4];
+
+        load_quaternions(l.data() + i, a);
+        load_quaternions(r.data() + i, b);
+        multiply_quaternions_sse(a, b, result);
+        store_quaternions(out.data() + i, result);
+    }
+
+    return count;
+}
+
+MATH_SIMD_TARGET_AVX2 inline auto multiply_avx2(std::span<quat const> l, std::span<quat const> r, std::span<quat> out) -> size_t
+{
+    size_t const count = l.size() & ~size_t{ 7 };
+
+    for (size_t i = 0; i < count; i += 8)
+    {
+        __m256 a[4], b[4], result[4];
+
+        load_quaternions(l.data() + i, a);
+        load_quaternions(r.data() + i, b);
+        multiply_quaternions_avx2(a, b, result);
+        store_quaternions(out.data() + i, result);
+    }
+
+    return count;
+}
+
+inline auto nlerp_sse(std::span<quat const> from, std::span<quat const> to, std::span<float32 const> weights, std::span<quat> out) -> size_t
+{
+    size_t const count = from.size() & ~size_t{ 3 };
+
+    for (size_t i = 0; i < count; i += 4)
+    {
+        __m128 a[4], b[4];
+
+        load_quaternions(from.data() + i, a);
+        load_quaternions(to.data() + i, b);
+        align_quaternions_sse(a, b);
+
+        __m128 const t = _mm_loadu_ps(weights.data() + i);
+
+        for (size_t k = 0; k < 4; ++k)
+        {
+            b[k] = simd::madd(_mm_sub_ps(b[k], a[k]), t, a[k]);
+        }
+
+        normalize_quaternions_sse(b);
+        store_quaternions(out.data() + i, b);
+    }
+
+    return count;
+}
+
+MATH_SIMD_TARGET_AVX2 inline auto nlerp_avx2(std::span<quat const> from, std::span<quat const> to, std::span<float32 const> weights, std::span<quat> out) -> size_t
+{
+    size_t const count = from.size() & ~size_t{ 7 };
+
+    for (size_t i = 0; i < count; i += 8)
+    {
+        __m256 a[4], b[4];
+
+        load_quaternions(from.data() + i, a);
+        load_quaternions(to.data() + i, b);
+        align_quaternions_avx2(a, b);
+
+        __m256 const t = _mm256_loadu_ps(weights.data() + i);
+
+        for (size_t k = 0; k < 4; ++k)
+        {
+            b[k] = _mm256_fmadd_ps(_mm256_sub_ps(b[k], a[k]), t, a[k]);
+        }
+
+        normalize_quaternions_avx2(b);
+        store_quaternions(out.data() + i, b);
+    }
+
+    return count;
+}
+
+inline auto slerp_sse(std::span<quat const> from, std::span<quat const> to, std::span<float32 const> weights, std::span<quat> out) -> size_t
+{
+    size_t const count = from.size() & ~size_t{ 3 };
+
+    for (size_t i = 0; i < count; i += 4)
+    {
+        __m128 a[4], b[4], result[4];
+
+        load_quaternions(from.data() + i, a);
+        load_quaternions(to.data() + i, b);
+        slerp_quaternions_sse(a, b, _mm_loadu_ps(weights.data() + i), result);
+        store_quaternions(out.data() + i, result);
+    }
+
+    return count;
+}
+
+MATH_SIMD_TARGET_AVX2 inline auto slerp_avx2(std::span<quat const> from, std::span<quat const> to, std::span<float32 const> weights, std::span<quat> out) -> size_t
+{
+    size_t const count = from.size() & ~size_t{ 7 };
+
+    for (size_t i = 0; i < count; i += 8)
+    {
+        __m256 a[4], b[4], result[4];
+
+        load_quaternions(from.data() + i, a);
+        load_quaternions(to.data() + i, b);
+        slerp_quaternions_avx2(a, b, _mm256_loadu_ps(weights.data() + i), result);
+        store_quaternions(out.data() + i, result);
+    }
+
+    return count;
+}
+
+inline auto compose_sse(std::span<quat const> rotations, vector3_view translations, vector3_view scales, std::span<mat4> out) -> size_t
+{
+    size_t const count = rotations.size() & ~size_t{ 3 };
+    __m128 const one = _mm_set1_ps(1.f);
+    __m128 const two = _mm_set1_ps(2.f);
+
+    for (size_t i = 0; i < count; i += 4)
+    {
+        __m128 q[4];
+
+        load_quaternions(rotations.data() + i, q);
+
+        __m128 const w2 = _mm_mul_ps(q[0], two);
+        __m128 const x2 = _mm_mul_ps(q[1], two);
+        __m128 const y2 = _mm_mul_ps(q[2], two);
+        __m128 const z2 = _mm_mul_ps(q[3], two);
+
+        __m128 const xx = _mm_mul_ps(q[1], x2), yy = _mm_mul_ps(q[2], y2), zz = _mm_mul_ps(q[3], z2);
+        __m128 const xy = _mm_mul_ps(q[1], y2), xz = _mm_mul_ps(q[1], z2), yz = _mm_mul_ps(q[2], z2);
+        __m128 const wx = _mm_mul_ps(q[1], w2), wy = _mm_mul_ps(q[2], w2), wz = _mm_mul_ps(q[3], w2);
+
+        __m128 const sx = _mm_loadu_ps(scales.x.data() + i);
+        __m128 const sy = _mm_loadu_ps(scales.y.data() + i);
+        __m128 const sz = _mm_loadu_ps(scales.z.data() + i);
+
+        __m128 columns[4][4] = {
+            { _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), sx), _mm_mul_ps(_mm_add_ps(xy, wz), sx), _mm_mul_ps(_mm_sub_ps(xz, wy), sx), _mm_setzero_ps() },
+            { _mm_mul_ps(_mm_sub_ps(xy, wz), sy), _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), sy), _mm_mul_ps(_mm_add_ps(yz, wx), sy), _mm_setzero_ps() },
+            { _mm_mul_ps(_mm_add_ps(xz, wy), sz), _mm_mul_ps(_mm_sub_ps(yz, wx), sz), _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), sz), _mm_setzero_ps() },
+            { _mm_loadu_ps(translations.x.data() + i), _mm_loadu_ps(translations.y.data() + i), _mm_loadu_ps(translations.z.data() + i), one }
+        };
+
+        for (size_t c = 0; c < 4; ++c)
+        {
+            _MM_TRANSPOSE4_PS(columns[c][0], columns[c][1], columns[c][2], columns[c][3]);
+
+            for (size_t k = 0; k < 4; ++k)
+            {
+                _mm_storeu_ps(&out[i + k].m00 + c * 4, columns[c][k]);
+            }
+        }
+    }
+
+    return count;
+}
+
+MATH_SIMD_TARGET_AVX2 inline auto compose_avx2(std::span<quat const> rotations, vector3_view translations, vector3_view scales, std::span<mat4> out) -> size_t
+{
+    size_t const count = rotations.size() & ~size_t{ 7 };
+    __m256 const one = _mm256_set1_ps(1.f);
+    __m256 const two = _mm256_set1_ps(2.f);
+
+    for (size_t i = 0; i < count; i += 8)
+    {
+        __m256 q[4];
+
+        load_quaternions(rotations.data() + i, q);
+
+        __m256 const w2 = _mm256_mul_ps(q[0], two);
+        __m256 const x2 = _mm256_mul_ps(q[1], two);
+        __m256 const y2 = _mm256_mul_ps(q[2], two);
+        __m256 const z2 = _mm256_mul_ps(q[3], two);
+
+        __m256 const xx = _mm256_mul_ps(q[1], x2), yy = _mm256_mul_ps(q[2], y2), zz = _mm256_mul_ps(q[3], z2);
+        __m256 const xy = _mm256_mul_ps(q[1], y2), xz = _mm256_mul_ps(q[1], z2), yz = _mm256_mul_ps(q[2], z2);
+        __m256 const wx = _mm256_mul_ps(q[1], w2), wy = _mm256_mul_ps(q[2], w2), wz = _mm256_mul_ps(q[3], w2);
+
+        __m256 const sx = _mm256_loadu_ps(scales.x.data() + i);
+        __m256 const sy = _mm256_loadu_ps(scales.y.data() + i);
+        __m256 const sz = _mm256_loadu_ps(scales.z.data() + i);
+
+        __m256 columns[4][4] = {
+            { _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), sx), _mm256_mul_ps(_mm256_add_ps(xy, wz), sx), _mm256_mul_ps(_mm256_sub_ps(xz, wy), sx), _mm256_setzero_ps() },
+            { _mm256_mul_ps(_mm256_sub_ps(xy, wz), sy), _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), sy), _mm256_mul_ps(_mm256_add_ps(yz, wx), sy), _mm256_setzero_ps() },
+            { _mm256_mul_ps(_mm256_add_ps(xz, wy), sz), _mm256_mul_ps(_mm256_sub_ps(yz, wx), sz), _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), sz), _mm256_setzero_ps() },
+            { _mm256_loadu_ps(translations.x.data() + i), _mm256_loadu_ps(translations.y.data() + i), _mm256_loadu_ps(translations.z.data() + i), one }
+        };
+
+        for (size_t c = 0; c < 4; ++c)
+        {
+            store_lanes(&out[i].m00 + c * 4, &out[i + 4].m00 + c * 4, columns[c], sizeof(mat4) / sizeof(float32));
+        }
+    }
+
+    return count;
+}
+#endif
+}
+
+/**
+* @brief out[i] = normalized(in[i]). "out" may be the same as "in".
+*/
+inline auto normalize_quaternions(std::span<quat const> in, std::span<quat> out) -> void
+{
+    ASSERTION(out.size() >= in.size());
+
+    size_t done = 0;
+
+#if MATH_SIMD_SSE2
+    done = simd::cpu_supports_avx2() ? detail::normalize_avx2(in, out) : detail::normalize_sse(in, out);
+#endif
+
+    for (size_t i = done; i < in.size(); ++i)
+    {
+        out[i] = normalized(in[i]);
+    }
+}
+
+/**
+* @brief out[i] = l[i] * r[i]. "out" may be the same as either input.
+*/
+inline auto multiply_quaternions(std::span<quat const> l, std::span<quat const> r, std::span<quat> out) -> void
+{
+    ASSERTION(r.size() == l.size() && out.size() >= l.size());
+
+    size_t done = 0;
+
+#if MATH_SIMD_SSE2
+    done = simd::cpu_supports_avx2() ? detail::multiply_avx2(l, r, out) : detail::multiply_sse(l, r, out);
+#endif
+
+    for (size_t i = done; i < l.size(); ++i)
+    {
+        out[i] = l[i] * r[i];
+    }
+}
+
+/**
+* @brief Normalized linear interpolation along the shorter arc, weights[i] = 0 gives from[i]. Cheaper than slerp and close enough for blending poses that are near each other.
+*/
+inline auto nlerp_quaternions(std::span<quat const> from, std::span<quat const> to, std::span<float32 const> weights, std::span<quat> out) -> void
+{
+    ASSERTION(to.size() == from.size() && weights.size() == from.size() && out.size() >= from.size());
+
+    size_t done = 0;
+
+#if MATH_SIMD_SSE2
+    done = simd::cpu_supports_avx2() ? detail::nlerp_avx2(from, to, weights, out) : detail::nlerp_sse(from, to, weights, out);
+#endif
+
+    for (size_t i = done; i < from.size(); ++i)
+    {
+        out[i] = detail::nlerp_scalar(from[i], to[i], weights[i]);
+    }
+}
+
+/**
+* @brief Spherical linear interpolation along the shorter arc, weights[i] = 0 gives from[i]. Inputs must be unit quaternions.
+* Uses a polynomial approximation accurate to about 1e-6 instead of acos and sin.
+*/
+inline auto slerp_quaternions(std::span<quat const> from, std::span<quat const> to, std::span<float32 const> weights, std::span<quat> out) -> void
+{
+    ASSERTION(to.size() == from.size() && weights.size() == from.size() && out.size() >= from.size());
+
+    size_t done = 0;
+
+#if MATH_SIMD_SSE2
+    done = simd::cpu_supports_avx2() ? detail::slerp_avx2(from, to, weights, out) : detail::slerp_sse(from, to, weights, out);
+#endif
+
+    for (size_t i = done; i < from.size(); ++i)
+    {
+        out[i] = detail::slerp_scalar(from[i], to[i], weights[i]);
+    }
+}
+
+/**
+* @brief out[i] = translate(translations[i]) * mat4_cast(rotations[i]) * scale(scales[i]). Rotations must be unit quaternions.
+*/
+inline auto compose_transforms(std::span<quat const> rotations, vector3_view translations, vector3_view scales, std::span<mat4> out) -> void
+{
+    ASSERTION(translations.size() == rotations.size() && scales.size() == rotations.size() && out.size() >= rotations.size());
+
+    size_t done = 0;
+
+#if MATH_SIMD_SSE2
+    done = simd::cpu_supports_avx2() ? detail::compose_avx2(rotations, translations, scales, out) : detail::compose_sse(rotations, translations, scales, out);
+#endif
+
+    for (size_t i = done; i < rotations.size(); ++i)
+    {
+        detail::compose_scalar(rotations[i], translations.x[i], translations.y[i], translations.z[i], scales.x[i], scales.y[i], scales.z[i], out[i]);
+    }
+}
+}
+}
+
+#endif // !MATH_LIBRARY_BATCH_H
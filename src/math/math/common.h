@@ -2,16 +2,21 @@
 #ifndef MATH_LIBRARY_MATH_H
 #define MATH_LIBRARY_MATH_H
 
+#include <bit>
 #include <cassert>
 #include <type_traits>
 #include <concepts>
 #include <cmath>
+#include <limits>
 
+// lib/common.hpp defines its own ASSERTION, which takes an optional message. Keep it when lib is included first.
+#ifndef ASSERTION
 #if _DEBUG
 #define ASSERTION(expr)	assert(expr)
 #else
 #define ASSERTION(expr)
 #endif
+#endif
 
 using int8 = char;
 using int16 = short;
@@ -31,6 +36,12 @@ namespace math
 template <typename T>
 concept is_arithmetic = std::is_arithmetic_v<T>;
 
+/**
+* Math types are copied in bulk, e.g. memcpy-ed into upload heaps and written into serialized buffers, so every one of them must satisfy this.
+*/
+template <typename T>
+concept is_trivially_copyable_layout = std::is_trivially_copyable_v<T> && std::is_standard_layout_v<T>;
+
 inline auto cos(std::floating_point auto num)
 {
     return std::cos(num);
@@ -166,6 +177,163 @@ inline bool compare_double(float64 a, float64 b, float64 epsilon = 0.0001)
 {
     return ((a - b) <= epsilon);
 }
+
+/**
+* Approximate tier of the float32 functions above for places where a few ULP do not matter, e.g. input smoothing, particles and culling.
+* They are minimax polynomials (Cephes) without data dependent branches. The 4 and 8 wide forms in simd.h run the same steps, except for rsqrt, and agree up to FMA contraction.
+*
+* Maximum error against the exact result, measured over the stated domains:
+*   sin, cos    2 ULP for |x| <= 8192 where |result| >= 1e-3. Closer to the zeros the absolute error stays below 1e-7.
+*   atan2       4 ULP for finite inputs, atan2(0, 0) is 0.
+*   exp2        2 ULP for x in [-126, 127]. Inputs outside are clamped, so the result never becomes a denormal or infinity.
+*   log2        2 ULP for positive normal x, 0 and negative inputs are not handled.
+*   rsqrt       4 ULP for positive normal x.
+*/
+namespace approx
+{
+namespace detail
+{
+/**
+* Adding and subtracting 1.5 * 2^23 rounds to the nearest integer, ties to even, the same as cvtps2dq. The low bits of the sum hold the integer.
+*/
+inline constexpr float32 round_magic_v = 12582912.f;
+
+inline constexpr float32 two_over_pi_v = 0.636619772367581343f;
+
+// pi / 2 split in three parts, k * part is exact for the first two as long as |k| < 2^13.
+inline constexpr float32 half_pi_a_v = 1.5703125f;
+inline constexpr float32 half_pi_b_v = 4.837512969970703125e-4f;
+inline constexpr float32 half_pi_c_v = 7.54978995489188216e-8f;
+
+inline constexpr float32 sin_coefficients_v[3] = { -1.9515295891e-4f, 8.3321608736e-3f, -1.6666654611e-1f };
+inline constexpr float32 cos_coefficients_v[3] = { 2.443315711809948e-5f, -1.388731625493765e-3f, 4.166664568298827e-2f };
+inline constexpr float32 atan_coefficients_v[4] = { 8.05374449538e-2f, -1.38776856032e-1f, 1.99777106478e-1f, -3.33329491539e-1f };
+inline constexpr float32 exp2_coefficients_v[6] = { 1.535336188319500e-4f, 1.339887440266574e-3f, 9.618437357674640e-3f, 5.550332471162809e-2f, 2.402264791363012e-1f, 6.931472028550421e-1f };
+inline constexpr float32 log_coefficients_v[9] = { 7.0376836292e-2f, -1.1514610310e-1f, 1.1676998740e-1f, -1.2420140846e-1f, 1.4249322787e-1f, -1.6668057665e-1f, 2.0000714765e-1f, -2.4999993993e-1f, 3.3333331174e-1f };
+
+inline constexpr float32 tan_eighth_pi_v = 0.414213562373095f;
+inline constexpr float32 quarter_pi_v = 0.785398163397448f;
+inline constexpr float32 half_pi_v = 1.57079632679490f;
+inline constexpr float32 pi_v = 3.14159265358979f;
+inline constexpr float32 sqrt_two_v = 1.41421356237310f;
+inline constexpr float32 log2e_minus_one_v = 0.44269504088896341f;
+
+template <size_t N>
+constexpr auto polynomial(float32 const (&coefficients)[N], float32 x) -> float32
+{
+    float32 result = coefficients[0];
+
+    for (size_t i = 1; i < N; ++i)
+    {
+        result = result * x + coefficients[i];
+    }
+
+    return result;
+}
+
+/**
+* @return sin(x) when quadrant is 0 and cos(x) when it is 1.
+*/
+constexpr auto sin_quadrant(float32 x, uint32 quadrant) -> float32
+{
+    float32 const k = (x * two_over_pi_v + round_magic_v) - round_magic_v;
+    uint32 const q = static_cast<uint32>(static_cast<int32>(k)) + quadrant;
+
+    float32 const r = ((x - k * half_pi_a_v) - k * half_pi_b_v) - k * half_pi_c_v;
+    float32 const z = r * r;
+
+    float32 const s = polynomial(sin_coefficients_v, z) * z * r + r;
+    float32 const c = polynomial(cos_coefficients_v, z) * z * z - 0.5f * z + 1.f;
+
+    // Selected with bit operations, a branch on the quadrant mispredicts half of the time on unsorted input.
+    uint32 const odd = 0u - (q & 1);
+    uint32 const result = (std::bit_cast<uint32>(c) & odd) | (std::bit_cast<uint32>(s) & ~odd);
+
+    return std::bit_cast<float32>(result ^ ((q & 2) << 30));
+}
+}
+
+constexpr auto sin(float32 x) -> float32
+{
+    return detail::sin_quadrant(x, 0);
+}
+
+constexpr auto cos(float32 x) -> float32
+{
+    return detail::sin_quadrant(x, 1);
+}
+
+constexpr auto atan2(float32 y, float32 x) -> float32
+{
+    float32 const ax = (x < 0.f) ? -x : x;
+    float32 const ay = (y < 0.f) ? -y : y;
+    float32 const hi = (ax > ay) ? ax : ay;
+    float32 const lo = (ax > ay) ? ay : ax;
+
+    // Keeps atan2(0, 0) at 0 instead of dividing 0 by 0.
+    float32 const a = lo / ((hi > std::numeric_limits<float32>::min()) ? hi : std::numeric_limits<float32>::min());
+    bool const reduce = a > detail::tan_eighth_pi_v;
+
+    float32 const t = reduce ? (a - 1.f) / (a + 1.f) : a;
+    float32 const z = t * t;
+
+    float32 result = detail::polynomial(detail::atan_coefficients_v, z) * z * t + t + (reduce ? detail::quarter_pi_v : 0.f);
+
+    result = (ay > ax) ? detail::half_pi_v - result : result;
+    result = (x < 0.f) ? detail::pi_v - result : result;
+
+    return ((std::bit_cast<uint32>(y) & 0x80000000u) != 0) ? -result : result;
+}
+
+constexpr auto exp2(float32 x) -> float32
+{
+    x = (x < -126.f) ? -126.f : ((x > 127.f) ? 127.f : x);
+
+    float32 const n = (x + detail::round_magic_v) - detail::round_magic_v;
+    float32 const f = x - n;
+
+    float32 const p = detail::polynomial(detail::exp2_coefficients_v, f) * f + 1.f;
+
+    return p * std::bit_cast<float32>(static_cast<uint32>(static_cast<int32>(n) + 127) << 23);
+}
+
+constexpr auto log2(float32 x) -> float32
+{
+    uint32 const bits = std::bit_cast<uint32>(x);
+
+    float32 e = static_cast<float32>(static_cast<int32>(bits >> 23) - 127);
+    float32 m = std::bit_cast<float32>((bits & 0x007FFFFFu) | 0x3F800000u);
+
+    // Centers the mantissa on 1, in [sqrt(0.5), sqrt(2)].
+    if (m > detail::sqrt_two_v)
+    {
+        m *= 0.5f;
+        e += 1.f;
+    }
+
+    float32 const f = m - 1.f;
+    float32 const z = f * f;
+    float32 const y = detail::polynomial(detail::log_coefficients_v, f) * f * z - 0.5f * z;
+
+    // log2(m) = (y + f) * log2(e), written out so that the large terms are added last.
+    return y * detail::log2e_minus_one_v + f * detail::log2e_minus_one_v + y + f + e;
+}
+
+/**
+* 1 / sqrt(x). The SIMD forms refine the 12 bit rsqrtps estimate with one Newton-Raphson step. The bit level estimate used here is only good to 5 bits and needs three.
+*/
+constexpr auto rsqrt(float32 x) -> float32
+{
+    float32 const half = 0.5f * x;
+    float32 y = std::bit_cast<float32>(0x5F375A86u - (std::bit_cast<uint32>(x) >> 1));
+
+    y = y * (1.5f - half * y * y);
+    y = y * (1.5f - half * y * y);
+    y = y * (1.5f - half * y * y);
+
+    return y;
+}
+}
 }
 
 #endif // MATH_LIBRARY_MATH_H
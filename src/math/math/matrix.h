@@ -3,6 +3,7 @@
 #define MATH_LIBRARY_MATRIX_H
 
 #include "vector.h"
+#include "simd.h"
 
 namespace math
 {
@@ -20,13 +21,6 @@ struct matrix3x3
         m20(0), m21(0), m22(0)
     {}
 
-    constexpr ~matrix3x3()
-    {
-        m00 = m01 = m02 = 0;
-        m10 = m11 = m12 = 0;
-        m20 = m21 = m22 = 0;
-    }
-
     constexpr matrix3x3(T v) :
         matrix3x3()
     {
@@ -49,16 +43,6 @@ struct matrix3x3
         m20(c.x), m21(c.y), m22(c.z)
     {}
 
-    constexpr matrix3x3(matrix3x3 const& m)
-    {
-        *this = m;
-    }
-
-    constexpr matrix3x3(matrix3x3&& m)
-    {
-        *this = std::move(m);
-    }
-
     constexpr T operator[] (size_t i)
     {
         return (&m00)[i];
@@ -69,41 +53,6 @@ struct matrix3x3
         return (&m00)[i];;
     }
 
-    constexpr matrix3x3& operator=(matrix3x3 const& m)
-    {
-        if (this != &m)
-        {
-            m00 = m.m00;
-            m01 = m.m01;
-            m02 = m.m02;
-            m10 = m.m10;
-            m11 = m.m11;
-            m12 = m.m12;
-            m20 = m.m20;
-            m21 = m.m21;
-            m22 = m.m22;
-        }
-        return *this;
-    }
-
-    constexpr matrix3x3& operator=(matrix3x3&& m)
-    {
-        if (this != &m)
-        {
-            m00 = m.m00;
-            m01 = m.m01;
-            m02 = m.m02;
-            m10 = m.m10;
-            m11 = m.m11;
-            m12 = m.m12;
-            m20 = m.m20;
-            m21 = m.m21;
-            m22 = m.m22;
-            new (&m) matrix3x3();
-        }
-        return *this;
-    }
-
     constexpr matrix3x3& operator+= (matrix3x3 const& m)
     {
         *this = *this + m;
@@ -335,7 +284,7 @@ constexpr matrix3x3<T> inverse(matrix3x3<T> const& m)
     res.m11 = +(m.m00 * m.m22 - m.m20 * m.m02) * d;
     res.m12 = -(m.m00 * m.m12 - m.m02 * m.m10) * d;
     res.m20 = +(m.m21 * m.m10 - m.m11 * m.m20) * d;
-    res.m21 = -(m.m21 * m.m00 - m.m02 * m.m20) * d;
+    res.m21 = -(m.m21 * m.m00 - m.m01 * m.m20) * d;
     res.m22 = +(m.m11 * m.m00 - m.m01 * m.m10) * d;
     return res;
 }
@@ -367,14 +316,6 @@ struct matrix4x4
         m30(0), m31(0), m32(0), m33(0)
     {}
 
-    constexpr ~matrix4x4()
-    {
-        m00 = m01 = m02 = m03 = 0;
-        m10 = m11 = m12 = m13 = 0;
-        m20 = m21 = m22 = m23 = 0;
-        m30 = m31 = m32 = m33 = 0;
-    }
-
     constexpr matrix4x4(T v) :
         matrix4x4()
     {
@@ -405,16 +346,6 @@ struct matrix4x4
         m30(0), m31(0), m32(0), m33(1)
     {}
 
-    constexpr matrix4x4(matrix4x4 const& m)
-    {
-        *this = m;
-    }
-
-    constexpr matrix4x4(matrix4x4&& m)
-    {
-        *this = std::move(m);
-    }
-
     constexpr T operator[] (size_t i)
     {
         return (&m00)[i];
@@ -425,55 +356,6 @@ struct matrix4x4
         return (&m00)[i];;
     }
 
-    constexpr matrix4x4& operator=(matrix4x4 const& m)
-    {
-        if (this != &m)
-        {
-            m00 = m.m00;
-            m01 = m.m01;
-            m02 = m.m02;
-            m03 = m.m03;
-            m10 = m.m10;
-            m11 = m.m11;
-            m12 = m.m12;
-            m13 = m.m13;
-            m20 = m.m20;
-            m21 = m.m21;
-            m22 = m.m22;
-            m23 = m.m23;
-            m30 = m.m30;
-            m31 = m.m31;
-            m32 = m.m32;
-            m33 = m.m33;
-        }
-        return *this;
-    }
-
-    constexpr matrix4x4& operator=(matrix4x4&& m)
-    {
-        if (this != &m)
-        {
-            m00 = m.m00;
-            m01 = m.m01;
-            m02 = m.m02;
-            m03 = m.m03;
-            m10 = m.m10;
-            m11 = m.m11;
-            m12 = m.m12;
-            m13 = m.m13;
-            m20 = m.m20;
-            m21 = m.m21;
-            m22 = m.m22;
-            m23 = m.m23;
-            m30 = m.m30;
-            m31 = m.m31;
-            m32 = m.m32;
-            m33 = m.m33;
-            new (&m) matrix4x4();
-        }
-        return *this;
-    }
-
     constexpr matrix4x4& operator+= (matrix4x4 const& m)
     {
         *this = *this + m;
@@ -656,6 +538,18 @@ constexpr matrix4x4<T> operator- (T s, matrix4x4<T> const& m)
 template <is_arithmetic T>
 constexpr matrix4x4<T> operator* (matrix4x4<T> const& l, matrix4x4<T> const& r)
 {
+#if MATH_SIMD_SSE2
+    if constexpr (std::same_as<T, float32>)
+    {
+        if (!std::is_constant_evaluated())
+        {
+            matrix4x4<T> res;
+            simd::multiply(&l.m00, &r.m00, &res.m00);
+            return res;
+        }
+    }
+#endif
+
     matrix4x4<T> res;
     res.m00 = r.m00 * l.m00 + r.m01 * l.m10 + r.m02 * l.m20 + r.m03 * l.m30;
     res.m01 = r.m00 * l.m01 + r.m01 * l.m11 + r.m02 * l.m21 + r.m03 * l.m31;
@@ -708,6 +602,18 @@ constexpr matrix4x4<T> operator* (T s, matrix4x4<T> const& m)
 template <is_arithmetic T>
 constexpr vector4<T> operator* (matrix4x4<T> const& m, vector4<T> const& v)
 {
+#if MATH_SIMD_SSE2
+    if constexpr (std::same_as<T, float32>)
+    {
+        if (!std::is_constant_evaluated())
+        {
+            vector4<T> res;
+            simd::transform4(&m.m00, &v.x, &res.x);
+            return res;
+        }
+    }
+#endif
+
     vector4<T> res;
     res.x = v.x * m.m00 + v.y * m.m10 + v.z * m.m20 + v.w * m.m30;
     res.y = v.x * m.m01 + v.y * m.m11 + v.z * m.m21 + v.w * m.m31;
@@ -726,6 +632,18 @@ constexpr vector4<T> operator* (vector4<T> const& v, matrix4x4<T> const& m)
 template <is_arithmetic T>
 constexpr vector3<T> operator* (matrix4x4<T> const& m, vector3<T> const& v)
 {
+#if MATH_SIMD_SSE2
+    if constexpr (std::same_as<T, float32>)
+    {
+        if (!std::is_constant_evaluated())
+        {
+            vector3<T> res;
+            simd::transform3(&m.m00, &v.x, &res.x);
+            return res;
+        }
+    }
+#endif
+
     vector3<T> res;
     res.x = v.x * m.m00 + v.y * m.m10 + v.z * m.m20;
     res.y = v.x * m.m01 + v.y * m.m11 + v.z * m.m21;
@@ -737,7 +655,7 @@ template <is_arithmetic T>
 constexpr vector3<T> operator* (vector3<T> const& v, matrix4x4<T> const& m)
 {
     const matrix4x4<T> transposed = transpose(m);
-    return m * v;
+    return transposed * v;
 }
 
 template <is_arithmetic T>
@@ -750,10 +668,10 @@ constexpr T determinant(matrix4x4<T> const& m)
     T sf04 = m.m20 * m.m32 - m.m30 * m.m22;
     T sf05 = m.m20 * m.m31 - m.m30 * m.m21;
 
-    T dc0 = +m.m11 * sf00 - m.m12 * sf01 + m.m13 * sf02;
-    T dc1 = -m.m10 * sf00 - m.m12 * sf03 + m.m13 * sf04;
-    T dc2 = +m.m10 * sf01 - m.m11 * sf03 + m.m13 * sf05;
-    T dc3 = -m.m10 * sf02 - m.m11 * sf04 + m.m12 * sf05;
+    T dc0 = +(m.m11 * sf00 - m.m12 * sf01 + m.m13 * sf02);
+    T dc1 = -(m.m10 * sf00 - m.m12 * sf03 + m.m13 * sf04);
+    T dc2 = +(m.m10 * sf01 - m.m11 * sf03 + m.m13 * sf05);
+    T dc3 = -(m.m10 * sf02 - m.m11 * sf04 + m.m12 * sf05);
 
     return m.m00 * dc0 + m.m01 * dc1 + m.m02 * dc2 + m.m03 * dc3;
 }
@@ -761,6 +679,18 @@ constexpr T determinant(matrix4x4<T> const& m)
 template <is_arithmetic T>
 constexpr matrix4x4<T> transpose(matrix4x4<T> const& m)
 {
+#if MATH_SIMD_SSE2
+    if constexpr (std::same_as<T, float32>)
+    {
+        if (!std::is_constant_evaluated())
+        {
+            matrix4x4<T> res;
+            simd::transpose(&m.m00, &res.m00);
+            return res;
+        }
+    }
+#endif
+
     matrix4x4<T> res;
     res.m00 = m.m00;
     res.m01 = m.m10;
@@ -784,6 +714,21 @@ constexpr matrix4x4<T> transpose(matrix4x4<T> const& m)
 template <is_arithmetic T>
 constexpr matrix4x4<T> inverse(matrix4x4<T> const& m)
 {
+#if MATH_SIMD_SSE2
+    if constexpr (std::same_as<T, float32>)
+    {
+        if (!std::is_constant_evaluated())
+        {
+            // A singular matrix falls through to the scalar path, which keeps its infinities.
+            matrix4x4<T> res;
+            if (simd::inverse(&m.m00, &res.m00) != 0.f)
+            {
+                return res;
+            }
+        }
+    }
+#endif
+
     matrix4x4<T> res;
     T d = 1 / determinant(m);
 
@@ -807,6 +752,37 @@ constexpr matrix4x4<T> inverse(matrix4x4<T> const& m)
     return res;
 }
 
+/**
+* Inverse of an affine transform, i.e. a matrix whose last row is (0, 0, 0, 1). Cheaper than the general inverse.
+*/
+template <is_arithmetic T>
+constexpr matrix4x4<T> inverse_affine(matrix4x4<T> const& m)
+{
+#if MATH_SIMD_SSE2
+    if constexpr (std::same_as<T, float32>)
+    {
+        if (!std::is_constant_evaluated())
+        {
+            matrix4x4<T> res;
+            simd::inverse_affine(&m.m00, &res.m00);
+            return res;
+        }
+    }
+#endif
+
+    const matrix3x3<T> linear = inverse(matrix3x3<T>(
+        m.m00, m.m01, m.m02,
+        m.m10, m.m11, m.m12,
+        m.m20, m.m21, m.m22
+    ));
+
+    matrix4x4<T> res(linear);
+    res.m30 = -(linear.m00 * m.m30 + linear.m10 * m.m31 + linear.m20 * m.m32);
+    res.m31 = -(linear.m01 * m.m30 + linear.m11 * m.m31 + linear.m21 * m.m32);
+    res.m32 = -(linear.m02 * m.m30 + linear.m12 * m.m31 + linear.m22 * m.m32);
+    return res;
+}
+
 template <is_arithmetic T>
 constexpr void transposed(matrix4x4<T>& m)
 {
@@ -851,8 +827,8 @@ constexpr matrix4x4<T> translated(matrix4x4<T> const& m, vector3<T> const& v)
 template <is_arithmetic T>
 constexpr matrix4x4<T> rotated(matrix4x4<T> const& m, T a, vector3<T> const& v)
 {
-    const T c = static_cast<T>(Cos(a));
-    const T s = static_cast<T>(Sin(a));
+    const T c = static_cast<T>(cos(a));
+    const T s = static_cast<T>(sin(a));
 
     vector3<T> axis = normalized(v);
     vector3<T> temp = (1 - c) * axis;
@@ -904,6 +880,18 @@ constexpr matrix4x4<T> orthographic_rh(T left, T right, T bottom, T top, T znear
 template <is_arithmetic T>
 constexpr matrix4x4<T> perspective_rh(T fov, T aspect, T znear, T zfar)
 {
+#if MATH_SIMD_SSE2
+    if constexpr (std::same_as<T, float32>)
+    {
+        if (!std::is_constant_evaluated())
+        {
+            matrix4x4<T> res;
+            simd::perspective_rh(1 / static_cast<T>(tan(fov * 0.5f)), aspect, znear, zfar, &res.m00);
+            return res;
+        }
+    }
+#endif
+
     matrix4x4<T> res(0);
     const T f = 1 / static_cast<T>(tan(fov * 0.5f));
 
@@ -921,8 +909,20 @@ constexpr matrix4x4<T> perspective_rh(T fov, T aspect, T znear, T zfar)
 template <is_arithmetic T>
 constexpr matrix4x4<T> look_at_rh(vector3<T> const& eye, vector3<T> const& center, vector3<T> const& up)
 {
+#if MATH_SIMD_SSE2
+    if constexpr (std::same_as<T, float32>)
+    {
+        if (!std::is_constant_evaluated())
+        {
+            matrix4x4<T> res;
+            simd::look_at_rh(&eye.x, &center.x, &up.x, &res.m00);
+            return res;
+        }
+    }
+#endif
+
     const vector3<T> f(normalized(center - eye));
-    const vector3<T> s(normalized(Cross(f, up)));
+    const vector3<T> s(normalized(cross(f, up)));
     const vector3<T> u(cross(s, f));
 
     matrix4x4<T> res(1);
@@ -963,6 +963,10 @@ constexpr matrix4x4<T> look_at_rh(vector3<T> const& eye, vector3<T> const& cente
 using mat3 = matrix3x3<float32>;
 using mat4 = matrix4x4<float32>;
 
+static_assert(is_trivially_copyable_layout<mat3> && sizeof(mat3) == 9 * sizeof(float32));
+static_assert(is_trivially_copyable_layout<mat4> && sizeof(mat4) == 16 * sizeof(float32));
+static_assert(is_trivially_copyable_layout<matrix3x3<float64>> && is_trivially_copyable_layout<matrix4x4<float64>>);
+
 }
 
 #endif // !MATH_LIBRARY_MATRIX_H
@@ -0,0 +1,933 @@
+#pragma once
+#ifndef MATH_LIBRARY_PACK_H
+#define MATH_LIBRARY_PACK_H
+
+#include "batch.h"
+
+namespace math
+{
+/**
+* Conversions between float32 and the compact formats in gpu::Format, for vertex data and textures produced by asset cooking or at runtime.
+* Every conversion has a scalar form for single values and a bulk form over spans. The bulk forms use F16C for halves and SSE2 for the rest, they are bound by memory bandwidth so wider registers would not help.
+* Rounding is to nearest even everywhere except RGB9E5, which rounds half up as the format's specification asks for.
+*/
+namespace pack
+{
+namespace detail
+{
+/**
+* Adding and subtracting 1.5 * 2^23 rounds to the nearest integer, ties to even, the same as cvtps2dq does with the default rounding mode.
+*/
+inline constexpr float32 round_magic_v = 12582912.f;
+
+/**
+* @brief Clamps like maxps and minps do, NaN becomes "lo".
+*/
+constexpr auto clamp(float32 x, float32 lo, float32 hi) -> float32
+{
+    x = (x > lo) ? x : lo;
+    return (x < hi) ? x : hi;
+}
+
+constexpr auto round_to_int(float32 x) -> int32
+{
+    return static_cast<int32>((x + round_magic_v) - round_magic_v);
+}
+
+/**
+* Converts the magnitude of a float32, given by its bits without the sign, to a float with 5 exponent bits, "M" mantissa bits and a bias of 15.
+* Rounds to nearest even, values too large for the format become infinity and NaN stays NaN.
+*/
+template <uint32 M>
+constexpr auto float_bits_to_small_float(uint32 bits) -> uint32
+{
+    constexpr uint32 shift = 23 - M;
+    constexpr uint32 infinity = 0x1Fu << M;
+
+    if (bits >= 0x7F800000u)
+    {
+        return (bits > 0x7F800000u) ? (infinity | (1u << (M - 1))) : infinity;
+    }
+
+    // Below 2^-14 the result is a denormal, counted in units of 2^(-14 - M).
+    if (bits < 0x38800000u)
+    {
+        uint32 const s = (113u - (bits >> 23)) + shift;
+
+        if (s > 24)
+        {
+            return 0;
+        }
+
+        uint32 const mantissa = (bits & 0x007FFFFFu) | 0x00800000u;
+        uint32 const result = mantissa >> s;
+        uint32 const remainder = mantissa & ((1u << s) - 1);
+        uint32 const half = 1u << (s - 1);
+
+        return result + ((remainder > half || (remainder == half && (result & 1) != 0)) ? 1 : 0);
+    }
+
+    // Rebiasing the exponent lines the float up with the target format, a carry out of the mantissa bumps the exponent as it should.
+    uint32 const rebiased = bits - ((127u - 15u) << 23);
+    uint32 const rounded = (rebiased + ((1u << (shift - 1)) - 1) + ((rebiased >> shift) & 1)) >> shift;
+
+    return (rounded < infinity) ? rounded : infinity;
+}
+
+/**
+* @return The float32 bits for a float with 5 exponent bits, "M" mantissa bits and a bias of 15.
+*/
+template <uint32 M>
+constexpr auto small_float_to_float_bits(uint32 value) -> uint32
+{
+    constexpr uint32 shift = 23 - M;
+    constexpr uint32 exponentMask = 0x1Fu << 23;
+
+    uint32 bits = value << shift;
+    uint32 const exponent = bits & exponentMask;
+
+    bits += (127u - 15u) << 23;
+
+    if (exponent == exponentMask)
+    {
+        // Infinity and NaN, all exponent bits set.
+        bits += (128u - 16u) << 23;
+    }
+    else if (exponent == 0)
+    {
+        // A denormal, renormalized by subtracting the implicit one. Stays correct with denormals-are-zero enabled.
+        bits += 1u << 23;
+        bits = std::bit_cast<uint32>(std::bit_cast<float32>(bits) - std::bit_cast<float32>(113u << 23));
+    }
+
+    return bits;
+}
+
+/**
+* Largest finite values of the unsigned packed float formats.
+*/
+inline constexpr float32 float11_max_v = 65024.f;
+inline constexpr float32 float10_max_v = 64512.f;
+inline constexpr float32 rgb9e5_max_v = 65408.f;
+}
+
+constexpr auto float_to_half(float32 value) -> uint16
+{
+    uint32 const bits = std::bit_cast<uint32>(value);
+    return static_cast<uint16>(((bits >> 16) & 0x8000u) | detail::float_bits_to_small_float<10>(bits & 0x7FFFFFFFu));
+}
+
+constexpr auto half_to_float(uint16 value) -> float32
+{
+    return std::bit_cast<float32>(((static_cast<uint32>(value) & 0x8000u) << 16) | detail::small_float_to_float_bits<10>(value & 0x7FFFu));
+}
+
+/**
+* @brief Clamps to [-1, 1] and rounds. NaN becomes -1.
+*/
+constexpr auto float_to_snorm8(float32 value) -> int8
+{
+    return static_cast<int8>(detail::round_to_int(detail::clamp(value, -1.f, 1.f) * 127.f));
+}
+
+constexpr auto snorm8_to_float(int8 value) -> float32
+{
+    float32 const result = static_cast<float32>(static_cast<signed char>(value)) * (1.f / 127.f);
+    return (result > -1.f) ? result : -1.f;
+}
+
+constexpr auto float_to_snorm16(float32 value) -> int16
+{
+    return static_cast<int16>(detail::round_to_int(detail::clamp(value, -1.f, 1.f) * 32767.f));
+}
+
+constexpr auto snorm16_to_float(int16 value) -> float32
+{
+    float32 const result = static_cast<float32>(value) * (1.f / 32767.f);
+    return (result > -1.f) ? result : -1.f;
+}
+
+/**
+* @brief Clamps to [0, 1] and rounds. NaN becomes 0.
+*/
+constexpr auto float_to_unorm8(float32 value) -> uint8
+{
+    return static_cast<uint8>(detail::round_to_int(detail::clamp(value, 0.f, 1.f) * 255.f));
+}
+
+constexpr auto unorm8_to_float(uint8 value) -> float32
+{
+    return static_cast<float32>(value) * (1.f / 255.f);
+}
+
+constexpr auto float_to_unorm16(float32 value) -> uint16
+{
+    return static_cast<uint16>(detail::round_to_int(detail::clamp(value, 0.f, 1.f) * 65535.f));
+}
+
+constexpr auto unorm16_to_float(uint16 value) -> float32
+{
+    return static_cast<float32>(value) * (1.f / 65535.f);
+}
+
+/**
+* @brief Octahedral encoding of a unit vector into two snorm16, x in the low half. Worst case angular error is about 0.004 degrees.
+*/
+inline auto octahedral_encode(vec3 const& n) -> uint32
+{
+    float32 const scale = 1.f / (std::fabs(n.x) + std::fabs(n.y) + std::fabs(n.z));
+
+    float32 x = n.x * scale;
+    float32 y = n.y * scale;
+
+    // The lower hemisphere is folded over the diagonals.
+    if (n.z < 0.f)
+    {
+        float32 const fx = (1.f - std::fabs(y)) * std::copysign(1.f, x);
+        float32 const fy = (1.f - std::fabs(x)) * std::copysign(1.f, y);
+
+        x = fx;
+        y = fy;
+    }
+
+    return static_cast<uint32>(static_cast<uint16>(float_to_snorm16(x))) | (static_cast<uint32>(static_cast<uint16>(float_to_snorm16(y))) << 16);
+}
+
+inline auto octahedral_decode(uint32 value) -> vec3
+{
+    float32 x = snorm16_to_float(static_cast<int16>(value & 0xFFFFu));
+    float32 y = snorm16_to_float(static_cast<int16>(value >> 16));
+    float32 const z = 1.f - std::fabs(x) - std::fabs(y);
+
+    // Unfolds the lower hemisphere.
+    float32 const t = (-z > 0.f) ? -z : 0.f;
+
+    x -= std::copysign(t, x);
+    y -= std::copysign(t, y);
+
+    float32 const scale = 1.f / std::sqrt(x * x + y * y + z * z);
+
+    return vec3(x * scale, y * scale, z * scale);
+}
+
+/**
+* @brief Shared exponent RGB (E5B9G9R9_UFloat_Pack32), following the Vulkan specification's encoding. Negative values and NaN become 0, values above 65408 clamp to it.
+*/
+inline auto float_to_rgb9e5(vec3 const& rgb) -> uint32
+{
+    float32 const r = detail::clamp(rgb.x, 0.f, detail::rgb9e5_max_v);
+    float32 const g = detail::clamp(rgb.y, 0.f, detail::rgb9e5_max_v);
+    float32 const b = detail::clamp(rgb.z, 0.f, detail::rgb9e5_max_v);
+
+    float32 const maxComponent = std::max(std::max(r, g), b);
+
+    // floor(log2(maxComponent)) straight from the exponent bits, kept at -16 or above. The shared exponent has a bias of 15.
+    int32 exponent = std::max(static_cast<int32>(std::bit_cast<uint32>(maxComponent) >> 23) - 127, -16) + 16;
+
+    // 2^(24 - exponent) turns a component into its 9 bit mantissa.
+    float32 scale = std::bit_cast<float32>(static_cast<uint32>(151 - exponent) << 23);
+
+    if (static_cast<uint32>(maxComponent * scale + 0.5f) == 512)
+    {
+        exponent += 1;
+        scale *= 0.5f;
+    }
+
+    uint32 const rs = static_cast<uint32>(r * scale + 0.5f);
+    uint32 const gs = static_cast<uint32>(g * scale + 0.5f);
+    uint32 const bs = static_cast<uint32>(b * scale + 0.5f);
+
+    return rs | (gs << 9) | (bs << 18) | (static_cast<uint32>(exponent) << 27);
+}
+
+inline auto rgb9e5_to_float(uint32 value) -> vec3
+{
+    // 2^(exponent - 15 - 9)
+    float32 const scale = std::bit_cast<float32>(((value >> 27) + 103u) << 23);
+
+    return vec3(
+        static_cast<float32>(value & 0x1FFu) * scale,
+        static_cast<float32>((value >> 9) & 0x1FFu) * scale,
+        static_cast<float32>((value >> 18) & 0x1FFu) * scale
+    );
+}
+
+/**
+* @brief Packed unsigned floats (B10G11R11_UFloat_Pack32), red in the low 11 bits. Negative values and NaN become 0, values too large clamp to the largest finite value.
+*/
+inline auto float_to_r11g11b10f(vec3 const& rgb) -> uint32
+{
+    uint32 const r = detail::float_bits_to_small_float<6>(std::bit_cast<uint32>(detail::clamp(rgb.x, 0.f, detail::float11_max_v)));
+    uint32 const g = detail::float_bits_to_small_float<6>(std::bit_cast<uint32>(detail::clamp(rgb.y, 0.f, detail::float11_max_v)));
+    uint32 const b = detail::float_bits_to_small_float<5>(std::bit_cast<uint32>(detail::clamp(rgb.z, 0.f, detail::float10_max_v)));
+
+    return r | (g << 11) | (b << 22);
+}
+
+inline auto r11g11b10f_to_float(uint32 value) -> vec3
+{
+    return vec3(
+        std::bit_cast<float32>(detail::small_float_to_float_bits<6>(value & 0x7FFu)),
+        std::bit_cast<float32>(detail::small_float_to_float_bits<6>((value >> 11) & 0x7FFu)),
+        std::bit_cast<float32>(detail::small_float_to_float_bits<5>(value >> 22))
+    );
+}
+
+namespace detail
+{
+#if MATH_SIMD_SSE2
+MATH_SIMD_TARGET_F16C inline auto float_to_half_f16c(std::span<float32 const> in, std::span<uint16> out) -> size_t
+{
+    size_t const count = in.size() & ~size_t{ 7 };
+
+    for (size_t i = 0; i < count; i += 8)
+    {
+        __m128i const h = _mm256_cvtps_ph(_mm256_loadu_ps(in.data() + i), _MM_FROUND_TO_NEAREST_INT);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out.data() + i), h);
+    }
+
+    return count;
+}
+
+MATH_SIMD_TARGET_F16C inline auto half_to_float_f16c(std::span<uint16 const> in, std::span<float32> out) -> size_t
+{
+    size_t const count = in.size() & ~size_t{ 7 };
+
+    for (size_t i = 0; i < count; i += 8)
+    {
+        __m128i const h = _mm_loadu_si128(reinterpret_cast<__m128i const*>(in.data() + i));
+        _mm256_storeu_ps(out.data() + i, _mm256_cvtph_ps(h));
+    }
+
+    return count;
+}
+
+inline auto round_clamped(float32 const* in, __m128 lo, __m128 hi, __m128 scale) -> __m128i
+{
+    return _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(in), lo), hi), scale));
+}
+
+inline auto float_to_norm8_sse(std::span<float32 const> in, void* out, bool isSigned) -> size_t
+{
+    __m128 const lo = _mm_set1_ps(isSigned ? -1.f : 0.f);
+    __m128 const hi = _mm_set1_ps(1.f);
+    __m128 const scale = _mm_set1_ps(isSigned ? 127.f : 255.f);
+
+    size_t const count = in.size() & ~size_t{ 15 };
+    uint8* bytes = static_cast<uint8*>(out);
+
+    for (size_t i = 0; i < count; i += 16)
+    {
+        float32 const* src = in.data() + i;
+
+        __m128i const a = _mm_packs_epi32(round_clamped(src, lo, hi, scale), round_clamped(src + 4, lo, hi, scale));
+        __m128i const b = _mm_packs_epi32(round_clamped(src + 8, lo, hi, scale), round_clamped(src + 12, lo, hi, scale));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(bytes + i), isSigned ? _mm_packs_epi16(a, b) : _mm_packus_epi16(a, b));
+    }
+
+    return count;
+}
+
+inline auto float_to_norm16_sse(std::span<float32 const> in, void* out, bool isSigned) -> size_t
+{
+    __m128 const lo = _mm_set1_ps(isSigned ? -1.f : 0.f);
+    __m128 const hi = _mm_set1_ps(1.f);
+    __m128 const scale = _mm_set1_ps(isSigned ? 32767.f : 65535.f);
+
+    // SSE2 can only pack with signed saturation, unsigned values are moved into the signed range and back.
+    __m128i const bias = _mm_set1_epi32(isSigned ? 0 : 32768);
+    __m128i const unbias = _mm_set1_epi16(isSigned ? 0 : static_cast<int16>(0x8000));
+
+    size_t const count = in.size() & ~size_t{ 7 };
+    uint16* words = static_cast<uint16*>(out);
+
+    for (size_t i = 0; i < count; i += 8)
+    {
+        float32 const* src = in.data() + i;
+
+        __m128i const a = _mm_sub_epi32(round_clamped(src, lo, hi, scale), bias);
+        __m128i const b = _mm_sub_epi32(round_clamped(src + 4, lo, hi, scale), bias);
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(words + i), _mm_xor_si128(_mm_packs_epi32(a, b), unbias));
+    }
+
+    return count;
+}
+
+inline auto store_norm(float32* out, __m128i values, __m128 scale, bool isSigned) -> void
+{
+    __m128 result = _mm_mul_ps(_mm_cvtepi32_ps(values), scale);
+
+    if (isSigned)
+    {
+        result = _mm_max_ps(result, _mm_set1_ps(-1.f));
+    }
+
+    _mm_storeu_ps(out, result);
+}
+
+inline auto norm8_to_float_sse(void const* in, std::span<float32> out, bool isSigned) -> size_t
+{
+    __m128 const scale = _mm_set1_ps(isSigned ? (1.f / 127.f) : (1.f / 255.f));
+
+    size_t const count = out.size() & ~size_t{ 15 };
+    uint8 const* bytes = static_cast<uint8 const*>(in);
+
+    for (size_t i = 0; i < count; i += 16)
+    {
+        __m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(bytes + i));
+
+        // Widening by unpacking a value with itself and shifting it back down extends the sign, unpacking with zero does not.
+        __m128i lo;
+        __m128i hi;
+
+        if (isSigned)
+        {
+            lo = _mm_srai_epi16(_mm_unpacklo_epi8(v, v), 8);
+            hi = _mm_srai_epi16(_mm_unpackhi_epi8(v, v), 8);
+        }
+        else
+        {
+            lo = _mm_unpacklo_epi8(v, _mm_setzero_si128());
+            hi = _mm_unpackhi_epi8(v, _mm_setzero_si128());
+        }
+
+        float32* dst = out.data() + i;
+
+        store_norm(dst, _mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 16), scale, isSigned);
+        store_norm(dst + 4, _mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 16), scale, isSigned);
+        store_norm(dst + 8, _mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 16), scale, isSigned);
+        store_norm(dst + 12, _mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 16), scale, isSigned);
+    }
+
+    return count;
+}
+
+inline auto norm16_to_float_sse(void const* in, std::span<float32> out, bool isSigned) -> size_t
+{
+    __m128 const scale = _mm_set1_ps(isSigned ? (1.f / 32767.f) : (1.f / 65535.f));
+
+    size_t const count = out.size() & ~size_t{ 7 };
+    uint16 const* words = static_cast<uint16 const*>(in);
+
+    for (size_t i = 0; i < count; i += 8)
+    {
+        __m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(words + i));
+
+        __m128i const lo = isSigned ? _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16) : _mm_unpacklo_epi16(v, _mm_setzero_si128());
+        __m128i const hi = isSigned ? _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16) : _mm_unpackhi_epi16(v, _mm_setzero_si128());
+
+        store_norm(out.data() + i, lo, scale, isSigned);
+        store_norm(out.data() + i + 4, hi, scale, isSigned);
+    }
+
+    return count;
+}
+
+/**
+* @return ±1 with the sign of v, +1 for +0.
+*/
+inline auto sign_not_zero(__m128 v) -> __m128
+{
+    return _mm_or_ps(_mm_and_ps(v, _mm_set1_ps(-0.f)), _mm_set1_ps(1.f));
+}
+
+inline auto octahedral_encode_sse(batch::vector3_view in, std::span<uint32> out) -> size_t
+{
+    __m128 const absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    __m128 const one = _mm_set1_ps(1.f);
+    __m128 const lo = _mm_set1_ps(-1.f);
+    __m128 const snorm = _mm_set1_ps(32767.f);
+
+    size_t const count = in.size() & ~size_t{ 3 };
+
+    for (size_t i = 0; i < count; i += 4)
+    {
+        __m128 const nx = _mm_loadu_ps(in.x.data() + i);
+        __m128 const ny = _mm_loadu_ps(in.y.data() + i);
+        __m128 const nz = _mm_loadu_ps(in.z.data() + i);
+
+        __m128 const scale = _mm_div_ps(one, _mm_add_ps(_mm_add_ps(_mm_and_ps(nx, absMask), _mm_and_ps(ny, absMask)), _mm_and_ps(nz, absMask)));
+
+        __m128 x = _mm_mul_ps(nx, scale);
+        __m128 y = _mm_mul_ps(ny, scale);
+
+        __m128 const fold = _mm_cmplt_ps(nz, _mm_setzero_ps());
+        __m128 const fx = _mm_mul_ps(_mm_sub_ps(one, _mm_and_ps(y, absMask)), sign_not_zero(x));
+        __m128 const fy = _mm_mul_ps(_mm_sub_ps(one, _mm_and_ps(x, absMask)), sign_not_zero(y));
+
+        x = simd::select(fold, fx, x);
+        y = simd::select(fold, fy, y);
+
+        __m128i const qx = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(x, lo), one), snorm));
+        __m128i const qy = _mm_cvtps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(y, lo), one), snorm));
+
+        __m128i const packed = _mm_or_si128(_mm_and_si128(qx, _mm_set1_epi32(0xFFFF)), _mm_slli_epi32(qy, 16));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out.data() + i), packed);
+    }
+
+    return count;
+}
+
+inline auto octahedral_decode_sse(std::span<uint32 const> in, batch::vector3_span out) -> size_t
+{
+    __m128 const signMask = _mm_set1_ps(-0.f);
+    __m128 const one = _mm_set1_ps(1.f);
+    __m128 const lo = _mm_set1_ps(-1.f);
+    __m128 const snorm = _mm_set1_ps(1.f / 32767.f);
+
+    size_t const count = in.size() & ~size_t{ 3 };
+
+    for (size_t i = 0; i < count; i += 4)
+    {
+        __m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(in.data() + i));
+
+        __m128 x = _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(v, 16), 16)), snorm), lo);
+        __m128 y = _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(v, 16)), snorm), lo);
+        __m128 const z = _mm_sub_ps(_mm_sub_ps(one, _mm_andnot_ps(signMask, x)), _mm_andnot_ps(signMask, y));
+
+        __m128 const t = _mm_max_ps(_mm_xor_ps(z, signMask), _mm_setzero_ps());
+
+        x = _mm_sub_ps(x, _mm_or_ps(t, _mm_and_ps(x, signMask)));
+        y = _mm_sub_ps(y, _mm_or_ps(t, _mm_and_ps(y, signMask)));
+
+        __m128 const scale = _mm_div_ps(one, _mm_sqrt_ps(simd::madd(z, z, simd::madd(y, y, _mm_mul_ps(x, x)))));
+
+        _mm_storeu_ps(out.x.data() + i, _mm_mul_ps(x, scale));
+        _mm_storeu_ps(out.y.data() + i, _mm_mul_ps(y, scale));
+        _mm_storeu_ps(out.z.data() + i, _mm_mul_ps(z, scale));
+    }
+
+    return count;
+}
+
+inline auto rgb9e5_encode_sse(batch::vector3_view in, std::span<uint32> out) -> size_t
+{
+    __m128 const zero = _mm_setzero_ps();
+    __m128 const hi = _mm_set1_ps(rgb9e5_max_v);
+    __m128 const half = _mm_set1_ps(0.5f);
+
+    size_t const count = in.size() & ~size_t{ 3 };
+
+    for (size_t i = 0; i < count; i += 4)
+    {
+        __m128 const r = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(in.x.data() + i), zero), hi);
+        __m128 const g = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(in.y.data() + i), zero), hi);
+        __m128 const b = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(in.z.data() + i), zero), hi);
+
+        __m128 const maxComponent = _mm_max_ps(_mm_max_ps(r, g), b);
+
+        // The components are not negative, so the shift leaves only the exponent. SSE2 has no epi32 max, compare and select instead.
+        __m128i exponent = _mm_sub_epi32(_mm_srli_epi32(_mm_castps_si128(maxComponent), 23), _mm_set1_epi32(127 - 16));
+        exponent = _mm_and_si128(exponent, _mm_cmpgt_epi32(exponent, _mm_setzero_si128()));
+
+        __m128 scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_sub_epi32(_mm_set1_epi32(151), exponent), 23));
+
+        __m128i const overflow = _mm_cmpeq_epi32(_mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(maxComponent, scale), half)), _mm_set1_epi32(512));
+
+        exponent = _mm_sub_epi32(exponent, overflow);
+        scale = simd::select(_mm_castsi128_ps(overflow), _mm_mul_ps(scale, half), scale);
+
+        __m128i const rs = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(r, scale), half));
+        __m128i const gs = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(g, scale), half));
+        __m128i const bs = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(b, scale), half));
+
+        __m128i const packed = _mm_or_si128(_mm_or_si128(rs, _mm_slli_epi32(gs, 9)), _mm_or_si128(_mm_slli_epi32(bs, 18), _mm_slli_epi32(exponent, 27)));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out.data() + i), packed);
+    }
+
+    return count;
+}
+
+inline auto rgb9e5_decode_sse(std::span<uint32 const> in, batch::vector3_span out) -> size_t
+{
+    __m128i const mantissaMask = _mm_set1_epi32(0x1FF);
+
+    size_t const count = in.size() & ~size_t{ 3 };
+
+    for (size_t i = 0; i < count; i += 4)
+    {
+        __m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(in.data() + i));
+        __m128 const scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_srli_epi32(v, 27), _mm_set1_epi32(103)), 23));
+
+        _mm_storeu_ps(out.x.data() + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(v, mantissaMask)), scale));
+        _mm_storeu_ps(out.y.data() + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(v, 9), mantissaMask)), scale));
+        _mm_storeu_ps(out.z.data() + i, _mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(v, 18), mantissaMask)), scale));
+    }
+
+    return count;
+}
+
+/**
+* SIMD form of float_bits_to_small_float for inputs already clamped to the format's finite range.
+*/
+template <uint32 M>
+inline auto float_to_small_float_sse(__m128 value) -> __m128i
+{
+    constexpr int32 shift = 23 - M;
+
+    __m128i const bits = _mm_castps_si128(value);
+
+    __m128i const rebiased = _mm_sub_epi32(bits, _mm_set1_epi32((127 - 15) << 23));
+    __m128i const odd = _mm_and_si128(_mm_srli_epi32(rebiased, shift), _mm_set1_epi32(1));
+    __m128i const normal = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(rebiased, _mm_set1_epi32((1 << (shift - 1)) - 1)), odd), shift);
+
+    // Denormals are exact multiples of 2^(-14 - M), so scaling and rounding gives the mantissa directly.
+    __m128i const denormal = _mm_cvtps_epi32(_mm_mul_ps(value, _mm_set1_ps(static_cast<float32>(1u << (14 + M)))));
+    __m128i const isDenormal = _mm_cmplt_epi32(bits, _mm_set1_epi32(0x38800000));
+
+    return _mm_or_si128(_mm_and_si128(isDenormal, denormal), _mm_andnot_si128(isDenormal, normal));
+}
+
+/**
+* SIMD form of small_float_to_float_bits.
+*/
+template <uint32 M>
+inline auto small_float_to_float_sse(__m128i value) -> __m128
+{
+    constexpr int32 shift = 23 - M;
+
+    __m128i const exponentMask = _mm_set1_epi32(0x1F << 23);
+
+    __m128i bits = _mm_slli_epi32(value, shift);
+    __m128i const exponent = _mm_and_si128(bits, exponentMask);
+
+    bits = _mm_add_epi32(bits, _mm_set1_epi32((127 - 15) << 23));
+
+    __m128i const special = _mm_cmpeq_epi32(exponent, exponentMask);
+    __m128i const denormal = _mm_cmpeq_epi32(exponent, _mm_setzero_si128());
+
+    bits = _mm_add_epi32(bits, _mm_and_si128(special, _mm_set1_epi32((128 - 16) << 23)));
+    bits = _mm_add_epi32(bits, _mm_and_si128(denormal, _mm_set1_epi32(1 << 23)));
+
+    __m128 const result = _mm_castsi128_ps(bits);
+    __m128 const renormalized = _mm_sub_ps(result, _mm_castsi128_ps(_mm_set1_epi32(113 << 23)));
+
+    return simd::select(_mm_castsi128_ps(denormal), renormalized, result);
+}
+
+inline auto r11g11b10f_encode_sse(batch::vector3_view in, std::span<uint32> out) -> size_t
+{
+    __m128 const zero = _mm_setzero_ps();
+    __m128 const max11 = _mm_set1_ps(float11_max_v);
+    __m128 const max10 = _mm_set1_ps(float10_max_v);
+
+    size_t const count = in.size() & ~size_t{ 3 };
+
+    for (size_t i = 0; i < count; i += 4)
+    {
+        __m128i const r = float_to_small_float_sse<6>(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(in.x.data() + i), zero), max11));
+        __m128i const g = float_to_small_float_sse<6>(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(in.y.data() + i), zero), max11));
+        __m128i const b = float_to_small_float_sse<5>(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(in.z.data() + i), zero), max10));
+
+        __m128i const packed = _mm_or_si128(_mm_or_si128(r, _mm_slli_epi32(g, 11)), _mm_slli_epi32(b, 22));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out.data() + i), packed);
+    }
+
+    return count;
+}
+
+inline auto r11g11b10f_decode_sse(std::span<uint32 const> in, batch::vector3_span out) -> size_t
+{
+    __m128i const mask11 = _mm_set1_epi32(0x7FF);
+
+    size_t const count = in.size() & ~size_t{ 3 };
+
+    for (size_t i = 0; i < count; i += 4)
+    {
+        __m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(in.data() + i));
+
+        _mm_storeu_ps(out.x.data() + i, small_float_to_float_sse<6>(_mm_and_si128(v, mask11)));
+        _mm_storeu_ps(out.y.data() + i, small_float_to_float_sse<6>(_mm_and_si128(_mm_srli_epi32(v, 11), mask11)));
+        _mm_storeu_ps(out.z.data() + i, small_float_to_float_sse<5>(_mm_srli_epi32(v, 22)));
+    }
+
+    return count;
+}
+#endif
+}
+
+/**
+* @brief Uses F16C when the CPU has it.
+*/
+inline auto float_to_half(std::span<float32 const> in, std::span<uint16> out) -> void
+{
+    ASSERTION(out.size() >= in.size());
+
+    size_t done = 0;
+
+#if MATH_SIMD_SSE2
+    if (simd::cpu_supports_f16c())
+    {
+        done = detail::float_to_half_f16c(in, out);
+    }
+#endif
+
+    for (size_t i = done; i < in.size(); ++i)
+    {
+        out[i] = float_to_half(in[i]);
+    }
+}
+
+inline auto half_to_float(std::span<uint16 const> in, std::span<float32> out) -> void
+{
+    ASSERTION(out.size() >= in.size());
+
+    size_t done = 0;
+
+#if MATH_SIMD_SSE2
+    if (simd::cpu_supports_f16c())
+    {
+        done = detail::half_to_float_f16c(in, out);
+    }
+#endif
+
+    for (size_t i = done; i < in.size(); ++i)
+    {
+        out[i] = half_to_float(in[i]);
+    }
+}
+
+inline auto float_to_snorm8(std::span<float32 const> in, std::span<int8> out) -> void
+{
+    ASSERTION(out.size() >= in.size());
+
+    size_t done = 0;
+
+#if MATH_SIMD_SSE2
+    done = detail::float_to_norm8_sse(in, out.data(), true);
+#endif
+
+    for (size_t i = done; i < in.size(); ++i)
+    {
+        out[i] = float_to_snorm8(in[i]);
+    }
+}
+
+inline auto snorm8_to_float(std::span<int8 const> in, std::span<float32> out) -> void
+{
+    ASSERTION(out.size() >= in.size());
+
+    size_t done = 0;
+
+#if MATH_SIMD_SSE2
+    done = detail::norm8_to_float_sse(in.data(), out.first(in.size()), true);
+#endif
+
+    for (size_t i = done; i < in.size(); ++i)
+    {
+        out[i] = snorm8_to_float(in[i]);
+    }
+}
+
+inline auto float_to_snorm16(std::span<float32 const> in, std::span<int16> out) -> void
+{
+    ASSERTION(out.size() >= in.size());
+
+    size_t done = 0;
+
+#if MATH_SIMD_SSE2
+    done = detail::float_to_norm16_sse(in, out.data(), true);
+#endif
+
+    for (size_t i = done; i < in.size(); ++i)
+    {
+        out[i] = float_to_snorm16(in[i]);
+    }
+}
+
+inline auto snorm16_to_float(std::span<int16 const> in, std::span<float32> out) -> void
+{
+    ASSERTION(out.size() >= in.size());
+
+    size_t done = 0;
+
+#if MATH_SIMD_SSE2
+    done = detail::norm16_to_float_sse(in.data(), out.first(in.size()), true);
+#endif
+
+    for (size_t i = done; i < in.size(); ++i)
+    {
+        out[i] = snorm16_to_float(in[i]);
+    }
+}
+
+inline auto float_to_unorm8(std::span<float32 const> in, std::span<uint8> out) -> void
+{
+    ASSERTION(out.size() >= in.size());
+
+    size_t done = 0;
+
+#if MATH_SIMD_SSE2
+    done = detail::float_to_norm8_sse(in, out.data(), false);
+#endif
+
+    for (size_t i = done; i < in.size(); ++i)
+    {
+        out[i] = float_to_unorm8(in[i]);
+    }
+}
+
+inline auto unorm8_to_float(std::span<uint8 const> in, std::span<float32> out) -> void
+{
+    ASSERTION(out.size() >= in.size());
+
+    size_t done = 0;
+
+#if MATH_SIMD_SSE2
+    done = detail::norm8_to_float_sse(in.data(), out.first(in.size()), false);
+#endif
+
+    for (size_t i = done; i < in.size(); ++i)
+    {
+        out[i] = unorm8_to_float(in[i]);
+    }
+}
+
+inline auto float_to_unorm16(std::span<float32 const> in, std::span<uint16> out) -> void
+{
+    ASSERTION(out.size() >= in.size());
+
+    size_t done = 0;
+
+#if MATH_SIMD_SSE2
+    done = detail::float_to_norm16_sse(in, out.data(), false);
+#endif
+
+    for (size_t i = done; i < in.size(); ++i)
+    {
+        out[i] = float_to_unorm16(in[i]);
+    }
+}
+
+inline auto unorm16_to_float(std::span<uint16 const> in, std::span<float32> out) -> void
+{
+    ASSERTION(out.size() >= in.size());
+
+    size_t done = 0;
+
+#if MATH_SIMD_SSE2
+    done = detail::norm16_to_float_sse(in.data(), out.first(in.size()), false);
+#endif
+
+    for (size_t i = done; i < in.size(); ++i)
+    {
+        out[i] = unorm16_to_float(in[i]);
+    }
+}
+
+inline auto octahedral_encode(batch::vector3_view in, std::span<uint32> out) -> void
+{
+    ASSERTION(out.size() >= in.size());
+
+    size_t done = 0;
+
+#if MATH_SIMD_SSE2
+    done = detail::octahedral_encode_sse(in, out);
+#endif
+
+    for (size_t i = done; i < in.size(); ++i)
+    {
+        out[i] = octahedral_encode(vec3(in.x[i], in.y[i], in.z[i]));
+    }
+}
+
+inline auto octahedral_decode(std::span<uint32 const> in, batch::vector3_span out) -> void
+{
+    ASSERTION(out.size() >= in.size());
+
+    size_t done = 0;
+
+#if MATH_SIMD_SSE2
+    done = detail::octahedral_decode_sse(in, out);
+#endif
+
+    for (size_t i = done; i < in.size(); ++i)
+    {
+        vec3 const n = octahedral_decode(in[i]);
+
+        out.x[i] = n.x;
+        out.y[i] = n.y;
+        out.z[i] = n.z;
+    }
+}
+
+inline auto float_to_rgb9e5(batch::vector3_view in, std::span<uint32> out) -> void
+{
+    ASSERTION(out.size() >= in.size());
+
+    size_t done = 0;
+
+#if MATH_SIMD_SSE2
+    done = detail::rgb9e5_encode_sse(in, out);
+#endif
+
+    for (size_t i = done; i < in.size(); ++i)
+    {
+        out[i] = float_to_rgb9e5(vec3(in.x[i], in.y[i], in.z[i]));
+    }
+}
+
+inline auto rgb9e5_to_float(std::span<uint32 const> in, batch::vector3_span out) -> void
+{
+    ASSERTION(out.size() >= in.size());
+
+    size_t done = 0;
+
+#if MATH_SIMD_SSE2
+    done = detail::rgb9e5_decode_sse(in, out);
+#endif
+
+    for (size_t i = done; i < in.size(); ++i)
+    {
+        vec3 const rgb = rgb9e5_to_float(in[i]);
+
+        out.x[i] = rgb.x;
+        out.y[i] = rgb.y;
+        out.z[i] = rgb.z;
+    }
+}
+
+inline auto float_to_r11g11b10f(batch::vector3_view in, std::span<uint32> out) -> void
+{
+    ASSERTION(out.size() >= in.size());
+
+    size_t done = 0;
+
+#if MATH_SIMD_SSE2
+    done = detail::r11g11b10f_encode_sse(in, out);
+#endif
+
+    for (size_t i = done; i < in.size(); ++i)
+    {
+        out[i] = float_to_r11g11b10f(vec3(in.x[i], in.y[i], in.z[i]));
+    }
+}
+
+inline auto r11g11b10f_to_float(std::span<uint32 const> in, batch::vector3_span out) -> void
+{
+    ASSERTION(out.size() >= in.size());
+
+    size_t done = 0;
+
+#if MATH_SIMD_SSE2
+    done = detail::r11g11b10f_decode_sse(in, out);
+#endif
+
+    for (size_t i = done; i < in.size(); ++i)
+    {
+        vec3 const rgb = r11g11b10f_to_float(in[i]);
+
+        out.x[i] = rgb.x;
+        out.y[i] = rgb.y;
+        out.z[i] = rgb.z;
+    }
+}
+}
+}
+
+#endif // !MATH_LIBRARY_PACK_H
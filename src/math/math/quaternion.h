@@ -15,12 +15,6 @@ struct quaternion
         w(1), x(0), y(0), z(0)
     {}
 
-    constexpr ~quaternion()
-    {
-        x = y = z = 0;
-        w = 1;
-    }
-
     constexpr quaternion(vector3<T> const& v, T s) :
         w(s), x(v.x), y(v.y), z(v.z)
     {}
@@ -33,41 +27,6 @@ struct quaternion
         w(w), x(x), y(y), z(z)
     {}
 
-    constexpr quaternion(quaternion const& q)
-    {
-        *this = q;
-    }
-
-    constexpr quaternion(quaternion&& q)
-    {
-        *this = std::move(q);
-    }
-
-    constexpr quaternion& operator=(quaternion const& q)
-    {
-        if (this != &q)
-        {
-            w = q.w;
-            x = q.x;
-            y = q.y;
-            z = q.z;
-        }
-        return *this;
-    }
-
-    constexpr quaternion& operator=(quaternion&& q)
-    {
-        if (this != &q)
-        {
-            w = q.w;
-            x = q.x;
-            y = q.y;
-            z = q.z;
-            new (&q) quaternion();
-        }
-        return *this;
-    }
-
     constexpr quaternion& operator+= (quaternion const& q)
     {
         *this = *this + q;
@@ -290,6 +249,9 @@ constexpr T dot(quaternion<T> const& a, quaternion<T> const& b)
 using quat  = quaternion<float32>;
 using dquat = quaternion<float64>;
 
+static_assert(is_trivially_copyable_layout<quat> && sizeof(quat) == 4 * sizeof(float32));
+static_assert(is_trivially_copyable_layout<dquat>);
+
 }
 
 #endif // !MATH_LIBRARY_QUATERNION_H
@@ -0,0 +1,703 @@
+#pragma once
+#ifndef MATH_LIBRARY_SIMD_H
+#define MATH_LIBRARY_SIMD_H
+
+#include <limits>
+#include "common.h"
+
+/**
+* SSE2 is part of x64 so the float32 kernels are always available there. SSE4.1, AVX2 and FMA paths are used when the compiler targets them, see MATH_ENABLE_AVX2.
+* Kernels that dispatch at runtime compile their AVX2 or F16C variant with MATH_SIMD_TARGET_AVX2 or MATH_SIMD_TARGET_F16C instead and check cpu_supports_avx2() or cpu_supports_f16c() before calling it.
+*/
+#if defined(_M_X64) || defined(_M_AMD64) || defined(__SSE2__)
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#define MATH_SIMD_SSE2 1
+#else
+#define MATH_SIMD_SSE2 0
+#endif
+
+#if defined(__AVX2__)
+#define MATH_SIMD_AVX2 1
+#else
+#define MATH_SIMD_AVX2 0
+#endif
+
+#if defined(__SSE4_1__) || defined(__AVX__)
+#define MATH_SIMD_SSE41 1
+#else
+#define MATH_SIMD_SSE41 0
+#endif
+
+#if defined(__FMA__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define MATH_SIMD_FMA 1
+#else
+#define MATH_SIMD_FMA 0
+#endif
+
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define MATH_SIMD_F16C 1
+#else
+#define MATH_SIMD_F16C 0
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define MATH_SIMD_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define MATH_SIMD_TARGET_F16C __attribute__((target("avx,f16c")))
+#else
+#define MATH_SIMD_TARGET_AVX2
+#define MATH_SIMD_TARGET_F16C
+#endif
+
+#if MATH_SIMD_SSE2
+namespace math
+{
+/**
+* float32 kernels behind the matrix and vector functions. Matrices are passed as pointers to their 16 elements, laid out column after column the way matrix4x4 stores them.
+*/
+namespace simd
+{
+#define MATH_SIMD_SHUFFLE_MASK(x, y, z, w) ((x) | ((y) << 2) | ((z) << 4) | ((w) << 6))
+
+/**
+* @return True when the CPU and the OS support AVX2 and FMA. Always true when the compiler already targets both.
+*/
+inline auto cpu_supports_avx2() -> bool
+{
+#if MATH_SIMD_AVX2 && MATH_SIMD_FMA
+    return true;
+#elif defined(__GNUC__) || defined(__clang__)
+    static bool const supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return supported;
+#elif defined(_MSC_VER)
+    static bool const supported = []() -> bool
+    {
+        int info[4];
+
+        __cpuid(info, 0);
+
+        if (info[0] < 7)
+        {
+            return false;
+        }
+
+        __cpuid(info, 1);
+
+        bool const fma = (info[2] & (1 << 12)) != 0;
+        bool const osxsave = (info[2] & (1 << 27)) != 0;
+
+        // The OS has to save the upper halves of the ymm registers.
+        if (!fma || !osxsave || (_xgetbv(0) & 0x6) != 0x6)
+        {
+            return false;
+        }
+
+        __cpuidex(info, 7, 0);
+
+        return (info[1] & (1 << 5)) != 0;
+    }();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+/**
+* @return True when the CPU and the OS support AVX and the F16C half precision conversions.
+*/
+inline auto cpu_supports_f16c() -> bool
+{
+#if MATH_SIMD_F16C
+    return true;
+#elif defined(__GNUC__) || defined(__clang__)
+    static bool const supported = __builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c");
+    return supported;
+#elif defined(_MSC_VER)
+    static bool const supported = []() -> bool
+    {
+        int info[4];
+
+        __cpuid(info, 1);
+
+        bool const f16c = (info[2] & (1 << 29)) != 0;
+        bool const avx = (info[2] & (1 << 28)) != 0;
+        bool const osxsave = (info[2] & (1 << 27)) != 0;
+
+        return f16c && avx && osxsave && (_xgetbv(0) & 0x6) == 0x6;
+    }();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+template <int x, int y, int z, int w>
+inline auto swizzle(__m128 v) -> __m128
+{
+    return _mm_castsi128_ps(_mm_shuffle_epi32(_mm_castps_si128(v), MATH_SIMD_SHUFFLE_MASK(x, y, z, w)));
+}
+
+template <int i>
+inline auto splat(__m128 v) -> __m128
+{
+    return swizzle<i, i, i, i>(v);
+}
+
+template <int x, int y, int z, int w>
+inline auto shuffle(__m128 a, __m128 b) -> __m128
+{
+    return _mm_shuffle_ps(a, b, MATH_SIMD_SHUFFLE_MASK(x, y, z, w));
+}
+
+/**
+* a * b + c
+*/
+inline auto madd(__m128 a, __m128 b, __m128 c) -> __m128
+{
+#if MATH_SIMD_FMA
+    return _mm_fmadd_ps(a, b, c);
+#else
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+}
+
+/**
+* Lanes of a where mask is set, lanes of b everywhere else.
+*/
+inline auto select(__m128 mask, __m128 a, __m128 b) -> __m128
+{
+#if MATH_SIMD_SSE41
+    return _mm_blendv_ps(b, a, mask);
+#else
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+#endif
+}
+
+#if MATH_SIMD_AVX2
+inline auto madd(__m256 a, __m256 b, __m256 c) -> __m256
+{
+#if MATH_SIMD_FMA
+    return _mm256_fmadd_ps(a, b, c);
+#else
+    return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+}
+#endif
+
+inline auto load3(float32 const* v) -> __m128
+{
+    return _mm_setr_ps(v[0], v[1], v[2], 0.f);
+}
+
+inline auto store3(float32* out, __m128 v) -> void
+{
+    _mm_storel_pi(reinterpret_cast<__m64*>(out), v);
+    _mm_store_ss(out + 2, _mm_movehl_ps(v, v));
+}
+
+/**
+* Dot product of the xyz components, broadcast to every lane.
+*/
+inline auto dot3(__m128 a, __m128 b) -> __m128
+{
+#if MATH_SIMD_SSE41
+    return _mm_dp_ps(a, b, 0x7F);
+#else
+    __m128 const m = _mm_mul_ps(a, b);
+    return _mm_add_ps(_mm_add_ps(splat<0>(m), splat<1>(m)), splat<2>(m));
+#endif
+}
+
+/**
+* Cross product of the xyz components, w is zero if it was in either input.
+*/
+inline auto cross3(__m128 a, __m128 b) -> __m128
+{
+    __m128 const c = _mm_sub_ps(_mm_mul_ps(a, swizzle<1, 2, 0, 3>(b)), _mm_mul_ps(swizzle<1, 2, 0, 3>(a), b));
+    return swizzle<1, 2, 0, 3>(c);
+}
+
+inline auto normalize3(__m128 v) -> __m128
+{
+    return _mm_div_ps(v, _mm_sqrt_ps(dot3(v, v)));
+}
+
+/**
+* c0 * v.x + c1 * v.y + c2 * v.z + c3 * v.w
+*/
+inline auto combine(__m128 v, __m128 c0, __m128 c1, __m128 c2, __m128 c3) -> __m128
+{
+    __m128 r = _mm_mul_ps(c0, splat<0>(v));
+    r = madd(c1, splat<1>(v), r);
+    r = madd(c2, splat<2>(v), r);
+    return madd(c3, splat<3>(v), r);
+}
+
+/**
+* out = l * r. Every column of the result is a combination of the columns of "l" weighted by the matching column of "r".
+*/
+inline auto multiply(float32 const* l, float32 const* r, float32* out) -> void
+{
+#if MATH_SIMD_AVX2
+    // Two result columns per iteration, each 128 bit lane works on one column.
+    __m256 const c0 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(l));
+    __m256 const c1 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(l + 4));
+    __m256 const c2 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(l + 8));
+    __m256 const c3 = _mm256_broadcast_ps(reinterpret_cast<__m128 const*>(l + 12));
+
+    for (size_t i = 0; i < 16; i += 8)
+    {
+        __m256 const v = _mm256_loadu_ps(r + i);
+
+        __m256 res = _mm256_mul_ps(c0, _mm256_shuffle_ps(v, v, MATH_SIMD_SHUFFLE_MASK(0, 0, 0, 0)));
+        res = madd(c1, _mm256_shuffle_ps(v, v, MATH_SIMD_SHUFFLE_MASK(1, 1, 1, 1)), res);
+        res = madd(c2, _mm256_shuffle_ps(v, v, MATH_SIMD_SHUFFLE_MASK(2, 2, 2, 2)), res);
+        res = madd(c3, _mm256_shuffle_ps(v, v, MATH_SIMD_SHUFFLE_MASK(3, 3, 3, 3)), res);
+
+        _mm256_storeu_ps(out + i, res);
+    }
+#else
+    __m128 const c0 = _mm_loadu_ps(l);
+    __m128 const c1 = _mm_loadu_ps(l + 4);
+    __m128 const c2 = _mm_loadu_ps(l + 8);
+    __m128 const c3 = _mm_loadu_ps(l + 12);
+
+    // Every column of "r" is read before it is written in case "out" aliases it.
+    __m128 const r0 = _mm_loadu_ps(r);
+    __m128 const r1 = _mm_loadu_ps(r + 4);
+    __m128 const r2 = _mm_loadu_ps(r + 8);
+    __m128 const r3 = _mm_loadu_ps(r + 12);
+
+    _mm_storeu_ps(out, combine(r0, c0, c1, c2, c3));
+    _mm_storeu_ps(out + 4, combine(r1, c0, c1, c2, c3));
+    _mm_storeu_ps(out + 8, combine(r2, c0, c1, c2, c3));
+    _mm_storeu_ps(out + 12, combine(r3, c0, c1, c2, c3));
+#endif
+}
+
+inline auto transform4(float32 const* m, float32 const* v, float32* out) -> void
+{
+    __m128 const res = combine(_mm_loadu_ps(v), _mm_loadu_ps(m), _mm_loadu_ps(m + 4), _mm_loadu_ps(m + 8), _mm_loadu_ps(m + 12));
+    _mm_storeu_ps(out, res);
+}
+
+/**
+* Transforms a direction by the upper 3x3 block, the translation is ignored.
+*/
+inline auto transform3(float32 const* m, float32 const* v, float32* out) -> void
+{
+    __m128 const p = load3(v);
+
+    __m128 res = _mm_mul_ps(_mm_loadu_ps(m), splat<0>(p));
+    res = madd(_mm_loadu_ps(m + 4), splat<1>(p), res);
+    res = madd(_mm_loadu_ps(m + 8), splat<2>(p), res);
+
+    store3(out, res);
+}
+
+inline auto transpose(float32 const* m, float32* out) -> void
+{
+    __m128 c0 = _mm_loadu_ps(m);
+    __m128 c1 = _mm_loadu_ps(m + 4);
+    __m128 c2 = _mm_loadu_ps(m + 8);
+    __m128 c3 = _mm_loadu_ps(m + 12);
+
+    _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+
+    _mm_storeu_ps(out, c0);
+    _mm_storeu_ps(out + 4, c1);
+    _mm_storeu_ps(out + 8, c2);
+    _mm_storeu_ps(out + 12, c3);
+}
+
+/**
+* 2x2 block helpers for the general inverse. A 2x2 block is stored as (a, b, c, d) for | a b |
+*                                                                                      | c d |
+*/
+inline auto block_multiply(__m128 a, __m128 b) -> __m128
+{
+    return _mm_add_ps(_mm_mul_ps(a, swizzle<0, 3, 0, 3>(b)), _mm_mul_ps(swizzle<1, 0, 3, 2>(a), swizzle<2, 1, 2, 1>(b)));
+}
+
+/**
+* adjugate(a) * b
+*/
+inline auto block_adjugate_multiply(__m128 a, __m128 b) -> __m128
+{
+    return _mm_sub_ps(_mm_mul_ps(swizzle<3, 3, 0, 0>(a), b), _mm_mul_ps(swizzle<1, 1, 2, 2>(a), swizzle<2, 3, 0, 1>(b)));
+}
+
+/**
+* a * adjugate(b)
+*/
+inline auto block_multiply_adjugate(__m128 a, __m128 b) -> __m128
+{
+    return _mm_sub_ps(_mm_mul_ps(a, swizzle<3, 0, 3, 0>(b)), _mm_mul_ps(swizzle<1, 0, 3, 2>(a), swizzle<2, 1, 2, 1>(b)));
+}
+
+/**
+* Inverse through the 2x2 block decomposition of the matrix. Returns the determinant, "out" is not written to when it is zero.
+* Works on the transpose just the same, the inverse of a transpose is the transpose of the inverse.
+*/
+inline auto inverse(float32 const* m, float32* out) -> float32
+{
+    __m128 const c0 = _mm_loadu_ps(m);
+    __m128 const c1 = _mm_loadu_ps(m + 4);
+    __m128 const c2 = _mm_loadu_ps(m + 8);
+    __m128 const c3 = _mm_loadu_ps(m + 12);
+
+    __m128 const a = _mm_movelh_ps(c0, c1);
+    __m128 const b = _mm_movehl_ps(c1, c0);
+    __m128 const c = _mm_movelh_ps(c2, c3);
+    __m128 const d = _mm_movehl_ps(c3, c2);
+
+    // (|a|, |b|, |c|, |d|)
+    __m128 const blockDeterminants = _mm_sub_ps(
+        _mm_mul_ps(shuffle<0, 2, 0, 2>(c0, c2), shuffle<1, 3, 1, 3>(c1, c3)),
+        _mm_mul_ps(shuffle<1, 3, 1, 3>(c0, c2), shuffle<0, 2, 0, 2>(c1, c3))
+    );
+
+    __m128 const detA = splat<0>(blockDeterminants);
+    __m128 const detB = splat<1>(blockDeterminants);
+    __m128 const detC = splat<2>(blockDeterminants);
+    __m128 const detD = splat<3>(blockDeterminants);
+
+    __m128 const dc = block_adjugate_multiply(d, c);
+    __m128 const ab = block_adjugate_multiply(a, b);
+
+    __m128 x = _mm_sub_ps(_mm_mul_ps(detD, a), block_multiply(b, dc));
+    __m128 w = _mm_sub_ps(_mm_mul_ps(detA, d), block_multiply(c, ab));
+    __m128 y = _mm_sub_ps(_mm_mul_ps(detB, c), block_multiply_adjugate(d, ab));
+    __m128 z = _mm_sub_ps(_mm_mul_ps(detC, b), block_multiply_adjugate(a, dc));
+
+    // |m| = |a||d| + |b||c| - tr(adj(a)b adj(d)c)
+    __m128 trace = _mm_mul_ps(ab, swizzle<0, 2, 1, 3>(dc));
+    trace = _mm_add_ps(trace, swizzle<2, 3, 0, 1>(trace));
+    trace = _mm_add_ps(trace, swizzle<1, 0, 3, 2>(trace));
+
+    __m128 const determinant = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), trace);
+    float32 const result = _mm_cvtss_f32(determinant);
+
+    if (result == 0.f)
+    {
+        return result;
+    }
+
+    __m128 const reciprocal = _mm_div_ps(_mm_setr_ps(1.f, -1.f, -1.f, 1.f), determinant);
+
+    x = _mm_mul_ps(x, reciprocal);
+    y = _mm_mul_ps(y, reciprocal);
+    z = _mm_mul_ps(z, reciprocal);
+    w = _mm_mul_ps(w, reciprocal);
+
+    // Applies the adjugate of each block while putting the blocks back together.
+    _mm_storeu_ps(out, shuffle<3, 1, 3, 1>(x, y));
+    _mm_storeu_ps(out + 4, shuffle<2, 0, 2, 0>(x, y));
+    _mm_storeu_ps(out + 8, shuffle<3, 1, 3, 1>(z, w));
+    _mm_storeu_ps(out + 12, shuffle<2, 0, 2, 0>(z, w));
+
+    return result;
+}
+
+/**
+* Inverse of a matrix whose last row is (0, 0, 0, 1). The rows of the inverted 3x3 block are the cross products of its columns over the determinant.
+*/
+inline auto inverse_affine(float32 const* m, float32* out) -> void
+{
+    __m128 const c0 = _mm_and_ps(_mm_loadu_ps(m), _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0)));
+    __m128 const c1 = _mm_and_ps(_mm_loadu_ps(m + 4), _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0)));
+    __m128 const c2 = _mm_and_ps(_mm_loadu_ps(m + 8), _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0)));
+    __m128 const t = _mm_loadu_ps(m + 12);
+
+    __m128 r0 = cross3(c1, c2);
+    __m128 r1 = cross3(c2, c0);
+    __m128 r2 = cross3(c0, c1);
+
+    __m128 const reciprocal = _mm_div_ps(_mm_set1_ps(1.f), dot3(c0, r0));
+
+    r0 = _mm_mul_ps(r0, reciprocal);
+    r1 = _mm_mul_ps(r1, reciprocal);
+    r2 = _mm_mul_ps(r2, reciprocal);
+
+    __m128 r3 = _mm_setr_ps(0.f, 0.f, 0.f, 1.f);
+
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+    // The new translation is -inverse(3x3) * t.
+    __m128 translation = _mm_mul_ps(r0, splat<0>(t));
+    translation = madd(r1, splat<1>(t), translation);
+    translation = madd(r2, splat<2>(t), translation);
+    translation = _mm_sub_ps(r3, translation);
+
+    _mm_storeu_ps(out, r0);
+    _mm_storeu_ps(out + 4, r1);
+    _mm_storeu_ps(out + 8, r2);
+    _mm_storeu_ps(out + 12, translation);
+}
+
+inline auto look_at_rh(float32 const* eye, float32 const* center, float32 const* up, float32* out) -> void
+{
+    __m128 const e = load3(eye);
+    __m128 const f = normalize3(_mm_sub_ps(load3(center), e));
+    __m128 const s = normalize3(cross3(f, load3(up)));
+    __m128 const u = cross3(s, f);
+
+    // The translation goes into the w lane of each basis vector so the transpose moves it into the last column.
+    __m128 r0 = _mm_sub_ps(s, _mm_and_ps(dot3(s, e), _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1))));
+    __m128 r1 = _mm_sub_ps(u, _mm_and_ps(dot3(u, e), _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1))));
+    __m128 r2 = _mm_sub_ps(_mm_and_ps(dot3(f, e), _mm_castsi128_ps(_mm_setr_epi32(0, 0, 0, -1))), f);
+    __m128 r3 = _mm_setr_ps(0.f, 0.f, 0.f, 1.f);
+
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+    _mm_storeu_ps(out, r0);
+    _mm_storeu_ps(out + 4, r1);
+    _mm_storeu_ps(out + 8, r2);
+    _mm_storeu_ps(out + 12, r3);
+}
+
+inline auto perspective_rh(float32 f, float32 aspect, float32 znear, float32 zfar, float32* out) -> void
+{
+    float32 const depth = 1.f / (zfar - znear);
+
+    _mm_storeu_ps(out, _mm_setr_ps(f / aspect, 0.f, 0.f, 0.f));
+    _mm_storeu_ps(out + 4, _mm_setr_ps(0.f, -f, 0.f, 0.f));
+    _mm_storeu_ps(out + 8, _mm_setr_ps(0.f, 0.f, zfar * depth, -1.f));
+    _mm_storeu_ps(out + 12, _mm_setr_ps(0.f, 0.f, -(zfar * znear) * depth, 0.f));
+}
+
+/**
+* 4 and 8 wide forms of math::approx, see common.h for their error bounds. The __m256 overloads are compiled for AVX2 and FMA and must only be called from code that checked cpu_supports_avx2().
+*/
+namespace approx
+{
+namespace constants = math::approx::detail;
+
+template <size_t N>
+inline auto polynomial(float32 const (&coefficients)[N], __m128 x) -> __m128
+{
+    __m128 result = _mm_set1_ps(coefficients[0]);
+
+    for (size_t i = 1; i < N; ++i)
+    {
+        result = madd(result, x, _mm_set1_ps(coefficients[i]));
+    }
+
+    return result;
+}
+
+inline auto sin_quadrant(__m128 x, int32 quadrant) -> __m128
+{
+    __m128 const magic = _mm_set1_ps(constants::round_magic_v);
+    __m128 const k = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(constants::two_over_pi_v)), magic), magic);
+    __m128i const q = _mm_add_epi32(_mm_cvttps_epi32(k), _mm_set1_epi32(quadrant));
+
+    __m128 r = _mm_sub_ps(x, _mm_mul_ps(k, _mm_set1_ps(constants::half_pi_a_v)));
+    r = _mm_sub_ps(r, _mm_mul_ps(k, _mm_set1_ps(constants::half_pi_b_v)));
+    r = _mm_sub_ps(r, _mm_mul_ps(k, _mm_set1_ps(constants::half_pi_c_v)));
+
+    __m128 const z = _mm_mul_ps(r, r);
+
+    __m128 const s = madd(_mm_mul_ps(polynomial(constants::sin_coefficients_v, z), z), r, r);
+    __m128 const c = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(_mm_mul_ps(polynomial(constants::cos_coefficients_v, z), z), z), _mm_mul_ps(_mm_set1_ps(0.5f), z)), _mm_set1_ps(1.f));
+
+    __m128 const odd = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+    __m128 const sign = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(q, _mm_set1_epi32(2)), 30));
+
+    return _mm_xor_ps(select(odd, c, s), sign);
+}
+
+inline auto sin(__m128 x) -> __m128
+{
+    return sin_quadrant(x, 0);
+}
+
+inline auto cos(__m128 x) -> __m128
+{
+    return sin_quadrant(x, 1);
+}
+
+inline auto atan2(__m128 y, __m128 x) -> __m128
+{
+    __m128 const signMask = _mm_set1_ps(-0.f);
+    __m128 const ax = _mm_andnot_ps(signMask, x);
+    __m128 const ay = _mm_andnot_ps(signMask, y);
+
+    __m128 const a = _mm_div_ps(_mm_min_ps(ax, ay), _mm_max_ps(_mm_max_ps(ax, ay), _mm_set1_ps(std::numeric_limits<float32>::min())));
+    __m128 const reduce = _mm_cmpgt_ps(a, _mm_set1_ps(constants::tan_eighth_pi_v));
+
+    __m128 const one = _mm_set1_ps(1.f);
+    __m128 const t = select(reduce, _mm_div_ps(_mm_sub_ps(a, one), _mm_add_ps(a, one)), a);
+    __m128 const z = _mm_mul_ps(t, t);
+
+    __m128 result = _mm_add_ps(madd(_mm_mul_ps(polynomial(constants::atan_coefficients_v, z), z), t, t), _mm_and_ps(reduce, _mm_set1_ps(constants::quarter_pi_v)));
+
+    result = select(_mm_cmpgt_ps(ay, ax), _mm_sub_ps(_mm_set1_ps(constants::half_pi_v), result), result);
+    result = select(_mm_cmplt_ps(x, _mm_setzero_ps()), _mm_sub_ps(_mm_set1_ps(constants::pi_v), result), result);
+
+    return _mm_xor_ps(result, _mm_and_ps(y, signMask));
+}
+
+inline auto exp2(__m128 x) -> __m128
+{
+    x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(-126.f)), _mm_set1_ps(127.f));
+
+    __m128 const magic = _mm_set1_ps(constants::round_magic_v);
+    __m128 const n = _mm_sub_ps(_mm_add_ps(x, magic), magic);
+    __m128 const f = _mm_sub_ps(x, n);
+
+    __m128 const p = madd(polynomial(constants::exp2_coefficients_v, f), f, _mm_set1_ps(1.f));
+    __m128 const scale = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(n), _mm_set1_epi32(127)), 23));
+
+    return _mm_mul_ps(p, scale);
+}
+
+inline auto log2(__m128 x) -> __m128
+{
+    __m128i const bits = _mm_castps_si128(x);
+    __m128 const one = _mm_set1_ps(1.f);
+
+    __m128 e = _mm_cvtepi32_ps(_mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127)));
+    __m128 m = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)), _mm_set1_epi32(0x3F800000)));
+
+    __m128 const big = _mm_cmpgt_ps(m, _mm_set1_ps(constants::sqrt_two_v));
+    m = select(big, _mm_mul_ps(m, _mm_set1_ps(0.5f)), m);
+    e = _mm_add_ps(e, _mm_and_ps(big, one));
+
+    __m128 const f = _mm_sub_ps(m, one);
+    __m128 const z = _mm_mul_ps(f, f);
+    __m128 const y = _mm_sub_ps(_mm_mul_ps(_mm_mul_ps(polynomial(constants::log_coefficients_v, f), f), z), _mm_mul_ps(_mm_set1_ps(0.5f), z));
+
+    __m128 const l = _mm_set1_ps(constants::log2e_minus_one_v);
+
+    return _mm_add_ps(_mm_add_ps(_mm_add_ps(madd(f, l, _mm_mul_ps(y, l)), y), f), e);
+}
+
+/**
+* rsqrtps is good to 12 bits, one Newton-Raphson step brings it close to full precision.
+*/
+inline auto rsqrt(__m128 x) -> __m128
+{
+    __m128 const y = _mm_rsqrt_ps(x);
+    __m128 const halfXYY = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), x), y), y);
+
+    return _mm_mul_ps(y, _mm_sub_ps(_mm_set1_ps(1.5f), halfXYY));
+}
+
+template <size_t N>
+MATH_SIMD_TARGET_AVX2 inline auto polynomial(float32 const (&coefficients)[N], __m256 x) -> __m256
+{
+    __m256 result = _mm256_set1_ps(coefficients[0]);
+
+    for (size_t i = 1; i < N; ++i)
+    {
+        result = _mm256_fmadd_ps(result, x, _mm256_set1_ps(coefficients[i]));
+    }
+
+    return result;
+}
+
+MATH_SIMD_TARGET_AVX2 inline auto sin_quadrant(__m256 x, int32 quadrant) -> __m256
+{
+    __m256 const magic = _mm256_set1_ps(constants::round_magic_v);
+    __m256 const k = _mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(constants::two_over_pi_v)), magic), magic);
+    __m256i const q = _mm256_add_epi32(_mm256_cvttps_epi32(k), _mm256_set1_epi32(quadrant));
+
+    __m256 r = _mm256_fnmadd_ps(k, _mm256_set1_ps(constants::half_pi_a_v), x);
+    r = _mm256_fnmadd_ps(k, _mm256_set1_ps(constants::half_pi_b_v), r);
+    r = _mm256_fnmadd_ps(k, _mm256_set1_ps(constants::half_pi_c_v), r);
+
+    __m256 const z = _mm256_mul_ps(r, r);
+
+    __m256 const s = _mm256_fmadd_ps(_mm256_mul_ps(polynomial(constants::sin_coefficients_v, z), z), r, r);
+    __m256 const c = _mm256_add_ps(_mm256_fnmadd_ps(_mm256_set1_ps(0.5f), z, _mm256_mul_ps(_mm256_mul_ps(polynomial(constants::cos_coefficients_v, z), z), z)), _mm256_set1_ps(1.f));
+
+    __m256 const odd = _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(q, _mm256_set1_epi32(1)), _mm256_set1_epi32(1)));
+    __m256 const sign = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(q, _mm256_set1_epi32(2)), 30));
+
+    return _mm256_xor_ps(_mm256_blendv_ps(s, c, odd), sign);
+}
+
+MATH_SIMD_TARGET_AVX2 inline auto sin(__m256 x) -> __m256
+{
+    return sin_quadrant(x, 0);
+}
+
+MATH_SIMD_TARGET_AVX2 inline auto cos(__m256 x) -> __m256
+{
+    return sin_quadrant(x, 1);
+}
+
+MATH_SIMD_TARGET_AVX2 inline auto atan2(__m256 y, __m256 x) -> __m256
+{
+    __m256 const signMask = _mm256_set1_ps(-0.f);
+    __m256 const ax = _mm256_andnot_ps(signMask, x);
+    __m256 const ay = _mm256_andnot_ps(signMask, y);
+
+    __m256 const a = _mm256_div_ps(_mm256_min_ps(ax, ay), _mm256_max_ps(_mm256_max_ps(ax, ay), _mm256_set1_ps(std::numeric_limits<float32>::min())));
+    __m256 const reduce = _mm256_cmp_ps(a, _mm256_set1_ps(constants::tan_eighth_pi_v), _CMP_GT_OQ);
+
+    __m256 const one = _mm256_set1_ps(1.f);
+    __m256 const t = _mm256_blendv_ps(a, _mm256_div_ps(_mm256_sub_ps(a, one), _mm256_add_ps(a, one)), reduce);
+    __m256 const z = _mm256_mul_ps(t, t);
+
+    __m256 result = _mm256_add_ps(_mm256_fmadd_ps(_mm256_mul_ps(polynomial(constants::atan_coefficients_v, z), z), t, t), _mm256_and_ps(reduce, _mm256_set1_ps(constants::quarter_pi_v)));
+
+    result = _mm256_blendv_ps(result, _mm256_sub_ps(_mm256_set1_ps(constants::half_pi_v), result), _mm256_cmp_ps(ay, ax, _CMP_GT_OQ));
+    result = _mm256_blendv_ps(result, _mm256_sub_ps(_mm256_set1_ps(constants::pi_v), result), _mm256_cmp_ps(x, _mm256_setzero_ps(), _CMP_LT_OQ));
+
+    return _mm256_xor_ps(result, _mm256_and_ps(y, signMask));
+}
+
+MATH_SIMD_TARGET_AVX2 inline auto exp2(__m256 x) -> __m256
+{
+    x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(-126.f)), _mm256_set1_ps(127.f));
+
+    __m256 const magic = _mm256_set1_ps(constants::round_magic_v);
+    __m256 const n = _mm256_sub_ps(_mm256_add_ps(x, magic), magic);
+    __m256 const f = _mm256_sub_ps(x, n);
+
+    __m256 const p = _mm256_fmadd_ps(polynomial(constants::exp2_coefficients_v, f), f, _mm256_set1_ps(1.f));
+    __m256 const scale = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(_mm256_cvttps_epi32(n), _mm256_set1_epi32(127)), 23));
+
+    return _mm256_mul_ps(p, scale);
+}
+
+MATH_SIMD_TARGET_AVX2 inline auto log2(__m256 x) -> __m256
+{
+    __m256i const bits = _mm256_castps_si256(x);
+    __m256 const one = _mm256_set1_ps(1.f);
+
+    __m256 e = _mm256_cvtepi32_ps(_mm256_sub_epi32(_mm256_srli_epi32(bits, 23), _mm256_set1_epi32(127)));
+    __m256 m = _mm256_castsi256_ps(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi32(0x007FFFFF)), _mm256_set1_epi32(0x3F800000)));
+
+    __m256 const big = _mm256_cmp_ps(m, _mm256_set1_ps(constants::sqrt_two_v), _CMP_GT_OQ);
+    m = _mm256_blendv_ps(m, _mm256_mul_ps(m, _mm256_set1_ps(0.5f)), big);
+    e = _mm256_add_ps(e, _mm256_and_ps(big, one));
+
+    __m256 const f = _mm256_sub_ps(m, one);
+    __m256 const z = _mm256_mul_ps(f, f);
+    __m256 const y = _mm256_fnmadd_ps(_mm256_set1_ps(0.5f), z, _mm256_mul_ps(_mm256_mul_ps(polynomial(constants::log_coefficients_v, f), f), z));
+
+    __m256 const l = _mm256_set1_ps(constants::log2e_minus_one_v);
+
+    return _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_fmadd_ps(f, l, _mm256_mul_ps(y, l)), y), f), e);
+}
+
+MATH_SIMD_TARGET_AVX2 inline auto rsqrt(__m256 x) -> __m256
+{
+    __m256 const y = _mm256_rsqrt_ps(x);
+    __m256 const halfXYY = _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(0.5f), x), y), y);
+
+    return _mm256_mul_ps(y, _mm256_sub_ps(_mm256_set1_ps(1.5f), halfXYY));
+}
+}
+
+#undef MATH_SIMD_SHUFFLE_MASK
+}
+}
+#endif // MATH_SIMD_SSE2
+
+#endif // !MATH_LIBRARY_SIMD_H
@@ -42,14 +42,6 @@ struct vector2
         x{ v.x }, y{ v.y }
     {}
 
-    constexpr ~vector2()
-    {
-        x = y = 0;
-    }
-
-    constexpr vector2(const vector2& vec) { *this = vec; }
-    constexpr vector2(vector2&& vec) { *this = std::move(vec); }
-
     constexpr T& operator[]	(size_t i)
     {
         ASSERTION(i < 2);
@@ -62,27 +54,6 @@ struct vector2
         return (&x)[i];
     }
 
-    constexpr vector2& operator= (const vector2& vec)
-    {
-        if (this != &vec)
-        {
-            x = vec.x;
-            y = vec.y;
-        }
-        return *this;
-    }
-
-    constexpr vector2& operator= (vector2&& vec)
-    {
-        if (this != &vec)
-        {
-            x = vec.x;
-            y = vec.y;
-            new (&vec) vector2{};
-        }
-        return *this;
-    }
-
     constexpr vector2 operator-()
     {
         return vector2{ -x, -y };
@@ -306,44 +277,6 @@ struct vector3
         x(v.x), y(v.y), z(v.z)
     {}
 
-    constexpr vector3(const vector3& v)
-    {
-        *this = v;
-    }
-
-    constexpr vector3(vector3&& v)
-    {
-        *this = std::move(v);
-    }
-
-    constexpr ~vector3()
-    {
-        x = y = z = 0;
-    }
-
-    constexpr vector3& operator= (const vector3& v)
-    {
-        if (this != &v)
-        {
-            x = v.x;
-            y = v.y;
-            z = v.z;
-        }
-        return *this;
-    }
-
-    constexpr vector3& operator= (vector3&& v)
-    {
-        if (this != &v)
-        {
-            x = v.x;
-            y = v.y;
-            z = v.z;
-            new (&v) vector3();
-        }
-        return *this;
-    }
-
     constexpr T& operator[] (size_t i)
     {
         ASSERTION(i < 3);
@@ -583,7 +516,7 @@ constexpr T dot(vector3<T> const& v)
 }
 
 template <is_arithmetic T>
-T dot(vector3<T> const& l, vector3<T> const& r)
+constexpr T dot(vector3<T> const& l, vector3<T> const& r)
 {
     return l.x * r.x + l.y * r.y + l.z * r.z;
 }
@@ -651,46 +584,6 @@ struct vector4
         x(v.x), y(v.y), z(v.z), w(0)
     {}
 
-    constexpr ~vector4()
-    {
-        x = y = z = w = 0;
-    }
-
-    constexpr vector4(const vector4& v)
-    {
-        *this = v;
-    }
-
-    constexpr vector4(vector4&& v)
-    {
-        *this = std::move(v);
-    }
-
-    constexpr vector4& operator= (const vector4& v)
-    {
-        if (this != &v)
-        {
-            x = v.x;
-            y = v.y;
-            z = v.z;
-            w = v.w;
-        }
-        return *this;
-    }
-
-    constexpr vector4& operator= (vector4&& v)
-    {
-        if (this != &v)
-        {
-            x = v.x;
-            y = v.y;
-            z = v.z;
-            w = v.w;
-            new (&v) vector4();
-        }
-        return *this;
-    }
-
     constexpr T& operator[] (size_t i)
     {
         ASSERTION(i < 4);
@@ -1044,6 +937,13 @@ using ivec4 = vector4<int32>;
 using uvec2 = vector2<uint32>;
 using uvec3 = vector3<uint32>;
 using uvec4 = vector4<uint32>;
+
+static_assert(is_trivially_copyable_layout<vec2> && sizeof(vec2) == 2 * sizeof(float32));
+static_assert(is_trivially_copyable_layout<vec3> && sizeof(vec3) == 3 * sizeof(float32));
+static_assert(is_trivially_copyable_layout<vec4> && sizeof(vec4) == 4 * sizeof(float32));
+static_assert(is_trivially_copyable_layout<dvec2> && is_trivially_copyable_layout<dvec3> && is_trivially_copyable_layout<dvec4>);
+static_assert(is_trivially_copyable_layout<ivec2> && is_trivially_copyable_layout<ivec3> && is_trivially_copyable_layout<ivec4>);
+static_assert(is_trivially_copyable_layout<uvec2> && is_trivially_copyable_layout<uvec3> && is_trivially_copyable_layout<uvec4>);
 }
 
 #endif // !MATH_LIBRARY_VECTOR_H
@@ -121,7 +121,10 @@ auto CommandQueue::new_command_recorder(RequestCommandRecorder&& info) -> gpu::C
 {
 	Queue& queue = get_queue(info.queue);
 
-	if (!queue.commandPoolStore.contains(info.tid))
+	// Pools are shared handles, so the copy handed out here stays valid when another thread's insert rehashes the store.
+	std::optional<gpu::CommandPool> commandPool = queue.commandPoolStore.find(info.tid);
+
+	if (!commandPool.has_value())
 	{
 		auto queue_type_name = [](gpu::DeviceQueue type) -> const char*
 		{
@@ -137,19 +140,17 @@ auto CommandQueue::new_command_recorder(RequestCommandRecorder&& info) -> gpu::C
 			}
 		};
 
-		auto commandPool = gpu::CommandPool::from(m_device, { .name = fmt::format("<cmdpool>:type={}, tid={}", queue_type_name(info.queue), info.tid), .queue = info.queue });
+		auto newCommandPool = gpu::CommandPool::from(m_device, { .name = fmt::format("<cmdpool>:type={}, tid={}", queue_type_name(info.queue), info.tid), .queue = info.queue });
 
-		if (!commandPool.valid())
+		if (!newCommandPool.valid())
 		{
 			return {};
 		}
 
-		queue.commandPoolStore.emplace(info.tid, std::move(commandPool));
+		commandPool = queue.commandPoolStore.find_or_emplace(info.tid, std::move(newCommandPool)).first;
 	}
 
-	auto& commandPool = queue.commandPoolStore[info.tid];
-
-	return gpu::CommandRecorder::from(commandPool);
+	return gpu::CommandRecorder::from(*commandPool);
 }
 
 auto CommandQueue::clear(gpu::DeviceQueue queue) -> void
@@ -60,7 +60,7 @@ auto MeshSbfPack::MeshPackIterator::to_mesh_sbf_view() const -> MeshSbfView
 
     MeshView const view = {
         .vertices   = std::span<float32>{ reinterpret_cast<float32*>(ptr), info.vertices.sizeBytes / sizeof(float32) },
-        .indices    = std::span<uint32>{ reinterpret_cast<uint32*>(ptr + info.vertices.sizeBytes), info.indices.count }
+        .indices    = std::span<std::byte>{ ptr + info.vertices.sizeBytes, info.indices.count * index_size_bytes(info.indexType) }
     };
 
     return MeshSbfView{ .metadata = info, .data = view };
@@ -92,8 +92,9 @@ auto MeshSbfPack::from_memory(std::span<std::byte> blob) -> bool
     size_t offset = {};
     auto const& sbfHeader = *reinterpret_cast<core::sbf::SbfFileHeader*>(&blob[offset]);
 
-    if (sbfHeader.magic != core::sbf::SBF_HEADER_TAG
-    /*|| should probably check the version sometime in the future.*/)
+    // Meshes written before the current MeshViewInfo layout can not be read.
+    if (sbfHeader.magic != core::sbf::SBF_HEADER_TAG ||
+        sbfHeader.version.major != SBF_VERSION_MAJOR)
     {
         return false;
     }
@@ -132,8 +133,8 @@ auto MeshSbfPack::from_mmap_file(core::sbf::File const& mmapFile) -> bool
 
 	auto const& sbfHeader = *reinterpret_cast<core::sbf::SbfFileHeader*>(ptr);
 
-	if (sbfHeader.magic != core::sbf::SBF_HEADER_TAG
-	/*|| should probably check the version sometime in the future.*/)
+	if (sbfHeader.magic != core::sbf::SBF_HEADER_TAG ||
+		sbfHeader.version.major != SBF_VERSION_MAJOR)
 	{
 		return false;
 	}
@@ -9,6 +9,7 @@
 
 #include "gpu/common.hpp"
 #include "lib/common.hpp"
+#include "lib/string_search.hpp"
 
 #include "pipeline_cache.hpp"
 
@@ -288,7 +289,7 @@ auto PipelineCache::cache_pipeline(RasterPipelineDefinition const& definition, s
         },
         {
             .name = std::string{ definition.info.name },
-            .colorAttachments = lib::array<gpu::ColorAttachment>(definition.info.colorAttachments.data(), definition.info.colorAttachments.data() + definition.info.numColorAttachments),
+            .colorAttachments = lib::small_array<gpu::ColorAttachment, 4>(definition.info.colorAttachments.data(), definition.info.colorAttachments.data() + definition.info.numColorAttachments),
             .depthAttachmentFormat = definition.info.depthAttachmentFormat,
 	        .stencilAttachmentFormat = definition.info.stencilAttachmentFormat,
             .rasterization = definition.info.rasterization,
@@ -301,15 +302,7 @@ auto PipelineCache::cache_pipeline(RasterPipelineDefinition const& definition, s
     if (pipeline.valid())
     {
         // Remove the old pipeline only when the new pipeline has been successfully created.
-        if (m_uriToPipeline.contains(definition.uri))
-        {
-            auto const it = m_uriToPipeline[definition.uri];
-            m_pipelines.erase(it);
-            //m_uriToPipeline.erase(definition.uri);    // I guess we don't have to delete the object, simply reassign it. Not sure...
-        }
-
-        auto it = m_pipelines.emplace(pipeline);
-        m_uriToPipeline[definition.uri] = it;
+        store_pipeline(definition.uri, pipeline);
     }
 
     return pipeline;
@@ -347,14 +340,7 @@ auto PipelineCache::cache_pipeline(ComputePipelineDefinition const& definition,
 
     if (pipeline.valid())
     {
-        if (m_uriToPipeline.contains(definition.uri))
-        {
-            auto const it = m_uriToPipeline[definition.uri];
-            m_pipelines.erase(it);
-        }
-
-        auto it = m_pipelines.emplace(pipeline);
-        m_uriToPipeline[definition.uri] = it;
+        store_pipeline(definition.uri, pipeline);
     }
 
     return pipeline;
@@ -362,28 +348,65 @@ auto PipelineCache::cache_pipeline(ComputePipelineDefinition const& definition,
 
 auto PipelineCache::remove_pipeline(std::string_view uri) -> void
 {
-    if (m_uriToPipeline.contains(uri))
+    remove_pipeline(lib::global_atom_table().find(uri));
+}
+
+auto PipelineCache::remove_pipeline(lib::atom uri) -> void
+{
+    if (auto const it = m_uriToPipeline.find(uri); it != m_uriToPipeline.end())
     {
-        auto const it = m_uriToPipeline[uri];
-        m_pipelines.erase(it);
-        m_uriToPipeline.erase(uri);
+        m_pipelines.erase(it->second);
+        m_uriToPipeline.erase(it);
     }
 };
 
 auto PipelineCache::get_pipeline(std::string_view uri) -> std::expected<gpu::Pipeline, std::string>
 {
-    if (!m_uriToPipeline.contains(uri))
+    if (auto const it = m_uriToPipeline.find(lib::global_atom_table().find(uri)); it != m_uriToPipeline.end())
+    {
+        return *it->second;
+    }
+    return std::unexpected{ fmt::format("Could not get pipeline with uri - {}", uri) };
+}
+
+auto PipelineCache::get_pipeline(lib::atom uri) -> std::expected<gpu::Pipeline, std::string>
+{
+    if (auto const it = m_uriToPipeline.find(uri); it != m_uriToPipeline.end())
     {
-        return std::unexpected{ fmt::format("Could not get pipeline with uri - {}", uri) };
+        return *it->second;
     }
-    return *m_uriToPipeline[uri];
+    return std::unexpected{ fmt::format("Could not get pipeline with uri - {}", lib::global_atom_table().str(uri)) };
 }
 
 auto PipelineCache::contains(std::string_view uri) -> bool
+{
+    return m_uriToPipeline.contains(lib::global_atom_table().find(uri));
+}
+
+auto PipelineCache::contains(lib::atom uri) -> bool
 {
     return m_uriToPipeline.contains(uri);
 }
 
+auto PipelineCache::store_pipeline(std::string_view uri, gpu::Pipeline pipeline) -> void
+{
+    // The atom table owns a copy of the URI, so the key stays valid after the definition is gone.
+    lib::atom const key = lib::intern(uri);
+
+    // Lookups of URIs that were never interned resolve to the null atom, it must not map to a pipeline.
+    if (!key.valid())
+    {
+        return;
+    }
+
+    if (auto const it = m_uriToPipeline.find(key); it != m_uriToPipeline.end())
+    {
+        m_pipelines.erase(it->second);
+    }
+
+    m_uriToPipeline[key] = m_pipelines.insert(std::move(pipeline));
+}
+
 auto PipelineCache::load_pipeline(RasterPipelineDefinition const& definition) -> void
 {
     std::filesystem::path vertexShaderPath  = m_configuration.cachePath / std::filesystem::path{ definition.shaderPaths.vertex }.stem().replace_extension(SHADER_EXTENSION_NAME[std::to_underlying(gpu::ShaderType::Vertex)]);
@@ -400,7 +423,7 @@ auto PipelineCache::load_pipeline(RasterPipelineDefinition const& definition) ->
         },
         {
             .name = std::string{ definition.info.name },
-            .colorAttachments = lib::array<gpu::ColorAttachment>(definition.info.colorAttachments.data(), definition.info.colorAttachments.data() + definition.info.numColorAttachments),
+            .colorAttachments = lib::small_array<gpu::ColorAttachment, 4>(definition.info.colorAttachments.data(), definition.info.colorAttachments.data() + definition.info.numColorAttachments),
             .depthAttachmentFormat = definition.info.depthAttachmentFormat,
 	        .stencilAttachmentFormat = definition.info.stencilAttachmentFormat,
             .rasterization = definition.info.rasterization,
@@ -412,8 +435,7 @@ auto PipelineCache::load_pipeline(RasterPipelineDefinition const& definition) ->
 
     if (pipeline.valid())
     {
-        auto it = m_pipelines.insert(std::move(pipeline));
-        m_uriToPipeline[definition.uri] = it;
+        store_pipeline(definition.uri, std::move(pipeline));
     }
 }
 
@@ -436,8 +458,7 @@ auto PipelineCache::load_pipeline(ComputePipelineDefinition const& definition) -
 
     if (pipeline.valid())
     {
-        auto it = m_pipelines.insert(std::move(pipeline));
-        m_uriToPipeline[definition.uri] = it;
+        store_pipeline(definition.uri, std::move(pipeline));
     }
 }
 
@@ -495,14 +516,16 @@ auto PipelineCache::compile_shader(std::string_view path, std::filesystem::path
             continue;
         }
 
-        if (token.find('=') == std::string_view::npos)
+        size_t const separator = lib::str::find(token, '=');
+
+        if (separator == lib::str::npos)
         {
             info.add_macro_definition(token);
         }
         else
         {
-            auto key = token.substr(0, token.find('='));
-            auto value = token.substr(token.find('=') + 1);
+            auto key = token.substr(0, separator);
+            auto value = token.substr(separator + 1);
 
             info.add_macro_definition(key, value);
         }
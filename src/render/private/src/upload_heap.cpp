@@ -72,6 +72,7 @@ auto UploadHeap::HeapPool::remaining_capacity() const -> size_t
 }
 
 UploadHeap::UploadHeap(gpu::Device& device, CommandQueue& commandQueue) :
+	m_memoryTracker{ "render::UploadHeap" },
 	m_heapPoolQueue{},
 	m_imageUploadInfo{},
 	m_bufferUploadInfo{},
@@ -83,11 +84,27 @@ UploadHeap::UploadHeap(gpu::Device& device, CommandQueue& commandQueue) :
 	m_nextPool{}
 {}
 
+UploadHeap::~UploadHeap()
+{
+	for (HeapPool const& heapPool : m_heapPoolQueue)
+	{
+		for (size_t i = 0; i < heapPool.heaps.size(); ++i)
+		{
+			m_memoryTracker.record_deallocation(HEAP_BLOCK_SIZE);
+		}
+	}
+}
+
 auto UploadHeap::device() const -> gpu::Device&
 {
 	return m_device;
 }
 
+auto UploadHeap::memory_tracker() const -> lib::tracking_memory_resource const&
+{
+	return m_memoryTracker;
+}
+
 auto UploadHeap::request_heaps(size_t size) -> std::span<HeapBlock>
 {
 	HeapPool& heapPool = next_heap_pool();
@@ -369,6 +386,8 @@ auto UploadHeap::allocate_heap(size_t count) -> void
 			.sharingMode = gpu::SharingMode::Exclusive
 		};
 		heapPool.heaps.emplace_back(gpu::Buffer::from(m_device, std::move(heapBlockInfo)));
+
+		m_memoryTracker.record_allocation(HEAP_BLOCK_SIZE);
 	}
 }
 
@@ -3,7 +3,7 @@
 #define RENDER_COMMAND_QUEUE_HPP
 
 #include <thread>
-#include "lib/map.hpp"
+#include "lib/concurrent_map.hpp"
 #include "gpu/gpu.hpp"
 
 namespace render
@@ -41,7 +41,7 @@ struct Queue
 	SemaphoreBuffer	submittedSemaphores;
 	CommandRecorderBuffer submittedCommands;
 	SubmissionDataBuffer submissionGroupData;
-	lib::map<std::thread::id, gpu::CommandPool> commandPoolStore;
+	lib::concurrent_map<std::thread::id, gpu::CommandPool> commandPoolStore;
 	uint32 numSubmissionGroups;
 };
 
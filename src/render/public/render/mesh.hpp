@@ -31,6 +31,20 @@ enum class Topology
 	Triangle_Fan
 };
 
+/**
+* @brief Compact encodings that can be applied to vertex attributes when a mesh is cooked into an sbf file.
+* Attributes that do not have their encoding bit set are stored as 32-bit floats, as described by AttribInfo.
+*/
+enum class VertexEncoding : uint8
+{
+	None				= 0,
+	Position_Unorm16	= 0x01,	// xyz quantized to 16 bits relative to the mesh's bounds and padded to 4 components.
+	Normal_Oct16		= 0x02,	// Octahedral encoded into 2 snorm16 components.
+	Tangent_Oct16		= 0x04,	// Octahedral encoded into 2 snorm16 components. The LSB of the 2nd component stores the bitangent's sign.
+	TexCoord_Half		= 0x08,	// 2 float16 components.
+	TexCoord_Unorm16	= 0x10	// 2 unorm16 components. Coordinates are clamped to [0, 1].
+};
+
 template <VertexAttribute>
 struct AttribInfo
 {
@@ -59,9 +73,56 @@ struct AttribInfo<VertexAttribute::All>
 	static constexpr uint32 componentSizeBytes = componentCount * sizeof(float32);
 };
 
+/**
+* @brief Size in bytes of a single vertex's attribute after the encoding has been applied.
+*/
+constexpr auto attribute_size_bytes(VertexAttribute attribute, VertexEncoding encoding) -> uint32
+{
+	auto const encoded = [encoding](VertexEncoding e) -> bool { return (encoding & e) != VertexEncoding::None; };
+
+	switch (attribute)
+	{
+	case VertexAttribute::Position:
+		return encoded(VertexEncoding::Position_Unorm16) ? 4u * sizeof(uint16) : AttribInfo<VertexAttribute::Position>::componentSizeBytes;
+	case VertexAttribute::Normal:
+		return encoded(VertexEncoding::Normal_Oct16) ? 2u * sizeof(int16) : AttribInfo<VertexAttribute::Normal>::componentSizeBytes;
+	case VertexAttribute::Tangent:
+		return encoded(VertexEncoding::Tangent_Oct16) ? 2u * sizeof(int16) : AttribInfo<VertexAttribute::Tangent>::componentSizeBytes;
+	case VertexAttribute::Color:
+		return AttribInfo<VertexAttribute::Color>::componentSizeBytes;
+	case VertexAttribute::TexCoord:
+		return encoded(VertexEncoding::TexCoord_Half | VertexEncoding::TexCoord_Unorm16) ? 2u * sizeof(uint16) : AttribInfo<VertexAttribute::TexCoord>::componentSizeBytes;
+	default:
+		return 0u;
+	}
+}
+
+/**
+* @brief Size in bytes of a single index.
+*/
+constexpr auto index_size_bytes(gpu::IndexType indexType) -> uint32
+{
+	switch (indexType)
+	{
+	case gpu::IndexType::Uint_8:
+		return sizeof(uint8);
+	case gpu::IndexType::Uint_16:
+		return sizeof(uint16);
+	case gpu::IndexType::Uint_32:
+	default:
+		return sizeof(uint32);
+	}
+}
+
 inline static constexpr uint32 SBF_MESH_VIEW_GROUP_HEADER_TAG	= 'GHSM';	// MSHG - Mesh Group
 inline static constexpr uint32 SBF_MESH_VIEW_HEADER_TAG			= 'HSEM';	// MESH - Mesh
 
+struct MeshBounds
+{
+	float32 min[3];
+	float32 max[3];
+};
+
 struct MeshViewInfo
 {
 	struct MeshViewDataInfo
@@ -73,6 +134,15 @@ struct MeshViewInfo
 	MeshViewDataInfo indices;
 	VertexAttribute attributes;
 	Topology topology;
+	VertexEncoding encoding;
+	/**
+	* @brief Type of the indices. Index data is padded to a multiple of 4 bytes so vertex data that follows stays aligned.
+	*/
+	gpu::IndexType indexType;
+	/**
+	* @brief Axis aligned bounds of the mesh's positions. Required to dequantize Position_Unorm16 encoded positions.
+	*/
+	MeshBounds bounds;
 };
 
 struct SbfMeshViewGroupHeader
@@ -92,8 +162,8 @@ struct SbfMeshViewHeader
 */
 struct MeshView
 {
-	std::span<float32>	vertices;
-	std::span<uint32>	indices;
+	std::span<float32>		vertices;
+	std::span<std::byte>	indices;	// Elements are of MeshViewInfo::indexType.
 };
 
 struct MeshSbfView
@@ -137,6 +207,9 @@ struct Mesh
 	gpu::device_address uv;
 	VertexAttribute attributes;
 	Topology topology;
+	VertexEncoding encoding;
+	gpu::IndexType indexType;
+	MeshBounds bounds;
 };
 
 class MeshSbfPack : public lib::non_copyable_non_movable
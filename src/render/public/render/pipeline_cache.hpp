@@ -4,6 +4,8 @@
 
 #include <filesystem>
 
+#include "lib/atom.hpp"
+
 #include "gpu/gpu.hpp"
 #include "gpu/shader_compiler.hpp"
 
@@ -82,15 +84,21 @@ public:
     */
     auto cache_pipeline(ComputePipelineDefinition const& definition, PipelineShaderCompileInfo const& compileInfo) -> std::expected<gpu::Pipeline, std::string>;
 
+    /*
+    * Pipelines are keyed by the atom of their URI in lib::global_atom_table(). Looking up by atom is an integer compare, prefer it for lookups done every frame.
+    */
     auto remove_pipeline(std::string_view uri) -> void;
+    auto remove_pipeline(lib::atom uri) -> void;
 
     auto get_pipeline(std::string_view uri) -> std::expected<gpu::Pipeline, std::string>;
+    auto get_pipeline(lib::atom uri) -> std::expected<gpu::Pipeline, std::string>;
     auto contains(std::string_view uri) -> bool;
+    auto contains(lib::atom uri) -> bool;
 
 private:
     PipelineCache(gpu::Device& device, PipelineCacheInfo const& info);
 
-    using UriToPipelineMap = ankerl::unordered_dense::map<std::string_view, plf::colony<gpu::Pipeline>::iterator>;
+    using UriToPipelineMap = ankerl::unordered_dense::map<lib::atom, plf::colony<gpu::Pipeline>::iterator, lib::hash<lib::atom>>;
 
     gpu::Device& m_device;
     PipelineCacheInfo m_configuration;
@@ -98,6 +106,7 @@ private:
     plf::colony<gpu::Pipeline> m_pipelines;
     UriToPipelineMap m_uriToPipeline;
 
+    auto store_pipeline(std::string_view uri, gpu::Pipeline pipeline) -> void;
     auto load_pipeline(RasterPipelineDefinition const& definition) -> void;
     auto load_pipeline(ComputePipelineDefinition const& definition) -> void;
     auto try_compile_shader(std::filesystem::path const& path, PipelineShaderCompileInfo const& compileInfo) -> std::expected<gpu::Shader, std::string>;
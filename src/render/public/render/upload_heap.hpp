@@ -3,6 +3,7 @@
 #define RENDER_UPLOAD_HEAP_HPP
 
 #include "lib/handle.hpp"
+#include "lib/tracking_memory_resource.hpp"
 #include "command_queue.hpp"
 
 namespace render
@@ -77,10 +78,14 @@ public:
 	static constexpr size_t HEAP_POOL_MAX_SIZE = 64_MiB;
 
 	UploadHeap(gpu::Device& device, CommandQueue& commandQueue);
-	~UploadHeap() = default;
+	~UploadHeap();
 
 	[[nodiscard]] auto device() const -> gpu::Device&;
 	/**
+	* @brief Accounts for the staging buffers of every heap pool.
+	*/
+	[[nodiscard]] auto memory_tracker() const -> lib::tracking_memory_resource const&;
+	/**
 	* @brief Retrieves HeapBlocks with spaces from the current active heap pool.
 	* 
 	* If <size> is larger than 64 MiBs, an empty span is returned instead. Consider breaking the data into smaller chunks and upload in a separate frame.
@@ -144,6 +149,7 @@ private:
 	using ImageUploadInfoQueue	= std::array<InfoPool<ImageUploadInfo>, MAX_POOL_IN_QUEUE>;
 	using BufferUploadInfoQueue = std::array<InfoPool<BufferUploadInfo>, MAX_POOL_IN_QUEUE>;
 	
+	lib::tracking_memory_resource m_memoryTracker;
 	mutable HeapPoolQueue m_heapPoolQueue;
 	mutable ImageUploadInfoQueue m_imageUploadInfo;
 	mutable BufferUploadInfoQueue m_bufferUploadInfo;
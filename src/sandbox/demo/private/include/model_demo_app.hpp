@@ -54,6 +54,9 @@ private:
 		uint64 textures[3];
 		uint64 sampler;
 		uint32 hasUV;
+		uint32 vertexEncoding;	// render::VertexEncoding, tells the shader how to decode the vertex attributes.
+		float32 boundsMin[3];
+		float32 boundsMax[3];
 	};
 
 	struct MeshRenderInfo
@@ -296,7 +296,7 @@ auto ModelDemoApp::render() -> void
 		cmd.bind_index_buffer({
 			.buffer = renderInfo.mesh->buffer,
 			.offset = renderInfo.mesh->info.indices.byteOffset,
-			.indexType = gpu::IndexType::Uint_32
+			.indexType = renderInfo.mesh->indexType
 		});
 
 		PushConstant pc{
@@ -780,6 +780,9 @@ auto ModelDemoApp::unpack_sponza() -> void
 
 		// Keep track of the mesh's attributes from the pack file.
 		mesh.attributes = metadata.attributes;
+		mesh.encoding	= metadata.encoding;
+		mesh.indexType	= metadata.indexType;
+		mesh.bounds		= metadata.bounds;
 
 		// Store mesh vertices information.
 		mesh.info.vertices.count 	= metadata.vertices.count;
@@ -808,9 +811,10 @@ auto ModelDemoApp::unpack_sponza() -> void
 		// Our project requires that a mesh contain position, normal and uv data.
 		// However, occassionally, some meshes will not contain some of these attributes and the sbf file does not store the offsets to each of these attributes.
 		// A single flag is used to determine the type of attributes that exist for the mesh in the sbf file.
-		uint32 const posCount 		= metadata.vertices.count * render::AttribInfo<render::VertexAttribute::Position>::componentCount;
-		uint32 const normalCount 	= normalDataExist * metadata.vertices.count * render::AttribInfo<render::VertexAttribute::Normal>::componentCount;
-		uint32 const uvCount 		= uvDataExist * metadata.vertices.count * render::AttribInfo<render::VertexAttribute::TexCoord>::componentCount;
+		// Encoded attributes are always a multiple of 4 bytes so the ranges below can still be expressed in terms of float32s.
+		uint32 const posCount 		= metadata.vertices.count * render::attribute_size_bytes(render::VertexAttribute::Position, metadata.encoding) / sizeof(float32);
+		uint32 const normalCount 	= normalDataExist * metadata.vertices.count * render::attribute_size_bytes(render::VertexAttribute::Normal, metadata.encoding) / sizeof(float32);
+		uint32 const uvCount 		= uvDataExist * metadata.vertices.count * render::attribute_size_bytes(render::VertexAttribute::TexCoord, metadata.encoding) / sizeof(float32);
 
 		std::span<float32> const posRange{ &data.vertices[0], posCount };
 		std::span<float32> const normalRange{ &data.vertices[normalDataExist * posCount], normalCount };
@@ -882,6 +886,10 @@ auto ModelDemoApp::unpack_sponza() -> void
 		meshRenderInfo.info->textures[2] = m_defaultNormalMap.id();
 		meshRenderInfo.info->sampler = m_normalSampler.id();
 		meshRenderInfo.info->hasUV = std::cmp_not_equal(uvCount, 0);
+		meshRenderInfo.info->vertexEncoding = static_cast<uint32>(std::to_underlying(mesh.encoding));
+
+		std::memcpy(meshRenderInfo.info->boundsMin, mesh.bounds.min, sizeof(float32) * 3);
+		std::memcpy(meshRenderInfo.info->boundsMax, mesh.bounds.max, sizeof(float32) * 3);
 
 		++i;
 	}
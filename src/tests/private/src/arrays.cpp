@@ -0,0 +1,251 @@
+#include <list>
+#include "lib/array.hpp"
+#include "lib/small_array.hpp"
+#include "check.hpp"
+
+/**
+* lib::array and lib::small_array, the small_array cases use sizes on both sides of its inline capacity.
+*
+* tracked counts how many objects are alive and leaves the value of a moved from object at MOVED_FROM, so that a resize that moves from its arguments more than once shows up.
+*/
+static constexpr int MOVED_FROM = -1;
+static int alive = 0;
+
+struct tracked
+{
+	int value = 0;
+
+	tracked() { ++alive; }
+	tracked(int v) : value{ v } { ++alive; }
+	tracked(tracked const& other) : value{ other.value } { ++alive; }
+	tracked(tracked&& other) noexcept : value{ other.value } { other.value = MOVED_FROM; ++alive; }
+	~tracked() { --alive; }
+
+	auto operator=(tracked const& other) -> tracked& { value = other.value; return *this; }
+	auto operator=(tracked&& other) noexcept -> tracked& { value = other.value; other.value = MOVED_FROM; return *this; }
+};
+
+template <typename array>
+static auto all_equal(array const& elements, size_t from, size_t to, int value) -> bool
+{
+	for (size_t i = from; i < to; ++i)
+	{
+		if (elements[i].value != value)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+* @return True when the values of "elements" are 0, 1, 2, ... "count" - 1.
+*/
+template <typename array>
+static auto is_sequence(array const& elements, size_t count) -> bool
+{
+	if (elements.size() != count)
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (elements[i].value != static_cast<int>(i))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+template <typename array>
+static auto make_sequence(size_t count) -> array
+{
+	array elements;
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		elements.emplace_back(static_cast<int>(i));
+	}
+
+	return elements;
+}
+
+/**
+* "count" is large enough for a small_array to outgrow its inline storage.
+*/
+template <typename array>
+static auto test_resize(size_t count) -> void
+{
+	{
+		array elements;
+
+		elements.resize(count);
+		CHECK(elements.size() == count);
+		CHECK(all_equal(elements, 0, count, 0));
+
+		// Every new element has to be made from 5, not just the first one.
+		elements.resize(count * 2, tracked{ 5 });
+		CHECK(elements.size() == count * 2);
+		CHECK(all_equal(elements, 0, count, 0));
+		CHECK(all_equal(elements, count, count * 2, 5));
+
+		tracked const seven{ 7 };
+		elements.resize(count * 3, seven);
+		CHECK(seven.value == 7);
+		CHECK(all_equal(elements, count * 2, count * 3, 7));
+
+		elements.resize(count / 2);
+		CHECK(elements.size() == count / 2);
+		CHECK(alive == static_cast<int>(count / 2) + 1);
+
+		elements.resize(count, 9);
+		CHECK(all_equal(elements, 0, count / 2, 0));
+		CHECK(all_equal(elements, count / 2, count, 9));
+	}
+
+	CHECK(alive == 0);
+}
+
+/**
+* Inserting into the front, the middle and the end, from a range that is not contiguous, from an initializer list and as copies of one value.
+*/
+template <typename array>
+static auto test_insert(size_t count) -> void
+{
+	{
+		array elements;
+
+		// Every value below "count" goes in through a different insert, the result has to be the sequence.
+		std::list<tracked> source;
+
+		for (size_t i = count / 2; i < count; ++i)
+		{
+			source.emplace_back(static_cast<int>(i));
+		}
+
+		elements.insert(elements.cbegin(), source.begin(), source.end());
+		CHECK(elements.size() == source.size());
+
+		elements.insert(elements.cbegin(), { tracked{ 0 }, tracked{ 1 } });
+		CHECK(elements.size() == source.size() + 2);
+
+		std::list<tracked> middle;
+
+		for (size_t i = 2; i < count / 2; ++i)
+		{
+			middle.emplace_back(static_cast<int>(i));
+		}
+
+		auto it = elements.insert(elements.cbegin() + 2, middle.begin(), middle.end());
+		CHECK(it == elements.begin() + 2);
+		CHECK(is_sequence(elements, count));
+
+		// The source ranges are copied from, not moved.
+		CHECK(source.front().value == static_cast<int>(count / 2));
+
+		elements.insert(elements.cend(), 3, tracked{ 7 });
+		CHECK(elements.size() == count + 3);
+		CHECK(all_equal(elements, count, count + 3, 7));
+
+		// An empty range leaves the array as it was.
+		std::list<tracked> const empty;
+		elements.insert(elements.cbegin() + 1, empty.begin(), empty.end());
+		CHECK(elements.size() == count + 3);
+
+		elements.insert(elements.cbegin() + count, { tracked{ 9 } });
+		CHECK(elements[count].value == 9);
+		CHECK(all_equal(elements, count + 1, count + 4, 7));
+		CHECK(alive == static_cast<int>(elements.size() + source.size() + middle.size()));
+	}
+
+	CHECK(alive == 0);
+}
+
+template <typename array>
+static auto test_erase(size_t count) -> void
+{
+	{
+		array elements = make_sequence<array>(count);
+
+		// Front, then back, then a range from the middle.
+		auto it = elements.erase(elements.cbegin());
+		CHECK(it->value == 1);
+		CHECK(elements.size() == count - 1);
+
+		elements.erase(elements.cend() - 1);
+		CHECK(elements.size() == count - 2);
+		CHECK(elements.back().value == static_cast<int>(count - 2));
+
+		it = elements.erase(elements.cbegin() + 1, elements.cbegin() + 1 + (count - 4));
+		CHECK(elements.size() == 2);
+		CHECK(elements[0].value == 1);
+		CHECK(elements[1].value == static_cast<int>(count - 2));
+		CHECK(it->value == static_cast<int>(count - 2));
+		CHECK(alive == 2);
+
+		elements.erase(elements.cbegin(), elements.cend());
+		CHECK(elements.empty());
+		CHECK(alive == 0);
+	}
+
+	CHECK(alive == 0);
+}
+
+template <typename array>
+static auto test_copy_move(size_t count) -> void
+{
+	{
+		array const original = make_sequence<array>(count);
+
+		array copy{ original };
+		CHECK(is_sequence(copy, count));
+		CHECK(is_sequence(original, count));
+		CHECK(alive == static_cast<int>(count * 2));
+
+		array assigned = make_sequence<array>(count / 2 + 1);
+		assigned = original;
+		CHECK(is_sequence(assigned, count));
+		CHECK(alive == static_cast<int>(count * 3));
+
+		array moved{ std::move(copy) };
+		CHECK(is_sequence(moved, count));
+		CHECK(copy.empty());
+		CHECK(alive == static_cast<int>(count * 3));
+
+		array target = make_sequence<array>(count + 5);
+		target = std::move(moved);
+		CHECK(is_sequence(target, count));
+		CHECK(moved.empty());
+		CHECK(alive == static_cast<int>(count * 3));
+
+		// The moved from arrays are still usable.
+		moved.emplace_back(0);
+		CHECK(is_sequence(moved, 1));
+	}
+
+	CHECK(alive == 0);
+}
+
+auto main() -> int
+{
+	test_resize<lib::array<tracked>>(3);
+	test_resize<lib::array<tracked>>(100);
+	test_resize<lib::small_array<tracked, 8>>(3);
+	test_resize<lib::small_array<tracked, 8>>(100);
+
+	for (size_t count : { size_t{ 6 }, size_t{ 100 } })
+	{
+		test_insert<lib::array<tracked>>(count);
+		test_insert<lib::small_array<tracked, 8>>(count);
+		test_erase<lib::array<tracked>>(count);
+		test_erase<lib::small_array<tracked, 8>>(count);
+		test_copy_move<lib::array<tracked>>(count);
+		test_copy_move<lib::small_array<tracked, 8>>(count);
+	}
+
+	return tests::report("arrays");
+}
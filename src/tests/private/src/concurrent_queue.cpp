@@ -0,0 +1,404 @@
+#include <memory>
+#include <thread>
+#include "lib/array.hpp"
+#include "lib/concurrent_queue.hpp"
+#include "check.hpp"
+
+/**
+* lib::spsc_queue, lib::mpmc_queue and lib::blocking_queue with several threads on each side.
+*
+* Every element is a producer id in the upper half and a sequence number in the lower half. Consumers count how often they saw each one, every count has to end up at exactly one.
+* The queues are small so that producers run into a full queue and consumers into an empty one many times over.
+*/
+static constexpr uint64 PER_PRODUCER = 50'000;
+static constexpr size_t BATCH_SIZE = 13;
+
+static auto element(uint64 producer, uint64 sequence) -> uint64
+{
+	return (producer << 32) | sequence;
+}
+
+/**
+* Records every element a consumer takes, the checks only run on the main thread once every thread has been joined.
+*/
+struct deliveries
+{
+	uint64 producerCount;
+	std::unique_ptr<std::atomic<uint32>[]> seen;
+	std::atomic<uint32> outOfOrder;
+
+	deliveries(uint64 producers) :
+		producerCount{ producers },
+		seen{ std::make_unique<std::atomic<uint32>[]>(producers * PER_PRODUCER) },
+		outOfOrder{ 0 }
+	{}
+
+	auto record(uint64 value) -> void
+	{
+		uint64 const producer = value >> 32;
+		uint64 const sequence = value & 0xFFFF'FFFFull;
+
+		if (producer >= producerCount || sequence >= PER_PRODUCER)
+		{
+			outOfOrder.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		seen[producer * PER_PRODUCER + sequence].fetch_add(1, std::memory_order_relaxed);
+	}
+
+	auto exactly_once() const -> bool
+	{
+		for (uint64 i = 0; i < producerCount * PER_PRODUCER; ++i)
+		{
+			if (seen[i].load(std::memory_order_relaxed) != 1)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+};
+
+/**
+* Tracks the last sequence number seen from every producer on one consumer. A FIFO queue never hands a consumer an older element of a producer after a newer one.
+*/
+struct order
+{
+	lib::array<int64> last;
+
+	order(uint64 producers) :
+		last{}
+	{
+		last.resize(producers, -1);
+	}
+
+	auto in_order(uint64 value) -> bool
+	{
+		int64 const sequence = static_cast<int64>(value & 0xFFFF'FFFFull);
+		int64& previous = last[value >> 32];
+		bool const ordered = sequence > previous;
+
+		previous = sequence;
+
+		return ordered;
+	}
+};
+
+/**
+* Pushes one producer's elements, one at a time or in batches, spinning while the queue is full.
+*/
+template <typename queue_type>
+static auto produce_spinning(queue_type& queue, uint64 producer, bool batched) -> void
+{
+	uint64 sequence = 0;
+
+	while (sequence < PER_PRODUCER)
+	{
+		if (!batched)
+		{
+			while (!queue.try_push(element(producer, sequence)))
+			{
+				std::this_thread::yield();
+			}
+
+			++sequence;
+			continue;
+		}
+
+		uint64 values[BATCH_SIZE];
+		size_t const count = static_cast<size_t>(std::min<uint64>(BATCH_SIZE, PER_PRODUCER - sequence));
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			values[i] = element(producer, sequence + i);
+		}
+
+		std::span<uint64> pending{ values, count };
+
+		while (!pending.empty())
+		{
+			size_t const pushed = queue.try_push_batch(pending);
+
+			if (pushed == 0)
+			{
+				std::this_thread::yield();
+			}
+
+			pending = pending.subspan(pushed);
+		}
+
+		sequence += count;
+	}
+}
+
+/**
+* Pops until "remaining" elements have been taken by all the consumers together.
+*/
+template <typename queue_type>
+static auto consume_spinning(queue_type& queue, std::atomic<uint64>& remaining, deliveries& delivered, order& seen, bool batched) -> void
+{
+	uint64 values[BATCH_SIZE];
+
+	while (remaining.load(std::memory_order_relaxed) != 0)
+	{
+		size_t count = 0;
+
+		if (batched)
+		{
+			count = queue.try_pop_batch(std::span{ values });
+		}
+		else if (std::optional<uint64> value = queue.try_pop(); value.has_value())
+		{
+			values[0] = *value;
+			count = 1;
+		}
+
+		if (count == 0)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			delivered.record(values[i]);
+
+			if (!seen.in_order(values[i]))
+			{
+				delivered.outOfOrder.fetch_add(1, std::memory_order_relaxed);
+			}
+		}
+
+		remaining.fetch_sub(count, std::memory_order_relaxed);
+	}
+}
+
+template <typename queue_type>
+static auto run_spinning(queue_type& queue, uint64 producers, uint64 consumers) -> void
+{
+	deliveries delivered{ producers };
+	std::atomic<uint64> remaining = producers * PER_PRODUCER;
+	lib::array<std::thread> threads;
+
+	// Every other thread on both sides uses the batch calls.
+	for (uint64 i = 0; i < consumers; ++i)
+	{
+		threads.emplace_back([&queue, &remaining, &delivered, producers, batched = (i % 2) == 1]
+		{
+			order seen{ producers };
+			consume_spinning(queue, remaining, delivered, seen, batched);
+		});
+	}
+
+	for (uint64 i = 0; i < producers; ++i)
+	{
+		threads.emplace_back([&queue, i, batched = (i % 2) == 1] { produce_spinning(queue, i, batched); });
+	}
+
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	CHECK(delivered.exactly_once());
+	CHECK(delivered.outOfOrder.load() == 0);
+	CHECK(queue.empty());
+}
+
+/**
+* "flip" swaps which threads use the batch calls, a single producer and consumer pair only gets to the batch calls that way.
+*/
+template <typename queue_type>
+static auto run_blocking(uint64 producers, uint64 consumers, size_t capacity, bool flip) -> void
+{
+	lib::blocking_queue<queue_type> queue{ capacity };
+	deliveries delivered{ producers };
+	lib::array<std::thread> threads;
+
+	// Each consumer takes a fixed share, so that every one of them returns from its last blocking pop.
+	uint64 const total = producers * PER_PRODUCER;
+
+	for (uint64 i = 0; i < consumers; ++i)
+	{
+		uint64 const share = total / consumers + (i < total % consumers ? 1 : 0);
+
+		threads.emplace_back([&queue, &delivered, producers, share, batched = ((i % 2) == 1) != flip]
+		{
+			order seen{ producers };
+			uint64 values[BATCH_SIZE];
+
+			for (uint64 taken = 0; taken < share;)
+			{
+				size_t count = 1;
+
+				if (batched)
+				{
+					count = queue.pop_batch(std::span{ values, static_cast<size_t>(std::min<uint64>(BATCH_SIZE, share - taken)) });
+				}
+				else
+				{
+					values[0] = queue.pop();
+				}
+
+				for (size_t j = 0; j < count; ++j)
+				{
+					delivered.record(values[j]);
+
+					if (!seen.in_order(values[j]))
+					{
+						delivered.outOfOrder.fetch_add(1, std::memory_order_relaxed);
+					}
+				}
+
+				taken += count;
+			}
+		});
+	}
+
+	for (uint64 i = 0; i < producers; ++i)
+	{
+		threads.emplace_back([&queue, i, batched = ((i % 2) == 1) != flip]
+		{
+			if (!batched)
+			{
+				for (uint64 sequence = 0; sequence < PER_PRODUCER; ++sequence)
+				{
+					queue.push(element(i, sequence));
+				}
+
+				return;
+			}
+
+			uint64 values[BATCH_SIZE];
+
+			for (uint64 sequence = 0; sequence < PER_PRODUCER; sequence += BATCH_SIZE)
+			{
+				size_t const count = static_cast<size_t>(std::min<uint64>(BATCH_SIZE, PER_PRODUCER - sequence));
+
+				for (size_t j = 0; j < count; ++j)
+				{
+					values[j] = element(i, sequence + j);
+				}
+
+				queue.push_batch(std::span{ values, count });
+			}
+		});
+	}
+
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	CHECK(delivered.exactly_once());
+	CHECK(delivered.outOfOrder.load() == 0);
+	CHECK(queue.empty());
+}
+
+/**
+* Single threaded edge cases: a full queue refuses elements without constructing them, batches stop at the capacity, and elements still queued are destroyed with the queue.
+*/
+template <typename queue_type>
+static auto test_bounds() -> void
+{
+	{
+		queue_type queue{ 5 };
+		CHECK(queue.capacity() == 8);
+
+		for (uint64 i = 0; i < 8; ++i)
+		{
+			CHECK(queue.try_push(std::make_unique<uint64>(i)));
+		}
+
+		std::unique_ptr<uint64> extra = std::make_unique<uint64>(8);
+		CHECK(!queue.try_push(std::move(extra)));
+		CHECK(extra != nullptr);
+
+		std::unique_ptr<uint64> out[5];
+		CHECK(queue.try_pop_batch(std::span{ out }) == 5);
+		CHECK(*out[0] == 0 && *out[4] == 4);
+
+		std::unique_ptr<uint64> in[6];
+
+		for (uint64 i = 0; i < 6; ++i)
+		{
+			in[i] = std::make_unique<uint64>(100 + i);
+		}
+
+		// Only five fit, the sixth stays with the caller.
+		CHECK(queue.try_push_batch(std::span{ in }) == 5);
+		CHECK(in[5] != nullptr && *in[5] == 105);
+		CHECK(queue.size() == 8);
+
+		std::optional<std::unique_ptr<uint64>> front = queue.try_pop();
+		CHECK(front.has_value() && **front == 5);
+	}
+
+	// ASan reports the elements left in the queue above if the destructor does not free them.
+	queue_type empty{ 4 };
+	CHECK(!empty.try_pop().has_value());
+	CHECK(empty.empty());
+}
+
+auto main() -> int
+{
+	test_bounds<lib::spsc_queue<std::unique_ptr<uint64>>>();
+	test_bounds<lib::mpmc_queue<std::unique_ptr<uint64>>>();
+
+	{
+		lib::spsc_queue<uint64> queue{ 64 };
+		run_spinning(queue, 1, 1);
+	}
+
+	{
+		// The producer batches and the consumer pops one at a time, then the other way around.
+		lib::spsc_queue<uint64> queue{ 64 };
+		deliveries delivered{ 2 };
+		std::atomic<uint64> remaining = 2 * PER_PRODUCER;
+		order seen{ 2 };
+
+		std::thread producer{ [&queue] { produce_spinning(queue, 0, true); produce_spinning(queue, 1, false); } };
+		std::thread consumer{ [&] { consume_spinning(queue, remaining, delivered, seen, false); } };
+
+		producer.join();
+		consumer.join();
+
+		CHECK(delivered.exactly_once());
+		CHECK(delivered.outOfOrder.load() == 0);
+	}
+
+	{
+		lib::spsc_queue<uint64> queue{ 64 };
+		std::atomic<uint64> remaining = PER_PRODUCER;
+		deliveries delivered{ 1 };
+		order seen{ 1 };
+
+		std::thread producer{ [&queue] { produce_spinning(queue, 0, false); } };
+		std::thread consumer{ [&] { consume_spinning(queue, remaining, delivered, seen, true); } };
+
+		producer.join();
+		consumer.join();
+
+		CHECK(delivered.exactly_once());
+		CHECK(delivered.outOfOrder.load() == 0);
+	}
+
+	{
+		lib::mpmc_queue<uint64> queue{ 64 };
+		run_spinning(queue, 4, 4);
+	}
+
+	{
+		lib::mpmc_queue<uint64> queue{ 16 };
+		run_spinning(queue, 6, 2);
+	}
+
+	run_blocking<lib::spsc_queue<uint64>>(1, 1, 16, false);
+	run_blocking<lib::spsc_queue<uint64>>(1, 1, 16, true);
+	run_blocking<lib::mpmc_queue<uint64>>(4, 4, 16, false);
+	run_blocking<lib::mpmc_queue<uint64>>(2, 5, 4, true);
+
+	return tests::report("concurrent_queue");
+}
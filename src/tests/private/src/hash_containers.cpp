@@ -0,0 +1,249 @@
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include "lib/map.hpp"
+#include "lib/set.hpp"
+#include "lib/string.hpp"
+#include "check.hpp"
+
+/**
+* lib::map and lib::set against std::unordered_map and std::unordered_set under the same random sequence of inserts, erases and lookups.
+* Every layout is run with lib::hash and with std::hash, which does not avalanche and leaves it to the container to mix the bits.
+*/
+static constexpr uint32 OPERATION_COUNT = 20'000;
+static constexpr uint64 KEY_RANGES[] = { 16, 1'000, 50'000 };
+
+template <typename hasher, typename layout>
+using map_type = lib::map<uint64, uint64, lib::allocator<std::pair<uint64 const, uint64>>, hasher, lib::shift_growth_policy<4>, layout>;
+
+template <typename hasher, typename layout>
+using set_type = lib::set<uint64, lib::allocator<uint64>, hasher, lib::shift_growth_policy<4>, layout>;
+
+/**
+* Keys in [0, range) moved into the top bits, so that a hasher that keeps the low bits as they are puts all of them into the same bucket.
+*/
+static auto make_key(tests::rng& random, uint64 range, bool highBits) -> uint64
+{
+	uint64 const key = random.next_below(range);
+	return highBits ? (key << 40) : key;
+}
+
+template <typename map>
+static auto same_contents(map const& ours, std::unordered_map<uint64, uint64> const& reference) -> bool
+{
+	if (ours.size() != reference.size())
+	{
+		return false;
+	}
+
+	size_t count = 0;
+
+	for (auto const& [key, value] : ours)
+	{
+		auto const it = reference.find(key);
+
+		if (it == reference.end() || it->second != value)
+		{
+			return false;
+		}
+
+		++count;
+	}
+
+	return count == reference.size();
+}
+
+template <typename map>
+static auto test_map(uint64 seed, uint64 range, bool highBits) -> void
+{
+	map ours;
+	std::unordered_map<uint64, uint64> reference;
+	tests::rng random{ seed };
+
+	for (uint32 i = 0; i < OPERATION_COUNT; ++i)
+	{
+		uint64 const key = make_key(random, range, highBits);
+		uint64 const value = random.next();
+
+		switch (random.next_below(6))
+		{
+		case 0:
+			// Replaces the value of an existing key.
+			ours.emplace(key, value);
+			reference.insert_or_assign(key, value);
+			break;
+		case 1:
+			ours.insert(key, value);
+			reference.insert_or_assign(key, value);
+			break;
+		case 2:
+			CHECK(ours.try_insert(key, value).has_value() == reference.try_emplace(key, value).second);
+			break;
+		case 3:
+			CHECK(ours.erase(key) == (reference.erase(key) != 0));
+			break;
+		default:
+		{
+			auto const found = ours.at(key);
+			auto const it = reference.find(key);
+
+			CHECK(ours.contains(key) == (it != reference.end()));
+			CHECK(found.has_value() == (it != reference.end()));
+
+			if (found.has_value() && it != reference.end())
+			{
+				CHECK(found.value()->second == it->second);
+			}
+			break;
+		}
+		}
+
+		CHECK(ours.size() == reference.size());
+
+		if (tests::failures != 0)
+		{
+			return;
+		}
+	}
+
+	CHECK(same_contents(ours, reference));
+
+	map const copy{ ours };
+	CHECK(same_contents(copy, reference));
+
+	map moved{ std::move(ours) };
+	CHECK(same_contents(moved, reference));
+
+	moved.clear();
+	CHECK(moved.size() == 0);
+	CHECK(moved.begin() == moved.end());
+
+	// A cleared container has to be usable again.
+	for (uint64 key = 0; key < 100; ++key)
+	{
+		moved.insert(key, key);
+	}
+
+	CHECK(moved.size() == 100);
+	CHECK(moved.at(uint64{ 42 }).has_value() && moved.at(uint64{ 42 }).value()->second == 42);
+}
+
+template <typename set>
+static auto test_set(uint64 seed, uint64 range, bool highBits) -> void
+{
+	set ours;
+	std::unordered_set<uint64> reference;
+	tests::rng random{ seed };
+
+	for (uint32 i = 0; i < OPERATION_COUNT; ++i)
+	{
+		uint64 const key = make_key(random, range, highBits);
+
+		switch (random.next_below(4))
+		{
+		case 0:
+		case 1:
+			ours.insert(key);
+			reference.insert(key);
+			break;
+		case 2:
+			CHECK(ours.erase(key) == (reference.erase(key) != 0));
+			break;
+		default:
+			CHECK(ours.contains(key) == reference.contains(key));
+			break;
+		}
+
+		CHECK(ours.size() == reference.size());
+
+		if (tests::failures != 0)
+		{
+			return;
+		}
+	}
+
+	size_t count = 0;
+
+	for (uint64 key : ours)
+	{
+		CHECK(reference.contains(key));
+		++count;
+	}
+
+	CHECK(count == reference.size());
+}
+
+template <typename layout>
+static auto test_string_map() -> void
+{
+	lib::map<lib::string, uint32, lib::allocator<std::pair<lib::string const, uint32>>, lib::hash<lib::string>, lib::shift_growth_policy<4>, layout> ours;
+	std::unordered_map<std::string, uint32> reference;
+	tests::rng random{ 7 };
+
+	for (uint32 i = 0; i < OPERATION_COUNT; ++i)
+	{
+		std::string const key = std::to_string(random.next_below(2'000));
+		lib::string const ourKey{ key.c_str() };
+		uint32 const value = static_cast<uint32>(random.next());
+
+		switch (random.next_below(3))
+		{
+		case 0:
+			ours.emplace(ourKey, value);
+			reference.insert_or_assign(key, value);
+			break;
+		case 1:
+			CHECK(ours.erase(ourKey) == (reference.erase(key) != 0));
+			break;
+		default:
+		{
+			auto const found = ours.at(ourKey);
+			auto const it = reference.find(key);
+
+			CHECK(found.has_value() == (it != reference.end()));
+
+			if (found.has_value() && it != reference.end())
+			{
+				CHECK(found.value()->second == it->second);
+			}
+			break;
+		}
+		}
+
+		CHECK(ours.size() == reference.size());
+
+		if (tests::failures != 0)
+		{
+			return;
+		}
+	}
+}
+
+template <typename hasher, typename layout>
+static auto test_layout() -> void
+{
+	uint64 seed = 1;
+
+	for (uint64 range : KEY_RANGES)
+	{
+		for (bool highBits : { false, true })
+		{
+			test_map<map_type<hasher, layout>>(seed, range, highBits);
+			test_set<set_type<hasher, layout>>(seed, range, highBits);
+			++seed;
+		}
+	}
+}
+
+auto main() -> int
+{
+	test_layout<lib::hash<uint64>, lib::robin_hood_layout>();
+	test_layout<std::hash<uint64>, lib::robin_hood_layout>();
+	test_layout<lib::hash<uint64>, lib::group_probing_layout>();
+	test_layout<std::hash<uint64>, lib::group_probing_layout>();
+
+	test_string_map<lib::robin_hood_layout>();
+	test_string_map<lib::group_probing_layout>();
+
+	return tests::report("hash_containers");
+}
@@ -0,0 +1,191 @@
+#include <memory>
+#include "lib/jobs.hpp"
+#include "check.hpp"
+
+/**
+* lib::jobs::scheduler with spawned functions, coroutine tasks and parallel_for. Every case runs enough jobs that they spread over all workers.
+*/
+using lib::jobs::counter;
+using lib::jobs::priority;
+using lib::jobs::scheduler;
+using lib::jobs::task;
+
+static constexpr uint32 JOB_COUNT = 1'000;
+
+static auto leaf(int32 value) -> task<int32>
+{
+	co_return value * 2;
+}
+
+/**
+* Suspends on a counter that other jobs signal, the case where the task is put back on a queue by counter::signal() instead of by the scheduler.
+*/
+static auto wait_for_jobs(scheduler& s, std::atomic<uint32>& sum, uint32 count) -> task<uint32>
+{
+	counter done;
+
+	for (uint32 i = 0; i < count; ++i)
+	{
+		s.spawn([&sum, i] { sum.fetch_add(i, std::memory_order_relaxed); }, &done);
+	}
+
+	co_await done;
+
+	co_return sum.load(std::memory_order_relaxed);
+}
+
+static auto middle(scheduler& s, std::atomic<uint32>& sum, uint32 count) -> task<uint32>
+{
+	uint32 const total = co_await wait_for_jobs(s, sum, count);
+	int32 const doubled = co_await leaf(static_cast<int32>(count));
+
+	co_return total + static_cast<uint32>(doubled);
+}
+
+static auto parent(scheduler& s, std::atomic<uint32>& sum, uint32 count) -> task<uint32>
+{
+	co_return co_await middle(s, sum, count);
+}
+
+static auto test_nested_tasks(scheduler& s) -> void
+{
+	CHECK(s.run(leaf(21)) == 42);
+
+	// parent -> middle -> wait_for_jobs -> counter, the counter reschedules a task two levels down.
+	for (uint32 round = 0; round < 50; ++round)
+	{
+		std::atomic<uint32> sum = 0;
+		uint32 const count = 1 + round * 7;
+
+		CHECK(s.run(parent(s, sum, count)) == count * (count - 1) / 2 + count * 2);
+	}
+
+	// Detached tasks that each await a child awaiting a counter.
+	counter done;
+	std::atomic<uint32> total = 0;
+
+	for (uint32 i = 0; i < 100; ++i)
+	{
+		s.spawn([](scheduler& s, std::atomic<uint32>& total) -> task<void>
+		{
+			std::atomic<uint32> sum = 0;
+			total.fetch_add(co_await middle(s, sum, 10), std::memory_order_relaxed);
+		}(s, total), &done);
+	}
+
+	s.wait(done);
+	CHECK(total.load() == 100 * (45 + 20));
+}
+
+static auto test_spawn(scheduler& s) -> void
+{
+	counter done;
+	std::atomic<uint32> normal = 0;
+	std::atomic<uint32> high = 0;
+	std::atomic<uint32> io = 0;
+
+	for (uint32 i = 0; i < JOB_COUNT; ++i)
+	{
+		s.spawn([&normal] { normal.fetch_add(1, std::memory_order_relaxed); }, &done);
+		s.spawn([&high] { high.fetch_add(1, std::memory_order_relaxed); }, &done, priority::high);
+		s.spawn([&io] { io.fetch_add(1, std::memory_order_relaxed); }, &done, priority::io);
+	}
+
+	s.wait(done);
+
+	CHECK(done.done());
+	CHECK(normal.load() == JOB_COUNT);
+	CHECK(high.load() == JOB_COUNT);
+	CHECK(io.load() == JOB_COUNT);
+
+	// Jobs that spawn jobs onto the same counter from inside a worker.
+	counter nested;
+	std::atomic<uint32> leaves = 0;
+
+	for (uint32 i = 0; i < 64; ++i)
+	{
+		s.spawn([&s, &nested, &leaves]
+		{
+			for (uint32 j = 0; j < 64; ++j)
+			{
+				s.spawn([&leaves] { leaves.fetch_add(1, std::memory_order_relaxed); }, &nested);
+			}
+		}, &nested);
+	}
+
+	s.wait(nested);
+	CHECK(leaves.load() == 64 * 64);
+}
+
+static auto test_parallel_for(scheduler& s) -> void
+{
+	std::atomic<int64> sum = 0;
+
+	s.parallel_for<int64>(0, 1'000'000, [&sum](int64 first, int64 last)
+	{
+		int64 local = 0;
+
+		for (int64 i = first; i < last; ++i)
+		{
+			local += i;
+		}
+
+		sum.fetch_add(local, std::memory_order_relaxed);
+	});
+
+	CHECK(sum.load() == int64{ 999'999 } * 1'000'000 / 2);
+
+	// Every index is visited exactly once, also with the smallest grain.
+	std::unique_ptr<std::atomic<uint32>[]> visits = std::make_unique<std::atomic<uint32>[]>(10'000);
+
+	s.parallel_for<uint32>(0, 10'000, [&visits](uint32 i) { visits[i].fetch_add(1, std::memory_order_relaxed); }, 1);
+
+	bool once = true;
+
+	for (uint32 i = 0; i < 10'000; ++i)
+	{
+		once = once && visits[i].load() == 1;
+	}
+
+	CHECK(once);
+
+	// Empty ranges return straight away.
+	s.parallel_for<int32>(5, 5, [](int32) { CHECK(false); });
+
+	// parallel_for from inside jobs, the waiting workers keep running the ranges.
+	counter done;
+	sum = 0;
+
+	for (uint32 i = 0; i < 8; ++i)
+	{
+		s.spawn([&s, &sum]
+		{
+			s.parallel_for<int64>(0, 10'000, [&sum](int64 j) { sum.fetch_add(j, std::memory_order_relaxed); });
+		}, &done);
+	}
+
+	s.wait(done);
+	CHECK(sum.load() == int64{ 8 } * 9'999 * 10'000 / 2);
+}
+
+auto main() -> int
+{
+	{
+		scheduler s{ { .workerCount = 4, .ioThreadCount = 1 } };
+
+		test_nested_tasks(s);
+		test_spawn(s);
+		test_parallel_for(s);
+	}
+
+	// A single worker and no IO threads, every wait has to run the jobs it waits for.
+	{
+		scheduler s{ { .workerCount = 1, .ioThreadCount = 0 } };
+
+		test_nested_tasks(s);
+		test_spawn(s);
+		test_parallel_for(s);
+	}
+
+	return tests::report("jobs");
+}
@@ -0,0 +1,236 @@
+#include <cmath>
+#include "lib/array.hpp"
+#include "check.hpp"
+#include "math/simd.h"
+
+/**
+* math::approx against the double precision std functions. Checks the error bounds documented in math/common.h for the scalar, SSE and AVX2 forms.
+*/
+static constexpr size_t INPUT_COUNT = 1 << 16;
+
+/**
+* Near the zeros of sin and cos the relative error is unbounded, common.h bounds the absolute error there instead.
+*/
+static constexpr float64 SIN_COS_RELATIVE_LIMIT	= 1e-3;
+static constexpr float64 SIN_COS_ABSOLUTE_ERROR	= 1e-7;
+
+/**
+* Distance from the float32 nearest to "reference" in units of that float's spacing.
+*/
+static auto ulp_error(float32 value, float64 reference) -> float64
+{
+	float32 const expected = static_cast<float32>(reference);
+	float64 const spacing = static_cast<float64>(std::nextafter(std::fabs(expected), std::numeric_limits<float32>::infinity()) - std::fabs(expected));
+
+	return std::fabs(static_cast<float64>(value) - reference) / spacing;
+}
+
+using unary_form = auto (*)(float32 const* in, float32* out, size_t count) -> void;
+using binary_form = auto (*)(float32 const* y, float32 const* x, float32* out, size_t count) -> void;
+
+struct unary_forms
+{
+	unary_form scalar;
+	unary_form sse;
+	unary_form avx2;
+};
+
+/**
+* The forms of math::approx::fn over a whole array. The SSE and AVX2 forms take four and eight inputs at a time, so the count has to be a multiple of eight.
+*/
+#define APPROX_SCALAR_FORM(fn) [](float32 const* in, float32* out, size_t count) { for (size_t i = 0; i < count; ++i) { out[i] = math::approx::fn(in[i]); } }
+
+#if MATH_SIMD_SSE2
+#define APPROX_SSE_FORM(fn) [](float32 const* in, float32* out, size_t count) { for (size_t i = 0; i < count; i += 4) { _mm_storeu_ps(out + i, math::simd::approx::fn(_mm_loadu_ps(in + i))); } }
+#define APPROX_AVX2_FORM(fn) &avx2_form<static_cast<auto (*)(__m256) -> __m256>(&math::simd::approx::fn)>
+
+template <auto (*fn)(__m256) -> __m256>
+MATH_SIMD_TARGET_AVX2 static auto avx2_form(float32 const* in, float32* out, size_t count) -> void
+{
+	for (size_t i = 0; i < count; i += 8)
+	{
+		_mm256_storeu_ps(out + i, fn(_mm256_loadu_ps(in + i)));
+	}
+}
+
+MATH_SIMD_TARGET_AVX2 static auto atan2_avx2(float32 const* y, float32 const* x, float32* out, size_t count) -> void
+{
+	for (size_t i = 0; i < count; i += 8)
+	{
+		_mm256_storeu_ps(out + i, math::simd::approx::atan2(_mm256_loadu_ps(y + i), _mm256_loadu_ps(x + i)));
+	}
+}
+#else
+#define APPROX_SSE_FORM(fn) nullptr
+#define APPROX_AVX2_FORM(fn) nullptr
+#endif
+
+static auto uniform_inputs(tests::rng& random, float32 lo, float32 hi) -> lib::array<float32>
+{
+	lib::array<float32> values;
+	values.reserve(INPUT_COUNT);
+
+	for (size_t i = 0; i < INPUT_COUNT; ++i)
+	{
+		values.push_back(random.next_float(lo, hi));
+	}
+
+	return values;
+}
+
+/**
+* Positive normal floats with exponents spread evenly over [minExponent, maxExponent).
+*/
+static auto logarithmic_inputs(tests::rng& random, int32 minExponent, int32 maxExponent) -> lib::array<float32>
+{
+	lib::array<float32> values;
+	values.reserve(INPUT_COUNT);
+
+	for (size_t i = 0; i < INPUT_COUNT; ++i)
+	{
+		uint32 const exponent = static_cast<uint32>(minExponent + static_cast<int32>(random.next_below(static_cast<uint64>(maxExponent - minExponent))) + 127);
+		uint32 const mantissa = static_cast<uint32>(random.next()) & 0x007FFFFFu;
+
+		values.push_back(std::bit_cast<float32>((exponent << 23) | mantissa));
+	}
+
+	return values;
+}
+
+/**
+* @return The largest error of "form" over "in", in ULP. Inputs for which "absolute" returns true are held to SIN_COS_ABSOLUTE_ERROR instead.
+*/
+template <typename Reference, typename Absolute>
+static auto max_error(unary_form form, lib::array<float32> const& in, Reference reference, Absolute absolute) -> float64
+{
+	lib::array<float32> out;
+	out.resize(in.size());
+
+	form(in.data(), out.data(), in.size());
+
+	float64 maxUlp = 0.0;
+
+	for (size_t i = 0; i < in.size(); ++i)
+	{
+		float64 const expected = reference(static_cast<float64>(in[i]));
+
+		if (absolute(expected))
+		{
+			CHECK(std::fabs(static_cast<float64>(out[i]) - expected) <= SIN_COS_ABSOLUTE_ERROR);
+			continue;
+		}
+
+		maxUlp = std::max(maxUlp, ulp_error(out[i], expected));
+	}
+
+	return maxUlp;
+}
+
+template <typename Reference, typename Absolute>
+static auto check_unary(char const* name, unary_forms const& forms, lib::array<float32> const& in, Reference reference, Absolute absolute, float64 bound) -> void
+{
+	float64 const scalar = max_error(forms.scalar, in, reference, absolute);
+
+	fmt::print("{:<6} scalar {:.2f} ULP", name, scalar);
+	CHECK(scalar <= bound);
+
+#if MATH_SIMD_SSE2
+	float64 const sse = max_error(forms.sse, in, reference, absolute);
+
+	fmt::print(", sse {:.2f} ULP", sse);
+	CHECK(sse <= bound);
+
+	if (math::simd::cpu_supports_avx2())
+	{
+		float64 const avx2 = max_error(forms.avx2, in, reference, absolute);
+
+		fmt::print(", avx2 {:.2f} ULP", avx2);
+		CHECK(avx2 <= bound);
+	}
+#endif
+
+	fmt::print(" (bound {} ULP)\n", bound);
+}
+
+static auto test_sin_cos(tests::rng& random) -> void
+{
+	lib::array<float32> const in = uniform_inputs(random, -8192.f, 8192.f);
+	auto const nearZero = [](float64 expected) { return std::fabs(expected) < SIN_COS_RELATIVE_LIMIT; };
+
+	check_unary("sin", { APPROX_SCALAR_FORM(sin), APPROX_SSE_FORM(sin), APPROX_AVX2_FORM(sin) }, in, [](float64 x) { return std::sin(x); }, nearZero, 2.0);
+	check_unary("cos", { APPROX_SCALAR_FORM(cos), APPROX_SSE_FORM(cos), APPROX_AVX2_FORM(cos) }, in, [](float64 x) { return std::cos(x); }, nearZero, 2.0);
+}
+
+static auto test_exp2_log2_rsqrt(tests::rng& random) -> void
+{
+	auto const never = [](float64) { return false; };
+
+	check_unary("exp2", { APPROX_SCALAR_FORM(exp2), APPROX_SSE_FORM(exp2), APPROX_AVX2_FORM(exp2) }, uniform_inputs(random, -126.f, 127.f), [](float64 x) { return std::exp2(x); }, never, 2.0);
+	check_unary("log2", { APPROX_SCALAR_FORM(log2), APPROX_SSE_FORM(log2), APPROX_AVX2_FORM(log2) }, logarithmic_inputs(random, -126, 128), [](float64 x) { return std::log2(x); }, never, 2.0);
+	check_unary("rsqrt", { APPROX_SCALAR_FORM(rsqrt), APPROX_SSE_FORM(rsqrt), APPROX_AVX2_FORM(rsqrt) }, logarithmic_inputs(random, -126, 128), [](float64 x) { return 1.0 / std::sqrt(x); }, never, 4.0);
+}
+
+static auto atan2_error(binary_form form, lib::array<float32> const& y, lib::array<float32> const& x) -> float64
+{
+	lib::array<float32> out;
+	out.resize(y.size());
+
+	form(y.data(), x.data(), out.data(), y.size());
+
+	float64 maxUlp = 0.0;
+
+	for (size_t i = 0; i < y.size(); ++i)
+	{
+		maxUlp = std::max(maxUlp, ulp_error(out[i], std::atan2(static_cast<float64>(y[i]), static_cast<float64>(x[i]))));
+	}
+
+	return maxUlp;
+}
+
+static auto test_atan2(tests::rng& random) -> void
+{
+	// Both signs and magnitudes far apart, so every octant and the reduction around tan(pi / 8) are covered.
+	lib::array<float32> y = logarithmic_inputs(random, -20, 20);
+	lib::array<float32> x = logarithmic_inputs(random, -20, 20);
+
+	for (size_t i = 0; i < y.size(); ++i)
+	{
+		y[i] = (random.next() & 1) ? -y[i] : y[i];
+		x[i] = (random.next() & 1) ? -x[i] : x[i];
+	}
+
+	float64 const scalar = atan2_error([](float32 const* y, float32 const* x, float32* out, size_t count) { for (size_t i = 0; i < count; ++i) { out[i] = math::approx::atan2(y[i], x[i]); } }, y, x);
+
+	fmt::print("{:<6} scalar {:.2f} ULP", "atan2", scalar);
+	CHECK(scalar <= 4.0);
+	CHECK(math::approx::atan2(0.f, 0.f) == 0.f);
+
+#if MATH_SIMD_SSE2
+	float64 const sse = atan2_error([](float32 const* y, float32 const* x, float32* out, size_t count) { for (size_t i = 0; i < count; i += 4) { _mm_storeu_ps(out + i, math::simd::approx::atan2(_mm_loadu_ps(y + i), _mm_loadu_ps(x + i))); } }, y, x);
+
+	fmt::print(", sse {:.2f} ULP", sse);
+	CHECK(sse <= 4.0);
+	CHECK(_mm_cvtss_f32(math::simd::approx::atan2(_mm_setzero_ps(), _mm_setzero_ps())) == 0.f);
+
+	if (math::simd::cpu_supports_avx2())
+	{
+		float64 const avx2 = atan2_error(&atan2_avx2, y, x);
+
+		fmt::print(", avx2 {:.2f} ULP", avx2);
+		CHECK(avx2 <= 4.0);
+	}
+#endif
+
+	fmt::print(" (bound 4 ULP)\n");
+}
+
+auto main() -> int
+{
+	tests::rng random{ 11 };
+
+	test_sin_cos(random);
+	test_exp2_log2_rsqrt(random);
+	test_atan2(random);
+
+	return tests::report("math_approx");
+}
@@ -0,0 +1,745 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "lib/array.hpp"
+#include "check.hpp"
+#include "math/batch.h"
+
+/**
+* The math::batch vector, matrix and quaternion kernels on every path the CPU has, against the same operations evaluated in float64 through the scalar templates.
+* Every path is run the way the public functions run it, the SIMD part first and the scalar loop for the remainder. The counts are not multiples of 8 so that the remainder is never empty.
+*/
+using matrix64 = math::matrix4x4<float64>;
+using vector64 = math::vector4<float64>;
+using vector3_64 = math::vector3<float64>;
+
+static constexpr size_t COUNT = 1'003;
+
+/**
+* A few ULP of rounding in a 4 term sum, relative to the sum of the magnitudes of the terms.
+*/
+static constexpr float64 TRANSFORM_BOUND	= 1e-6;
+static constexpr float64 HIERARCHY_BOUND	= 1e-5;
+static constexpr float64 PLANE_BOUND		= 1e-5;
+static constexpr float64 QUATERNION_BOUND	= 1e-6;
+
+/**
+* math/batch.h documents its slerp polynomial as accurate to about 1e-6, float32 rounding comes on top.
+*/
+static constexpr float64 SLERP_BOUND		= 3e-6;
+
+/**
+* Objects closer than this to a plane, relative to their distance from the origin, may go either way.
+*/
+static constexpr float64 CULL_MARGIN		= 1e-5;
+
+enum class path
+{
+	scalar,
+	sse,
+	avx2
+};
+
+static auto path_name(path p) -> char const*
+{
+	switch (p)
+	{
+	case path::sse:
+		return "sse";
+	case path::avx2:
+		return "avx2";
+	default:
+		return "scalar";
+	}
+}
+
+static auto supported(path p) -> bool
+{
+#if MATH_SIMD_SSE2
+	return p != path::avx2 || math::simd::cpu_supports_avx2();
+#else
+	return p == path::scalar;
+#endif
+}
+
+static constexpr path PATHS[] = { path::scalar, path::sse, path::avx2 };
+
+/**
+* Runs the SIMD part of math::batch::detail::fn on path "p". @return Number of elements it handled, the rest is left to the scalar loop.
+*/
+#if MATH_SIMD_SSE2
+#define BATCH_SIMD_PART(p, fn, ...) ((p) == path::sse ? math::batch::detail::fn##_sse(__VA_ARGS__) : (p) == path::avx2 ? math::batch::detail::fn##_avx2(__VA_ARGS__) : size_t{ 0 })
+#else
+#define BATCH_SIMD_PART(p, fn, ...) size_t{ 0 }
+#endif
+
+static auto widen(math::mat4 const& m) -> matrix64
+{
+	matrix64 res;
+
+	for (size_t i = 0; i < 16; ++i)
+	{
+		(&res.m00)[i] = static_cast<float64>(m[i]);
+	}
+
+	return res;
+}
+
+/**
+* Normwise error relative to the largest element of the reference.
+*/
+static auto relative_error(math::mat4 const& value, matrix64 const& reference) -> float64
+{
+	float64 difference = 0.0;
+	float64 magnitude = 0.0;
+
+	for (size_t i = 0; i < 16; ++i)
+	{
+		difference = std::max(difference, std::fabs(static_cast<float64>(value[i]) - reference[i]));
+		magnitude = std::max(magnitude, std::fabs(reference[i]));
+	}
+
+	return difference / magnitude;
+}
+
+static auto random_vector(tests::rng& random, float32 lo, float32 hi) -> math::vec3
+{
+	return math::vec3{ random.next_float(lo, hi), random.next_float(lo, hi), random.next_float(lo, hi) };
+}
+
+/**
+* Rotation, non uniform scale and translation, the matrices a scene hierarchy is made of.
+*/
+static auto random_affine(tests::rng& random) -> math::mat4
+{
+	math::vec3 axis = random_vector(random, -1.f, 1.f);
+	axis.x += 0.01f;
+
+	math::mat4 m = math::rotated(math::mat4{ 1.f }, random.next_float(-3.14f, 3.14f), axis);
+	m = math::scaled(m, random_vector(random, 0.5f, 2.f));
+	m = math::translated(m, random_vector(random, -10.f, 10.f));
+
+	return m;
+}
+
+/**
+* Components stored one array each, with views for the kernels.
+*/
+struct soa
+{
+	lib::array<float32> x;
+	lib::array<float32> y;
+	lib::array<float32> z;
+
+	soa(size_t count)
+	{
+		x.resize(count);
+		y.resize(count);
+		z.resize(count);
+	}
+
+	auto view() const -> math::batch::vector3_view
+	{
+		return math::batch::vector3_view{ { x.data(), x.size() }, { y.data(), y.size() }, { z.data(), z.size() } };
+	}
+
+	auto span() -> math::batch::vector3_span
+	{
+		return math::batch::vector3_span{ { x.data(), x.size() }, { y.data(), y.size() }, { z.data(), z.size() } };
+	}
+};
+
+static auto random_soa(tests::rng& random, float32 lo, float32 hi) -> soa
+{
+	soa values{ COUNT };
+
+	for (size_t i = 0; i < COUNT; ++i)
+	{
+		values.x[i] = random.next_float(lo, hi);
+		values.y[i] = random.next_float(lo, hi);
+		values.z[i] = random.next_float(lo, hi);
+	}
+
+	return values;
+}
+
+static auto transform(path p, math::mat4 const& m, math::batch::vector3_view in, math::batch::vector3_span out, float32 w) -> void
+{
+	size_t done = 0;
+
+#if MATH_SIMD_SSE2
+	if (p == path::sse)
+	{
+		done = math::batch::detail::transform_sse(m, in, out, w);
+	}
+	else if (p == path::avx2)
+	{
+		done = math::batch::detail::transform_avx2(m, in, out, w);
+	}
+#endif
+
+	math::batch::detail::transform_scalar(m, in, out, w, done);
+}
+
+/**
+* @return The largest error of the transformed components, each relative to the sum of the magnitudes of its terms.
+*/
+static auto transform_error(math::mat4 const& m, soa const& in, soa const& out, float64 w) -> float64
+{
+	matrix64 const m64 = widen(m);
+	matrix64 magnitude64;
+
+	for (size_t i = 0; i < 16; ++i)
+	{
+		(&magnitude64.m00)[i] = std::fabs(m64[i]);
+	}
+
+	float64 error = 0.0;
+
+	for (size_t i = 0; i < COUNT; ++i)
+	{
+		vector64 const v{ in.x[i], in.y[i], in.z[i], w };
+		vector64 const expected = m64 * v;
+		vector64 const magnitude = magnitude64 * vector64{ std::fabs(v.x), std::fabs(v.y), std::fabs(v.z), std::fabs(w) };
+
+		error = std::max(error, std::fabs(out.x[i] - expected.x) / magnitude.x);
+		error = std::max(error, std::fabs(out.y[i] - expected.y) / magnitude.y);
+		error = std::max(error, std::fabs(out.z[i] - expected.z) / magnitude.z);
+	}
+
+	return error;
+}
+
+static auto test_transform(tests::rng& random) -> void
+{
+	math::mat4 const m = random_affine(random);
+	soa const in = random_soa(random, -100.f, 100.f);
+
+	for (path p : PATHS)
+	{
+		if (!supported(p))
+		{
+			continue;
+		}
+
+		soa points{ COUNT };
+		soa directions{ COUNT };
+
+		transform(p, m, in.view(), points.span(), 1.f);
+		transform(p, m, in.view(), directions.span(), 0.f);
+
+		float64 const pointError = transform_error(m, in, points, 1.0);
+		float64 const directionError = transform_error(m, in, directions, 0.0);
+
+		fmt::print("transform {:<6} points {:.2e}, directions {:.2e} (bound {:.0e})\n", path_name(p), pointError, directionError, TRANSFORM_BOUND);
+		CHECK(pointError <= TRANSFORM_BOUND);
+		CHECK(directionError <= TRANSFORM_BOUND);
+	}
+
+	// The public functions pick a path themselves and may transform in place.
+	soa inPlace = in;
+
+	math::batch::transform_points(m, inPlace.view(), inPlace.span());
+	CHECK(transform_error(m, in, inPlace, 1.0) <= TRANSFORM_BOUND);
+
+	inPlace = in;
+
+	math::batch::transform_directions(m, inPlace.view(), inPlace.span());
+	CHECK(transform_error(m, in, inPlace, 0.0) <= TRANSFORM_BOUND);
+}
+
+/**
+* Random parents that come before their children, with a root every so often. Picking any earlier node keeps the hierarchy a few levels deep, so that the rounding has something to accumulate over.
+*/
+static auto test_hierarchy(tests::rng& random) -> void
+{
+	lib::array<math::mat4> local;
+	lib::array<uint32> parents;
+
+	for (size_t i = 0; i < COUNT; ++i)
+	{
+		local.push_back(random_affine(random));
+		parents.push_back((i == 0 || random.next_below(16) == 0) ? math::batch::no_parent_v : static_cast<uint32>(random.next_below(i)));
+	}
+
+	lib::array<matrix64> expected;
+	lib::array<math::mat4> world;
+	world.resize(COUNT);
+
+	for (size_t i = 0; i < COUNT; ++i)
+	{
+		expected.push_back((parents[i] == math::batch::no_parent_v) ? widen(local[i]) : expected[parents[i]] * widen(local[i]));
+	}
+
+	math::batch::compose_world_matrices({ local.data(), local.size() }, { parents.data(), parents.size() }, { world.data(), world.size() });
+
+	float64 error = 0.0;
+
+	for (size_t i = 0; i < COUNT; ++i)
+	{
+		error = std::max(error, relative_error(world[i], expected[i]));
+	}
+
+	fmt::print("hierarchy        {:.2e} (bound {:.0e})\n", error, HIERARCHY_BOUND);
+	CHECK(error <= HIERARCHY_BOUND);
+}
+
+/**
+* Gribb-Hartmann in float64, the planes math::batch::extract_frustum() has to match.
+*/
+static auto reference_planes(math::mat4 const& viewProjection, vector64 (&planes)[6]) -> void
+{
+	matrix64 const m = widen(viewProjection);
+
+	vector64 const row0{ m.m00, m.m10, m.m20, m.m30 };
+	vector64 const row1{ m.m01, m.m11, m.m21, m.m31 };
+	vector64 const row2{ m.m02, m.m12, m.m22, m.m32 };
+	vector64 const row3{ m.m03, m.m13, m.m23, m.m33 };
+
+	planes[0] = row3 + row0;
+	planes[1] = row3 - row0;
+	planes[2] = row3 + row1;
+	planes[3] = row3 - row1;
+	planes[4] = row2;
+	planes[5] = row3 - row2;
+
+	for (vector64& plane : planes)
+	{
+		plane /= std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+	}
+}
+
+/**
+* Right handed with Vulkan's [0, 1] depth range, the projection extract_frustum() is written for.
+*/
+static auto projection(float32 fov, float32 aspect, float32 znear, float32 zfar) -> math::mat4
+{
+	float32 const f = 1.f / std::tan(fov * 0.5f);
+	math::mat4 res{ 0.f };
+
+	res.m00 = f / aspect;
+	res.m11 = -f;
+	res.m22 = zfar / (znear - zfar);
+	res.m23 = -1.f;
+	res.m32 = -(zfar * znear) / (zfar - znear);
+
+	return res;
+}
+
+/**
+* How the visibility of one object compares with the float64 reference.
+*/
+struct cull_result
+{
+	size_t visible = 0;
+	size_t borderline = 0;
+	size_t wrong = 0;
+
+	auto add(bool value, float64 margin, float64 scale) -> void
+	{
+		bool const expected = margin >= 0.0;
+
+		visible += expected ? 1 : 0;
+
+		if (std::fabs(margin) <= CULL_MARGIN * scale)
+		{
+			++borderline;
+		}
+		else if (value != expected)
+		{
+			++wrong;
+		}
+	}
+};
+
+static auto is_visible(std::span<uint64 const> visibility, size_t index) -> bool
+{
+	return (visibility[index >> 6] >> (index & 63)) & 1;
+}
+
+static auto cull_spheres(path p, math::batch::frustum const& f, math::batch::vector3_view centers, std::span<float32 const> radii, std::span<uint64> visibility) -> void
+{
+	std::fill(visibility.begin(), visibility.end(), uint64{ 0 });
+
+	size_t done = 0;
+
+#if MATH_SIMD_SSE2
+	if (p == path::sse)
+	{
+		done = math::batch::detail::cull_spheres_sse(f, centers, radii, visibility);
+	}
+	else if (p == path::avx2)
+	{
+		done = math::batch::detail::cull_spheres_avx2(f, centers, radii, visibility);
+	}
+#endif
+
+	for (size_t i = done; i < centers.size(); ++i)
+	{
+		if (math::batch::detail::sphere_visible(f, centers.x[i], centers.y[i], centers.z[i], radii[i]))
+		{
+			math::batch::detail::set_visible(visibility, i);
+		}
+	}
+}
+
+static auto cull_aabbs(path p, math::batch::frustum const& f, math::batch::vector3_view centers, math::batch::vector3_view extents, std::span<uint64> visibility) -> void
+{
+	std::fill(visibility.begin(), visibility.end(), uint64{ 0 });
+
+	size_t done = 0;
+
+#if MATH_SIMD_SSE2
+	if (p == path::sse)
+	{
+		done = math::batch::detail::cull_aabbs_sse(f, centers, extents, visibility);
+	}
+	else if (p == path::avx2)
+	{
+		done = math::batch::detail::cull_aabbs_avx2(f, centers, extents, visibility);
+	}
+#endif
+
+	for (size_t i = done; i < centers.size(); ++i)
+	{
+		if (math::batch::detail::aabb_visible(f, centers.x[i], centers.y[i], centers.z[i], extents.x[i], extents.y[i], extents.z[i]))
+		{
+			math::batch::detail::set_visible(visibility, i);
+		}
+	}
+}
+
+/**
+* Objects scattered around a camera so that some are inside, some outside and some straddle a plane. Objects within CULL_MARGIN of a plane are counted but not checked.
+*/
+static auto test_culling(tests::rng& random) -> void
+{
+	math::vec3 const eye = random_vector(random, -20.f, 20.f);
+	math::mat4 const viewProjection = projection(1.2f, 1.6f, 0.1f, 200.f) * math::look_at_rh(eye, math::vec3{ 0.f }, math::vec3{ 0.f, 1.f, 0.f });
+
+	vector64 planes[6];
+	reference_planes(viewProjection, planes);
+
+	math::batch::frustum const f = math::batch::extract_frustum(viewProjection);
+	float64 planeError = 0.0;
+
+	for (size_t i = 0; i < 6; ++i)
+	{
+		planeError = std::max(planeError, std::fabs(f.planes[i].x - planes[i].x) + std::fabs(f.planes[i].y - planes[i].y) + std::fabs(f.planes[i].z - planes[i].z));
+		planeError = std::max(planeError, std::fabs(f.planes[i].w - planes[i].w) / std::max(1.0, std::fabs(planes[i].w)));
+	}
+
+	fmt::print("frustum planes   {:.2e} (bound {:.0e})\n", planeError, PLANE_BOUND);
+	CHECK(planeError <= PLANE_BOUND);
+
+	soa const centers = random_soa(random, -150.f, 150.f);
+	soa const extents = random_soa(random, 0.f, 10.f);
+	lib::array<float32> radii;
+
+	for (size_t i = 0; i < COUNT; ++i)
+	{
+		radii.push_back(random.next_float(0.f, 10.f));
+	}
+
+	lib::array<uint64> visibility;
+	visibility.resize(math::batch::visibility_words(COUNT));
+
+	for (path p : PATHS)
+	{
+		if (!supported(p))
+		{
+			continue;
+		}
+
+		cull_result spheres;
+		cull_result boxes;
+
+		cull_spheres(p, f, centers.view(), { radii.data(), radii.size() }, { visibility.data(), visibility.size() });
+
+		for (size_t i = 0; i < COUNT; ++i)
+		{
+			float64 margin = std::numeric_limits<float64>::max();
+
+			for (vector64 const& plane : planes)
+			{
+				margin = std::min(margin, plane.x * centers.x[i] + plane.y * centers.y[i] + plane.z * centers.z[i] + plane.w + radii[i]);
+			}
+
+			spheres.add(is_visible({ visibility.data(), visibility.size() }, i), margin, std::fabs(centers.x[i]) + std::fabs(centers.y[i]) + std::fabs(centers.z[i]) + radii[i] + 1.0);
+		}
+
+		cull_aabbs(p, f, centers.view(), extents.view(), { visibility.data(), visibility.size() });
+
+		for (size_t i = 0; i < COUNT; ++i)
+		{
+			float64 margin = std::numeric_limits<float64>::max();
+
+			for (vector64 const& plane : planes)
+			{
+				float64 const reach = std::fabs(plane.x) * extents.x[i] + std::fabs(plane.y) * extents.y[i] + std::fabs(plane.z) * extents.z[i];
+
+				margin = std::min(margin, plane.x * centers.x[i] + plane.y * centers.y[i] + plane.z * centers.z[i] + plane.w + reach);
+			}
+
+			boxes.add(is_visible({ visibility.data(), visibility.size() }, i), margin, std::fabs(centers.x[i]) + std::fabs(centers.y[i]) + std::fabs(centers.z[i]) + extents.x[i] + extents.y[i] + extents.z[i] + 1.0);
+		}
+
+		fmt::print("cull {:<6} spheres {} visible, {} borderline, {} wrong; boxes {} visible, {} borderline, {} wrong\n", path_name(p), spheres.visible, spheres.borderline, spheres.wrong, boxes.visible, boxes.borderline, boxes.wrong);
+
+		// Without both outcomes the comparison proves little.
+		CHECK(spheres.visible > 0 && spheres.visible < COUNT);
+		CHECK(boxes.visible > 0 && boxes.visible < COUNT);
+		CHECK(spheres.wrong == 0);
+		CHECK(boxes.wrong == 0);
+	}
+
+	// Bits past the last object stay clear.
+	math::batch::cull_spheres(f, centers.view(), { radii.data(), radii.size() }, { visibility.data(), visibility.size() });
+	CHECK((visibility.back() >> (COUNT & 63)) == 0);
+}
+
+static auto widen(math::quat const& q) -> math::dquat
+{
+	return math::dquat{ q.w, q.x, q.y, q.z };
+}
+
+/**
+* @return The largest difference of any component, the quaternions being compared are all unit length.
+*/
+static auto quaternion_error(math::quat const& value, math::dquat const& reference) -> float64
+{
+	return std::max({
+		std::fabs(value.w - reference.w),
+		std::fabs(value.x - reference.x),
+		std::fabs(value.y - reference.y),
+		std::fabs(value.z - reference.z)
+	});
+}
+
+static auto random_quaternion(tests::rng& random) -> math::quat
+{
+	math::dquat q{ random.next_float(-1.f, 1.f), random.next_float(-1.f, 1.f), random.next_float(-1.f, 1.f), random.next_float(-1.f, 1.f) };
+	q = math::normalized(q);
+
+	return math::quat{ static_cast<float32>(q.w), static_cast<float32>(q.x), static_cast<float32>(q.y), static_cast<float32>(q.z) };
+}
+
+/**
+* Pairs that are far apart, on opposite hemispheres, and a few ULP to a few degrees apart, where the slerp weights divide by almost nothing.
+*/
+static auto random_pair(tests::rng& random, math::quat& from, math::quat& to) -> void
+{
+	from = random_quaternion(random);
+
+	switch (random.next_below(4))
+	{
+	case 0:
+		to = random_quaternion(random);
+		break;
+	case 1:
+		to = random_quaternion(random) * -1.f;
+		break;
+	case 2:
+		to = math::normalized(from + math::quat{ random.next_float(-1e-6f, 1e-6f), random.next_float(-1e-6f, 1e-6f), 0.f, 0.f });
+		break;
+	default:
+		to = math::normalized(from + random_quaternion(random) * 0.05f) * -1.f;
+		break;
+	}
+}
+
+static auto reference_nlerp(math::dquat const& from, math::dquat to, float64 t) -> math::dquat
+{
+	if (math::dot(from, to) < 0.0)
+	{
+		to = to * -1.0;
+	}
+
+	return math::normalized(from + (to - from) * t);
+}
+
+static auto reference_slerp(math::dquat const& from, math::dquat to, float64 t) -> math::dquat
+{
+	float64 cosine = math::dot(from, to);
+
+	if (cosine < 0.0)
+	{
+		to = to * -1.0;
+		cosine = -cosine;
+	}
+
+	float64 const angle = std::acos(std::min(cosine, 1.0));
+
+	if (angle < 1e-9)
+	{
+		return from * (1.0 - t) + to * t;
+	}
+
+	return from * (std::sin((1.0 - t) * angle) / std::sin(angle)) + to * (std::sin(t * angle) / std::sin(angle));
+}
+
+static auto test_quaternions(tests::rng& random) -> void
+{
+	lib::array<math::quat> raw;
+	lib::array<math::quat> l;
+	lib::array<math::quat> r;
+	lib::array<float32> weights;
+
+	for (size_t i = 0; i < COUNT; ++i)
+	{
+		raw.push_back(math::quat{ random.next_float(-2.f, 2.f), random.next_float(-2.f, 2.f), random.next_float(-2.f, 2.f), random.next_float(-2.f, 2.f) });
+
+		math::quat from;
+		math::quat to;
+		random_pair(random, from, to);
+
+		l.push_back(from);
+		r.push_back(to);
+		weights.push_back(random.next_below(8) == 0 ? static_cast<float32>(random.next_below(2)) : random.next_float(0.f, 1.f));
+	}
+
+	// Zero length quaternions normalize to the identity, one on every SIMD path and one in the scalar remainder.
+	raw[5] = math::quat{ 0.f, 0.f, 0.f, 0.f };
+	raw[COUNT - 1] = math::quat{ 0.f, 0.f, 0.f, 0.f };
+
+	std::span<math::quat const> const rawSpan{ raw.data(), raw.size() };
+	std::span<math::quat const> const from{ l.data(), l.size() };
+	std::span<math::quat const> const to{ r.data(), r.size() };
+	std::span<float32 const> const t{ weights.data(), weights.size() };
+
+	lib::array<math::quat> out;
+	out.resize(COUNT);
+	std::span<math::quat> const outSpan{ out.data(), out.size() };
+
+	for (path p : PATHS)
+	{
+		if (!supported(p))
+		{
+			continue;
+		}
+
+		float64 normalizeError = 0.0;
+		float64 multiplyError = 0.0;
+		float64 nlerpError = 0.0;
+		float64 slerpError = 0.0;
+
+		for (size_t i = BATCH_SIMD_PART(p, normalize, rawSpan, outSpan); i < COUNT; ++i)
+		{
+			out[i] = math::normalized(raw[i]);
+		}
+
+		for (size_t i = 0; i < COUNT; ++i)
+		{
+			normalizeError = std::max(normalizeError, quaternion_error(out[i], (i == 5 || i == COUNT - 1) ? math::dquat{} : math::normalized(widen(raw[i]))));
+		}
+
+		for (size_t i = BATCH_SIMD_PART(p, multiply, from, to, outSpan); i < COUNT; ++i)
+		{
+			out[i] = l[i] * r[i];
+		}
+
+		for (size_t i = 0; i < COUNT; ++i)
+		{
+			multiplyError = std::max(multiplyError, quaternion_error(out[i], widen(l[i]) * widen(r[i])));
+		}
+
+		for (size_t i = BATCH_SIMD_PART(p, nlerp, from, to, t, outSpan); i < COUNT; ++i)
+		{
+			out[i] = math::batch::detail::nlerp_scalar(l[i], r[i], weights[i]);
+		}
+
+		for (size_t i = 0; i < COUNT; ++i)
+		{
+			nlerpError = std::max(nlerpError, quaternion_error(out[i], reference_nlerp(widen(l[i]), widen(r[i]), weights[i])));
+		}
+
+		for (size_t i = BATCH_SIMD_PART(p, slerp, from, to, t, outSpan); i < COUNT; ++i)
+		{
+			out[i] = math::batch::detail::slerp_scalar(l[i], r[i], weights[i]);
+		}
+
+		for (size_t i = 0; i < COUNT; ++i)
+		{
+			slerpError = std::max(slerpError, quaternion_error(out[i], reference_slerp(widen(l[i]), widen(r[i]), weights[i])));
+		}
+
+		fmt::print("quaternion {:<6} normalize {:.2e}, multiply {:.2e}, nlerp {:.2e} (bound {:.0e}), slerp {:.2e} (bound {:.0e})\n", path_name(p), normalizeError, multiplyError, nlerpError, QUATERNION_BOUND, slerpError, SLERP_BOUND);
+		CHECK(normalizeError <= QUATERNION_BOUND);
+		CHECK(multiplyError <= QUATERNION_BOUND);
+		CHECK(nlerpError <= QUATERNION_BOUND);
+		CHECK(slerpError <= SLERP_BOUND);
+	}
+
+	// The public functions pick a path themselves, "out" may be one of the inputs.
+	std::copy(l.begin(), l.end(), out.begin());
+	math::batch::slerp_quaternions({ out.data(), out.size() }, to, t, outSpan);
+
+	float64 slerpError = 0.0;
+
+	for (size_t i = 0; i < COUNT; ++i)
+	{
+		slerpError = std::max(slerpError, quaternion_error(out[i], reference_slerp(widen(l[i]), widen(r[i]), weights[i])));
+	}
+
+	CHECK(slerpError <= SLERP_BOUND);
+}
+
+static auto test_compose(tests::rng& random) -> void
+{
+	lib::array<math::quat> rotations;
+
+	for (size_t i = 0; i < COUNT; ++i)
+	{
+		rotations.push_back(random_quaternion(random));
+	}
+
+	soa const translations = random_soa(random, -100.f, 100.f);
+	soa const scales = random_soa(random, 0.1f, 10.f);
+
+	std::span<math::quat const> const rotationSpan{ rotations.data(), rotations.size() };
+
+	lib::array<math::mat4> out;
+	out.resize(COUNT);
+	std::span<math::mat4> const outSpan{ out.data(), out.size() };
+
+	for (path p : PATHS)
+	{
+		if (!supported(p))
+		{
+			continue;
+		}
+
+		for (size_t i = BATCH_SIMD_PART(p, compose, rotationSpan, translations.view(), scales.view(), outSpan); i < COUNT; ++i)
+		{
+			math::batch::detail::compose_scalar(rotations[i], translations.x[i], translations.y[i], translations.z[i], scales.x[i], scales.y[i], scales.z[i], out[i]);
+		}
+
+		float64 error = 0.0;
+
+		for (size_t i = 0; i < COUNT; ++i)
+		{
+			matrix64 const expected =
+				math::translated(matrix64{ 1.0 }, vector3_64{ translations.x[i], translations.y[i], translations.z[i] }) *
+				math::mat4_cast(widen(rotations[i])) *
+				math::scaled(matrix64{ 1.0 }, vector3_64{ scales.x[i], scales.y[i], scales.z[i] });
+
+			error = std::max(error, relative_error(out[i], expected));
+		}
+
+		fmt::print("compose {:<6}   {:.2e} (bound {:.0e})\n", path_name(p), error, TRANSFORM_BOUND);
+		CHECK(error <= TRANSFORM_BOUND);
+	}
+}
+
+auto main() -> int
+{
+	tests::rng random{ 43 };
+
+	test_transform(random);
+	test_hierarchy(random);
+	test_culling(random);
+	test_quaternions(random);
+	test_compose(random);
+
+	return tests::report("math_batch");
+}
@@ -0,0 +1,399 @@
+#include <cmath>
+#include "lib/array.hpp"
+#include "check.hpp"
+#include "math/pack.h"
+
+/**
+* Round trips through every math::pack format. The bulk forms have to agree with the scalar ones bit for bit, and scalar halves with F16C.
+* The counts are not a multiple of the SIMD width so that the scalar tails of the bulk forms run too.
+*/
+static constexpr size_t VALUE_COUNT = (1 << 16) + 5;
+
+static auto random_floats(tests::rng& random, float32 lo, float32 hi) -> lib::array<float32>
+{
+	lib::array<float32> values;
+	values.reserve(VALUE_COUNT);
+
+	for (size_t i = 0; i < VALUE_COUNT; ++i)
+	{
+		values.push_back(random.next_float(lo, hi));
+	}
+
+	return values;
+}
+
+/**
+* Floats with exponents spread evenly over [minExponent, maxExponent) and either sign.
+*/
+static auto random_magnitudes(tests::rng& random, int32 minExponent, int32 maxExponent, bool negative) -> lib::array<float32>
+{
+	lib::array<float32> values;
+	values.reserve(VALUE_COUNT);
+
+	for (size_t i = 0; i < VALUE_COUNT; ++i)
+	{
+		uint32 const exponent = static_cast<uint32>(minExponent + static_cast<int32>(random.next_below(static_cast<uint64>(maxExponent - minExponent))) + 127);
+		uint32 const mantissa = static_cast<uint32>(random.next()) & 0x007FFFFFu;
+		uint32 const sign = (negative && (random.next() & 1)) ? 0x80000000u : 0u;
+
+		values.push_back(std::bit_cast<float32>(sign | (exponent << 23) | mantissa));
+	}
+
+	return values;
+}
+
+static auto same_bits(float32 a, float32 b) -> bool
+{
+	return std::bit_cast<uint32>(a) == std::bit_cast<uint32>(b) || (std::isnan(a) && std::isnan(b));
+}
+
+static auto test_half(tests::rng& random) -> void
+{
+	// Every half survives a trip through float32.
+	for (uint32 code = 0; code <= 0xFFFFu; ++code)
+	{
+		uint16 const half = static_cast<uint16>(code);
+		float32 const value = math::pack::half_to_float(half);
+
+		if (std::isnan(value))
+		{
+			CHECK((math::pack::float_to_half(value) & 0x7C00u) == 0x7C00u && (math::pack::float_to_half(value) & 0x03FFu) != 0);
+			continue;
+		}
+
+		CHECK(math::pack::float_to_half(value) == half);
+	}
+
+	// Normals, subnormals, values that overflow to infinity and the special values.
+	lib::array<float32> in = random_magnitudes(random, -30, 20, true);
+
+	in[0] = 0.f;
+	in[1] = -0.f;
+	in[2] = std::numeric_limits<float32>::infinity();
+	in[3] = -std::numeric_limits<float32>::infinity();
+	in[4] = std::numeric_limits<float32>::quiet_NaN();
+	in[5] = 65504.f;
+	in[6] = 65520.f;	// Halfway to the next power of two, rounds to infinity.
+
+	lib::array<uint16> scalar;
+	lib::array<uint16> bulk;
+	scalar.resize(in.size());
+	bulk.resize(in.size());
+
+	for (size_t i = 0; i < in.size(); ++i)
+	{
+		scalar[i] = math::pack::float_to_half(in[i]);
+	}
+
+	math::pack::float_to_half(std::span{ in.data(), in.size() }, std::span{ bulk.data(), bulk.size() });
+
+	for (size_t i = 0; i < in.size(); ++i)
+	{
+		CHECK(same_bits(math::pack::half_to_float(bulk[i]), math::pack::half_to_float(scalar[i])));
+
+		// Half has 11 significant bits, so rounding is off by at most 2^-11 relative to the input within the normal range.
+		float32 const magnitude = std::fabs(in[i]);
+
+		if (magnitude >= 0x1.0p-14f && magnitude <= 65504.f)
+		{
+			CHECK(std::fabs(math::pack::half_to_float(scalar[i]) - in[i]) <= magnitude * 0x1.0p-11f);
+		}
+	}
+
+	lib::array<float32> back;
+	back.resize(in.size());
+
+	math::pack::half_to_float(std::span<uint16 const>{ bulk.data(), bulk.size() }, std::span{ back.data(), back.size() });
+
+	for (size_t i = 0; i < in.size(); ++i)
+	{
+		CHECK(same_bits(back[i], math::pack::half_to_float(bulk[i])));
+	}
+
+#if MATH_SIMD_SSE2
+	if (math::simd::cpu_supports_f16c())
+	{
+		lib::array<uint16> f16c;
+		f16c.resize(in.size());
+
+		size_t const done = math::pack::detail::float_to_half_f16c(std::span{ in.data(), in.size() }, std::span{ f16c.data(), f16c.size() });
+
+		for (size_t i = 0; i < done; ++i)
+		{
+			CHECK(same_bits(math::pack::half_to_float(f16c[i]), math::pack::half_to_float(scalar[i])));
+		}
+
+		lib::array<uint16> codes;
+		lib::array<float32> widened;
+
+		for (uint32 code = 0; code <= 0xFFFFu; ++code)
+		{
+			codes.push_back(static_cast<uint16>(code));
+		}
+
+		widened.resize(codes.size());
+		math::pack::detail::half_to_float_f16c(std::span<uint16 const>{ codes.data(), codes.size() }, std::span{ widened.data(), widened.size() });
+
+		for (size_t i = 0; i < codes.size(); ++i)
+		{
+			CHECK(same_bits(widened[i], math::pack::half_to_float(codes[i])));
+		}
+	}
+	else
+	{
+		fmt::print("half: no F16C on this CPU, only the scalar form was checked.\n");
+	}
+#endif
+}
+
+/**
+* Decoding an encoded value must land within half a step of the clamped input, every code must survive decoding and the bulk forms must match the scalar ones.
+*/
+template <typename T, auto encode, auto decode, auto encode_bulk, auto decode_bulk>
+static auto test_norm(tests::rng& random, float32 lo, float32 steps) -> void
+{
+	lib::array<float32> const in = random_floats(random, lo - 0.5f, 1.5f);
+	lib::array<T> scalar;
+	lib::array<T> bulk;
+	lib::array<float32> back;
+	scalar.resize(in.size());
+	bulk.resize(in.size());
+	back.resize(in.size());
+
+	for (size_t i = 0; i < in.size(); ++i)
+	{
+		scalar[i] = encode(in[i]);
+
+		float32 const clamped = std::clamp(in[i], lo, 1.f);
+		CHECK(std::fabs(decode(scalar[i]) - clamped) <= 0.5f / steps + 1e-6f);
+	}
+
+	encode_bulk(std::span<float32 const>{ in.data(), in.size() }, std::span{ bulk.data(), bulk.size() });
+	decode_bulk(std::span<T const>{ bulk.data(), bulk.size() }, std::span{ back.data(), back.size() });
+
+	for (size_t i = 0; i < in.size(); ++i)
+	{
+		CHECK(bulk[i] == scalar[i]);
+		CHECK(same_bits(back[i], decode(scalar[i])));
+	}
+
+	// The most negative snorm code decodes to -1 like the one above it, so it is the only one that does not come back.
+	for (int32 code = std::numeric_limits<T>::min() + (lo < 0.f ? 1 : 0); code <= std::numeric_limits<T>::max(); ++code)
+	{
+		CHECK(encode(decode(static_cast<T>(code))) == static_cast<T>(code));
+	}
+
+	CHECK(encode(std::numeric_limits<float32>::quiet_NaN()) == encode(lo));
+}
+
+static auto test_octahedral(tests::rng& random) -> void
+{
+	lib::array<float32> x;
+	lib::array<float32> y;
+	lib::array<float32> z;
+
+	// Uniform on the sphere, plus the axes, where the folding switches sides.
+	for (size_t i = 0; i < VALUE_COUNT; ++i)
+	{
+		float32 const cosTheta = random.next_float(-1.f, 1.f);
+		float32 const phi = random.next_float(0.f, 6.2831853f);
+		float32 const sinTheta = std::sqrt(std::max(0.f, 1.f - cosTheta * cosTheta));
+
+		x.push_back(sinTheta * std::cos(phi));
+		y.push_back(sinTheta * std::sin(phi));
+		z.push_back(cosTheta);
+	}
+
+	float32 const axes[6][3] = { { 1.f, 0.f, 0.f }, { -1.f, 0.f, 0.f }, { 0.f, 1.f, 0.f }, { 0.f, -1.f, 0.f }, { 0.f, 0.f, 1.f }, { 0.f, 0.f, -1.f } };
+
+	for (size_t i = 0; i < 6; ++i)
+	{
+		x[i] = axes[i][0];
+		y[i] = axes[i][1];
+		z[i] = axes[i][2];
+	}
+
+	lib::array<uint32> scalar;
+	lib::array<uint32> bulk;
+	lib::array<float32> bx;
+	lib::array<float32> by;
+	lib::array<float32> bz;
+	scalar.resize(x.size());
+	bulk.resize(x.size());
+	bx.resize(x.size());
+	by.resize(x.size());
+	bz.resize(x.size());
+
+	float64 maxDegrees = 0.0;
+
+	for (size_t i = 0; i < x.size(); ++i)
+	{
+		scalar[i] = math::pack::octahedral_encode(math::vec3(x[i], y[i], z[i]));
+
+		// atan2 of the cross and dot products, acos of a dot product this close to 1 would be dominated by rounding.
+		math::vec3 const n = math::pack::octahedral_decode(scalar[i]);
+		float64 const cx = static_cast<float64>(n.y) * z[i] - static_cast<float64>(n.z) * y[i];
+		float64 const cy = static_cast<float64>(n.z) * x[i] - static_cast<float64>(n.x) * z[i];
+		float64 const cz = static_cast<float64>(n.x) * y[i] - static_cast<float64>(n.y) * x[i];
+		float64 const dot = static_cast<float64>(n.x) * x[i] + static_cast<float64>(n.y) * y[i] + static_cast<float64>(n.z) * z[i];
+
+		maxDegrees = std::max(maxDegrees, std::atan2(std::sqrt(cx * cx + cy * cy + cz * cz), dot) * 57.29577951308232);
+	}
+
+	fmt::print("octahedral: {:.4f} degrees\n", maxDegrees);
+	CHECK(maxDegrees <= 0.004);
+
+	math::batch::vector3_view const in{ std::span{ x.data(), x.size() }, std::span{ y.data(), y.size() }, std::span{ z.data(), z.size() } };
+	math::batch::vector3_span const out{ std::span{ bx.data(), bx.size() }, std::span{ by.data(), by.size() }, std::span{ bz.data(), bz.size() } };
+
+	math::pack::octahedral_encode(in, std::span{ bulk.data(), bulk.size() });
+	math::pack::octahedral_decode(std::span<uint32 const>{ bulk.data(), bulk.size() }, out);
+
+	for (size_t i = 0; i < x.size(); ++i)
+	{
+		CHECK(bulk[i] == scalar[i]);
+
+		math::vec3 const n = math::pack::octahedral_decode(scalar[i]);
+		CHECK(std::fabs(bx[i] - n.x) <= 1e-6f && std::fabs(by[i] - n.y) <= 1e-6f && std::fabs(bz[i] - n.z) <= 1e-6f);
+	}
+}
+
+static auto test_rgb9e5(tests::rng& random) -> void
+{
+	lib::array<float32> r = random_magnitudes(random, -20, 16, false);
+	lib::array<float32> g = random_floats(random, 0.f, 1.f);
+	lib::array<float32> b = random_magnitudes(random, -20, 16, false);
+
+	for (size_t i = 0; i < g.size(); ++i)
+	{
+		g[i] *= r[i];
+	}
+
+	lib::array<uint32> scalar;
+	lib::array<uint32> bulk;
+	scalar.resize(r.size());
+	bulk.resize(r.size());
+
+	for (size_t i = 0; i < r.size(); ++i)
+	{
+		scalar[i] = math::pack::float_to_rgb9e5(math::vec3(r[i], g[i], b[i]));
+
+		// Every component is within half a step of the shared exponent's 9 bit mantissa.
+		math::vec3 const rgb = math::pack::rgb9e5_to_float(scalar[i]);
+		float32 const step = std::ldexp(1.f, static_cast<int32>(scalar[i] >> 27) - 15 - 9);
+		float32 const limit = math::pack::detail::rgb9e5_max_v;
+
+		CHECK(std::fabs(rgb.x - std::min(r[i], limit)) <= step * 0.5f);
+		CHECK(std::fabs(rgb.y - std::min(g[i], limit)) <= step * 0.5f);
+		CHECK(std::fabs(rgb.z - std::min(b[i], limit)) <= step * 0.5f);
+	}
+
+	math::batch::vector3_view const in{ std::span{ r.data(), r.size() }, std::span{ g.data(), g.size() }, std::span{ b.data(), b.size() } };
+	math::pack::float_to_rgb9e5(in, std::span{ bulk.data(), bulk.size() });
+
+	lib::array<float32> br;
+	lib::array<float32> bg;
+	lib::array<float32> bb;
+	br.resize(r.size());
+	bg.resize(r.size());
+	bb.resize(r.size());
+
+	math::pack::rgb9e5_to_float(std::span<uint32 const>{ bulk.data(), bulk.size() }, math::batch::vector3_span{ std::span{ br.data(), br.size() }, std::span{ bg.data(), bg.size() }, std::span{ bb.data(), bb.size() } });
+
+	for (size_t i = 0; i < r.size(); ++i)
+	{
+		CHECK(bulk[i] == scalar[i]);
+
+		math::vec3 const rgb = math::pack::rgb9e5_to_float(scalar[i]);
+		CHECK(same_bits(br[i], rgb.x) && same_bits(bg[i], rgb.y) && same_bits(bb[i], rgb.z));
+	}
+
+	math::vec3 const clamped = math::pack::rgb9e5_to_float(math::pack::float_to_rgb9e5(math::vec3(-1.f, std::numeric_limits<float32>::quiet_NaN(), 1e9f)));
+
+	CHECK(clamped.x == 0.f);
+	CHECK(clamped.y == 0.f);
+	CHECK(clamped.z == math::pack::detail::rgb9e5_max_v);
+}
+
+static auto test_r11g11b10f(tests::rng& random) -> void
+{
+	// Every finite code of each channel survives decoding, exponent 31 holds infinity and NaN.
+	for (uint32 code = 0; code < (31u << 6); ++code)
+	{
+		uint32 const packed = code | (code << 11) | ((code >> 1) << 22);
+		CHECK(math::pack::float_to_r11g11b10f(math::pack::r11g11b10f_to_float(packed)) == packed);
+	}
+
+	lib::array<float32> r = random_magnitudes(random, -14, 16, false);
+	lib::array<float32> g = random_magnitudes(random, -14, 16, false);
+	lib::array<float32> b = random_magnitudes(random, -14, 16, false);
+	lib::array<uint32> scalar;
+	lib::array<uint32> bulk;
+	scalar.resize(r.size());
+	bulk.resize(r.size());
+
+	for (size_t i = 0; i < r.size(); ++i)
+	{
+		scalar[i] = math::pack::float_to_r11g11b10f(math::vec3(r[i], g[i], b[i]));
+
+		// 6 and 5 mantissa bits round to within 2^-7 and 2^-6 of the value.
+		math::vec3 const rgb = math::pack::r11g11b10f_to_float(scalar[i]);
+		float32 const red = std::min(r[i], math::pack::detail::float11_max_v);
+		float32 const green = std::min(g[i], math::pack::detail::float11_max_v);
+		float32 const blue = std::min(b[i], math::pack::detail::float10_max_v);
+
+		CHECK(std::fabs(rgb.x - red) <= red * 0x1.0p-7f);
+		CHECK(std::fabs(rgb.y - green) <= green * 0x1.0p-7f);
+		CHECK(std::fabs(rgb.z - blue) <= blue * 0x1.0p-6f);
+	}
+
+	math::batch::vector3_view const in{ std::span{ r.data(), r.size() }, std::span{ g.data(), g.size() }, std::span{ b.data(), b.size() } };
+	math::pack::float_to_r11g11b10f(in, std::span{ bulk.data(), bulk.size() });
+
+	lib::array<float32> br;
+	lib::array<float32> bg;
+	lib::array<float32> bb;
+	br.resize(r.size());
+	bg.resize(r.size());
+	bb.resize(r.size());
+
+	math::pack::r11g11b10f_to_float(std::span<uint32 const>{ bulk.data(), bulk.size() }, math::batch::vector3_span{ std::span{ br.data(), br.size() }, std::span{ bg.data(), bg.size() }, std::span{ bb.data(), bb.size() } });
+
+	for (size_t i = 0; i < r.size(); ++i)
+	{
+		CHECK(bulk[i] == scalar[i]);
+
+		math::vec3 const rgb = math::pack::r11g11b10f_to_float(scalar[i]);
+		CHECK(same_bits(br[i], rgb.x) && same_bits(bg[i], rgb.y) && same_bits(bb[i], rgb.z));
+	}
+
+	math::vec3 const clamped = math::pack::r11g11b10f_to_float(math::pack::float_to_r11g11b10f(math::vec3(-1.f, std::numeric_limits<float32>::quiet_NaN(), 1e9f)));
+
+	CHECK(clamped.x == 0.f);
+	CHECK(clamped.y == 0.f);
+	CHECK(clamped.z == math::pack::detail::float10_max_v);
+}
+
+auto main() -> int
+{
+	tests::rng random{ 13 };
+
+	test_half(random);
+
+	using span_f = std::span<float32 const>;
+
+	test_norm<int8, [](float32 v) { return math::pack::float_to_snorm8(v); }, [](int8 v) { return math::pack::snorm8_to_float(v); },
+		[](span_f in, std::span<int8> out) { math::pack::float_to_snorm8(in, out); }, [](std::span<int8 const> in, std::span<float32> out) { math::pack::snorm8_to_float(in, out); }>(random, -1.f, 127.f);
+	test_norm<int16, [](float32 v) { return math::pack::float_to_snorm16(v); }, [](int16 v) { return math::pack::snorm16_to_float(v); },
+		[](span_f in, std::span<int16> out) { math::pack::float_to_snorm16(in, out); }, [](std::span<int16 const> in, std::span<float32> out) { math::pack::snorm16_to_float(in, out); }>(random, -1.f, 32767.f);
+	test_norm<uint8, [](float32 v) { return math::pack::float_to_unorm8(v); }, [](uint8 v) { return math::pack::unorm8_to_float(v); },
+		[](span_f in, std::span<uint8> out) { math::pack::float_to_unorm8(in, out); }, [](std::span<uint8 const> in, std::span<float32> out) { math::pack::unorm8_to_float(in, out); }>(random, 0.f, 255.f);
+	test_norm<uint16, [](float32 v) { return math::pack::float_to_unorm16(v); }, [](uint16 v) { return math::pack::unorm16_to_float(v); },
+		[](span_f in, std::span<uint16> out) { math::pack::float_to_unorm16(in, out); }, [](std::span<uint16 const> in, std::span<float32> out) { math::pack::unorm16_to_float(in, out); }>(random, 0.f, 65535.f);
+
+	test_octahedral(random);
+	test_rgb9e5(random);
+	test_r11g11b10f(random);
+
+	return tests::report("math_pack");
+}
@@ -0,0 +1,248 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "check.hpp"
+#include "math/matrix.h"
+#include "math/simd.h"
+
+/**
+* The float32 matrix4x4 functions that math/simd.h accelerates, against the same functions evaluated in float64 through the scalar templates.
+* Errors are measured relative to the largest element of the reference, element wise relative errors mean nothing for the elements that are close to zero.
+*/
+using matrix = math::matrix4x4<float32>;
+using matrix64 = math::matrix4x4<float64>;
+
+static constexpr size_t CASE_COUNT = 20'000;
+
+/**
+* A few ULP of rounding in a 4 term sum. The inverse bound is per unit of condition number, see check_inverse().
+*/
+static constexpr float64 MULTIPLY_BOUND	= 1e-6;
+static constexpr float64 INVERSE_BOUND	= 4.0 * std::numeric_limits<float32>::epsilon();
+static constexpr float64 VIEW_BOUND		= 1e-5;
+
+static auto widen(matrix const& m) -> matrix64
+{
+	matrix64 res;
+
+	for (size_t i = 0; i < 16; ++i)
+	{
+		(&res.m00)[i] = static_cast<float64>(m[i]);
+	}
+
+	return res;
+}
+
+static auto relative_error(matrix const& value, matrix64 const& reference) -> float64
+{
+	float64 difference = 0.0;
+	float64 magnitude = 0.0;
+
+	for (size_t i = 0; i < 16; ++i)
+	{
+		difference = std::max(difference, std::fabs(static_cast<float64>(value[i]) - reference[i]));
+		magnitude = std::max(magnitude, std::fabs(reference[i]));
+	}
+
+	return difference / magnitude;
+}
+
+/**
+* Elements in [-1, 1) plus 2 on the diagonal, which keeps most of them far from singular.
+*/
+static auto random_matrix(tests::rng& random) -> matrix
+{
+	matrix m;
+
+	for (size_t i = 0; i < 16; ++i)
+	{
+		(&m.m00)[i] = random.next_float(-1.f, 1.f) + ((i % 5 == 0) ? 2.f : 0.f);
+	}
+
+	return m;
+}
+
+static auto random_vector(tests::rng& random, float32 lo, float32 hi) -> math::vector3<float32>
+{
+	return math::vector3<float32>{ random.next_float(lo, hi), random.next_float(lo, hi), random.next_float(lo, hi) };
+}
+
+/**
+* Rotation, non uniform scale and translation, the kind of matrix inverse_affine() is meant for.
+*/
+static auto random_affine(tests::rng& random) -> matrix
+{
+	math::vector3<float32> axis = random_vector(random, -1.f, 1.f);
+	axis.x += 0.01f;
+
+	matrix m = math::rotated(matrix{ 1.f }, random.next_float(-3.14f, 3.14f), axis);
+	m = math::scaled(m, random_vector(random, 0.25f, 4.f));
+	m = math::translated(m, random_vector(random, -100.f, 100.f));
+
+	return m;
+}
+
+struct worst
+{
+	char const* name;
+	float64 bound;
+	float64 error = 0.0;
+
+	auto add(float64 e) -> void { error = std::max(error, e); }
+
+	auto check() const -> void
+	{
+		fmt::print("{:<15} {:.2e} (bound {:.1e})\n", name, error, bound);
+		CHECK(error <= bound);
+	}
+};
+
+static auto test_multiply_transpose(tests::rng& random) -> void
+{
+	worst multiply{ "multiply", MULTIPLY_BOUND };
+	bool transposeExact = true;
+
+	for (size_t i = 0; i < CASE_COUNT; ++i)
+	{
+		matrix const l = random_matrix(random);
+		matrix const r = random_matrix(random);
+
+		multiply.add(relative_error(l * r, widen(l) * widen(r)));
+
+		matrix const t = math::transpose(l);
+		matrix64 const t64 = math::transpose(widen(l));
+
+		for (size_t j = 0; j < 16; ++j)
+		{
+			transposeExact = transposeExact && static_cast<float64>(t[j]) == t64[j];
+		}
+	}
+
+	multiply.check();
+	CHECK(transposeExact);
+}
+
+static auto infinity_norm(matrix64 const& m) -> float64
+{
+	float64 norm = 0.0;
+
+	for (size_t row = 0; row < 4; ++row)
+	{
+		norm = std::max(norm, std::fabs(m[row * 4]) + std::fabs(m[row * 4 + 1]) + std::fabs(m[row * 4 + 2]) + std::fabs(m[row * 4 + 3]));
+	}
+
+	return norm;
+}
+
+/**
+* Even an exact inverse of the rounded input is off by the condition number times the rounding, so the error is divided by the condition number before it is held to the bound.
+*/
+static auto check_inverse(worst& general, worst& affine, matrix const& m, bool isAffine) -> void
+{
+	matrix64 const m64 = widen(m);
+	matrix64 const inverse64 = math::inverse(m64);
+	float64 const condition = infinity_norm(m64) * infinity_norm(inverse64);
+
+	general.add(relative_error(math::inverse(m), inverse64) / condition);
+
+	if (isAffine)
+	{
+		affine.add(relative_error(math::inverse_affine(m), math::inverse_affine(m64)) / condition);
+	}
+}
+
+static auto test_inverse(tests::rng& random) -> void
+{
+	worst general{ "inverse", INVERSE_BOUND };
+	worst affine{ "inverse_affine", INVERSE_BOUND };
+	worst reference{ "reference", 1e-12 };
+
+	for (size_t i = 0; i < CASE_COUNT; ++i)
+	{
+		matrix const m = random_matrix(random);
+		matrix const a = random_affine(random);
+
+		check_inverse(general, affine, m, false);
+		check_inverse(general, affine, a, true);
+
+		// The float64 reference has to hold up too, or the comparisons mean nothing.
+		reference.add(relative_error(matrix{ 1.f }, widen(m) * math::inverse(widen(m))));
+		reference.add(relative_error(matrix{ 1.f }, widen(a) * math::inverse_affine(widen(a))));
+	}
+
+	general.check();
+	affine.check();
+	reference.check();
+
+	// A singular matrix leaves the SIMD path and keeps the infinities of the scalar one.
+	matrix singular{ 1.f };
+	singular.m22 = 0.f;
+
+	CHECK(!std::isfinite(math::inverse(singular).m00));
+}
+
+static auto test_view_projection(tests::rng& random) -> void
+{
+	worst lookAt{ "look_at_rh", VIEW_BOUND };
+	worst perspective{ "perspective_rh", VIEW_BOUND };
+
+	for (size_t i = 0; i < CASE_COUNT; ++i)
+	{
+		math::vector3<float32> const eye = random_vector(random, -50.f, 50.f);
+		math::vector3<float32> const center = random_vector(random, -50.f, 50.f);
+		math::vector3<float32> const up{ 0.f, 1.f, 0.f };
+
+		// Looking almost straight up or down leaves the side vector ill defined.
+		math::vector3<float32> const direction = math::normalized(center - eye);
+
+		if (std::fabs(direction.y) > 0.99f)
+		{
+			continue;
+		}
+
+		lookAt.add(relative_error(
+			math::look_at_rh(eye, center, up),
+			math::look_at_rh(
+				math::vector3<float64>{ eye.x, eye.y, eye.z },
+				math::vector3<float64>{ center.x, center.y, center.z },
+				math::vector3<float64>{ up.x, up.y, up.z })
+		));
+
+		float32 const fov = random.next_float(0.2f, 2.5f);
+		float32 const aspect = random.next_float(0.5f, 3.f);
+		float32 const znear = random.next_float(0.01f, 1.f);
+		float32 const zfar = znear + random.next_float(10.f, 10'000.f);
+
+		perspective.add(relative_error(
+			math::perspective_rh(fov, aspect, znear, zfar),
+			math::perspective_rh<float64>(fov, aspect, znear, zfar)
+		));
+	}
+
+	lookAt.check();
+	perspective.check();
+}
+
+/**
+* Constant evaluation takes the scalar path.
+*/
+static_assert([]
+{
+	matrix const m = matrix{ 2.f } * matrix{ 3.f };
+	return m.m00 == 6.f && m.m33 == 6.f && m.m01 == 0.f;
+}());
+
+auto main() -> int
+{
+	tests::rng random{ 41 };
+
+#if MATH_SIMD_SSE2
+	fmt::print("SSE2 {}, SSE4.1 {}, AVX2 {}, FMA {}\n", MATH_SIMD_SSE2, MATH_SIMD_SSE41, MATH_SIMD_AVX2, MATH_SIMD_FMA);
+#endif
+
+	test_multiply_transpose(random);
+	test_inverse(random);
+	test_view_projection(random);
+
+	return tests::report("math_simd");
+}
@@ -0,0 +1,434 @@
+#include <thread>
+#include "lib/array.hpp"
+#include "lib/paged_array.hpp"
+#include "check.hpp"
+
+/**
+* lib::paged_array from several threads at once. Threads only count what went wrong, the checks run on the main thread after every thread has been joined.
+*/
+static constexpr uint32 THREAD_COUNT = 8;
+
+static std::atomic<int32> alive = 0;
+
+/**
+* Counts how many elements are alive, so that a slot that is destroyed twice or never shows up.
+*/
+struct element
+{
+	uint64 value;
+
+	element(uint64 v) : value{ v } { alive.fetch_add(1, std::memory_order_relaxed); }
+	element(element const& other) : value{ other.value } { alive.fetch_add(1, std::memory_order_relaxed); }
+	~element() { alive.fetch_sub(1, std::memory_order_relaxed); }
+};
+
+static auto tag(uint64 thread, uint64 sequence) -> uint64
+{
+	return (thread << 32) | sequence;
+}
+
+template <typename paged_array_type>
+struct live_element
+{
+	typename paged_array_type::index index;
+	uint64 value;
+};
+
+/**
+* Runs "fn(threadIndex, errors)" on THREAD_COUNT threads and returns the sum of the errors they counted.
+*/
+template <typename Fn>
+static auto run_threads(Fn&& fn) -> uint32
+{
+	std::atomic<uint32> errors = 0;
+	lib::array<std::thread> threads;
+
+	for (uint32 i = 0; i < THREAD_COUNT; ++i)
+	{
+		threads.emplace_back([&fn, &errors, i] { fn(i, errors); });
+	}
+
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	return errors.load();
+}
+
+/**
+* Each thread inserts elements and erases random ones of its own. An element that some other thread's insert overwrote, or an erase that hit the wrong slot, shows up as a changed value.
+* Afterwards, iteration has to visit exactly the elements the threads still hold.
+*/
+static auto test_concurrent_insert_erase() -> void
+{
+	using container = lib::paged_array<element, 100>;
+	using live = live_element<container>;
+
+	{
+		container elements;
+		lib::array<live> held[THREAD_COUNT];
+
+		uint32 const errors = run_threads([&elements, &held](uint32 thread, std::atomic<uint32>& failed)
+		{
+			tests::rng random{ thread + 1 };
+			lib::array<live>& mine = held[thread];
+
+			for (uint64 i = 0; i < 20'000; ++i)
+			{
+				if (mine.empty() || random.next_below(3) != 0)
+				{
+					auto [index, pointer] = elements.emplace(tag(thread, i));
+
+					if (pointer == nullptr || !index.valid() || elements.at(index) != pointer)
+					{
+						failed.fetch_add(1, std::memory_order_relaxed);
+						continue;
+					}
+
+					mine.push_back(live{ index, tag(thread, i) });
+					continue;
+				}
+
+				size_t const which = static_cast<size_t>(random.next_below(mine.size()));
+				live const victim = mine[which];
+				element const* current = elements.at(victim.index);
+
+				if (current == nullptr || current->value != victim.value || !elements.erase(victim.index))
+				{
+					failed.fetch_add(1, std::memory_order_relaxed);
+				}
+
+				// The index is stale from here on, even once the slot holds another thread's element.
+				if (elements.contains(victim.index) || elements.erase(victim.index))
+				{
+					failed.fetch_add(1, std::memory_order_relaxed);
+				}
+
+				mine[which] = mine.back();
+				mine.pop_back();
+			}
+
+			for (live const& entry : mine)
+			{
+				if (elements.at(entry.index) == nullptr || elements.at(entry.index)->value != entry.value)
+				{
+					failed.fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+		});
+
+		CHECK(errors == 0);
+
+		size_t total = 0;
+
+		for (lib::array<live> const& mine : held)
+		{
+			total += mine.size();
+		}
+
+		CHECK(elements.size() == total);
+		CHECK(alive.load() == static_cast<int32>(total));
+
+		// Iteration visits every held element once, and the index it reports is the one insert returned.
+		size_t visited = 0;
+		size_t mismatched = 0;
+
+		for (auto it = elements.begin(); it != elements.end(); ++it)
+		{
+			uint64 const thread = it->value >> 32;
+			container::index const index = it.index();
+			bool found = false;
+
+			for (live const& entry : held[thread])
+			{
+				found = found || (entry.index == index && entry.value == it->value);
+			}
+
+			mismatched += found ? 0 : 1;
+			++visited;
+		}
+
+		CHECK(visited == total);
+		CHECK(mismatched == 0);
+
+		container const& constElements = elements;
+		size_t constVisited = 0;
+
+		for (element const& e : constElements)
+		{
+			constVisited += (e.value >> 32) < THREAD_COUNT ? 1 : 0;
+		}
+
+		CHECK(constVisited == total);
+	}
+
+	CHECK(alive.load() == 0);
+}
+
+/**
+* Hammers the free list with erase and insert pairs on a container that has exactly as many slots as the threads hold elements.
+* A slot popped twice (ABA on the free list head) ends up behind two live indices, a slot lost from the list makes an insert fail.
+*/
+static auto test_free_list() -> void
+{
+	static constexpr uint16 PAGE_SIZE = 4;
+	static constexpr uint32 PAGE_COUNT = 8;
+	static constexpr size_t PER_THREAD = PAGE_SIZE * PAGE_COUNT / THREAD_COUNT;
+
+	using container = lib::paged_array<element, PAGE_SIZE, PAGE_COUNT>;
+	using live = live_element<container>;
+
+	{
+		container elements;
+		lib::array<live> held[THREAD_COUNT];
+
+		uint32 const errors = run_threads([&elements, &held](uint32 thread, std::atomic<uint32>& failed)
+		{
+			lib::array<live>& mine = held[thread];
+
+			for (uint64 i = 0; i < 100'000; ++i)
+			{
+				if (mine.size() == PER_THREAD)
+				{
+					size_t const which = static_cast<size_t>(i % PER_THREAD);
+					live const victim = mine[which];
+					element const* current = elements.at(victim.index);
+
+					if (current == nullptr || current->value != victim.value || !elements.erase(victim.index))
+					{
+						failed.fetch_add(1, std::memory_order_relaxed);
+					}
+
+					mine[which] = mine.back();
+					mine.pop_back();
+				}
+
+				auto [index, pointer] = elements.emplace(tag(thread, i));
+
+				if (pointer == nullptr)
+				{
+					failed.fetch_add(1, std::memory_order_relaxed);
+					continue;
+				}
+
+				mine.push_back(live{ index, tag(thread, i) });
+			}
+		});
+
+		CHECK(errors == 0);
+		CHECK(elements.size() == container::max_size());
+		CHECK(elements.page_count() == PAGE_COUNT);
+
+		// Every slot is held by exactly one thread.
+		bool distinct = true;
+
+		for (uint32 t = 0; t < THREAD_COUNT; ++t)
+		{
+			for (live const& entry : held[t])
+			{
+				distinct = distinct && elements.at(entry.index) != nullptr && elements.at(entry.index)->value == entry.value;
+			}
+		}
+
+		CHECK(distinct);
+
+		// Full, and the only way back in is through an erase.
+		CHECK(elements.emplace(uint64{ 0 }).second == nullptr);
+		CHECK(elements.erase(held[0][0].index));
+		CHECK(elements.emplace(uint64{ 0 }).second != nullptr);
+	}
+
+	CHECK(alive.load() == 0);
+}
+
+/**
+* Every thread tries to erase every element, exactly one erase of each may succeed.
+*/
+static auto test_racing_erase() -> void
+{
+	using container = lib::paged_array<element, 64>;
+
+	{
+		container elements;
+		lib::array<container::index> indices;
+
+		for (uint64 i = 0; i < 10'000; ++i)
+		{
+			indices.push_back(elements.emplace(i).first);
+		}
+
+		std::atomic<uint32> erased = 0;
+
+		run_threads([&elements, &indices, &erased](uint32 thread, std::atomic<uint32>&)
+		{
+			// Different starting points so that the threads collide all over the range.
+			for (size_t i = 0; i < indices.size(); ++i)
+			{
+				if (elements.erase(indices[(i + thread * 1'237) % indices.size()]))
+				{
+					erased.fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+		});
+
+		CHECK(erased.load() == indices.size());
+		CHECK(elements.empty());
+		CHECK(alive.load() == 0);
+		CHECK(elements.begin() == elements.end());
+	}
+
+	CHECK(alive.load() == 0);
+}
+
+/**
+* Stale, even versioned and out of range indices never reach an element.
+*/
+static auto test_stale_indices() -> void
+{
+	using container = lib::paged_array<element, 8, 4>;
+
+	container elements;
+
+	auto const [first, pointer] = elements.emplace(uint64{ 1 });
+	CHECK(elements.at(first) == pointer);
+
+	CHECK(elements.erase(first));
+	CHECK(!elements.contains(first));
+	CHECK(!elements.erase(first));
+
+	// The slot comes back with a new version, the old index stays dead.
+	auto const [second, reused] = elements.emplace(uint64{ 2 });
+	CHECK(second.page == first.page && second.offset == first.offset);
+	CHECK(second.version != first.version);
+	CHECK(elements.at(first) == nullptr);
+	CHECK(elements.at(second) == reused);
+	CHECK(!elements.erase(first));
+	CHECK(elements.contains(second));
+
+	container::index even = second;
+	even.version += 1;
+	CHECK(!even.valid());
+	CHECK(elements.at(even) == nullptr);
+	CHECK(!elements.erase(even));
+
+	CHECK(elements.at(container::index{ .page = 3, .offset = 0, .version = 1 }) == nullptr);
+	CHECK(elements.at(container::index{ .page = 0, .offset = 8, .version = second.version }) == nullptr);
+	CHECK(elements.at(container::index{ .page = 100, .offset = 0, .version = 1 }) == nullptr);
+	CHECK(!elements.erase(container::index{ .page = 100, .offset = 0, .version = 1 }));
+
+	CHECK(container::index::from(second.to_uint64()) == second);
+
+	// clear() invalidates everything handed out before it.
+	elements.clear();
+	CHECK(!elements.contains(second));
+	CHECK(elements.empty());
+}
+
+/**
+* clear(page) on its own, and while other threads erase elements of the same page.
+*/
+static auto test_clear_page() -> void
+{
+	static constexpr uint16 PAGE_SIZE = 130;
+
+	using container = lib::paged_array<element, PAGE_SIZE>;
+
+	{
+		container elements;
+		lib::array<container::index> indices;
+
+		for (uint64 i = 0; i < PAGE_SIZE * 3; ++i)
+		{
+			indices.push_back(elements.emplace(i).first);
+		}
+
+		// A few holes in the page being cleared, clear only counts what is still there.
+		CHECK(elements.erase(indices[PAGE_SIZE + 1]));
+		CHECK(elements.erase(indices[PAGE_SIZE + 100]));
+
+		CHECK(elements.clear(1) == PAGE_SIZE - 2);
+		CHECK(elements.size() == PAGE_SIZE * 2);
+		CHECK(elements.clear(1) == 0);
+		CHECK(elements.clear(7) == 0);
+
+		bool pagesIntact = true;
+
+		for (size_t i = 0; i < indices.size(); ++i)
+		{
+			pagesIntact = pagesIntact && elements.contains(indices[i]) == (indices[i].page != 1);
+		}
+
+		CHECK(pagesIntact);
+
+		// Iteration skips the empty page.
+		size_t visited = 0;
+
+		for (element const& e : elements)
+		{
+			visited += (e.value / PAGE_SIZE != 1) ? 1 : 0;
+		}
+
+		CHECK(visited == PAGE_SIZE * 2);
+
+		// The cleared slots are reused before a new page is allocated.
+		for (uint64 i = 0; i < PAGE_SIZE; ++i)
+		{
+			CHECK(elements.emplace(i).first.page == 1);
+		}
+
+		CHECK(elements.page_count() == 3);
+		CHECK(alive.load() == static_cast<int32>(PAGE_SIZE * 3));
+	}
+
+	CHECK(alive.load() == 0);
+
+	// Racing erases against clear(page): every element goes exactly once, either through an erase or through the clear.
+	for (uint32 round = 0; round < 20; ++round)
+	{
+		container elements;
+		lib::array<container::index> indices;
+
+		for (uint64 i = 0; i < PAGE_SIZE * 2; ++i)
+		{
+			indices.push_back(elements.emplace(i).first);
+		}
+
+		std::atomic<uint32> erased = 0;
+		std::atomic<size_t> cleared = 0;
+
+		run_threads([&](uint32 thread, std::atomic<uint32>&)
+		{
+			if (thread == 0)
+			{
+				cleared.fetch_add(elements.clear(0), std::memory_order_relaxed);
+				return;
+			}
+
+			for (size_t i = thread; i < PAGE_SIZE; i += THREAD_COUNT - 1)
+			{
+				if (elements.erase(indices[i]))
+				{
+					erased.fetch_add(1, std::memory_order_relaxed);
+				}
+			}
+		});
+
+		CHECK(erased.load() + cleared.load() == PAGE_SIZE);
+		CHECK(elements.size() == PAGE_SIZE);
+		CHECK(alive.load() == static_cast<int32>(PAGE_SIZE));
+	}
+
+	CHECK(alive.load() == 0);
+}
+
+auto main() -> int
+{
+	test_stale_indices();
+	test_concurrent_insert_erase();
+	test_free_list();
+	test_racing_erase();
+	test_clear_page();
+
+	return tests::report("paged_array");
+}
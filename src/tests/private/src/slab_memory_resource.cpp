@@ -0,0 +1,341 @@
+#include <algorithm>
+#include <barrier>
+#include <optional>
+#include <span>
+#include <thread>
+#include "lib/array.hpp"
+#include "lib/slab_memory_resource.hpp"
+#include "check.hpp"
+
+/**
+* lib::slab_memory_resource with blocks freed by threads that do not own them, owner threads that exit and trim().
+*
+* Slabs come straight from the OS, so the sanitizers do not see inside them. Every block carries a pattern that is checked before it is freed instead, a block handed out twice overwrites another block's pattern.
+*/
+static constexpr size_t BLOCK_SIZE = 64;
+
+/**
+* Counts what reaches the upstream resource, only requests larger than max_block_size_v should.
+*/
+class counting_resource : public lib::memory_resource
+{
+public:
+	size_t allocations = 0;
+	size_t deallocations = 0;
+
+private:
+	auto do_allocate(size_t size, size_t alignment) -> void* override
+	{
+		++allocations;
+		return lib::get_default_resource()->allocate(size, alignment);
+	}
+
+	auto do_deallocate(void* p, size_t bytes, size_t alignment) -> void override
+	{
+		++deallocations;
+		lib::get_default_resource()->deallocate(p, bytes, alignment);
+	}
+
+	auto do_is_equal(lib::memory_resource const& other) -> bool override
+	{
+		return this == &other;
+	}
+};
+
+struct block
+{
+	void* data;
+	size_t size;
+	uint64 pattern;
+};
+
+static auto fill(block const& b) -> void
+{
+	std::memcpy(b.data, &b.pattern, sizeof(uint64));
+	std::memset(static_cast<std::byte*>(b.data) + sizeof(uint64), static_cast<int>(b.pattern & 0xFF), b.size - sizeof(uint64));
+}
+
+static auto intact(block const& b) -> bool
+{
+	uint64 pattern = 0;
+	std::memcpy(&pattern, b.data, sizeof(uint64));
+
+	auto const* bytes = static_cast<std::byte const*>(b.data);
+
+	return pattern == b.pattern && bytes[b.size - 1] == static_cast<std::byte>(b.pattern & 0xFF);
+}
+
+static auto allocate_blocks(lib::slab_memory_resource& resource, size_t count, uint64 tag) -> lib::array<block>
+{
+	lib::array<block> blocks;
+	blocks.reserve(count);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		block const b{ resource.allocate(BLOCK_SIZE, 8), BLOCK_SIZE, (tag << 32) | i };
+
+		fill(b);
+		blocks.push_back(b);
+	}
+
+	return blocks;
+}
+
+/**
+* @return Number of blocks whose pattern was overwritten.
+*/
+static auto free_blocks(lib::slab_memory_resource& resource, std::span<block const> blocks) -> size_t
+{
+	size_t damaged = 0;
+
+	for (block const& b : blocks)
+	{
+		damaged += intact(b) ? 0 : 1;
+		resource.deallocate(b.data, b.size, 8);
+	}
+
+	return damaged;
+}
+
+/**
+* @return The slabs "blocks" were carved out of, sorted and without duplicates.
+*/
+static auto slabs_of(std::span<block const> blocks) -> lib::array<uintptr_t>
+{
+	lib::array<uintptr_t> slabs;
+
+	for (block const& b : blocks)
+	{
+		slabs.push_back(reinterpret_cast<uintptr_t>(b.data) & ~(lib::slab_memory_resource::slab_size_v - 1));
+	}
+
+	std::sort(slabs.begin(), slabs.end());
+	slabs.erase(std::unique(slabs.begin(), slabs.end()), slabs.cend());
+
+	return slabs;
+}
+
+static auto test_size_classes() -> void
+{
+	using resource_type = lib::slab_memory_resource;
+
+	CHECK(resource_type::size_class_of(1, 1) == 0);
+	CHECK(resource_type::size_class_of(16, 16) == 0);
+	CHECK(resource_type::size_class_of(17, 8) == 1);
+	CHECK(resource_type::size_class_of(16, 64) == 2);
+	CHECK(resource_type::size_class_of(resource_type::max_block_size_v, 8) == resource_type::size_class_count_v - 1);
+	CHECK(resource_type::size_class_of(resource_type::max_block_size_v + 1, 8) == resource_type::size_class_count_v);
+
+	counting_resource upstream;
+
+	{
+		lib::slab_memory_resource resource{ &upstream };
+
+		void* small = resource.allocate(48, 64);
+		CHECK(reinterpret_cast<uintptr_t>(small) % 64 == 0);
+		CHECK(upstream.allocations == 0);
+
+		void* large = resource.allocate(resource_type::max_block_size_v * 2, 8);
+		CHECK(upstream.allocations == 1);
+
+		resource.deallocate(large, resource_type::max_block_size_v * 2, 8);
+		CHECK(upstream.deallocations == 1);
+
+		resource.deallocate(small, 48, 64);
+		CHECK(resource.slab_count() == 1);
+	}
+
+	CHECK(upstream.allocations == upstream.deallocations);
+}
+
+/**
+* The main thread owns the blocks, another thread frees them. The owner allocates from the same slabs again instead of new ones, and trim() returns the slabs once they are empty.
+*/
+static auto test_remote_frees() -> void
+{
+	static constexpr size_t COUNT = 3'000;
+
+	lib::slab_memory_resource resource;
+
+	lib::array<block> blocks = allocate_blocks(resource, COUNT, 1);
+	size_t const slabs = resource.slab_count();
+	lib::array<uintptr_t> const owned = slabs_of(std::span{ blocks.data(), blocks.size() });
+
+	CHECK(slabs > 1);
+
+	size_t damaged = 0;
+
+	std::thread{ [&] { damaged = free_blocks(resource, std::span{ blocks.data(), blocks.size() }); } }.join();
+	CHECK(damaged == 0);
+
+	// Remote frees wait on the slabs until the owner picks them up.
+	CHECK(resource.slab_count() == slabs);
+
+	blocks = allocate_blocks(resource, COUNT, 2);
+	CHECK(resource.slab_count() == slabs);
+	CHECK(slabs_of(std::span{ blocks.data(), blocks.size() }) == owned);
+
+	std::thread{ [&] { damaged = free_blocks(resource, std::span{ blocks.data(), blocks.size() }); } }.join();
+	CHECK(damaged == 0);
+
+	resource.trim();
+	CHECK(resource.slab_count() == 0);
+
+	// trim() from a thread that never allocated from the resource does nothing.
+	std::thread{ [&] { resource.trim(); } }.join();
+}
+
+/**
+* Every thread allocates a round of blocks of mixed sizes and frees the round of its neighbour, so that every block is freed remotely while its owner keeps allocating.
+*/
+static auto test_cross_thread_rounds() -> void
+{
+	static constexpr uint32 THREAD_COUNT = 4;
+	static constexpr uint32 ROUND_COUNT = 50;
+	static constexpr size_t PER_ROUND = 500;
+
+	lib::slab_memory_resource resource;
+	lib::array<block> rounds[THREAD_COUNT];
+	std::atomic<size_t> damaged = 0;
+	std::barrier sync{ THREAD_COUNT };
+	lib::array<std::thread> threads;
+
+	for (uint32 t = 0; t < THREAD_COUNT; ++t)
+	{
+		threads.emplace_back([&, t]
+		{
+			tests::rng random{ t + 1 };
+
+			for (uint32 round = 0; round < ROUND_COUNT; ++round)
+			{
+				lib::array<block>& mine = rounds[t];
+
+				for (size_t i = 0; i < PER_ROUND; ++i)
+				{
+					size_t const size = size_t{ 16 } << random.next_below(5);
+					block const b{ resource.allocate(size, 8), size, (uint64{ t } << 48) | (uint64{ round } << 32) | i };
+
+					fill(b);
+					mine.push_back(b);
+				}
+
+				sync.arrive_and_wait();
+
+				lib::array<block>& neighbour = rounds[(t + 1) % THREAD_COUNT];
+
+				for (block const& b : neighbour)
+				{
+					damaged.fetch_add(intact(b) ? 0 : 1, std::memory_order_relaxed);
+					resource.deallocate(b.data, b.size, 8);
+				}
+
+				neighbour.clear();
+				sync.arrive_and_wait();
+			}
+
+			// Every block has been freed, each thread gives its empty slabs back.
+			resource.trim();
+		});
+	}
+
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	CHECK(damaged.load() == 0);
+	CHECK(resource.slab_count() == 0);
+}
+
+/**
+* A thread that exits leaves its slabs behind with blocks still in use. They are freed remotely afterwards, and the next thread that allocates from the resource adopts the slabs instead of asking the OS for new ones.
+*/
+static auto test_adoption() -> void
+{
+	static constexpr size_t COUNT = 2'000;
+
+	lib::slab_memory_resource resource;
+	lib::array<block> blocks;
+
+	std::thread{ [&]
+	{
+		blocks = allocate_blocks(resource, COUNT, 3);
+
+		// Half of them are freed by the owner, the other half after it is gone.
+		CHECK(free_blocks(resource, std::span{ blocks.data(), blocks.size() }.first(COUNT / 2)) == 0);
+	} }.join();
+
+	size_t const slabs = resource.slab_count();
+	lib::array<uintptr_t> const owned = slabs_of(std::span{ blocks.data(), blocks.size() });
+
+	CHECK(slabs > 1);
+	CHECK(free_blocks(resource, std::span{ blocks.data(), blocks.size() }.subspan(COUNT / 2)) == 0);
+	CHECK(resource.slab_count() == slabs);
+
+	lib::array<uintptr_t> adopted;
+	size_t damaged = 0;
+
+	std::thread{ [&]
+	{
+		lib::array<block> reused = allocate_blocks(resource, COUNT, 4);
+
+		adopted = slabs_of(std::span{ reused.data(), reused.size() });
+		damaged = free_blocks(resource, std::span{ reused.data(), reused.size() });
+
+		resource.trim();
+	} }.join();
+
+	CHECK(adopted == owned);
+	CHECK(damaged == 0);
+	CHECK(resource.slab_count() == 0);
+}
+
+/**
+* The resource is destroyed while a thread still holds its heap, and a new resource is constructed at the same address. Whichever of the thread and the resource lets go last frees the heap.
+*/
+static auto test_lifetimes() -> void
+{
+	std::optional<lib::slab_memory_resource> resource;
+	resource.emplace();
+
+	std::atomic_bool destroyed = false;
+	std::atomic_bool allocated = false;
+
+	std::thread worker{ [&]
+	{
+		void* p = resource->allocate(BLOCK_SIZE, 8);
+		resource->deallocate(p, BLOCK_SIZE, 8);
+
+		allocated.store(true);
+		allocated.notify_one();
+		destroyed.wait(false);
+	} };
+
+	allocated.wait(false);
+
+	// The main thread holds a heap of the first resource as well.
+	void* p = resource->allocate(BLOCK_SIZE, 8);
+	resource->deallocate(p, BLOCK_SIZE, 8);
+
+	resource.reset();
+	destroyed.store(true);
+	destroyed.notify_one();
+	worker.join();
+
+	resource.emplace();
+
+	lib::array<block> blocks = allocate_blocks(*resource, 100, 5);
+	CHECK(resource->slab_count() == 1);
+	CHECK(free_blocks(*resource, std::span{ blocks.data(), blocks.size() }) == 0);
+}
+
+auto main() -> int
+{
+	test_size_classes();
+	test_remote_frees();
+	test_cross_thread_rounds();
+	test_adoption();
+	test_lifetimes();
+
+	return tests::report("slab_memory_resource");
+}
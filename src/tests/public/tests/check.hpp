@@ -0,0 +1,74 @@
+#pragma once
+#ifndef TESTS_CHECK_HPP
+#define TESTS_CHECK_HPP
+
+#include <source_location>
+#include "fmt/format.h"
+#include "lib/common.hpp"
+
+namespace tests
+{
+/**
+* @brief Number of checks that failed so far. main() returns it, so ctest sees a failing test as a non-zero exit code.
+*/
+inline int failures = 0;
+
+/**
+* @brief Records a failed check when "condition" is false. Testing carries on so that one run reports every failure.
+*/
+inline auto check(bool condition, char const* expression, std::source_location const location = std::source_location::current()) -> bool
+{
+	if (!condition)
+	{
+		fmt::print("{}:{}: check failed: {}\n", location.file_name(), location.line(), expression);
+		++failures;
+	}
+
+	return condition;
+}
+
+/**
+* @brief splitmix64. Deterministic, so a failing run can be repeated.
+*/
+struct rng
+{
+	uint64 state;
+
+	auto next() -> uint64
+	{
+		uint64 z = (state += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+	auto next_below(uint64 bound) -> uint64 { return next() % bound; }
+
+	/**
+	* @brief Uniform in [lo, hi).
+	*/
+	auto next_float(float32 lo, float32 hi) -> float32
+	{
+		return lo + (hi - lo) * (static_cast<float32>(next() >> 40) * 0x1.0p-24f);
+	}
+};
+
+/**
+* @brief Prints a summary and returns the exit code of the test.
+*/
+inline auto report(char const* name) -> int
+{
+	if (failures != 0)
+	{
+		fmt::print("{}: {} check(s) failed.\n", name, failures);
+		return 1;
+	}
+
+	fmt::print("{}: passed.\n", name);
+	return 0;
+}
+}
+
+#define CHECK(condition) ::tests::check(static_cast<bool>(condition), #condition)
+
+#endif // !TESTS_CHECK_HPP
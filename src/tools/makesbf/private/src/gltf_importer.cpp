@@ -2,8 +2,10 @@
 #include <fstream>
 #include <array>
 #include <bitset>
+#include <cstring>
 #include "cgltf.h"
 #include "lib/map.hpp"
+#include "math/simd.h"
 #include "gltf_importer.hpp"
 
 namespace makesbf
@@ -28,6 +30,278 @@ struct CgltfDecodedData
 	size_t numMaterialNameChars;
 };
 
+/**
+* Components are decoded in blocks of this many floats. Every component count a vertex attribute can have (1 to 4) divides it,
+* so the scale applied to a component only depends on its position within the block.
+*/
+static constexpr size_t DECODE_BLOCK_SIZE = 12;
+
+/**
+* cgltf frees without telling us the size, so it is stored in front of the allocation.
+*/
+static constexpr size_t CGLTF_ALLOCATION_HEADER_SIZE = alignof(std::max_align_t);
+
+auto memory_tracker() -> lib::tracking_memory_resource&
+{
+	static lib::tracking_memory_resource tracker{ "makesbf::gltf::Importer" };
+	return tracker;
+}
+
+static auto cgltf_allocate(void* user, cgltf_size size) -> void*
+{
+	lib::memory_resource* resource = static_cast<lib::memory_resource*>(user);
+	std::byte* p = static_cast<std::byte*>(resource->allocate(size + CGLTF_ALLOCATION_HEADER_SIZE));
+
+	if (p == nullptr)
+	{
+		return nullptr;
+	}
+
+	std::memcpy(p, &size, sizeof(cgltf_size));
+
+	return p + CGLTF_ALLOCATION_HEADER_SIZE;
+}
+
+static auto cgltf_deallocate(void* user, void* ptr) -> void
+{
+	if (ptr == nullptr)
+	{
+		return;
+	}
+
+	lib::memory_resource* resource = static_cast<lib::memory_resource*>(user);
+	std::byte* p = static_cast<std::byte*>(ptr) - CGLTF_ALLOCATION_HEADER_SIZE;
+
+	cgltf_size size = 0;
+	std::memcpy(&size, p, sizeof(cgltf_size));
+
+	resource->deallocate(p, size + CGLTF_ALLOCATION_HEADER_SIZE);
+}
+
+static auto accessor_data(cgltf_accessor const* accessor) -> uint8 const*
+{
+	if (accessor->buffer_view == nullptr)
+	{
+		return nullptr;
+	}
+
+	uint8 const* data = static_cast<uint8 const*>(cgltf_buffer_view_data(accessor->buffer_view));
+
+	return (data != nullptr) ? data + accessor->offset : nullptr;
+}
+
+template <typename T>
+static auto decode_component(uint8 const* src, bool normalized) -> float32
+{
+	T value;
+	std::memcpy(&value, src, sizeof(T));
+
+	if constexpr (std::is_same_v<T, float32>)
+	{
+		return value;
+	}
+	else
+	{
+		if (!normalized)
+		{
+			return static_cast<float32>(value);
+		}
+
+		// Multiply by the reciprocal so that this matches the SIMD path bit for bit.
+		float32 const result = static_cast<float32>(value) * (1.f / static_cast<float32>(std::numeric_limits<T>::max()));
+
+		// The most negative value of a signed normalized integer maps to -1 as well.
+		if constexpr (std::is_signed_v<T>)
+		{
+			return std::max(result, -1.f);
+		}
+		else
+		{
+			return result;
+		}
+	}
+}
+
+static auto scale_components(float32* data, size_t total, float32 const* pattern) -> void
+{
+	for (size_t k = 0; k < total; ++k)
+	{
+		data[k] *= pattern[k % DECODE_BLOCK_SIZE];
+	}
+}
+
+/**
+* Decodes as many whole blocks of tightly packed components as possible with SIMD.
+* @return Number of components decoded.
+*/
+template <typename T>
+static auto decode_packed_components([[maybe_unused]] uint8 const* src, [[maybe_unused]] size_t total, [[maybe_unused]] bool normalized, [[maybe_unused]] float32 const* pattern, [[maybe_unused]] float32* out) -> size_t
+{
+#if MATH_SIMD_SSE2
+	if constexpr (std::is_same_v<T, float32> || std::is_same_v<T, int8> || std::is_same_v<T, uint8> || std::is_same_v<T, int16> || std::is_same_v<T, uint16>)
+	{
+		__m128 const scale[3] = { _mm_loadu_ps(pattern), _mm_loadu_ps(pattern + 4), _mm_loadu_ps(pattern + 8) };
+
+		float32 normalizer = 1.f;
+		float32 lowest = std::numeric_limits<float32>::lowest();
+
+		if constexpr (!std::is_same_v<T, float32>)
+		{
+			if (normalized)
+			{
+				normalizer = 1.f / static_cast<float32>(std::numeric_limits<T>::max());
+				lowest = std::is_signed_v<T> ? -1.f : 0.f;
+			}
+		}
+
+		__m128 const normalizerV = _mm_set1_ps(normalizer);
+		__m128 const lowestV = _mm_set1_ps(lowest);
+
+		size_t k = 0;
+
+		for (; k + DECODE_BLOCK_SIZE <= total; k += DECODE_BLOCK_SIZE)
+		{
+			for (size_t j = 0; j < 3; ++j)
+			{
+				uint8 const* p = src + (k + j * 4) * sizeof(T);
+				__m128 value;
+
+				if constexpr (std::is_same_v<T, float32>)
+				{
+					value = _mm_loadu_ps(reinterpret_cast<float32 const*>(p));
+				}
+				else
+				{
+					__m128i wide;
+
+					if constexpr (sizeof(T) == 1)
+					{
+						int32 bytes;
+						std::memcpy(&bytes, p, sizeof(bytes));
+
+						__m128i const v = _mm_cvtsi32_si128(bytes);
+
+						if constexpr (std::is_signed_v<T>)
+						{
+							wide = _mm_srai_epi32(_mm_unpacklo_epi16(_mm_unpacklo_epi8(v, v), _mm_unpacklo_epi8(v, v)), 24);
+						}
+						else
+						{
+							wide = _mm_unpacklo_epi16(_mm_unpacklo_epi8(v, _mm_setzero_si128()), _mm_setzero_si128());
+						}
+					}
+					else
+					{
+						__m128i const v = _mm_loadl_epi64(reinterpret_cast<__m128i const*>(p));
+
+						if constexpr (std::is_signed_v<T>)
+						{
+							wide = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+						}
+						else
+						{
+							wide = _mm_unpacklo_epi16(v, _mm_setzero_si128());
+						}
+					}
+
+					value = _mm_max_ps(_mm_mul_ps(_mm_cvtepi32_ps(wide), normalizerV), lowestV);
+				}
+
+				_mm_storeu_ps(out + k + j * 4, _mm_mul_ps(value, scale[j]));
+			}
+		}
+
+		return k;
+	}
+#endif
+	return 0;
+}
+
+template <typename T>
+static auto decode_components(uint8 const* src, size_t stride, size_t count, size_t componentCount, bool normalized, float32 const* pattern, float32* out) -> void
+{
+	// Tightly packed accessors are one flat array of components.
+	if (stride == sizeof(T) * componentCount)
+	{
+		size_t const total = count * componentCount;
+		size_t k = decode_packed_components<T>(src, total, normalized, pattern, out);
+
+		for (; k < total; ++k)
+		{
+			out[k] = decode_component<T>(src + k * sizeof(T), normalized) * pattern[k % DECODE_BLOCK_SIZE];
+		}
+
+		return;
+	}
+
+	size_t v = 0;
+
+#if MATH_SIMD_SSE2
+	// Interleaved float vertices are loaded whole. A vec3 load reads into the next vertex and its 4th lane is overwritten by the next store,
+	// which is why the last vertex is left to the scalar loop.
+	if constexpr (std::is_same_v<T, float32>)
+	{
+		if (componentCount == 3 || componentCount == 4)
+		{
+			__m128 const scale = _mm_loadu_ps(pattern);
+			size_t const simdCount = (componentCount == 4) ? count : (count != 0 ? count - 1 : 0);
+
+			for (; v < simdCount; ++v)
+			{
+				__m128 const value = _mm_loadu_ps(reinterpret_cast<float32 const*>(src + v * stride));
+				_mm_storeu_ps(out + v * componentCount, _mm_mul_ps(value, scale));
+			}
+		}
+	}
+#endif
+
+	for (; v < count; ++v)
+	{
+		uint8 const* vertex = src + v * stride;
+
+		for (size_t c = 0; c < componentCount; ++c)
+		{
+			out[v * componentCount + c] = decode_component<T>(vertex + c * sizeof(T), normalized) * pattern[c];
+		}
+	}
+}
+
+template <typename Src, typename Dst>
+static auto copy_indices(uint8 const* src, size_t stride, size_t count, Dst* dst) -> void
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		Src index;
+		std::memcpy(&index, src + i * stride, sizeof(Src));
+		dst[i] = static_cast<Dst>(index);
+	}
+}
+
+template <typename T>
+static auto convert_indices(uint8 const* src, size_t stride, size_t count, void* dst, size_t size) -> bool
+{
+	if (stride == sizeof(T) && size == sizeof(T))
+	{
+		std::memcpy(dst, src, count * sizeof(T));
+		return true;
+	}
+
+	switch (size)
+	{
+	case sizeof(uint8):
+		copy_indices<T>(src, stride, count, static_cast<uint8*>(dst));
+		return true;
+	case sizeof(uint16):
+		copy_indices<T>(src, stride, count, static_cast<uint16*>(dst));
+		return true;
+	case sizeof(uint32):
+		copy_indices<T>(src, stride, count, static_cast<uint32*>(dst));
+		return true;
+	default:
+		return false;
+	}
+}
+
 auto translate_topology(cgltf_primitive_type topology) -> render::Topology
 {
 	switch (topology)
@@ -139,6 +413,10 @@ auto create_cgltf_data(std::filesystem::path const& path) -> cgltf_data*
 	cgltf_data* data = nullptr;
 	cgltf_options options = {};
 
+	options.memory.alloc_func	= cgltf_allocate;
+	options.memory.free_func	= cgltf_deallocate;
+	options.memory.user_data	= static_cast<lib::memory_resource*>(&memory_tracker());
+
 	cgltf_result result = cgltf_parse(&options, json.data(), json.size() * sizeof(decltype(json)::value_type), &data);
 
 	if (result != cgltf_result_success)
@@ -505,6 +783,25 @@ auto Mesh::has_attribute(VertexAttribute attribute) const -> bool
 	return m_data.attributes[i].accessor != nullptr;
 }
 
+auto Mesh::attribute_bounds(VertexAttribute attribute, float32* min, float32* max, size_t elementSize) const -> bool
+{
+	auto const i = std::to_underlying(attribute);
+	Attribute const& attrib = m_data.attributes[i];
+
+	// The spec requires POSITION accessors to specify their bounds but it is optional for everything else.
+	if (!(attrib.accessor && attrib.accessor->has_min && attrib.accessor->has_max))
+	{
+		return false;
+	}
+
+	size_t const count = std::min(elementSize, std::size(attrib.accessor->min));
+
+	std::memcpy(min, attrib.accessor->min, sizeof(float32) * count);
+	std::memcpy(max, attrib.accessor->max, sizeof(float32) * count);
+
+	return true;
+}
+
 auto Mesh::read_float_data(VertexAttribute attribute, size_t index, float32* out, size_t elementSize) const -> void
 {
 	// NOTE:
@@ -529,39 +826,119 @@ auto Mesh::read_uint_data(size_t index) const -> uint32
 	return out;
 }
 
-auto Mesh::unpack_vertex_data(VertexAttribute attribute, std::span<float32> floatData) const -> void
+auto Mesh::unpack_vertex_data(VertexAttribute attribute, std::span<float32> floatData, std::span<float32 const> scale) const -> bool
 {
 	// NOTE:
 	// Pretend EXT_meshopt_compression doesn't exist at the moment.
 	//
 
 	auto const i = std::to_underlying(attribute);
-	Attribute& attrib = m_data.attributes[i - 1];
+	Attribute const& attrib = m_data.attributes[i];
+	cgltf_accessor const* accessor = attrib.accessor;
 
-	if (!(attrib.accessor && attrib.accessor->buffer_view))
+	if (!accessor)
 	{
-		return;
-	};
+		return false;
+	}
+
+	size_t const componentCount = cgltf_num_components(accessor->type);
+
+	if (componentCount == 0 || DECODE_BLOCK_SIZE % componentCount != 0)
+	{
+		return false;
+	}
+
+	size_t const count = std::min(static_cast<size_t>(accessor->count), floatData.size() / componentCount);
 
-	cgltf_accessor_unpack_floats(attrib.accessor, floatData.data(), floatData.size());
+	// Scale applied to every component of the vertex, repeated over a whole decode block.
+	float32 pattern[DECODE_BLOCK_SIZE];
+
+	for (size_t k = 0; k < DECODE_BLOCK_SIZE; ++k)
+	{
+		size_t const component = k % componentCount;
+		pattern[k] = (component < scale.size()) ? scale[component] : 1.f;
+	}
+
+	uint8 const* src = accessor_data(accessor);
+
+	// Sparse accessors and accessors without data are left to cgltf.
+	if (accessor->is_sparse || src == nullptr)
+	{
+		cgltf_accessor_unpack_floats(accessor, floatData.data(), count * componentCount);
+		scale_components(floatData.data(), count * componentCount, pattern);
+		return true;
+	}
+
+	size_t const stride = accessor->stride;
+	bool const normalized = accessor->normalized;
+
+	switch (accessor->component_type)
+	{
+	case cgltf_component_type_r_8:
+		decode_components<int8>(src, stride, count, componentCount, normalized, pattern, floatData.data());
+		break;
+	case cgltf_component_type_r_8u:
+		decode_components<uint8>(src, stride, count, componentCount, normalized, pattern, floatData.data());
+		break;
+	case cgltf_component_type_r_16:
+		decode_components<int16>(src, stride, count, componentCount, normalized, pattern, floatData.data());
+		break;
+	case cgltf_component_type_r_16u:
+		decode_components<uint16>(src, stride, count, componentCount, normalized, pattern, floatData.data());
+		break;
+	case cgltf_component_type_r_32u:
+		decode_components<uint32>(src, stride, count, componentCount, normalized, pattern, floatData.data());
+		break;
+	case cgltf_component_type_r_32f:
+		decode_components<float32>(src, stride, count, componentCount, normalized, pattern, floatData.data());
+		break;
+	default:
+		return false;
+	}
+
+	return true;
 }
 
-auto Mesh::unpack_index_data_internal(void* data, size_t count, size_t size) const -> void
+auto Mesh::unpack_index_data_internal(void* data, size_t count, size_t size) const -> bool
 {
 	if (!m_data.indices || size > sizeof(cgltf_uint))
 	{
-		return;
+		return false;
+	}
+
+	cgltf_accessor const* accessor = m_data.indices;
+	uint8 const* src = accessor_data(accessor);
+
+	count = std::min(count, static_cast<size_t>(accessor->count));
+
+	if (accessor->is_sparse || src == nullptr)
+	{
+		uint8* ptr = static_cast<uint8*>(data);
+
+		for (size_t i = 0; i < count; ++i)
+		{
+			cgltf_uint index = {};
+			cgltf_accessor_read_uint(accessor, i, &index, 1);
+
+			std::memcpy(ptr, &index, size);
+			ptr += size;
+		}
+
+		return true;
 	}
 
-	uint8* ptr = static_cast<uint8*>(data);
+	size_t const stride = accessor->stride;
 
-	for (size_t i = 0; i < m_data.indices->count && i < count; ++i)
+	switch (accessor->component_type)
 	{
-		cgltf_uint index = {};
-		cgltf_accessor_read_uint(m_data.indices, i, &index, 1);
-		
-		std::memcpy(ptr, &index, size);
-		ptr += size;
+	case cgltf_component_type_r_8u:
+		return convert_indices<uint8>(src, stride, count, data, size);
+	case cgltf_component_type_r_16u:
+		return convert_indices<uint16>(src, stride, count, data, size);
+	case cgltf_component_type_r_32u:
+		return convert_indices<uint32>(src, stride, count, data, size);
+	default:
+		return false;
 	}
 }
 
@@ -573,7 +950,7 @@ auto Mesh::material_info() const -> MaterialInfo const&
 Importer::Importer() :
 	m_path{},
 	m_cgltf_ptr{},
-	m_data{},
+	m_data{ &memory_tracker() },
 	m_meshes{},
 	m_images{},
 	m_materials{}
@@ -582,7 +959,7 @@ Importer::Importer() :
 Importer::Importer(std::filesystem::path const& path) :
 	m_path{},
 	m_cgltf_ptr{},
-	m_data{},
+	m_data{ &memory_tracker() },
 	m_meshes{},
 	m_images{},
 	m_materials{}
@@ -595,7 +972,8 @@ Importer::~Importer()
 	close();
 }
 
-Importer::Importer(Importer&& rhs) noexcept
+Importer::Importer(Importer&& rhs) noexcept :
+	Importer{}
 {
 	*this = std::move(rhs);
 }
@@ -623,6 +1001,8 @@ auto Importer::open(std::filesystem::path const& path) -> bool
 		return false;
 	}
 
+	lib::tracking_memory_resource::call_site site{};
+
 	m_path = std::filesystem::absolute(path);
 
 	auto absolutePath = std::filesystem::absolute(m_path).remove_filename();
@@ -634,6 +1014,8 @@ auto Importer::open(std::filesystem::path const& path) -> bool
 
 auto Importer::decode() -> void
 {
+	lib::tracking_memory_resource::call_site site{};
+
 	auto absolutePath = std::filesystem::absolute(m_path).remove_filename();
 	size_t const parentPathLength = lib::strlen(absolutePath.c_str());
 
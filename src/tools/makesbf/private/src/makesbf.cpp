@@ -22,17 +22,52 @@ auto MakeSbf::mise_en_place(int argc, char** argv) -> bool
 	std::filesystem::path input;
 	std::filesystem::path output;
 	std::filesystem::path filename;
+	bool quantizePositions = false;
+	bool octahedralNormals = false;
+	lib::string uvFormat;
+	bool skipOptimization = false;
+	uint32 vertexCacheSize = DEFAULT_VERTEX_CACHE_SIZE;
+	uint32 workerCount = 0;
 
 	core::cmdline::ProgramOptions po{ "usage: makesbf [options] -i <input> -o <output>" };
 	core::cmdline::Option inputOpt{ po, "-i", "--input", "Path to file or directory.", input };
 	core::cmdline::Option outputOpt{ po, "-o", "--output-dir", "Output dir of SBF file.", output };
 	core::cmdline::Option outFilenameOpt{ po, "-F", "--filename", "Name of SBF file.", filename };
+	core::cmdline::Option quantizeOpt{ po, "-qp", "--quantize-positions", "Quantize positions to 16 bits relative to the mesh's bounds.", quantizePositions };
+	core::cmdline::Option octNormalOpt{ po, "-on", "--oct-normals", "Store normals and tangents as octahedral encoded snorm16.", octahedralNormals };
+	core::cmdline::Option uvFormatOpt{ po, "-uv", "--uv-format", "Texture coordinate format. Either \"half\" or \"unorm16\".", uvFormat };
+	core::cmdline::Option noOptimizeOpt{ po, "-no", "--no-optimize", "Skip vertex deduplication and the vertex cache, overdraw and vertex fetch optimizations.", skipOptimization };
+	core::cmdline::Option workerCountOpt{ po, "-j", "--jobs", "Number of jobs to cook in parallel. Defaults to the number of hardware threads.", workerCount };
+	core::cmdline::Option vertexCacheOpt{ po, "-vc", "--vertex-cache-size", "Size of the post-transform vertex cache meshes are optimized for.", vertexCacheSize };
 
 	if (!po.parse(core::cmdline::CommandLine{ argc, argv }) || input.empty())
 	{
 		return false;
 	}
 
+	if (quantizePositions)
+	{
+		m_vertexEncoding |= render::VertexEncoding::Position_Unorm16;
+	}
+
+	if (octahedralNormals)
+	{
+		m_vertexEncoding |= render::VertexEncoding::Normal_Oct16 | render::VertexEncoding::Tangent_Oct16;
+	}
+
+	if (uvFormat == std::string_view{ "half" })
+	{
+		m_vertexEncoding |= render::VertexEncoding::TexCoord_Half;
+	}
+	else if (uvFormat == std::string_view{ "unorm16" })
+	{
+		m_vertexEncoding |= render::VertexEncoding::TexCoord_Unorm16;
+	}
+
+	m_optimizeMeshes = !skipOptimization;
+	m_vertexCacheSize = std::max(vertexCacheSize, 3u);
+	m_workerCount = workerCount;
+
 	add_job(std::move(input), std::move(output), std::move(filename));
 
 	return true;
@@ -40,27 +75,31 @@ auto MakeSbf::mise_en_place(int argc, char** argv) -> bool
 
 auto MakeSbf::cook() -> void
 {
-	/**
-	* NOTE(afiq):
-	* Once we have our coroutine-based task scheduler, use that.
-	*/
-	while (!m_jobDescription.empty())
+	lib::jobs::scheduler scheduler{ { .workerCount = m_workerCount, .ioThreadCount = 0 } };
+	lib::jobs::counter pending;
+
+	lib::array<MakeSbfJobDescription> descriptions;
+
 	{
-		auto const& description = m_jobDescription.front();
+		std::lock_guard lock{ m_jobMutex };
 
-		switch (description.jobType)
-		{
-		case JobType::Gltf_To_Mesh:
-			_translate_gltf_to_sbf(description);
-			break;
-		case JobType::Ktx2_To_Image:
-			_translate_ktx2_to_sbf(description);
-		default:
-			break;
-		}
+		m_scheduler = &scheduler;
+		m_pending = &pending;
+		std::swap(descriptions, m_jobDescriptions);
+	}
 
-		m_jobDescription.pop();
+	for (auto& description : descriptions)
+	{
+		scheduler.spawn([this, job = std::move(description)]() -> void { _run_job(job); }, &pending);
 	}
+
+	// Jobs can add more jobs, e.g. a mesh's textures, to the same counter so it only settles once everything is done.
+	scheduler.wait(pending);
+
+	std::lock_guard lock{ m_jobMutex };
+
+	m_scheduler = nullptr;
+	m_pending = nullptr;
 }
 
 auto MakeSbf::add_job(std::filesystem::path&& input, std::filesystem::path&& output, std::filesystem::path&& filename) -> void
@@ -95,11 +134,11 @@ auto MakeSbf::add_job(std::filesystem::path&& input, std::filesystem::path&& out
 
 			std::filesystem::path const outFilename = path.stem().replace_extension(".sbf");
 
-			m_jobDescription.emplace(
-				path,
-				(!output.empty()) ? output / outFilename : input.parent_path() / outFilename,
-				EXTENSION_TASK_MAP.at(ext).value()->second
-			);
+			_schedule_job({
+				.input = path,
+				.output = (!output.empty()) ? output / outFilename : input.parent_path() / outFilename,
+				.jobType = EXTENSION_TASK_MAP.at(ext).value()->second
+			});
 		}
 	}
 	else
@@ -108,21 +147,62 @@ auto MakeSbf::add_job(std::filesystem::path&& input, std::filesystem::path&& out
 		{
 			auto const outFilename = (filename.empty()) ? input.filename().replace_extension(".sbf").string() : filename.replace_extension(".sbf");
 
-			m_jobDescription.emplace(
-				std::move(input),
-				(!output.empty()) ? output.remove_filename() / outFilename : input.parent_path() / outFilename,
-				EXTENSION_TASK_MAP.at(extension).value()->second
-			);
+			_schedule_job({
+				.input = input,
+				.output = (!output.empty()) ? output.remove_filename() / outFilename : input.parent_path() / outFilename,
+				.jobType = EXTENSION_TASK_MAP.at(extension).value()->second
+			});
 		}
 	}
 }
 
+auto MakeSbf::_schedule_job(MakeSbfJobDescription&& description) -> void
+{
+	std::lock_guard lock{ m_jobMutex };
+
+	// A texture shared by several materials only needs to be cooked once.
+	std::filesystem::path output = description.output.lexically_normal();
+
+	if (m_scheduledOutputs.contains(output))
+	{
+		return;
+	}
+
+	m_scheduledOutputs.insert(std::move(output));
+
+	if (m_scheduler == nullptr)
+	{
+		m_jobDescriptions.push_back(std::move(description));
+		return;
+	}
+
+	m_scheduler->spawn([this, job = std::move(description)]() -> void { _run_job(job); }, m_pending);
+}
+
+auto MakeSbf::_run_job(MakeSbfJobDescription const& description) -> void
+{
+	switch (description.jobType)
+	{
+	case JobType::Gltf_To_Mesh:
+		_translate_gltf_to_sbf(description);
+		break;
+	case JobType::Ktx2_To_Image:
+		_translate_ktx2_to_sbf(description);
+		break;
+	default:
+		break;
+	}
+}
+
 auto MakeSbf::_translate_gltf_to_sbf(MakeSbfJobDescription const& description) -> void
 {
 	MeshifyJobInfo info{
 		.input = description.input,
 		.output = description.output,
-		.attributes = render::VertexAttribute::Position | render::VertexAttribute::Normal | render::VertexAttribute::TexCoord
+		.attributes = render::VertexAttribute::Position | render::VertexAttribute::Normal | render::VertexAttribute::TexCoord,
+		.encoding = m_vertexEncoding,
+		.optimize = m_optimizeMeshes,
+		.vertexCacheSize = m_vertexCacheSize
 	};
 
 	MeshifyJob job{ *this, info };
@@ -0,0 +1,552 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include "lib/monotonic_memory_resource.hpp"
+#include "mesh_optimizer.hpp"
+
+namespace makesbf
+{
+/**
+* FIFO vertex cache that tracks the time each vertex entered it. Advancing the clock past the cache size flushes it.
+*/
+struct VertexCacheTimestamps
+{
+	lib::array<uint32> timestamps;
+	uint32 time;
+	uint32 cacheSize;
+
+	VertexCacheTimestamps(uint32 vertexCount, uint32 size) :
+		timestamps(static_cast<size_t>(vertexCount), 0u),
+		time{ size + 1 },
+		cacheSize{ size }
+	{}
+
+	auto in_cache(uint32 vertex) const -> bool
+	{
+		return time - timestamps[vertex] <= cacheSize;
+	}
+
+	auto flush() -> void
+	{
+		time += cacheSize + 1;
+	}
+
+	/**
+	* @return Number of cache misses the triangle caused.
+	*/
+	auto update(uint32 const* triangle) -> uint32
+	{
+		uint32 misses = 0;
+
+		for (uint32 i = 0; i < 3; ++i)
+		{
+			if (!in_cache(triangle[i]))
+			{
+				timestamps[triangle[i]] = time++;
+				++misses;
+			}
+		}
+
+		return misses;
+	}
+};
+
+auto VertexCacheStatistics::acmr() const -> float32
+{
+	return (triangleCount != 0) ? static_cast<float32>(cacheMisses) / static_cast<float32>(triangleCount) : 0.f;
+}
+
+auto VertexCacheStatistics::atvr() const -> float32
+{
+	return (vertexCount != 0) ? static_cast<float32>(cacheMisses) / static_cast<float32>(vertexCount) : 0.f;
+}
+
+auto VertexCacheStatistics::operator+=(VertexCacheStatistics const& rhs) -> VertexCacheStatistics&
+{
+	vertexCount		+= rhs.vertexCount;
+	triangleCount	+= rhs.triangleCount;
+	cacheMisses		+= rhs.cacheMisses;
+
+	return *this;
+}
+
+static auto hash_vertex(std::span<VertexStreamView const> streams, uint32 vertex) -> uint64
+{
+	uint64 hash = 0xcbf29ce484222325ull;
+
+	for (auto const& stream : streams)
+	{
+		float32 const* data = stream.data + vertex * stream.componentCount;
+
+		for (size_t i = 0; i < stream.componentCount; ++i)
+		{
+			hash ^= std::bit_cast<uint32>(data[i]);
+			hash *= 0x100000001b3ull;
+			hash ^= hash >> 29;
+		}
+	}
+
+	return hash;
+}
+
+static auto vertex_equal(std::span<VertexStreamView const> streams, uint32 a, uint32 b) -> bool
+{
+	for (auto const& stream : streams)
+	{
+		if (std::memcmp(stream.data + a * stream.componentCount, stream.data + b * stream.componentCount, sizeof(float32) * stream.componentCount) != 0)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+auto deduplicate_vertices(std::span<VertexStreamView const> streams, uint32 vertexCount, std::span<uint32> indices, lib::array<uint32>& uniqueVertices) -> uint32
+{
+	static constexpr uint32 EMPTY = std::numeric_limits<uint32>::max();
+
+	uniqueVertices.clear();
+
+	if (vertexCount == 0)
+	{
+		return 0;
+	}
+
+	// Open addressed table of unique vertex ids with linear probing, kept at most half full.
+	size_t const tableSize = std::bit_ceil(static_cast<size_t>(vertexCount) * 2);
+	size_t const tableMask = tableSize - 1;
+
+	lib::monotonic_memory_resource& arena = lib::thread_frame_arena();
+	lib::monotonic_memory_resource::scope scratch{ arena };
+
+	lib::array<uint32> table(tableSize, EMPTY, &arena);
+	lib::array<uint32> remap(static_cast<size_t>(vertexCount), EMPTY, &arena);
+
+	for (uint32 vertex = 0; vertex < vertexCount; ++vertex)
+	{
+		size_t bucket = static_cast<size_t>(hash_vertex(streams, vertex)) & tableMask;
+
+		while (table[bucket] != EMPTY && !vertex_equal(streams, uniqueVertices[table[bucket]], vertex))
+		{
+			bucket = (bucket + 1) & tableMask;
+		}
+
+		if (table[bucket] == EMPTY)
+		{
+			table[bucket] = static_cast<uint32>(uniqueVertices.size());
+			uniqueVertices.push_back(vertex);
+		}
+
+		remap[vertex] = table[bucket];
+	}
+
+	for (uint32& index : indices)
+	{
+		index = remap[index];
+	}
+
+	return static_cast<uint32>(uniqueVertices.size());
+}
+
+auto optimize_vertex_cache(std::span<uint32> indices, uint32 vertexCount, lib::array<uint32>& clusters, uint32 cacheSize) -> void
+{
+	clusters.clear();
+
+	size_t const triangleCount = indices.size() / 3;
+
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	lib::monotonic_memory_resource& arena = lib::thread_frame_arena();
+	lib::monotonic_memory_resource::scope scratch{ arena };
+
+	// Number of triangles that have yet to be emitted for each vertex.
+	lib::array<uint32> liveTriangles(static_cast<size_t>(vertexCount), 0u, &arena);
+
+	for (uint32 index : indices)
+	{
+		++liveTriangles[index];
+	}
+
+	// Vertex to triangle adjacency, triangles of vertex i are in adjacency[offsets[i], offsets[i + 1]).
+	lib::array<uint32> offsets(static_cast<size_t>(vertexCount) + 1, 0u, &arena);
+
+	for (uint32 i = 0; i < vertexCount; ++i)
+	{
+		offsets[i + 1] = offsets[i] + liveTriangles[i];
+	}
+
+	lib::array<uint32> adjacency(indices.size(), 0u, &arena);
+
+	{
+		lib::array<uint32> filled(static_cast<size_t>(vertexCount), 0u, &arena);
+
+		for (size_t i = 0; i < indices.size(); ++i)
+		{
+			uint32 const v = indices[i];
+			adjacency[offsets[v] + filled[v]++] = static_cast<uint32>(i / 3);
+		}
+	}
+
+	VertexCacheTimestamps cache{ vertexCount, cacheSize };
+
+	lib::array<bool> emitted(triangleCount, false, &arena);
+	lib::array<uint32> deadEnd(&arena);
+	lib::array<uint32> candidates;
+	lib::array<uint32> output(&arena);
+
+	deadEnd.reserve(indices.size());
+	output.reserve(indices.size());
+
+	uint32 cursor = 0;
+	int64 fanning = -1;
+
+	auto const next_in_input_order = [&]() -> int64
+	{
+		for (; cursor < vertexCount; ++cursor)
+		{
+			if (liveTriangles[cursor] > 0)
+			{
+				return cursor;
+			}
+		}
+		return -1;
+	};
+
+	// Every time locality is lost a new cluster starts.
+	if (fanning = next_in_input_order(); fanning >= 0)
+	{
+		clusters.push_back(0);
+	}
+
+	while (fanning >= 0)
+	{
+		candidates.clear();
+
+		uint32 const vertex = static_cast<uint32>(fanning);
+
+		for (uint32 k = offsets[vertex]; k < offsets[vertex + 1]; ++k)
+		{
+			uint32 const triangle = adjacency[k];
+
+			if (emitted[triangle])
+			{
+				continue;
+			}
+
+			for (uint32 l = 0; l < 3; ++l)
+			{
+				uint32 const v = indices[triangle * 3 + l];
+
+				output.push_back(v);
+				deadEnd.push_back(v);
+				candidates.push_back(v);
+
+				--liveTriangles[v];
+
+				if (!cache.in_cache(v))
+				{
+					cache.timestamps[v] = cache.time++;
+				}
+			}
+
+			emitted[triangle] = true;
+		}
+
+		// Pick the candidate that would still be in the cache after emitting all of its remaining triangles, oldest first.
+		int64 next = -1;
+		int64 bestPriority = -1;
+
+		for (uint32 v : candidates)
+		{
+			if (liveTriangles[v] == 0)
+			{
+				continue;
+			}
+
+			int64 priority = 0;
+
+			if (cache.time - cache.timestamps[v] + 2 * liveTriangles[v] <= cacheSize)
+			{
+				priority = cache.time - cache.timestamps[v];
+			}
+
+			if (priority > bestPriority)
+			{
+				bestPriority = priority;
+				next = v;
+			}
+		}
+
+		// Dead end, go back to recently emitted vertices before resorting to the input order.
+		while (next < 0 && !deadEnd.empty())
+		{
+			uint32 const v = deadEnd.back();
+			deadEnd.pop();
+
+			if (liveTriangles[v] > 0)
+			{
+				next = v;
+			}
+		}
+
+		if (next < 0)
+		{
+			if (next = next_in_input_order(); next >= 0)
+			{
+				clusters.push_back(static_cast<uint32>(output.size() / 3));
+			}
+		}
+
+		fanning = next;
+	}
+
+	std::copy(output.begin(), output.end(), indices.begin());
+}
+
+/**
+* Splits hard clusters at points where the running ACMR is within threshold of the cluster's ACMR.
+* Smaller clusters give the overdraw sort more freedom at little cost to vertex cache efficiency.
+*/
+static auto generate_soft_clusters(std::span<uint32 const> indices, std::span<uint32 const> clusters, uint32 vertexCount, uint32 cacheSize, float32 threshold) -> lib::array<uint32>
+{
+	size_t const triangleCount = indices.size() / 3;
+
+	VertexCacheTimestamps cache{ vertexCount, cacheSize };
+
+	lib::array<uint32> result;
+	result.reserve(clusters.size());
+
+	for (size_t i = 0; i < clusters.size(); ++i)
+	{
+		size_t const start	= clusters[i];
+		size_t const end	= (i + 1 < clusters.size()) ? clusters[i + 1] : triangleCount;
+
+		if (start >= end)
+		{
+			continue;
+		}
+
+		cache.flush();
+
+		uint32 clusterMisses = 0;
+
+		for (size_t t = start; t < end; ++t)
+		{
+			clusterMisses += cache.update(&indices[t * 3]);
+		}
+
+		float32 const clusterThreshold = threshold * static_cast<float32>(clusterMisses) / static_cast<float32>(end - start);
+
+		result.push_back(static_cast<uint32>(start));
+
+		cache.flush();
+
+		uint32 runningMisses = 0;
+		uint32 runningTriangles = 0;
+
+		for (size_t t = start; t < end; ++t)
+		{
+			runningMisses += cache.update(&indices[t * 3]);
+			++runningTriangles;
+
+			if (static_cast<float32>(runningMisses) / static_cast<float32>(runningTriangles) <= clusterThreshold && t + 1 < end)
+			{
+				result.push_back(static_cast<uint32>(t + 1));
+
+				cache.flush();
+
+				runningMisses = 0;
+				runningTriangles = 0;
+			}
+		}
+	}
+
+	return result;
+}
+
+auto optimize_overdraw(
+	std::span<uint32> indices,
+	std::span<uint32 const> clusters,
+	VertexStreamView positions,
+	uint32 vertexCount,
+	uint32 cacheSize,
+	float32 threshold
+) -> void
+{
+	size_t const triangleCount = indices.size() / 3;
+
+	if (triangleCount == 0 || clusters.empty() || positions.data == nullptr || positions.componentCount < 3)
+	{
+		return;
+	}
+
+	auto const position = [&positions](uint32 vertex) -> float32 const* { return positions.data + vertex * positions.componentCount; };
+
+	lib::array<uint32> softClusters = generate_soft_clusters(indices, clusters, vertexCount, cacheSize, threshold);
+
+	size_t const clusterCount = softClusters.size();
+
+	lib::monotonic_memory_resource& arena = lib::thread_frame_arena();
+	lib::monotonic_memory_resource::scope scratch{ arena };
+
+	// Area weighted centroid and normal of every cluster.
+	lib::array<float32> clusterData(clusterCount * 6, 0.f, &arena);
+	lib::array<float32> clusterArea(clusterCount, 0.f, &arena);
+
+	float32 meshCentroid[3] = {};
+	float32 meshArea = 0.f;
+
+	for (size_t i = 0; i < clusterCount; ++i)
+	{
+		size_t const start	= softClusters[i];
+		size_t const end	= (i + 1 < clusterCount) ? softClusters[i + 1] : triangleCount;
+
+		float32* const centroid	= &clusterData[i * 6];
+		float32* const normal	= &clusterData[i * 6 + 3];
+
+		for (size_t t = start; t < end; ++t)
+		{
+			float32 const* p0 = position(indices[t * 3 + 0]);
+			float32 const* p1 = position(indices[t * 3 + 1]);
+			float32 const* p2 = position(indices[t * 3 + 2]);
+
+			float32 const e0[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+			float32 const e1[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+
+			// Cross product length is twice the triangle's area.
+			float32 const n[3] = {
+				e0[1] * e1[2] - e0[2] * e1[1],
+				e0[2] * e1[0] - e0[0] * e1[2],
+				e0[0] * e1[1] - e0[1] * e1[0]
+			};
+
+			float32 const area = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+
+			for (uint32 l = 0; l < 3; ++l)
+			{
+				float32 const c = (p0[l] + p1[l] + p2[l]) / 3.f;
+
+				centroid[l]		+= c * area;
+				normal[l]		+= n[l];
+				meshCentroid[l]	+= c * area;
+			}
+
+			clusterArea[i] += area;
+			meshArea += area;
+		}
+	}
+
+	if (meshArea > 0.f)
+	{
+		for (float32& c : meshCentroid)
+		{
+			c /= meshArea;
+		}
+	}
+
+	// Clusters facing away from the center of the mesh are more likely to occlude the rest and are drawn first.
+	lib::array<float32> sortKeys(clusterCount, 0.f, &arena);
+
+	for (size_t i = 0; i < clusterCount; ++i)
+	{
+		float32 const* centroid	= &clusterData[i * 6];
+		float32 const* normal	= &clusterData[i * 6 + 3];
+
+		float32 const area		= clusterArea[i];
+		float32 const length	= std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+
+		if (area <= 0.f || length <= 0.f)
+		{
+			continue;
+		}
+
+		float32 key = 0.f;
+
+		for (uint32 l = 0; l < 3; ++l)
+		{
+			key += (centroid[l] / area - meshCentroid[l]) * (normal[l] / length);
+		}
+
+		sortKeys[i] = key;
+	}
+
+	lib::array<uint32> order(clusterCount, 0u, &arena);
+
+	for (uint32 i = 0; i < clusterCount; ++i)
+	{
+		order[i] = i;
+	}
+
+	std::stable_sort(order.begin(), order.end(), [&sortKeys](uint32 a, uint32 b) { return sortKeys[a] > sortKeys[b]; });
+
+	lib::array<uint32> output(&arena);
+	output.reserve(indices.size());
+
+	for (uint32 cluster : order)
+	{
+		size_t const start	= softClusters[cluster];
+		size_t const end	= (cluster + 1 < clusterCount) ? softClusters[cluster + 1] : triangleCount;
+
+		for (size_t k = start * 3; k < end * 3; ++k)
+		{
+			output.push_back(indices[k]);
+		}
+	}
+
+	std::copy(output.begin(), output.end(), indices.begin());
+}
+
+auto optimize_vertex_fetch(std::span<uint32> indices, uint32 vertexCount, lib::array<uint32>& vertexOrder) -> uint32
+{
+	static constexpr uint32 UNUSED = std::numeric_limits<uint32>::max();
+
+	vertexOrder.clear();
+
+	lib::monotonic_memory_resource& arena = lib::thread_frame_arena();
+	lib::monotonic_memory_resource::scope scratch{ arena };
+
+	lib::array<uint32> remap(static_cast<size_t>(vertexCount), UNUSED, &arena);
+
+	for (uint32& index : indices)
+	{
+		if (remap[index] == UNUSED)
+		{
+			remap[index] = static_cast<uint32>(vertexOrder.size());
+			vertexOrder.push_back(index);
+		}
+
+		index = remap[index];
+	}
+
+	return static_cast<uint32>(vertexOrder.size());
+}
+
+auto analyze_vertex_cache(std::span<uint32 const> indices, uint32 vertexCount, uint32 cacheSize) -> VertexCacheStatistics
+{
+	VertexCacheStatistics statistics{ .vertexCount = 0, .triangleCount = static_cast<uint32>(indices.size() / 3), .cacheMisses = 0 };
+
+	VertexCacheTimestamps cache{ vertexCount, cacheSize };
+	lib::array<bool> referenced(static_cast<size_t>(vertexCount), false);
+
+	for (size_t t = 0; t < statistics.triangleCount; ++t)
+	{
+		statistics.cacheMisses += cache.update(&indices[t * 3]);
+	}
+
+	for (uint32 index : indices)
+	{
+		if (!referenced[index])
+		{
+			referenced[index] = true;
+			++statistics.vertexCount;
+		}
+	}
+
+	return statistics;
+}
+}
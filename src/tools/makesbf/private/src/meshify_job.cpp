@@ -2,6 +2,7 @@
 #include "cgltf.h"
 #include "meshify_job.hpp"
 #include "makesbf.hpp"
+#include "math/pack.h"
 
 /**
 * TODO(afiq):
@@ -27,11 +28,125 @@ static_assert(glz::detail::reflectable<render::material::util::MaterialRepresent
 
 namespace makesbf
 {
+/**
+* glTF is right handed with +Z pointing out of the screen. Flip Z so that it points into the screen.
+* Only the xyz components are transformed, a fourth component (tangent handedness, color alpha) is kept as is.
+*/
+static constexpr float32 VERTEX_MULTIPLIER[3] = { 1.f, 1.f, -1.f };
+
+/**
+* Encodes a single vertex's attribute into dst in the format described by the encoding.
+*/
+static auto encode_vertex_attribute(
+	std::byte* dst,
+	render::VertexAttribute attrib,
+	render::VertexEncoding encoding,
+	render::MeshBounds const& bounds,
+	float32 const* data,
+	size_t componentCount
+) -> void
+{
+	using enum render::VertexEncoding;
+
+	auto const encoded = [encoding](render::VertexEncoding e) -> bool { return (encoding & e) != None; };
+
+	switch (attrib)
+	{
+	case render::VertexAttribute::Position:
+		{
+			uint16 quantized[4] = {};
+
+			for (uint32 i = 0; i < 3; ++i)
+			{
+				float32 const extent = bounds.max[i] - bounds.min[i];
+				quantized[i] = math::pack::float_to_unorm16((extent > 0.f) ? (data[i] - bounds.min[i]) / extent : 0.f);
+			}
+
+			std::memcpy(dst, quantized, sizeof(quantized));
+		}
+		break;
+	case render::VertexAttribute::Normal:
+		{
+			uint32 const octahedral = math::pack::octahedral_encode(math::vec3{ data[0], data[1], data[2] });
+			std::memcpy(dst, &octahedral, sizeof(octahedral));
+		}
+		break;
+	case render::VertexAttribute::Tangent:
+		{
+			uint32 octahedral = math::pack::octahedral_encode(math::vec3{ data[0], data[1], data[2] });
+
+			// Sacrifice the lowest bit of y to keep the bitangent's sign.
+			uint32 const sign = (componentCount > 3 && data[3] < 0.f) ? 1u : 0u;
+			octahedral = (octahedral & ~(1u << 16)) | (sign << 16);
+
+			std::memcpy(dst, &octahedral, sizeof(octahedral));
+		}
+		break;
+	case render::VertexAttribute::TexCoord:
+		if (encoded(TexCoord_Half))
+		{
+			uint16 const half[2] = { math::pack::float_to_half(data[0]), math::pack::float_to_half(data[1]) };
+			std::memcpy(dst, half, sizeof(half));
+		}
+		else
+		{
+			uint16 const unorm[2] = { math::pack::float_to_unorm16(data[0]), math::pack::float_to_unorm16(data[1]) };
+			std::memcpy(dst, unorm, sizeof(unorm));
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+/**
+* Writes every vertex's attribute into the buffer in the format described by the encoding.
+* Attributes without an encoding are written out as is, encoded attributes are encoded straight into the buffer.
+* Returns false if the buffer does not have room for the attribute.
+*/
+static auto write_vertex_stream(
+	core::sbf::Buffer& buffer,
+	render::VertexAttribute attrib,
+	render::VertexEncoding encoding,
+	render::MeshBounds const& bounds,
+	float32 const* data,
+	size_t vertexCount,
+	size_t componentCount
+) -> bool
+{
+	if (vertexCount == 0)
+	{
+		return true;
+	}
+
+	uint32 const encodedSizeBytes = render::attribute_size_bytes(attrib, encoding);
+
+	if (encodedSizeBytes == render::attribute_size_bytes(attrib, render::VertexEncoding::None))
+	{
+		return buffer.write(data, sizeof(float32) * vertexCount * componentCount);
+	}
+
+	std::span<std::byte> const dst = buffer.reserve_for<std::byte>(vertexCount * encodedSizeBytes);
+
+	if (dst.empty())
+	{
+		return false;
+	}
+
+	for (size_t k = 0; k < vertexCount; ++k)
+	{
+		encode_vertex_attribute(&dst[k * encodedSizeBytes], attrib, encoding, bounds, &data[k * componentCount], componentCount);
+	}
+
+	return true;
+}
+
 MeshifyJob::MeshifyJob(MakeSbf& makeSbf, MeshifyJobInfo const& info) :
 	m_tool{ makeSbf },
 	m_info{ info },
 	m_unpackedMeshes{},
-	m_materials{}
+	m_materials{},
+	m_cacheStatistics{}
 {}
 
 auto MeshifyJob::execute() -> std::optional<std::string_view>
@@ -53,7 +168,21 @@ auto MeshifyJob::execute() -> std::optional<std::string_view>
 
 	core::sbf::Buffer scratchBuffer{ bufferInfo, *m_info.allocator.resource() };
 
-	_convert_gltf_to_ours(scratchBuffer, model);
+	if (!_convert_gltf_to_ours(scratchBuffer, model))
+	{
+		return "Could not write mesh data into the scratch buffer.";
+	}
+
+	if (auto const& [before, after] = m_cacheStatistics; m_info.optimize && before.triangleCount != 0)
+	{
+		fmt::print(
+			"[Info] {}: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}, vertices {} -> {}\n",
+			m_info.input.filename().string(),
+			before.acmr(), after.acmr(),
+			before.atvr(), after.atvr(),
+			before.vertexCount, after.vertexCount
+		);
+	}
 
 	core::sbf::WriteStream stream{ m_info.output };
 
@@ -133,7 +262,7 @@ auto MeshifyJob::_calculate_num_meshes_and_total_size_bytes(gltf::Importer const
 			if (mesh.has_attribute(gltfAttribEnum))
 			{
 				auto const attribInfo = mesh.attribute_info(static_cast<gltf::VertexAttribute>(j));
-				totalSizeBytes += attribInfo.totalSizeBytes;
+				totalSizeBytes += _attribute_size_bytes(vertexAttribute, attribInfo, attribInfo.numVertices);
 			}
 		}
 
@@ -143,7 +272,7 @@ auto MeshifyJob::_calculate_num_meshes_and_total_size_bytes(gltf::Importer const
 	return { numMeshes, totalSizeBytes };
 }
 
-auto MeshifyJob::_convert_gltf_to_ours(core::sbf::Buffer& buffer, gltf::Importer const& model) -> void
+auto MeshifyJob::_convert_gltf_to_ours(core::sbf::Buffer& buffer, gltf::Importer const& model) -> bool
 {
 	uint32 const meshCount = model.num_meshes();
 
@@ -158,47 +287,229 @@ auto MeshifyJob::_convert_gltf_to_ours(core::sbf::Buffer& buffer, gltf::Importer
 
 		auto mesh = *meshExist;
 
-		_unpack_mesh_vertex_data(j, buffer, mesh);
-		_unpack_mesh_index_data(j, buffer, mesh);
+		MeshStreams streams{};
+
+		if (!_load_mesh_streams(mesh, streams))
+		{
+			return false;
+		}
+
+		if (m_info.optimize && mesh.topology() == render::Topology::Triangles)
+		{
+			_optimize_mesh_streams(streams);
+		}
+
+		if (!_unpack_mesh_vertex_data(j, buffer, mesh, streams) ||
+			!_unpack_mesh_index_data(j, buffer, streams))
+		{
+			return false;
+		}
 
 		auto&& unpackMeshInfo = m_unpackedMeshes[j];
 
 		unpackMeshInfo.header.descriptor.sizeBytes = unpackMeshInfo.header.meshInfo.vertices.sizeBytes + unpackMeshInfo.header.meshInfo.indices.sizeBytes;
 		++j;
 	}
+
+	return true;
 }
 
-auto MeshifyJob::_attribute_element_count(render::VertexAttribute attrib) -> uint32
+auto MeshifyJob::_attribute_size_bytes(render::VertexAttribute attrib, gltf::AttributeInfo const& attribInfo, size_t numVertices) const -> size_t
 {
-	switch (attrib)
+	uint32 const encodedSizeBytes = render::attribute_size_bytes(attrib, m_info.encoding);
+
+	// Attributes that are not encoded keep every component stored in the source file.
+	if (encodedSizeBytes == render::attribute_size_bytes(attrib, render::VertexEncoding::None))
 	{
-	case render::VertexAttribute::Position:
-		return 3;
-	case render::VertexAttribute::Normal:
-		return 3;
-	case render::VertexAttribute::Tangent:
-		return 3;
-	case render::VertexAttribute::Color:
-		return 3;
-	case render::VertexAttribute::TexCoord:
-		return 2;
-	default:
-		return 0;
+		return numVertices * attribInfo.componentCountForType * sizeof(float32);
+	}
+
+	return numVertices * static_cast<size_t>(encodedSizeBytes);
+}
+
+auto MeshifyJob::_compute_mesh_bounds(gltf::Mesh const& mesh, MeshStreams const& streams, render::MeshBounds& bounds) const -> void
+{
+	bounds = {};
+
+	auto const& positions = streams.attributes[std::to_underlying(gltf::VertexAttribute::Position)];
+
+	if (positions.componentCount < 3 || streams.vertexCount == 0)
+	{
+		return;
+	}
+
+	float32 min[3] = {};
+	float32 max[3] = {};
+
+	// Use the bounds specified in the accessor if there are any, they only need to go through the same transformation as the vertices.
+	if (mesh.attribute_bounds(gltf::VertexAttribute::Position, min, max, 3))
+	{
+		// Flipping an axis swaps its min and max.
+		for (uint32 l = 0; l < 3; ++l)
+		{
+			float32 const a = min[l] * VERTEX_MULTIPLIER[l];
+			float32 const b = max[l] * VERTEX_MULTIPLIER[l];
+
+			bounds.min[l] = std::min(a, b);
+			bounds.max[l] = std::max(a, b);
+		}
+		return;
+	}
+
+	std::fill(std::begin(bounds.min), std::end(bounds.min), std::numeric_limits<float32>::max());
+	std::fill(std::begin(bounds.max), std::end(bounds.max), std::numeric_limits<float32>::lowest());
+
+	for (size_t k = 0; k < static_cast<size_t>(streams.vertexCount); ++k)
+	{
+		float32 const* data = &positions.data[k * positions.componentCount];
+
+		for (uint32 l = 0; l < 3; ++l)
+		{
+			bounds.min[l] = std::min(bounds.min[l], data[l]);
+			bounds.max[l] = std::max(bounds.max[l], data[l]);
+		}
 	}
 }
 
-auto MeshifyJob::_unpack_mesh_vertex_data(uint32 i, core::sbf::Buffer& buffer, gltf::Mesh const& mesh) -> void
+auto MeshifyJob::_load_mesh_streams(gltf::Mesh const& mesh, MeshStreams& streams) const -> bool
 {
 	auto constexpr MAX_ATTRIBUTES = std::to_underlying(gltf::VertexAttribute::Max);
 
-	constexpr float32 VERTEX_MULTIPLIER[4] = { 1.f, 1.f, -1.f, 0.f };
+	size_t const numVertices = static_cast<size_t>(mesh.num_vertices());
+
+	streams.vertexCount = mesh.num_vertices();
+
+	for (auto j = 0; j < MAX_ATTRIBUTES; ++j)
+	{
+		auto const gltfAttribEnum = static_cast<gltf::VertexAttribute>(j);
+		auto const vertexAttrib = static_cast<render::VertexAttribute>(1 << j);
+
+		auto& stream = streams.attributes[j];
+
+		stream.componentCount = 0;
+
+		if ((m_info.attributes & vertexAttrib) == render::VertexAttribute::None ||
+			!mesh.has_attribute(gltfAttribEnum))
+		{
+			continue;
+		}
+
+		size_t const componentCountForType = mesh.attribute_info(gltfAttribEnum).componentCountForType;
+
+		stream.componentCount = componentCountForType;
+		stream.data.assign(numVertices * componentCountForType, 0.f);
+
+		// The axis flip is applied while decoding.
+		if (!mesh.unpack_vertex_data(gltfAttribEnum, std::span{ stream.data.data(), stream.data.size() }, std::span<float32 const>{ VERTEX_MULTIPLIER }))
+		{
+			return false;
+		}
+	}
+
+	// Meshes without an index accessor keep an empty index stream.
+	if (mesh.num_indices() == 0)
+	{
+		return true;
+	}
+
+	streams.indices.assign(static_cast<size_t>(mesh.num_indices()), 0u);
+
+	return mesh.unpack_index_data(std::span{ streams.indices.data(), streams.indices.size() });
+}
+
+auto MeshifyJob::_optimize_mesh_streams(MeshStreams& streams) -> void
+{
+	// Triangle reordering is only meaningful for indexed triangle lists.
+	if (streams.indices.empty() || streams.indices.size() % 3 != 0)
+	{
+		return;
+	}
+
+	std::span<uint32> indices{ streams.indices.data(), streams.indices.size() };
+
+	uint32 const cacheSize = m_info.vertexCacheSize;
+
+	m_cacheStatistics[0] += analyze_vertex_cache(indices, streams.vertexCount, cacheSize);
+
+	std::array<VertexStreamView, std::tuple_size_v<decltype(streams.attributes)>> views = {};
+	size_t viewCount = 0;
+
+	for (auto const& stream : streams.attributes)
+	{
+		if (stream.componentCount != 0)
+		{
+			views[viewCount++] = VertexStreamView{ .data = stream.data.data(), .componentCount = stream.componentCount };
+		}
+	}
+
+	lib::array<uint32> order;
+
+	// 1. Collapse vertices that are exactly the same, DCC exports tend to be full of them.
+	uint32 vertexCount = deduplicate_vertices(std::span{ views.data(), viewCount }, streams.vertexCount, indices, order);
+
+	_remap_mesh_streams(streams, order, vertexCount);
+
+	// 2. Reorder triangles for the post-transform vertex cache and then reorder clusters of them to reduce overdraw.
+	lib::array<uint32> clusters;
+
+	optimize_vertex_cache(indices, vertexCount, clusters, cacheSize);
+
+	if (auto const& positions = streams.attributes[std::to_underlying(gltf::VertexAttribute::Position)]; positions.componentCount >= 3)
+	{
+		optimize_overdraw(
+			indices,
+			std::span{ clusters.data(), clusters.size() },
+			VertexStreamView{ .data = positions.data.data(), .componentCount = positions.componentCount },
+			vertexCount,
+			cacheSize
+		);
+	}
+
+	// 3. Lay the vertices out in the order the triangles reference them.
+	vertexCount = optimize_vertex_fetch(indices, vertexCount, order);
+
+	_remap_mesh_streams(streams, order, vertexCount);
+
+	m_cacheStatistics[1] += analyze_vertex_cache(indices, streams.vertexCount, cacheSize);
+}
+
+auto MeshifyJob::_remap_mesh_streams(MeshStreams& streams, lib::array<uint32> const& order, uint32 vertexCount) -> void
+{
+	for (auto& stream : streams.attributes)
+	{
+		if (stream.componentCount == 0)
+		{
+			continue;
+		}
+
+		size_t const componentCount = stream.componentCount;
+
+		lib::array<float32> remapped(static_cast<size_t>(vertexCount) * componentCount, 0.f);
+
+		for (size_t k = 0; k < static_cast<size_t>(vertexCount); ++k)
+		{
+			std::memcpy(&remapped[k * componentCount], &stream.data[order[k] * componentCount], sizeof(float32) * componentCount);
+		}
+
+		stream.data = std::move(remapped);
+	}
+
+	streams.vertexCount = vertexCount;
+}
+
+auto MeshifyJob::_unpack_mesh_vertex_data(uint32 i, core::sbf::Buffer& buffer, gltf::Mesh const& mesh, MeshStreams const& streams) -> bool
+{
+	auto constexpr MAX_ATTRIBUTES = std::to_underlying(gltf::VertexAttribute::Max);
 
 	auto&& [header, meshObj] = m_unpackedMeshes[static_cast<size_t>(i)];
 
-	size_t const numVertices = static_cast<size_t>(mesh.num_vertices());
+	size_t const numVertices = static_cast<size_t>(streams.vertexCount);
 
-	header.meshInfo.vertices.count = mesh.num_vertices();
+	header.meshInfo.vertices.count = streams.vertexCount;
 	header.meshInfo.topology = mesh.topology();
+	header.meshInfo.encoding = m_info.encoding;
+
+	_compute_mesh_bounds(mesh, streams, header.meshInfo.bounds);
 
 	size_t const bufferByteOffset = buffer.byte_offset();
 
@@ -212,34 +523,23 @@ auto MeshifyJob::_unpack_mesh_vertex_data(uint32 i, core::sbf::Buffer& buffer, g
 			continue;
 		}
 
-		if (mesh.has_attribute(gltfAttribEnum))
+		auto const& stream = streams.attributes[j];
+
+		if (stream.componentCount != 0)
 		{
 			auto const attribInfo = mesh.attribute_info(gltfAttribEnum);
 
-			size_t const componentCountForType	= attribInfo.componentCountForType;
-			[[maybe_unused]] size_t const totalComponentCount	= attribInfo.numVertices * attribInfo.componentCountForType;
+			size_t const componentCountForType = stream.componentCount;
 
 			header.meshInfo.attributes |= vertexAttrib;
-			header.meshInfo.vertices.sizeBytes += static_cast<uint32>(attribInfo.totalSizeBytes);
+			header.meshInfo.vertices.sizeBytes += static_cast<uint32>(_attribute_size_bytes(vertexAttrib, attribInfo, numVertices));
 
-			size_t fetchedComponentCount = {};
-			float32 data[4] = {};
+			ASSERTION(stream.data.size() == numVertices * componentCountForType);
 
-			for (size_t k = 0; k < numVertices; ++k)
+			if (!write_vertex_stream(buffer, vertexAttrib, m_info.encoding, header.meshInfo.bounds, stream.data.data(), numVertices, componentCountForType))
 			{
-				mesh.read_float_data(gltfAttribEnum, k, data, componentCountForType);
-
-				for (uint32 l = 0; l < componentCountForType; ++l)
-				{
-					data[l] *= VERTEX_MULTIPLIER[l];
-				}
-
-				// Write to the buffer.
-				buffer.write(&data, sizeof(float32) * componentCountForType);
-				fetchedComponentCount += componentCountForType;
+				return false;
 			}
-
-			ASSERTION(fetchedComponentCount == totalComponentCount);
 		}
 	}
 
@@ -249,30 +549,63 @@ auto MeshifyJob::_unpack_mesh_vertex_data(uint32 i, core::sbf::Buffer& buffer, g
 	{
 		meshObj.vertices = std::span{ ptr, header.meshInfo.vertices.sizeBytes / sizeof(float32) };
 	}
+
+	return true;
 }
 
-auto MeshifyJob::_unpack_mesh_index_data(uint32 i, core::sbf::Buffer& buffer, gltf::Mesh const& mesh) -> void
+auto MeshifyJob::_unpack_mesh_index_data(uint32 i, core::sbf::Buffer& buffer, MeshStreams const& streams) -> bool
 {
 	auto&& [header, meshObj] = m_unpackedMeshes[static_cast<size_t>(i)];
 
-	header.meshInfo.indices.count = mesh.num_indices();
-	header.meshInfo.indices.sizeBytes = static_cast<uint32>(mesh.indices_size_bytes());
+	uint32 const numIndices = static_cast<uint32>(streams.indices.size());
+
+	// 16-bit indices are used whenever every vertex can be addressed by them. 0xFFFF is left alone as it doubles as the primitive restart index.
+	gpu::IndexType const indexType = (streams.vertexCount <= std::numeric_limits<uint16>::max()) ? gpu::IndexType::Uint_16 : gpu::IndexType::Uint_32;
 
-	uint32 const numIndices = mesh.num_indices();
+	uint32 const indicesSizeBytes = numIndices * render::index_size_bytes(indexType);
 
-	uint32* ptr = (std::cmp_not_equal(header.meshInfo.indices.count, 0)) ? static_cast<uint32*>(buffer.current_byte()) : nullptr;
-	
+	header.meshInfo.indexType = indexType;
+	header.meshInfo.indices.count = numIndices;
+	header.meshInfo.indices.sizeBytes = (indicesSizeBytes + 3u) & ~3u;
 
-	for (uint32 j = 0; j < numIndices; ++j)
+	std::byte* ptr = (std::cmp_not_equal(header.meshInfo.indices.count, 0)) ? static_cast<std::byte*>(buffer.current_byte()) : nullptr;
+
+	if (ptr == nullptr)
 	{
-		uint32 index = mesh.read_uint_data(j);
-		buffer.write(index);
+		return true;
 	}
 
-	if (ptr != nullptr)
+	if (indexType == gpu::IndexType::Uint_16)
 	{
-		meshObj.indices = std::span{ ptr, static_cast<size_t>(numIndices) };
+		std::span<uint16> const dst = buffer.reserve_for<uint16>(static_cast<size_t>(numIndices));
+
+		if (dst.empty())
+		{
+			return false;
+		}
+
+		for (size_t k = 0; k < dst.size(); ++k)
+		{
+			dst[k] = static_cast<uint16>(streams.indices[k]);
+		}
+	}
+	else if (!buffer.write(streams.indices.data(), streams.indices.size_bytes()))
+	{
+		return false;
 	}
+
+	// Pad the index data so that the next mesh's vertices begin at a 4 byte boundary.
+	if (uint32 const padding = header.meshInfo.indices.sizeBytes - indicesSizeBytes; padding != 0)
+	{
+		if (!buffer.fill(std::byte{ 0 }, static_cast<size_t>(padding)))
+		{
+			return false;
+		}
+	}
+
+	meshObj.indices = std::span{ ptr, static_cast<size_t>(header.meshInfo.indices.sizeBytes) };
+
+	return true;
 }
 
 auto MeshifyJob::_unpack_materials(gltf::Importer const& model) -> void
@@ -6,11 +6,17 @@
 #include "render/render.hpp"
 #include "lib/array.hpp"
 #include "lib/string.hpp"
+#include "lib/tracking_memory_resource.hpp"
 
 namespace makesbf
 {
 namespace gltf
 {
+/**
+* Accounts for everything the importers allocate, including cgltf's own allocations and the loaded buffers.
+*/
+auto memory_tracker() -> lib::tracking_memory_resource&;
+
 struct ImageInfo
 {
 	std::wstring_view uri;
@@ -93,14 +99,22 @@ public:
 	auto topology() const -> render::Topology;
 	auto attribute_info(VertexAttribute attribute) const -> AttributeInfo;
 	auto has_attribute(VertexAttribute attribute) const -> bool;
+	auto attribute_bounds(VertexAttribute attribute, float32* min, float32* max, size_t elementSize) const -> bool;
 	auto read_uint_data(size_t index) const -> uint32;
 	auto read_float_data(VertexAttribute attribute, size_t index, float32* out, size_t elementSize) const -> void;
-	auto unpack_vertex_data(VertexAttribute attribute, std::span<float32> floatData) const -> void;
-
+	/**
+	* Decodes the whole accessor of the attribute into floatData as tightly packed vertices of componentCountForType floats.
+	* Normalized integer components are converted to floats. Every component is multiplied by the matching entry in scale, if there is one.
+	*/
+	[[nodiscard]] auto unpack_vertex_data(VertexAttribute attribute, std::span<float32> floatData, std::span<float32 const> scale = {}) const -> bool;
+
+	/**
+	* Decodes the whole index accessor into data, converting every index to T.
+	*/
 	template <std::integral T>
-	auto unpack_index_data(std::span<T> data) const -> void
+	[[nodiscard]] auto unpack_index_data(std::span<T> data) const -> bool
 	{
-		unpack_index_data_internal(data.data(), data.size(), sizeof(T));
+		return unpack_index_data_internal(data.data(), data.size(), sizeof(T));
 	}
 
 	auto material_info() const -> MaterialInfo const&;
@@ -112,7 +126,7 @@ private:
 
 	Mesh(MeshInfo& meshInfo);
 
-	auto unpack_index_data_internal(void* data, size_t count, size_t size) const -> void;
+	[[nodiscard]] auto unpack_index_data_internal(void* data, size_t count, size_t size) const -> bool;
 };
 
 class Importer
@@ -2,9 +2,13 @@
 #define MESHIFY_MESHIFY_HPP
 
 #include <filesystem>
-#include <queue>
+#include <mutex>
 #include "lib/string.hpp"
 #include "lib/map.hpp"
+#include "lib/set.hpp"
+#include "lib/jobs.hpp"
+#include "render/mesh.hpp"
+#include "mesh_optimizer.hpp"
 
 namespace makesbf
 {
@@ -22,6 +26,9 @@ public:
 	auto mise_en_place(int argc, char** argv) -> bool;
 	auto cook() -> void;
 
+	/**
+	* @brief Thread safe. Jobs added while cooking are scheduled right away. Jobs writing to an output that has already been scheduled are dropped.
+	*/
 	auto add_job(std::filesystem::path&& input, std::filesystem::path&& output, std::filesystem::path&& filename) -> void;
 private:
 	static const lib::map<std::filesystem::path, JobType> EXTENSION_TASK_MAP;
@@ -33,9 +40,19 @@ private:
 		JobType jobType;
 	};
 
-	std::queue<MakeSbfJobDescription> m_jobDescription;
+	lib::array<MakeSbfJobDescription> m_jobDescriptions;
+	lib::set<std::filesystem::path> m_scheduledOutputs;
+	std::mutex m_jobMutex;
+	lib::jobs::scheduler* m_scheduler = nullptr;
+	lib::jobs::counter* m_pending = nullptr;
+	uint32 m_workerCount = 0;
 	std::filesystem::path m_baseDirectory;
+	render::VertexEncoding m_vertexEncoding = render::VertexEncoding::None;
+	bool m_optimizeMeshes = true;
+	uint32 m_vertexCacheSize = DEFAULT_VERTEX_CACHE_SIZE;
 
+	auto _schedule_job(MakeSbfJobDescription&& description) -> void;
+	auto _run_job(MakeSbfJobDescription const& description) -> void;
 	auto _translate_gltf_to_sbf(MakeSbfJobDescription const& description) -> void;
 	auto _translate_ktx2_to_sbf(MakeSbfJobDescription const& description) -> void;
 };
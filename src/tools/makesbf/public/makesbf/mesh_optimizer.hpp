@@ -0,0 +1,81 @@
+#pragma once
+#ifndef MAKESBF_MESH_OPTIMIZER_HPP
+#define MAKESBF_MESH_OPTIMIZER_HPP
+
+#include <span>
+#include "lib/array.hpp"
+
+namespace makesbf
+{
+inline static constexpr uint32 DEFAULT_VERTEX_CACHE_SIZE	= 16u;
+inline static constexpr float32 DEFAULT_OVERDRAW_THRESHOLD	= 1.05f;
+
+/**
+* @brief Non-owning view to a single vertex attribute stream. Vertex i's data lives in data[i * componentCount].
+*/
+struct VertexStreamView
+{
+	float32 const* data;
+	size_t componentCount;
+};
+
+/**
+* @brief Result of simulating a FIFO post-transform vertex cache over an index buffer.
+*/
+struct VertexCacheStatistics
+{
+	uint32 vertexCount;		// Number of unique vertices referenced by the index buffer.
+	uint32 triangleCount;
+	uint32 cacheMisses;
+
+	/**
+	* @brief Average cache miss ratio, transformed vertices per triangle. 0.5 is the theoretical best, 3.0 is the worst.
+	*/
+	auto acmr() const -> float32;
+	/**
+	* @brief Average transformed vertex ratio, transformed vertices per unique vertex. 1.0 is the best.
+	*/
+	auto atvr() const -> float32;
+
+	auto operator+=(VertexCacheStatistics const& rhs) -> VertexCacheStatistics&;
+};
+
+/**
+* @brief Collapses vertices whose attributes are bitwise identical in every stream and rewrites the indices to reference the unique vertices.
+* @return Number of unique vertices. uniqueVertices[i] holds the source vertex for unique vertex i.
+*/
+auto deduplicate_vertices(std::span<VertexStreamView const> streams, uint32 vertexCount, std::span<uint32> indices, lib::array<uint32>& uniqueVertices) -> uint32;
+
+/**
+* @brief Reorders triangles to improve post-transform vertex cache hits using Tipsify (Sander et al. 2007).
+* clusters receives the starting triangle of every run where locality to the previous run was lost.
+*/
+auto optimize_vertex_cache(std::span<uint32> indices, uint32 vertexCount, lib::array<uint32>& clusters, uint32 cacheSize = DEFAULT_VERTEX_CACHE_SIZE) -> void;
+
+/**
+* @brief Reorders the clusters produced by optimize_vertex_cache so that outward facing clusters are drawn first.
+* Clusters are split further where the vertex cache efficiency stays within threshold of the cluster's own ACMR.
+*/
+auto optimize_overdraw(
+	std::span<uint32> indices,
+	std::span<uint32 const> clusters,
+	VertexStreamView positions,
+	uint32 vertexCount,
+	uint32 cacheSize = DEFAULT_VERTEX_CACHE_SIZE,
+	float32 threshold = DEFAULT_OVERDRAW_THRESHOLD
+) -> void;
+
+/**
+* @brief Renumbers vertices in the order they are first referenced by the indices so vertex fetches are sequential.
+* Vertices that are never referenced are dropped.
+* @return Number of referenced vertices. vertexOrder[i] holds the previous index of vertex i.
+*/
+auto optimize_vertex_fetch(std::span<uint32> indices, uint32 vertexCount, lib::array<uint32>& vertexOrder) -> uint32;
+
+/**
+* @brief Simulates a FIFO vertex cache of cacheSize entries over the indices.
+*/
+auto analyze_vertex_cache(std::span<uint32 const> indices, uint32 vertexCount, uint32 cacheSize = DEFAULT_VERTEX_CACHE_SIZE) -> VertexCacheStatistics;
+}
+
+#endif // !MAKESBF_MESH_OPTIMIZER_HPP
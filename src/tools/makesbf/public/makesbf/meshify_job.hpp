@@ -2,12 +2,14 @@
 #ifndef MAKESBF_MESHIFY_JOB_HPP
 #define MAKESBF_MESHIFY_JOB_HPP
 
+#include <array>
 #include <filesystem>
 
 #include "core.serialization/write_stream.hpp"
 #include "render/render.hpp"
 
 #include "gltf_importer.hpp"
+#include "mesh_optimizer.hpp"
 
 namespace makesbf
 {
@@ -18,6 +20,9 @@ struct MeshifyJobInfo
 	size_t writeStreamBufferCapacity = 5_MiB;
 	lib::allocator<std::byte> allocator = {};
 	render::VertexAttribute attributes;
+	render::VertexEncoding encoding = render::VertexEncoding::None;
+	bool optimize = true;
+	uint32 vertexCacheSize = DEFAULT_VERTEX_CACHE_SIZE;
 };
 
 class MakeSbf;
@@ -41,20 +46,41 @@ private:
 		render::MeshView data;
 	};
 
+	/**
+	* Vertex attributes and indices of a mesh decoded into memory so they can be optimized before being written out.
+	*/
+	struct MeshStreams
+	{
+		struct Attribute
+		{
+			lib::array<float32> data;
+			size_t componentCount;
+		};
+
+		std::array<Attribute, std::to_underlying(gltf::VertexAttribute::Max)> attributes;
+		lib::array<uint32> indices;
+		uint32 vertexCount;
+	};
+
 	MakeSbf& m_tool;
 	MeshifyJobInfo m_info;
 	lib::array<MeshInfo> m_unpackedMeshes;
 	render::material::util::MaterialJSON m_materials;
+	VertexCacheStatistics m_cacheStatistics[2];
 
 	auto _calculate_num_meshes_and_total_size_bytes(gltf::Importer const& model) const -> std::pair<size_t, size_t>;
-	auto _convert_gltf_to_ours(core::sbf::Buffer& buffer, gltf::Importer const& model) -> void;
-	auto _unpack_mesh_vertex_data(uint32 i, core::sbf::Buffer& buffer, gltf::Mesh const& mesh) -> void;
-	auto _unpack_mesh_index_data(uint32 i, core::sbf::Buffer& buffer, gltf::Mesh const& mesh) -> void;
+	auto _convert_gltf_to_ours(core::sbf::Buffer& buffer, gltf::Importer const& model) -> bool;
+	auto _attribute_size_bytes(render::VertexAttribute attrib, gltf::AttributeInfo const& attribInfo, size_t numVertices) const -> size_t;
+	auto _compute_mesh_bounds(gltf::Mesh const& mesh, MeshStreams const& streams, render::MeshBounds& bounds) const -> void;
+	auto _load_mesh_streams(gltf::Mesh const& mesh, MeshStreams& streams) const -> bool;
+	auto _optimize_mesh_streams(MeshStreams& streams) -> void;
+	auto _unpack_mesh_vertex_data(uint32 i, core::sbf::Buffer& buffer, gltf::Mesh const& mesh, MeshStreams const& streams) -> bool;
+	auto _unpack_mesh_index_data(uint32 i, core::sbf::Buffer& buffer, MeshStreams const& streams) -> bool;
+
+	static auto _remap_mesh_streams(MeshStreams& streams, lib::array<uint32> const& order, uint32 vertexCount) -> void;
 
 	auto _unpack_materials(gltf::Importer const& model) -> void;
 	auto _output_material_json() -> void;
-
-	static auto _attribute_element_count(render::VertexAttribute attrib) -> uint32;
 };
 }
 